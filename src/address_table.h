@@ -0,0 +1,131 @@
+#ifndef SPLINTERCELLPATCH_ADDRESS_TABLE_H
+#define SPLINTERCELLPATCH_ADDRESS_TABLE_H
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Fixed-capacity lock-free hash table keyed by an object's address (a CRITICAL_SECTION, a wait handle). Lookups and
+// inserts never lock or allocate, so they are safe inside hooks on the lock and heap functions themselves.
+//
+// Open addressing with linear probing. A slot is claimed by a compare-exchange on its key and is never freed: an
+// address that is reused (a lock deleted and initialized again) keeps its slot, and the owner resets the value.
+// Inserts stop once the table is three quarters full, so probes stay short; later keys are simply not tracked. A
+// slot is reserved against that limit before it is claimed, so racing inserts never overshoot it; an insert racing
+// another for the last reservation may be refused even when the other ends up claiming an existing key's slot.
+//
+// Values are default-constructed up front and must tolerate concurrent access on their own (atomics). A value can
+// be observed by a lookup before its inserter has initialized it.
+
+template <typename Value>
+class AddressTable {
+public:
+    AddressTable() = default;
+    AddressTable(const AddressTable &) = delete;
+    AddressTable &operator=(const AddressTable &) = delete;
+
+    // Allocates the slots, rounding capacity up to a power of two. Not thread-safe; call before any lookup.
+    [[nodiscard]] bool Create(size_t capacity) {
+        if (m_slots || capacity == 0 || capacity > (size_t{1} << 24)) {
+            return false;
+        }
+        m_capacity = std::bit_ceil(std::max<size_t>(capacity, 16));
+        m_slots = std::make_unique<Slot[]>(m_capacity);
+        m_shift = 64 - std::countr_zero(m_capacity);
+        m_limit = m_capacity / 4 * 3;
+        return true;
+    }
+
+    [[nodiscard]] bool Active() const { return m_slots != nullptr; }
+
+    // Null when the key is not in the table
+    [[nodiscard]] Value *Find(const void *address) const {
+        const auto key = reinterpret_cast<uintptr_t>(address);
+        if (!m_slots || key == 0) {
+            return nullptr;
+        }
+        for (size_t i = Home(key), probes = 0; probes < m_capacity; i = (i + 1) & (m_capacity - 1), ++probes) {
+            const uintptr_t current = m_slots[i].key.load(std::memory_order_acquire);
+            if (current == key) {
+                return &m_slots[i].value;
+            }
+            if (current == 0) {
+                return nullptr;
+            }
+        }
+        return nullptr;
+    }
+
+    // Null when the table is full. inserted tells the one caller that claimed the slot to initialize the value.
+    [[nodiscard]] Value *FindOrInsert(const void *address, bool &inserted) {
+        inserted = false;
+        const auto key = reinterpret_cast<uintptr_t>(address);
+        if (!m_slots || key == 0) {
+            return nullptr;
+        }
+        for (size_t i = Home(key), probes = 0; probes < m_capacity; i = (i + 1) & (m_capacity - 1), ++probes) {
+            uintptr_t current = m_slots[i].key.load(std::memory_order_acquire);
+            if (current == 0) {
+                if (!Reserve()) {
+                    return nullptr;
+                }
+                // Losing the race to the same key is a hit; losing it to another key moves on
+                if (m_slots[i].key.compare_exchange_strong(current, key, std::memory_order_acq_rel)) {
+                    inserted = true;
+                    return &m_slots[i].value;
+                }
+                m_size.fetch_sub(1, std::memory_order_relaxed);
+            }
+            if (current == key) {
+                return &m_slots[i].value;
+            }
+        }
+        return nullptr;
+    }
+
+    // Calls fn(address, value) for every key. Keys inserted concurrently may or may not be visited.
+    template <typename Fn>
+    void ForEach(Fn &&fn) const {
+        for (size_t i = 0; m_slots && i < m_capacity; ++i) {
+            if (const uintptr_t key = m_slots[i].key.load(std::memory_order_acquire); key != 0) {
+                fn(reinterpret_cast<const void *>(key), m_slots[i].value);
+            }
+        }
+    }
+
+    [[nodiscard]] size_t Size() const { return m_size.load(std::memory_order_relaxed); }
+    [[nodiscard]] size_t Capacity() const { return m_capacity; }
+
+private:
+    struct Slot {
+        std::atomic<uintptr_t> key = 0;
+        Value value = {};
+    };
+
+    // Counts a slot about to be claimed; false once the table is at its limit
+    [[nodiscard]] bool Reserve() {
+        size_t size = m_size.load(std::memory_order_relaxed);
+        do {
+            if (size >= m_limit) {
+                return false;
+            }
+        } while (!m_size.compare_exchange_weak(size, size + 1, std::memory_order_relaxed));
+        return true;
+    }
+
+    // Fibonacci hashing: allocations are aligned, so the low bits of an address carry little information
+    [[nodiscard]] size_t Home(uintptr_t key) const {
+        return static_cast<size_t>((static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ull) >> m_shift);
+    }
+
+    std::unique_ptr<Slot[]> m_slots;
+    size_t m_capacity = 0;
+    size_t m_limit = 0;
+    int m_shift = 64;
+    std::atomic<size_t> m_size = 0;
+};
+
+#endif // SPLINTERCELLPATCH_ADDRESS_TABLE_H
\ No newline at end of file
@@ -0,0 +1,106 @@
+#include "async_logger.h"
+#include <chrono>
+
+namespace {
+
+// Stop gives a drain in progress this long before assuming the drain thread is gone (terminated at process exit
+// while holding the lock)
+constexpr auto STOP_LOCK_TIMEOUT = std::chrono::milliseconds(100);
+
+AsyncLogger g_processLogger;
+
+} // namespace
+
+AsyncLogger &ProcessLogger() {
+    return g_processLogger;
+}
+
+bool AsyncLogger::Start(SinkFn sink, std::string_view filePath) {
+    std::lock_guard lock(m_drainMutex);
+    if (m_thread.joinable()) {
+        return false;
+    }
+    m_sink = sink;
+    if (!filePath.empty()) {
+        m_file = std::fopen(std::string(filePath).c_str(), "w");
+    }
+
+    m_thread = std::thread(&AsyncLogger::Run, this);
+    return true;
+}
+
+void AsyncLogger::Stop() {
+    std::unique_lock lock(m_drainMutex, STOP_LOCK_TIMEOUT);
+    if (!lock) {
+        return;
+    }
+    m_stopping = true;
+    DrainLocked();
+    if (const uint64_t dropped = Dropped(); dropped != 0) {
+        m_line.assign(LOG_PREFIX);
+        m_line += std::to_string(dropped);
+        m_line += " log record(s) dropped, ring buffer full";
+        if (m_sink) {
+            m_sink(m_line.c_str());
+        }
+        if (m_file) {
+            std::fprintf(m_file, "%s\n", m_line.c_str());
+        }
+    }
+    if (m_file) {
+        std::fflush(m_file);
+    }
+    m_synchronous.store(true, std::memory_order_release);
+    lock.unlock();
+
+    m_wake.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.detach();
+    }
+}
+
+void AsyncLogger::Push(const LogRecord &record) {
+    if (m_synchronous.load(std::memory_order_acquire)) {
+        std::lock_guard lock(m_drainMutex);
+        WriteLocked(record);
+        if (m_file) {
+            std::fflush(m_file);
+        }
+        return;
+    }
+    if (!m_ring.TryPush(record)) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void AsyncLogger::Run() {
+    std::unique_lock lock(m_drainMutex);
+    while (!m_stopping) {
+        DrainLocked();
+        if (m_file) {
+            std::fflush(m_file);
+        }
+        m_wake.wait_for(lock, DRAIN_INTERVAL, [this] { return m_stopping; });
+    }
+}
+
+void AsyncLogger::DrainLocked() {
+    LogRecord record;
+    while (m_ring.TryPop(record)) {
+        WriteLocked(record);
+    }
+}
+
+void AsyncLogger::WriteLocked(const LogRecord &record) {
+    m_line.assign(LOG_PREFIX);
+    record.format(record, m_line);
+    if (m_sink) {
+        m_sink(m_line.c_str());
+    }
+    if (m_file) {
+        const auto elapsed = std::chrono::steady_clock::duration(
+            static_cast<std::chrono::steady_clock::rep>(record.timestamp - m_startTimestamp));
+        const double seconds = std::chrono::duration<double>(elapsed).count();
+        std::fprintf(m_file, "%10.3f %s\n", seconds, m_line.c_str());
+    }
+}
\ No newline at end of file
@@ -0,0 +1,63 @@
+#ifndef SPLINTERCELLPATCH_ASYNC_LOGGER_H
+#define SPLINTERCELLPATCH_ASYNC_LOGGER_H
+
+#include "log_ring.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+// Asynchronous log pipeline. Producers push binary records into a LogRing; a background thread formats them and
+// writes each line to the sinks. Records pushed before Start are kept until the thread runs.
+
+inline constexpr std::string_view LOG_PREFIX = "[AffinityHook] ";
+
+class AsyncLogger {
+public:
+    // Receives one NUL-terminated line at a time, prefix included
+    using SinkFn = void (*)(const char *line);
+
+    static constexpr size_t DEFAULT_CAPACITY = 4096;
+    static constexpr auto DRAIN_INTERVAL = std::chrono::milliseconds(20);
+
+    explicit AsyncLogger(size_t capacity = DEFAULT_CAPACITY) : m_ring(capacity) {}
+
+    // Starts the drain thread. filePath is optional; the file is truncated and receives timestamped lines.
+    [[nodiscard]] bool Start(SinkFn sink, std::string_view filePath);
+
+    // Writes out pending records on the calling thread and switches to synchronous writes. Does not wait for the
+    // drain thread, so it is safe under the loader lock.
+    void Stop();
+
+    // Lock-free unless stopped; a full ring drops the record
+    void Push(const LogRecord &record);
+
+    [[nodiscard]] uint64_t Dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+    void Run();
+    void DrainLocked();
+    void WriteLocked(const LogRecord &record);
+
+    LogRing m_ring;
+    std::atomic<uint64_t> m_dropped = 0;
+    std::atomic<bool> m_synchronous = false;
+
+    std::timed_mutex m_drainMutex; // Serializes the consumer side and the sinks
+    std::condition_variable_any m_wake;
+    bool m_stopping = false;
+    std::thread m_thread;
+    SinkFn m_sink = nullptr;
+    std::FILE *m_file = nullptr;
+    uint64_t m_startTimestamp = LogTimestamp();
+    std::string m_line;
+};
+
+// Logger shared by every module of the DLL
+[[nodiscard]] AsyncLogger &ProcessLogger();
+
+#endif // SPLINTERCELLPATCH_ASYNC_LOGGER_H
\ No newline at end of file
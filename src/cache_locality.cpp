@@ -0,0 +1,46 @@
+#include "cache_locality.h"
+
+void L3DomainSelector::Configure(const CpuTopology &topology, const ProcessorSet &allowed,
+                                 const CacheLocalitySettings &settings) {
+    m_settings = settings;
+    m_domains = RankL3Domains(topology, allowed);
+    m_activeDomains = m_domains.empty() ? 0 : 1;
+    m_quietSamples = 0;
+    Recompute();
+}
+
+bool L3DomainSelector::Update(double busyProcessors) {
+    if (m_domains.size() < 2) {
+        return false;
+    }
+
+    const double active = m_active.Count();
+    if (m_activeDomains < m_domains.size() && busyProcessors * 100.0 >= active * m_settings.expandBusyPercent) {
+        ++m_activeDomains;
+        m_quietSamples = 0;
+        Recompute();
+        return true;
+    }
+
+    if (m_activeDomains > 1) {
+        const double remaining = active - m_domains[m_activeDomains - 1].Count();
+        if (busyProcessors * 100.0 <= remaining * m_settings.shrinkBusyPercent) {
+            if (++m_quietSamples >= m_settings.shrinkSamples) {
+                --m_activeDomains;
+                m_quietSamples = 0;
+                Recompute();
+                return true;
+            }
+            return false;
+        }
+    }
+    m_quietSamples = 0;
+    return false;
+}
+
+void L3DomainSelector::Recompute() {
+    m_active = {};
+    for (size_t i = 0; i < m_activeDomains; ++i) {
+        m_active = m_active.Union(m_domains[i]);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+#ifndef SPLINTERCELLPATCH_CACHE_LOCALITY_H
+#define SPLINTERCELLPATCH_CACHE_LOCALITY_H
+
+#include "topology.h"
+#include <cstdint>
+#include <vector>
+
+// L3/CCD-aware co-location. On multi-CCD parts, producer/consumer thread pairs pay cross-die latency every frame
+// once the process is spread over every core. The selector keeps the process inside the best L3 domain and only
+// adds the next domain while the active ones are saturated.
+
+struct CacheLocalitySettings {
+    bool enabled = false;
+    uint32_t expandBusyPercent = 90; // Add the next domain when this share of the active processors is busy
+    uint32_t shrinkBusyPercent = 60; // Drop the last domain when the remaining ones would be at most this busy
+    uint32_t shrinkSamples = 4;      // Consecutive quiet samples required before dropping a domain
+};
+
+class L3DomainSelector {
+public:
+    void Configure(const CpuTopology &topology, const ProcessorSet &allowed, const CacheLocalitySettings &settings);
+
+    // Feeds the average number of processors the process kept busy over the last interval.
+    // Returns true when the active set changed.
+    bool Update(double busyProcessors);
+
+    [[nodiscard]] const ProcessorSet &Active() const { return m_active; }
+    [[nodiscard]] size_t ActiveDomains() const { return m_activeDomains; }
+    [[nodiscard]] size_t DomainCount() const { return m_domains.size(); }
+
+private:
+    void Recompute();
+
+    CacheLocalitySettings m_settings;
+    std::vector<ProcessorSet> m_domains; // Best first
+    ProcessorSet m_active;
+    size_t m_activeDomains = 0;
+    uint32_t m_quietSamples = 0;
+};
+
+#endif // SPLINTERCELLPATCH_CACHE_LOCALITY_H
\ No newline at end of file
@@ -0,0 +1,99 @@
+#include "chrome_trace.h"
+#include "trace_format.h"
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <string_view>
+
+namespace {
+
+void WriteValue(std::ostream &out, uint64_t value, TraceValueFormat format) {
+    switch (format) {
+        case TraceValueFormat::Unsigned:
+            out << value;
+            break;
+        case TraceValueFormat::Signed:
+            out << static_cast<int64_t>(value);
+            break;
+        case TraceValueFormat::Hex:
+            out << "\"0x" << std::hex << std::uppercase << value << std::dec << std::nouppercase << '"';
+            break;
+    }
+}
+
+void WriteField(std::ostream &out, const TraceField &field, uint64_t value, bool &first) {
+    if (field.name.empty()) {
+        return;
+    }
+    out << (first ? "" : ",") << '"' << field.name << "\":";
+    WriteValue(out, value, field.format);
+    first = false;
+}
+
+// Instant event scoped to one thread's track
+void BeginInstant(std::ostream &out, std::string_view name, std::string_view category, double timestamp,
+                  uint32_t processId, uint64_t threadId) {
+    out << ",\n{\"name\":\"" << name << "\",\"cat\":\"" << category << "\",\"ph\":\"i\",\"s\":\"t\",\"ts\":"
+        << timestamp << ",\"pid\":" << processId << ",\"tid\":" << threadId << ",\"args\":{";
+}
+
+} // namespace
+
+bool ConvertTraceToChromeJson(std::span<const std::byte> trace, std::ostream &out) {
+    TraceFileHeader header;
+    if (trace.size() < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, trace.data(), sizeof(header));
+    if (header.magic != TRACE_MAGIC || header.version != TRACE_VERSION || header.recordSize != sizeof(TraceRecord) ||
+        header.ticksPerSecond == 0) {
+        return false;
+    }
+
+    // A trace whose writer never closed it has no record count; every complete record in the file is used
+    uint64_t count = (trace.size() - sizeof(header)) / sizeof(TraceRecord);
+    if (header.recordCount != 0) {
+        count = std::min(count, header.recordCount);
+    }
+
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+        << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << header.processId
+        << ",\"args\":{\"name\":\"SplinterCellPatch hooks\"}}";
+
+    for (uint64_t i = 0; i < count; ++i) {
+        TraceRecord record;
+        std::memcpy(&record, trace.data() + sizeof(header) + i * sizeof(TraceRecord), sizeof(record));
+        if (record.hook == TraceHook::None || record.hook >= TraceHook::Count) {
+            continue;
+        }
+
+        const TraceHookInfo &info = TRACE_HOOKS[static_cast<size_t>(record.hook)];
+        const double timestamp = static_cast<double>(static_cast<int64_t>(record.timestamp - header.startTicks)) *
+                                 1e6 / static_cast<double>(header.ticksPerSecond);
+        const bool onTarget = info.targetsThread && record.targetThreadId != 0;
+        const uint64_t track = onTarget ? record.targetThreadId : record.threadId;
+
+        BeginInstant(out, info.name, "hook", timestamp, header.processId, track);
+        bool first = true;
+        if (onTarget) {
+            WriteField(out, {"caller"}, record.threadId, first);
+            WriteField(out, {"thread"}, record.targetThreadId, first);
+        }
+        for (size_t arg = 0; arg < 2; ++arg) {
+            WriteField(out, info.original[arg], record.original[arg], first);
+        }
+        for (size_t arg = 0; arg < 2; ++arg) {
+            WriteField(out, info.rewritten[arg], record.rewritten[arg], first);
+        }
+        WriteField(out, info.result, record.result, first);
+        out << "}}";
+
+        if (record.hook == TraceHook::CreateThread && record.result != 0) {
+            BeginInstant(out, "Thread created", "thread", timestamp, header.processId, record.result);
+            out << "\"creator\":" << record.threadId << "}}";
+        }
+    }
+    out << "\n]}\n";
+    return static_cast<bool>(out);
+}
\ No newline at end of file
@@ -0,0 +1,14 @@
+#ifndef SPLINTERCELLPATCH_CHROME_TRACE_H
+#define SPLINTERCELLPATCH_CHROME_TRACE_H
+
+#include <cstddef>
+#include <ostream>
+#include <span>
+
+// Converts a binary hook trace (see trace_format.h) into Chrome trace-event JSON for chrome://tracing or
+// ui.perfetto.dev. Calls that act on a thread (affinity, ideal processor, priority) are drawn on that thread's
+// track, and CreateThread also marks the start of the new thread's track, so placement changes line up with
+// thread creation. Returns false when the data is not a trace of a supported version.
+[[nodiscard]] bool ConvertTraceToChromeJson(std::span<const std::byte> trace, std::ostream &out);
+
+#endif // SPLINTERCELLPATCH_CHROME_TRACE_H
\ No newline at end of file
@@ -0,0 +1,250 @@
+#include "config_file.h"
+#include "string_utils.h"
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <iterator>
+#include <optional>
+
+namespace {
+
+using ApplyFn = bool (*)(ProfileConfig &config, std::string_view value);
+
+struct ConfigKey {
+    std::string_view name;
+    ApplyFn apply;
+};
+
+struct ConfigEntry {
+    uint32_t line = 0;
+    std::string_view section;
+    std::string_view key;
+    std::string_view value;
+};
+
+std::string_view Trim(std::string_view text) {
+    const size_t first = text.find_first_not_of(" \t\r");
+    if (first == std::string_view::npos) {
+        return {};
+    }
+    return text.substr(first, text.find_last_not_of(" \t\r") - first + 1);
+}
+
+std::optional<bool> ParseBool(std::string_view value) {
+    for (const std::string_view name : {"true", "yes", "on", "1"}) {
+        if (EqualsIgnoreCase(value, name)) {
+            return true;
+        }
+    }
+    for (const std::string_view name : {"false", "no", "off", "0"}) {
+        if (EqualsIgnoreCase(value, name)) {
+            return false;
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<uint32_t> ParseUInt32(std::string_view value) {
+    uint32_t result = 0;
+    const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), result);
+    return error == std::errc() && end == value.data() + value.size() ? std::optional(result) : std::nullopt;
+}
+
+// Priority names as listed in priority_rules.h, matched case-insensitively
+template <typename Value, size_t N>
+std::optional<Value> ParsePriorityName(const std::array<std::pair<Value, std::string_view>, N> &names,
+                                       std::string_view value) {
+    for (const auto &[priority, name] : names) {
+        if (EqualsIgnoreCase(value, name)) {
+            return priority;
+        }
+    }
+    return std::nullopt;
+}
+
+template <typename T>
+bool Assign(std::optional<T> parsed, T &target) {
+    if (parsed) {
+        target = *parsed;
+    }
+    return parsed.has_value();
+}
+
+// Values may be quoted to keep surrounding spaces
+std::string_view Unquote(std::string_view value) {
+    return value.size() >= 2 && value.front() == '"' && value.back() == '"' ? value.substr(1, value.size() - 2) : value;
+}
+
+constexpr ConfigKey CONFIG_KEYS[] = {
+    {"policy", [](ProfileConfig &c, std::string_view v) { return Assign(ParseAffinityPolicy(v), c.profile.policy); }},
+    {"placement",
+     [](ProfileConfig &c, std::string_view v) { return Assign(ParsePlacementMode(v), c.profile.placement); }},
+    {"priority.maxClass",
+     [](ProfileConfig &c, std::string_view v) {
+         return Assign(ParsePriorityName(PRIORITY_CLASS_NAMES, v), c.profile.priority.maxPriorityClass);
+     }},
+    {"priority.maxMainThread",
+     [](ProfileConfig &c, std::string_view v) {
+         return Assign(ParsePriorityName(THREAD_PRIORITY_NAMES, v), c.profile.priority.maxMainThreadPriority);
+     }},
+    {"priority.maxWorkerThread",
+     [](ProfileConfig &c, std::string_view v) {
+         return Assign(ParsePriorityName(THREAD_PRIORITY_NAMES, v), c.profile.priority.maxWorkerThreadPriority);
+     }},
+    {"hotThreads.enabled",
+     [](ProfileConfig &c, std::string_view v) { return Assign(ParseBool(v), c.profile.hotThreads.enabled); }},
+    {"hotThreads.intervalMs",
+     [](ProfileConfig &c, std::string_view v) { return Assign(ParseUInt32(v), c.profile.hotThreads.intervalMs); }},
+    {"hotThreads.maxHotThreads",
+     [](ProfileConfig &c, std::string_view v) { return Assign(ParseUInt32(v), c.profile.hotThreads.maxHotThreads); }},
+    {"hotThreads.minSharePercent",
+     [](ProfileConfig &c, std::string_view v) { return Assign(ParseUInt32(v), c.profile.hotThreads.minSharePercent); }},
+    {"hotThreads.promoteSamples",
+     [](ProfileConfig &c, std::string_view v) { return Assign(ParseUInt32(v), c.profile.hotThreads.promoteSamples); }},
+    {"hotThreads.demoteSamples",
+     [](ProfileConfig &c, std::string_view v) { return Assign(ParseUInt32(v), c.profile.hotThreads.demoteSamples); }},
+    {"locality.enabled",
+     [](ProfileConfig &c, std::string_view v) { return Assign(ParseBool(v), c.profile.locality.enabled); }},
+    {"locality.expandBusyPercent",
+     [](ProfileConfig &c, std::string_view v) { return Assign(ParseUInt32(v), c.profile.locality.expandBusyPercent); }},
+    {"locality.shrinkBusyPercent",
+     [](ProfileConfig &c, std::string_view v) { return Assign(ParseUInt32(v), c.profile.locality.shrinkBusyPercent); }},
+    {"locality.shrinkSamples",
+     [](ProfileConfig &c, std::string_view v) { return Assign(ParseUInt32(v), c.profile.locality.shrinkSamples); }},
+    {"monotonicTimers",
+     [](ProfileConfig &c, std::string_view v) { return Assign(ParseBool(v), c.profile.monotonicTimers); }},
+    {"logFile", [](ProfileConfig &c, std::string_view v) { c.logFile = Unquote(v); return true; }},
+    {"trace.file", [](ProfileConfig &c, std::string_view v) { c.traceFile = Unquote(v); return true; }},
+    {"trace.maxRecords",
+     [](ProfileConfig &c, std::string_view v) { return Assign(ParseUInt32(v), c.profile.trace.maxRecords); }},
+    {"statistics", [](ProfileConfig &c, std::string_view v) { return Assign(ParseBool(v), c.profile.statistics); }},
+    {"control", [](ProfileConfig &c, std::string_view v) { return Assign(ParseBool(v), c.profile.control); }},
+    {"suspendAllThreads",
+     [](ProfileConfig &c, std::string_view v) { return Assign(ParseBool(v), c.profile.suspendAllThreads); }},
+    {"hookBackend",
+     [](ProfileConfig &c, std::string_view v) { return Assign(ParseHookBackend(v), c.profile.hookBackend); }},
+    {"heap.enabled", [](ProfileConfig &c, std::string_view v) { return Assign(ParseBool(v), c.profile.heap.enabled); }},
+    {"heap.arenaMiB",
+     [](ProfileConfig &c, std::string_view v) { return Assign(ParseUInt32(v), c.profile.heap.arenaMiB); }},
+    {"spinTuning.enabled",
+     [](ProfileConfig &c, std::string_view v) { return Assign(ParseBool(v), c.profile.spinTuning.enabled); }},
+    {"spinTuning.initialSpinCount",
+     [](ProfileConfig &c, std::string_view v) {
+         return Assign(ParseUInt32(v), c.profile.spinTuning.initialSpinCount);
+     }},
+    {"spinTuning.minSpinCount",
+     [](ProfileConfig &c, std::string_view v) { return Assign(ParseUInt32(v), c.profile.spinTuning.minSpinCount); }},
+    {"spinTuning.maxSpinCount",
+     [](ProfileConfig &c, std::string_view v) { return Assign(ParseUInt32(v), c.profile.spinTuning.maxSpinCount); }},
+    {"spinTuning.maxLocks",
+     [](ProfileConfig &c, std::string_view v) { return Assign(ParseUInt32(v), c.profile.spinTuning.maxLocks); }},
+    {"lockProfiling.enabled",
+     [](ProfileConfig &c, std::string_view v) { return Assign(ParseBool(v), c.profile.lockProfiling.enabled); }},
+    {"lockProfiling.maxLocks",
+     [](ProfileConfig &c, std::string_view v) { return Assign(ParseUInt32(v), c.profile.lockProfiling.maxLocks); }},
+    {"lockProfiling.reportLocks",
+     [](ProfileConfig &c, std::string_view v) {
+         return Assign(ParseUInt32(v), c.profile.lockProfiling.reportLocks);
+     }},
+};
+
+// Splits the text into entries; syntax errors are recorded and their lines skipped
+std::vector<ConfigEntry> Tokenize(std::string_view text, std::vector<ConfigError> &errors) {
+    std::vector<ConfigEntry> entries;
+    std::string_view section;
+    uint32_t lineNumber = 0;
+    while (!text.empty()) {
+        const size_t end = text.find('\n');
+        const std::string_view line = Trim(text.substr(0, end));
+        text = end == std::string_view::npos ? std::string_view{} : text.substr(end + 1);
+        ++lineNumber;
+
+        if (line.empty() || line.front() == '#' || line.front() == ';') {
+            continue;
+        }
+        if (line.front() == '[') {
+            if (line.back() != ']') {
+                errors.push_back({lineNumber, "unterminated section name"});
+                continue;
+            }
+            section = Trim(line.substr(1, line.size() - 2));
+            continue;
+        }
+        const size_t equals = line.find('=');
+        if (equals == std::string_view::npos) {
+            errors.push_back({lineNumber, "expected 'key = value'"});
+            continue;
+        }
+        entries.push_back({lineNumber, section, Trim(line.substr(0, equals)), Trim(line.substr(equals + 1))});
+    }
+    return entries;
+}
+
+void Apply(const ConfigEntry &entry, ProfileConfig &config, std::vector<ConfigError> &errors) {
+    for (const ConfigKey &key : CONFIG_KEYS) {
+        if (EqualsIgnoreCase(entry.key, key.name)) {
+            if (!key.apply(config, entry.value)) {
+                errors.push_back({entry.line, "invalid value"});
+            }
+            return;
+        }
+    }
+    errors.push_back({entry.line, "unknown key"});
+}
+
+} // namespace
+
+std::unique_ptr<ProfileConfig> ParseProfileConfig(std::string_view text, std::string_view executablePath,
+                                                  const ExecutableProfile &base) {
+    auto config = std::make_unique<ProfileConfig>();
+    config->profile = base;
+    config->logFile = base.logFile;
+    config->traceFile = base.trace.file;
+
+    const size_t separator = executablePath.find_last_of("\\/");
+    const std::string_view fileName =
+        separator == std::string_view::npos ? executablePath : executablePath.substr(separator + 1);
+
+    // Sections for other executables are still checked, against a scratch profile
+    std::vector<ConfigError> errors;
+    const std::vector<ConfigEntry> entries = Tokenize(text, errors);
+    ProfileConfig scratch;
+    for (const ConfigEntry &entry : entries) {
+        if (!entry.section.empty() && !EqualsIgnoreCase(entry.section, fileName)) {
+            Apply(entry, scratch, errors);
+        }
+    }
+    for (const ConfigEntry &entry : entries) {
+        if (entry.section.empty()) {
+            Apply(entry, *config, errors);
+        }
+    }
+    for (const ConfigEntry &entry : entries) {
+        if (!entry.section.empty() && EqualsIgnoreCase(entry.section, fileName)) {
+            Apply(entry, *config, errors);
+        }
+    }
+    std::ranges::sort(errors, {}, &ConfigError::line);
+    config->errors = std::move(errors);
+
+    // Views are only taken once the strings are final
+    config->profile.logFile = config->logFile;
+    config->profile.trace.file = config->traceFile;
+    return config;
+}
+
+std::string ConfigFilePath(std::string_view executablePath) {
+    const size_t separator = executablePath.find_last_of("\\/");
+    const std::string_view directory =
+        separator == std::string_view::npos ? std::string_view{} : executablePath.substr(0, separator + 1);
+    return std::string(directory) + std::string(CONFIG_FILE_NAME);
+}
+
+bool ReadConfigFile(const std::string &path, std::string &text) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    text.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return !file.bad();
+}
\ No newline at end of file
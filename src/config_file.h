@@ -0,0 +1,53 @@
+#ifndef SPLINTERCELLPATCH_CONFIG_FILE_H
+#define SPLINTERCELLPATCH_CONFIG_FILE_H
+
+#include "settings.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Per-executable config file. SplinterCellPatch.ini next to the target executable overrides its compiled-in profile:
+//
+//   # Applies to every executable in the directory
+//   policy = physical-cores-only
+//
+//   [SplinterCell.exe]
+//   placement = soft-cpu-sets
+//   priority.maxClass = high
+//
+// Keys outside any section apply first, then the section named after the executable (matched case-insensitively).
+// Lines starting with '#' or ';' are comments. Key names mirror the ExecutableProfile fields.
+
+inline constexpr std::string_view CONFIG_FILE_NAME = "SplinterCellPatch.ini";
+
+struct ConfigError {
+    uint32_t line = 0;
+    std::string_view message; // Static text
+};
+
+// Profile built from a config file. It owns the strings the profile's views refer to, so it is never copied.
+struct ProfileConfig {
+    ProfileConfig() = default;
+    ProfileConfig(const ProfileConfig &) = delete;
+    ProfileConfig &operator=(const ProfileConfig &) = delete;
+
+    ExecutableProfile profile;
+    std::string logFile;
+    std::string traceFile;
+    std::vector<ConfigError> errors; // Lines that were ignored
+};
+
+// Applies the config text on top of base, which may itself come from a ProfileConfig about to be released: its
+// strings are copied. Lines with errors are skipped and listed in the result.
+[[nodiscard]] std::unique_ptr<ProfileConfig> ParseProfileConfig(std::string_view text, std::string_view executablePath,
+                                                                const ExecutableProfile &base);
+
+// CONFIG_FILE_NAME in the executable's directory
+[[nodiscard]] std::string ConfigFilePath(std::string_view executablePath);
+
+// Returns false when the file does not exist or cannot be read
+[[nodiscard]] bool ReadConfigFile(const std::string &path, std::string &text);
+
+#endif // SPLINTERCELLPATCH_CONFIG_FILE_H
\ No newline at end of file
@@ -0,0 +1,242 @@
+#include "config_payload.h"
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <utility>
+
+namespace {
+
+uint32_t Fnv1a(std::span<const uint8_t> bytes) {
+    uint32_t hash = 0x811C9DC5;
+    for (const uint8_t byte : bytes) {
+        hash = (hash ^ byte) * 0x01000193;
+    }
+    return hash;
+}
+
+class PayloadWriter {
+public:
+    template <typename T>
+    void Put(T value) {
+        const size_t offset = m_bytes.size();
+        m_bytes.resize(offset + sizeof(T));
+        std::memcpy(m_bytes.data() + offset, &value, sizeof(T));
+    }
+
+    // Longer strings are cut; paths never come close to 64 KiB
+    void PutString(std::string_view text) {
+        const auto length = static_cast<uint16_t>(std::min<size_t>(text.size(), UINT16_MAX));
+        Put(length);
+        m_bytes.insert(m_bytes.end(), text.begin(), text.begin() + length);
+    }
+
+    template <typename T>
+    void PutAt(size_t offset, T value) {
+        std::memcpy(m_bytes.data() + offset, &value, sizeof(T));
+    }
+
+    std::vector<uint8_t> &Bytes() {
+        return m_bytes;
+    }
+
+private:
+    std::vector<uint8_t> m_bytes;
+};
+
+// Reads fields in order; once a read runs past the end every later read fails too
+class PayloadReader {
+public:
+    explicit PayloadReader(std::span<const uint8_t> bytes) : m_bytes(bytes) {}
+
+    template <typename T>
+    T Get() {
+        T value{};
+        if (!m_ok || m_bytes.size() - m_offset < sizeof(T)) {
+            m_ok = false;
+            return value;
+        }
+        std::memcpy(&value, m_bytes.data() + m_offset, sizeof(T));
+        m_offset += sizeof(T);
+        return value;
+    }
+
+    std::string GetString() {
+        const auto length = Get<uint16_t>();
+        if (!m_ok || m_bytes.size() - m_offset < length) {
+            m_ok = false;
+            return {};
+        }
+        std::string text(reinterpret_cast<const char *>(m_bytes.data() + m_offset), length);
+        m_offset += length;
+        return text;
+    }
+
+    bool Ok() const {
+        return m_ok;
+    }
+
+private:
+    std::span<const uint8_t> m_bytes;
+    size_t m_offset = 0;
+    bool m_ok = true;
+};
+
+uint16_t ProfileFlags(const ExecutableProfile &profile) {
+    uint16_t flags = 0;
+    flags |= profile.monotonicTimers ? CONFIG_PAYLOAD_FLAG_MONOTONIC_TIMERS : 0;
+    flags |= profile.statistics ? CONFIG_PAYLOAD_FLAG_STATISTICS : 0;
+    flags |= profile.control ? CONFIG_PAYLOAD_FLAG_CONTROL : 0;
+    flags |= profile.suspendAllThreads ? CONFIG_PAYLOAD_FLAG_SUSPEND_ALL_THREADS : 0;
+    flags |= profile.hotThreads.enabled ? CONFIG_PAYLOAD_FLAG_HOT_THREADS : 0;
+    flags |= profile.locality.enabled ? CONFIG_PAYLOAD_FLAG_LOCALITY : 0;
+    flags |= profile.heap.enabled ? CONFIG_PAYLOAD_FLAG_HEAP : 0;
+    flags |= profile.spinTuning.enabled ? CONFIG_PAYLOAD_FLAG_SPIN_TUNING : 0;
+    flags |= profile.lockProfiling.enabled ? CONFIG_PAYLOAD_FLAG_LOCK_PROFILING : 0;
+    return flags;
+}
+
+// Enums are checked against their name tables, so a value added there is accepted here too
+template <typename Enum, typename NameFn>
+bool ToEnum(uint8_t value, NameFn name, Enum &result) {
+    result = static_cast<Enum>(value);
+    return name(result) != "unknown";
+}
+
+constexpr std::pair<ConfigPayloadStatus, std::string_view> CONFIG_PAYLOAD_STATUS_NAMES[] = {
+    {ConfigPayloadStatus::Ok, "ok"},
+    {ConfigPayloadStatus::Truncated, "truncated"},
+    {ConfigPayloadStatus::BadMagic, "not a config payload"},
+    {ConfigPayloadStatus::UnsupportedVersion, "unsupported version"},
+    {ConfigPayloadStatus::BadChecksum, "checksum mismatch"},
+    {ConfigPayloadStatus::InvalidValue, "invalid value"},
+};
+
+} // namespace
+
+std::string_view ConfigPayloadStatusName(ConfigPayloadStatus status) {
+    for (const auto &[candidate, name] : CONFIG_PAYLOAD_STATUS_NAMES) {
+        if (candidate == status) {
+            return name;
+        }
+    }
+    return "unknown";
+}
+
+std::vector<uint8_t> WriteConfigPayload(const ExecutableProfile &profile) {
+    PayloadWriter writer;
+    writer.Put(CONFIG_PAYLOAD_MAGIC);
+    writer.Put(CONFIG_PAYLOAD_VERSION);
+    writer.Put(static_cast<uint16_t>(CONFIG_PAYLOAD_HEADER_SIZE));
+    writer.Put(uint32_t{0}); // Size and checksum are filled in once the body is written
+    writer.Put(uint32_t{0});
+
+    writer.Put(static_cast<uint8_t>(profile.policy));
+    writer.Put(static_cast<uint8_t>(profile.placement));
+    writer.Put(static_cast<uint8_t>(profile.hookBackend));
+    writer.Put(ProfileFlags(profile));
+    writer.Put(profile.priority.maxPriorityClass);
+    writer.Put(static_cast<int32_t>(profile.priority.maxMainThreadPriority));
+    writer.Put(static_cast<int32_t>(profile.priority.maxWorkerThreadPriority));
+    writer.Put(profile.hotThreads.intervalMs);
+    writer.Put(profile.hotThreads.maxHotThreads);
+    writer.Put(profile.hotThreads.minSharePercent);
+    writer.Put(profile.hotThreads.promoteSamples);
+    writer.Put(profile.hotThreads.demoteSamples);
+    writer.Put(profile.locality.expandBusyPercent);
+    writer.Put(profile.locality.shrinkBusyPercent);
+    writer.Put(profile.locality.shrinkSamples);
+    writer.Put(profile.trace.maxRecords);
+    writer.Put(profile.heap.arenaMiB);
+    writer.Put(profile.spinTuning.initialSpinCount);
+    writer.Put(profile.spinTuning.minSpinCount);
+    writer.Put(profile.spinTuning.maxSpinCount);
+    writer.Put(profile.spinTuning.maxLocks);
+    writer.Put(profile.lockProfiling.maxLocks);
+    writer.Put(profile.lockProfiling.reportLocks);
+    writer.PutString(profile.logFile);
+    writer.PutString(profile.trace.file);
+
+    std::vector<uint8_t> &bytes = writer.Bytes();
+    writer.PutAt(8, static_cast<uint32_t>(bytes.size()));
+    writer.PutAt(12, Fnv1a(std::span(bytes).subspan(CONFIG_PAYLOAD_HEADER_SIZE)));
+    return std::move(bytes);
+}
+
+ConfigPayloadStatus ReadConfigPayload(std::span<const uint8_t> payload, ProfileConfig &config) {
+    PayloadReader header(payload);
+    const auto magic = header.Get<uint32_t>();
+    const auto version = header.Get<uint16_t>();
+    const auto headerSize = header.Get<uint16_t>();
+    const auto size = header.Get<uint32_t>();
+    const auto checksum = header.Get<uint32_t>();
+    if (!header.Ok()) {
+        return ConfigPayloadStatus::Truncated;
+    }
+    if (magic != CONFIG_PAYLOAD_MAGIC) {
+        return ConfigPayloadStatus::BadMagic;
+    }
+    if (version != CONFIG_PAYLOAD_VERSION || headerSize != CONFIG_PAYLOAD_HEADER_SIZE) {
+        return ConfigPayloadStatus::UnsupportedVersion;
+    }
+    // Detours may round the payload up, so only the recorded size counts
+    if (size < CONFIG_PAYLOAD_HEADER_SIZE || size > payload.size()) {
+        return ConfigPayloadStatus::Truncated;
+    }
+    const std::span body = payload.subspan(CONFIG_PAYLOAD_HEADER_SIZE, size - CONFIG_PAYLOAD_HEADER_SIZE);
+    if (Fnv1a(body) != checksum) {
+        return ConfigPayloadStatus::BadChecksum;
+    }
+
+    ExecutableProfile profile = config.profile;
+    PayloadReader reader(body);
+    const auto policy = reader.Get<uint8_t>();
+    const auto placement = reader.Get<uint8_t>();
+    const auto backend = reader.Get<uint8_t>();
+    const auto flags = reader.Get<uint16_t>();
+    profile.priority.maxPriorityClass = reader.Get<uint32_t>();
+    profile.priority.maxMainThreadPriority = reader.Get<int32_t>();
+    profile.priority.maxWorkerThreadPriority = reader.Get<int32_t>();
+    profile.hotThreads.intervalMs = reader.Get<uint32_t>();
+    profile.hotThreads.maxHotThreads = reader.Get<uint32_t>();
+    profile.hotThreads.minSharePercent = reader.Get<uint32_t>();
+    profile.hotThreads.promoteSamples = reader.Get<uint32_t>();
+    profile.hotThreads.demoteSamples = reader.Get<uint32_t>();
+    profile.locality.expandBusyPercent = reader.Get<uint32_t>();
+    profile.locality.shrinkBusyPercent = reader.Get<uint32_t>();
+    profile.locality.shrinkSamples = reader.Get<uint32_t>();
+    profile.trace.maxRecords = reader.Get<uint32_t>();
+    profile.heap.arenaMiB = reader.Get<uint32_t>();
+    profile.spinTuning.initialSpinCount = reader.Get<uint32_t>();
+    profile.spinTuning.minSpinCount = reader.Get<uint32_t>();
+    profile.spinTuning.maxSpinCount = reader.Get<uint32_t>();
+    profile.spinTuning.maxLocks = reader.Get<uint32_t>();
+    profile.lockProfiling.maxLocks = reader.Get<uint32_t>();
+    profile.lockProfiling.reportLocks = reader.Get<uint32_t>();
+    std::string logFile = reader.GetString();
+    std::string traceFile = reader.GetString();
+    if (!reader.Ok()) {
+        return ConfigPayloadStatus::Truncated;
+    }
+    if (!ToEnum(policy, AffinityPolicyName, profile.policy) ||
+        !ToEnum(placement, PlacementModeName, profile.placement) ||
+        !ToEnum(backend, HookBackendName, profile.hookBackend)) {
+        return ConfigPayloadStatus::InvalidValue;
+    }
+    profile.monotonicTimers = flags & CONFIG_PAYLOAD_FLAG_MONOTONIC_TIMERS;
+    profile.statistics = flags & CONFIG_PAYLOAD_FLAG_STATISTICS;
+    profile.control = flags & CONFIG_PAYLOAD_FLAG_CONTROL;
+    profile.suspendAllThreads = flags & CONFIG_PAYLOAD_FLAG_SUSPEND_ALL_THREADS;
+    profile.hotThreads.enabled = flags & CONFIG_PAYLOAD_FLAG_HOT_THREADS;
+    profile.locality.enabled = flags & CONFIG_PAYLOAD_FLAG_LOCALITY;
+    profile.heap.enabled = flags & CONFIG_PAYLOAD_FLAG_HEAP;
+    profile.spinTuning.enabled = flags & CONFIG_PAYLOAD_FLAG_SPIN_TUNING;
+    profile.lockProfiling.enabled = flags & CONFIG_PAYLOAD_FLAG_LOCK_PROFILING;
+
+    // Views are only taken once the strings are final
+    config.logFile = std::move(logFile);
+    config.traceFile = std::move(traceFile);
+    config.profile = profile;
+    config.profile.logFile = config.logFile;
+    config.profile.trace.file = config.traceFile;
+    return ConfigPayloadStatus::Ok;
+}
\ No newline at end of file
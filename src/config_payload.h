@@ -0,0 +1,72 @@
+#ifndef SPLINTERCELLPATCH_CONFIG_PAYLOAD_H
+#define SPLINTERCELLPATCH_CONFIG_PAYLOAD_H
+
+#include "config_file.h"
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+// Resolved profile handed from SplinterCellLauncher to the DLL as a Detours payload (DetourCopyPayloadToProcess /
+// DetourFindPayloadEx), so the DLL starts without reading SplinterCellPatch.ini.
+//
+// Layout, little-endian, no padding:
+//
+//   header   u32 magic "SCCF", u16 version, u16 header size, u32 payload size, u32 FNV-1a of the body
+//   body v4  u8 policy, u8 placement, u8 hook backend, u16 flags (CONFIG_PAYLOAD_FLAG_*)
+//            u32 priority class, i32 main thread priority, i32 worker thread priority
+//            u32 x5 hot thread interval, max threads, min share, promote samples, demote samples
+//            u32 x3 locality expand percent, shrink percent, shrink samples
+//            u32 trace max records, u32 heap arena MiB
+//            u32 x4 spin tuning initial, min and max spin count, max locks
+//            u32 x2 lock profiling max locks, report locks
+//            u16 length + bytes log file, u16 length + bytes trace file
+//
+// A payload with an unknown version is rejected as a whole; the DLL then falls back to the config file.
+
+inline constexpr uint32_t CONFIG_PAYLOAD_MAGIC = 0x46434353; // "SCCF"
+inline constexpr uint16_t CONFIG_PAYLOAD_VERSION = 4;
+inline constexpr size_t CONFIG_PAYLOAD_HEADER_SIZE = 16;
+
+inline constexpr uint16_t CONFIG_PAYLOAD_FLAG_MONOTONIC_TIMERS = 0x01;
+inline constexpr uint16_t CONFIG_PAYLOAD_FLAG_STATISTICS = 0x02;
+inline constexpr uint16_t CONFIG_PAYLOAD_FLAG_CONTROL = 0x04;
+inline constexpr uint16_t CONFIG_PAYLOAD_FLAG_SUSPEND_ALL_THREADS = 0x08;
+inline constexpr uint16_t CONFIG_PAYLOAD_FLAG_HOT_THREADS = 0x10;
+inline constexpr uint16_t CONFIG_PAYLOAD_FLAG_LOCALITY = 0x20;
+inline constexpr uint16_t CONFIG_PAYLOAD_FLAG_HEAP = 0x40;
+inline constexpr uint16_t CONFIG_PAYLOAD_FLAG_SPIN_TUNING = 0x80;
+inline constexpr uint16_t CONFIG_PAYLOAD_FLAG_LOCK_PROFILING = 0x100;
+
+// Same layout as a Windows GUID, which it is bit_cast to
+struct PayloadGuid {
+    uint32_t data1 = 0;
+    uint16_t data2 = 0;
+    uint16_t data3 = 0;
+    std::array<uint8_t, 8> data4 = {};
+};
+
+// {5C1A8E27-3F4B-4A96-B0D2-7E91C4A5F608}
+inline constexpr PayloadGuid CONFIG_PAYLOAD_GUID = {
+    0x5C1A8E27, 0x3F4B, 0x4A96, {0xB0, 0xD2, 0x7E, 0x91, 0xC4, 0xA5, 0xF6, 0x08}
+};
+
+enum class ConfigPayloadStatus : uint8_t {
+    Ok,
+    Truncated,          // Shorter than its header or its recorded size
+    BadMagic,
+    UnsupportedVersion,
+    BadChecksum,
+    InvalidValue,       // An enum out of range or a string running past the end
+};
+
+[[nodiscard]] std::string_view ConfigPayloadStatusName(ConfigPayloadStatus status);
+
+[[nodiscard]] std::vector<uint8_t> WriteConfigPayload(const ExecutableProfile &profile);
+
+// Fills config from the payload. The executable name is not part of the payload and is left as it is; on failure
+// config is unchanged.
+[[nodiscard]] ConfigPayloadStatus ReadConfigPayload(std::span<const uint8_t> payload, ProfileConfig &config);
+
+#endif // SPLINTERCELLPATCH_CONFIG_PAYLOAD_H
\ No newline at end of file
@@ -0,0 +1,87 @@
+#include "config_watcher.h"
+
+#ifndef _WIN32
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <thread>
+
+struct ConfigWatcher::State {
+    std::string fileName;
+    ChangeFn onChange;
+    int inotify = -1;
+    int stopPipe[2] = {-1, -1};
+    std::thread thread;
+
+    void Run();
+};
+
+void ConfigWatcher::State::Run() {
+    alignas(inotify_event) char buffer[4096];
+    bool pending = false; // Changed, waiting for the file to go quiet
+    for (;;) {
+        pollfd fds[2] = {{stopPipe[0], POLLIN, 0}, {inotify, POLLIN, 0}};
+        const int ready = poll(fds, 2, pending ? static_cast<int>(QUIET_MS) : -1);
+        if (ready < 0 || (fds[0].revents & POLLIN)) {
+            return;
+        }
+        if (ready == 0) {
+            pending = false;
+            onChange();
+            continue;
+        }
+
+        const ssize_t length = read(inotify, buffer, sizeof(buffer));
+        for (ssize_t offset = 0; offset < length;) {
+            const auto *event = reinterpret_cast<const inotify_event *>(buffer + offset);
+            if ((event->mask & IN_Q_OVERFLOW) || (event->len != 0 && fileName == event->name)) {
+                pending = true;
+            }
+            offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+        }
+    }
+}
+
+ConfigWatcher::ConfigWatcher() = default;
+
+ConfigWatcher::~ConfigWatcher() {
+    Stop();
+}
+
+bool ConfigWatcher::Start(const std::string &path, ChangeFn onChange) {
+    if (m_state) {
+        return false;
+    }
+    const size_t separator = path.find_last_of('/');
+    const std::string directory = separator == std::string::npos ? "." : path.substr(0, separator + 1);
+
+    auto state = std::make_unique<State>();
+    state->fileName = separator == std::string::npos ? path : path.substr(separator + 1);
+    state->onChange = std::move(onChange);
+    state->inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (state->inotify < 0) {
+        return false;
+    }
+    if (inotify_add_watch(state->inotify, directory.c_str(),
+                          IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO) < 0 ||
+        pipe(state->stopPipe) != 0) {
+        close(state->inotify);
+        return false;
+    }
+    state->thread = std::thread(&State::Run, state.get());
+    m_state = std::move(state);
+    return true;
+}
+
+void ConfigWatcher::Stop() {
+    if (!m_state) {
+        return;
+    }
+    [[maybe_unused]] const ssize_t written = write(m_state->stopPipe[1], "", 1);
+    m_state->thread.join();
+    close(m_state->stopPipe[0]);
+    close(m_state->stopPipe[1]);
+    close(m_state->inotify);
+    m_state.reset();
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,35 @@
+#ifndef SPLINTERCELLPATCH_CONFIG_WATCHER_H
+#define SPLINTERCELLPATCH_CONFIG_WATCHER_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+// Watches one file for changes on a background thread (ReadDirectoryChangesW on Windows, inotify elsewhere). The
+// parent directory is watched, so the file being created, deleted or replaced by an editor's rename is noticed too.
+// Editors often write in several steps, so the callback runs once the file has been quiet for QUIET_MS.
+
+class ConfigWatcher {
+public:
+    using ChangeFn = std::function<void()>;
+
+    static constexpr uint32_t QUIET_MS = 200;
+
+    ConfigWatcher();
+    ConfigWatcher(const ConfigWatcher &) = delete;
+    ConfigWatcher &operator=(const ConfigWatcher &) = delete;
+    ~ConfigWatcher();
+
+    // onChange runs on the watcher thread. A watcher is started at most once.
+    [[nodiscard]] bool Start(const std::string &path, ChangeFn onChange);
+
+    // Signals the watcher thread. On Windows it does not wait (safe under the loader lock).
+    void Stop();
+
+private:
+    struct State; // Platform-specific
+    std::unique_ptr<State> m_state;
+};
+
+#endif // SPLINTERCELLPATCH_CONFIG_WATCHER_H
\ No newline at end of file
@@ -0,0 +1,130 @@
+#include "config_watcher.h"
+#include <windows.h>
+
+struct ConfigWatcher::State {
+    std::wstring fileName;
+    ChangeFn onChange;
+    HANDLE directory = INVALID_HANDLE_VALUE;
+    HANDLE stopEvent = nullptr;
+    HANDLE thread = nullptr;
+
+    static DWORD WINAPI ThreadProc(LPVOID parameter);
+    void Run();
+    [[nodiscard]] bool Matches(const FILE_NOTIFY_INFORMATION &info) const;
+};
+
+DWORD WINAPI ConfigWatcher::State::ThreadProc(LPVOID parameter) {
+    static_cast<State *>(parameter)->Run();
+    return 0;
+}
+
+bool ConfigWatcher::State::Matches(const FILE_NOTIFY_INFORMATION &info) const {
+    return CompareStringOrdinal(info.FileName, static_cast<int>(info.FileNameLength / sizeof(WCHAR)),
+                                fileName.c_str(), static_cast<int>(fileName.size()), TRUE) == CSTR_EQUAL;
+}
+
+void ConfigWatcher::State::Run() {
+    constexpr DWORD FILTER = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE;
+    alignas(DWORD) BYTE buffer[4096];
+    OVERLAPPED overlapped = {};
+    overlapped.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    if (!overlapped.hEvent) {
+        return;
+    }
+
+    // One read stays outstanding; the quiet period is the wait timeout
+    bool reading = ReadDirectoryChangesW(directory, buffer, sizeof(buffer), FALSE, FILTER, nullptr, &overlapped,
+                                         nullptr);
+    bool pending = false; // Changed, waiting for the file to go quiet
+    while (reading) {
+        const HANDLE handles[] = {stopEvent, overlapped.hEvent};
+        const DWORD wait = WaitForMultipleObjects(2, handles, FALSE, pending ? QUIET_MS : INFINITE);
+        if (wait == WAIT_TIMEOUT) {
+            pending = false;
+            onChange();
+            continue;
+        }
+        if (wait != WAIT_OBJECT_0 + 1) {
+            break;
+        }
+
+        DWORD bytes = 0;
+        if (!GetOverlappedResult(directory, &overlapped, &bytes, FALSE)) {
+            reading = false;
+            break;
+        }
+
+        // Zero bytes means the buffer overflowed and the changes were lost: assume the file was among them
+        pending = pending || bytes == 0;
+        for (DWORD offset = 0; offset < bytes;) {
+            const auto &info = *reinterpret_cast<const FILE_NOTIFY_INFORMATION *>(buffer + offset);
+            pending = pending || Matches(info);
+            if (info.NextEntryOffset == 0) {
+                break;
+            }
+            offset += info.NextEntryOffset;
+        }
+        ResetEvent(overlapped.hEvent);
+        reading = ReadDirectoryChangesW(directory, buffer, sizeof(buffer), FALSE, FILTER, nullptr, &overlapped,
+                                        nullptr);
+    }
+
+    // The buffer lives on this stack, so the outstanding read must be gone before returning
+    if (reading) {
+        DWORD bytes = 0;
+        CancelIoEx(directory, &overlapped);
+        GetOverlappedResult(directory, &overlapped, &bytes, TRUE);
+    }
+    CloseHandle(overlapped.hEvent);
+}
+
+ConfigWatcher::ConfigWatcher() = default;
+
+// The thread is gone by the time static destructors run at process exit
+ConfigWatcher::~ConfigWatcher() = default;
+
+bool ConfigWatcher::Start(const std::string &path, ChangeFn onChange) {
+    if (m_state) {
+        return false;
+    }
+    const size_t separator = path.find_last_of("\\/");
+    const std::string directory = separator == std::string::npos ? "." : path.substr(0, separator + 1);
+    const std::string fileName = separator == std::string::npos ? path : path.substr(separator + 1);
+
+    auto state = std::make_unique<State>();
+    const int length = MultiByteToWideChar(CP_ACP, 0, fileName.c_str(), -1, nullptr, 0);
+    if (length <= 1) {
+        return false;
+    }
+    state->fileName.resize(static_cast<size_t>(length));
+    MultiByteToWideChar(CP_ACP, 0, fileName.c_str(), -1, state->fileName.data(), length);
+    state->fileName.resize(static_cast<size_t>(length - 1));
+    state->onChange = std::move(onChange);
+
+    state->directory = CreateFileA(directory.c_str(), FILE_LIST_DIRECTORY,
+                                   FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+                                   FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+    if (state->directory == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    state->stopEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    if (!state->stopEvent) {
+        CloseHandle(state->directory);
+        return false;
+    }
+
+    state->thread = CreateThread(nullptr, 0, State::ThreadProc, state.get(), 0, nullptr);
+    if (!state->thread) {
+        CloseHandle(state->stopEvent);
+        CloseHandle(state->directory);
+        return false;
+    }
+    m_state = std::move(state);
+    return true;
+}
+
+void ConfigWatcher::Stop() {
+    if (m_state && m_state->stopEvent) {
+        SetEvent(m_state->stopEvent);
+    }
+}
\ No newline at end of file
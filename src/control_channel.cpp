@@ -0,0 +1,257 @@
+#include "control_channel.h"
+#include <charconv>
+
+namespace {
+
+std::string_view TrimSpaces(std::string_view text) {
+    const size_t first = text.find_first_not_of(" \t\r");
+    if (first == std::string_view::npos) {
+        return {};
+    }
+    return text.substr(first, text.find_last_not_of(" \t\r") - first + 1);
+}
+
+} // namespace
+
+ControlRequest ParseControlRequest(std::string_view line) {
+    line = TrimSpaces(line);
+    const size_t space = line.find_first_of(" \t");
+    if (space == std::string_view::npos) {
+        return {line, {}};
+    }
+    return {line.substr(0, space), TrimSpaces(line.substr(space + 1))};
+}
+
+std::string FormatControlResponse(const ControlResponse &response) {
+    std::string text = (response.ok ? "ok " : "error ") + std::to_string(response.lines.size()) + "\n";
+    for (const std::string &line : response.lines) {
+        text += line;
+        text += '\n';
+    }
+    return text;
+}
+
+std::optional<std::string> TakeControlLine(std::string &buffer) {
+    const size_t newline = buffer.find('\n');
+    if (newline == std::string::npos) {
+        return std::nullopt;
+    }
+    std::string line = buffer.substr(0, newline > 0 && buffer[newline - 1] == '\r' ? newline - 1 : newline);
+    buffer.erase(0, newline + 1);
+    return line;
+}
+
+std::optional<ControlResponse> TakeControlResponse(std::string &buffer) {
+    // Nothing is consumed until every line of the response is there
+    const size_t headerEnd = buffer.find('\n');
+    if (headerEnd == std::string::npos) {
+        return std::nullopt;
+    }
+    const ControlRequest header = ParseControlRequest(std::string_view(buffer).substr(0, headerEnd));
+    size_t count = 0;
+    std::from_chars(header.argument.data(), header.argument.data() + header.argument.size(), count);
+    size_t end = headerEnd;
+    for (size_t line = 0; line < count; ++line) {
+        end = buffer.find('\n', end + 1);
+        if (end == std::string::npos) {
+            return std::nullopt;
+        }
+    }
+
+    ControlResponse response;
+    response.ok = header.command == "ok";
+    [[maybe_unused]] const std::optional<std::string> headerLine = TakeControlLine(buffer);
+    for (size_t line = 0; line < count; ++line) {
+        response.lines.push_back(*TakeControlLine(buffer));
+    }
+    return response;
+}
+
+bool ControlClient::Request(std::string_view line, ControlResponse &response) {
+    if (m_handle == -1 || line.find('\n') != std::string_view::npos || !Write(std::string(line) + "\n")) {
+        return false;
+    }
+    for (;;) {
+        if (std::optional<ControlResponse> received = TakeControlResponse(m_buffer)) {
+            response = std::move(*received);
+            return true;
+        }
+        if (!Read(m_buffer)) {
+            return false;
+        }
+    }
+}
+
+#ifndef _WIN32
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cstring>
+#include <thread>
+
+struct ControlServer::State {
+    std::string path;
+    Handler handler;
+    int listener = -1;
+    int stopPipe[2] = {-1, -1};
+    std::thread thread;
+
+    void Run();
+    void Serve(int client);
+
+    // Waits until fd is readable; false when stopping
+    [[nodiscard]] bool WaitReadable(int fd) const;
+};
+
+namespace {
+
+bool WriteAll(int fd, std::string_view data) {
+    while (!data.empty()) {
+        const ssize_t written = send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+        if (written <= 0) {
+            return false;
+        }
+        data.remove_prefix(static_cast<size_t>(written));
+    }
+    return true;
+}
+
+bool MakeAddress(const std::string &path, sockaddr_un &address) {
+    address = {};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        return false;
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+} // namespace
+
+std::string ControlEndpointName(uint32_t processId) {
+    return "/tmp/SplinterCellPatch." + std::to_string(processId) + ".sock";
+}
+
+bool ControlServer::State::WaitReadable(int fd) const {
+    pollfd fds[2] = {{stopPipe[0], POLLIN, 0}, {fd, POLLIN, 0}};
+    return poll(fds, 2, -1) > 0 && !(fds[0].revents & POLLIN);
+}
+
+void ControlServer::State::Run() {
+    while (WaitReadable(listener)) {
+        const int client = accept(listener, nullptr, nullptr);
+        if (client >= 0) {
+            Serve(client);
+            close(client);
+        }
+    }
+}
+
+void ControlServer::State::Serve(int client) {
+    std::string buffer;
+    char chunk[512];
+    for (;;) {
+        while (std::optional<std::string> line = TakeControlLine(buffer)) {
+            if (!WriteAll(client, FormatControlResponse(handler(ParseControlRequest(*line))))) {
+                return;
+            }
+        }
+        if (buffer.size() > CONTROL_MAX_LINE || !WaitReadable(client)) {
+            return;
+        }
+        const ssize_t received = recv(client, chunk, sizeof(chunk), 0);
+        if (received <= 0) {
+            return;
+        }
+        buffer.append(chunk, static_cast<size_t>(received));
+    }
+}
+
+ControlServer::ControlServer() = default;
+
+ControlServer::~ControlServer() {
+    Stop();
+}
+
+bool ControlServer::Start(uint32_t processId, Handler handler) {
+    if (m_state) {
+        return false;
+    }
+    auto state = std::make_unique<State>();
+    state->path = ControlEndpointName(processId);
+    state->handler = std::move(handler);
+
+    sockaddr_un address;
+    if (!MakeAddress(state->path, address)) {
+        return false;
+    }
+    unlink(state->path.c_str()); // Left behind by a process that reused this id
+    state->listener = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (state->listener < 0) {
+        return false;
+    }
+    if (bind(state->listener, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0 ||
+        listen(state->listener, 4) != 0 || pipe(state->stopPipe) != 0) {
+        close(state->listener);
+        unlink(state->path.c_str());
+        return false;
+    }
+    state->thread = std::thread(&State::Run, state.get());
+    m_state = std::move(state);
+    return true;
+}
+
+void ControlServer::Stop() {
+    if (!m_state) {
+        return;
+    }
+    [[maybe_unused]] const ssize_t written = write(m_state->stopPipe[1], "", 1);
+    m_state->thread.join();
+    close(m_state->stopPipe[0]);
+    close(m_state->stopPipe[1]);
+    close(m_state->listener);
+    unlink(m_state->path.c_str());
+    m_state.reset();
+}
+
+bool ControlClient::Connect(uint32_t processId) {
+    Close();
+    sockaddr_un address;
+    if (!MakeAddress(ControlEndpointName(processId), address)) {
+        return false;
+    }
+    const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return false;
+    }
+    if (connect(fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0) {
+        close(fd);
+        return false;
+    }
+    m_handle = fd;
+    return true;
+}
+
+void ControlClient::Close() {
+    if (m_handle != -1) {
+        close(static_cast<int>(m_handle));
+        m_handle = -1;
+    }
+    m_buffer.clear();
+}
+
+bool ControlClient::Write(std::string_view data) {
+    return WriteAll(static_cast<int>(m_handle), data);
+}
+
+bool ControlClient::Read(std::string &buffer) {
+    char chunk[512];
+    const ssize_t received = recv(static_cast<int>(m_handle), chunk, sizeof(chunk), 0);
+    if (received <= 0) {
+        return false;
+    }
+    buffer.append(chunk, static_cast<size_t>(received));
+    return true;
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,83 @@
+#ifndef SPLINTERCELLPATCH_CONTROL_CHANNEL_H
+#define SPLINTERCELLPATCH_CONTROL_CHANNEL_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Control endpoint of an injected process: a named pipe (\\.\pipe\SplinterCellPatch.<pid>) on Windows, a Unix
+// socket (/tmp/SplinterCellPatch.<pid>.sock) elsewhere. The protocol is line based. A request is one line,
+// "<command> [<argument>]". The response starts with "ok <n>" or "error <n>", followed by n lines of text.
+
+inline constexpr size_t CONTROL_MAX_LINE = 1024; // Longer requests close the connection
+
+struct ControlRequest {
+    std::string_view command;
+    std::string_view argument; // Rest of the line, trimmed
+};
+
+struct ControlResponse {
+    bool ok = true;
+    std::vector<std::string> lines;
+
+    [[nodiscard]] static ControlResponse Error(std::string message) { return {false, {std::move(message)}}; }
+};
+
+[[nodiscard]] std::string ControlEndpointName(uint32_t processId);
+
+[[nodiscard]] ControlRequest ParseControlRequest(std::string_view line);
+[[nodiscard]] std::string FormatControlResponse(const ControlResponse &response);
+
+// Removes and returns the first complete line of buffer (without its line ending)
+[[nodiscard]] std::optional<std::string> TakeControlLine(std::string &buffer);
+
+// Removes and returns the first complete response of buffer; nullopt until all of it has arrived
+[[nodiscard]] std::optional<ControlResponse> TakeControlResponse(std::string &buffer);
+
+// Serves one client at a time on a background thread
+class ControlServer {
+public:
+    using Handler = std::function<ControlResponse(const ControlRequest &request)>;
+
+    ControlServer();
+    ControlServer(const ControlServer &) = delete;
+    ControlServer &operator=(const ControlServer &) = delete;
+    ~ControlServer();
+
+    // handler runs on the server thread. A server is started at most once.
+    [[nodiscard]] bool Start(uint32_t processId, Handler handler);
+
+    // Signals the server thread. On Windows it does not wait (safe under the loader lock).
+    void Stop();
+
+private:
+    struct State; // Platform-specific
+    std::unique_ptr<State> m_state;
+};
+
+class ControlClient {
+public:
+    ControlClient() = default;
+    ControlClient(const ControlClient &) = delete;
+    ControlClient &operator=(const ControlClient &) = delete;
+    ~ControlClient() { Close(); }
+
+    [[nodiscard]] bool Connect(uint32_t processId);
+    void Close();
+
+    // Sends one request line and waits for its response
+    [[nodiscard]] bool Request(std::string_view line, ControlResponse &response);
+
+private:
+    [[nodiscard]] bool Write(std::string_view data);
+    [[nodiscard]] bool Read(std::string &buffer); // Appends whatever arrived; false on disconnect
+
+    intptr_t m_handle = -1; // Socket or pipe HANDLE
+    std::string m_buffer;
+};
+
+#endif // SPLINTERCELLPATCH_CONTROL_CHANNEL_H
\ No newline at end of file
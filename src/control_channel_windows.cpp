@@ -0,0 +1,174 @@
+#include "control_channel.h"
+#include <windows.h>
+
+struct ControlServer::State {
+    Handler handler;
+    HANDLE pipe = INVALID_HANDLE_VALUE;
+    HANDLE stopEvent = nullptr;
+    HANDLE thread = nullptr;
+    OVERLAPPED overlapped = {};
+
+    static DWORD WINAPI ThreadProc(LPVOID parameter);
+    void Run();
+    void Serve();
+
+    // Waits for an overlapped operation on the pipe; false when stopping or when the operation failed
+    [[nodiscard]] bool Complete(BOOL issued, DWORD &bytes);
+};
+
+std::string ControlEndpointName(uint32_t processId) {
+    return "\\\\.\\pipe\\SplinterCellPatch." + std::to_string(processId);
+}
+
+DWORD WINAPI ControlServer::State::ThreadProc(LPVOID parameter) {
+    static_cast<State *>(parameter)->Run();
+    return 0;
+}
+
+bool ControlServer::State::Complete(BOOL issued, DWORD &bytes) {
+    bytes = 0;
+    if (!issued) {
+        const DWORD error = GetLastError();
+        if (error == ERROR_PIPE_CONNECTED) {
+            return true; // The client connected between CreateNamedPipe and ConnectNamedPipe
+        }
+        if (error != ERROR_IO_PENDING) {
+            return false;
+        }
+    }
+    const HANDLE handles[] = {stopEvent, overlapped.hEvent};
+    if (WaitForMultipleObjects(2, handles, FALSE, INFINITE) != WAIT_OBJECT_0 + 1) {
+        CancelIoEx(pipe, &overlapped);
+        GetOverlappedResult(pipe, &overlapped, &bytes, TRUE);
+        return false;
+    }
+    return GetOverlappedResult(pipe, &overlapped, &bytes, FALSE);
+}
+
+void ControlServer::State::Run() {
+    overlapped.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    if (!overlapped.hEvent) {
+        return;
+    }
+
+    // One pipe instance, reused for every client
+    while (WaitForSingleObject(stopEvent, 0) == WAIT_TIMEOUT) {
+        DWORD bytes = 0;
+        ResetEvent(overlapped.hEvent);
+        if (Complete(ConnectNamedPipe(pipe, &overlapped), bytes)) {
+            Serve();
+        }
+        DisconnectNamedPipe(pipe);
+    }
+    CloseHandle(overlapped.hEvent);
+}
+
+void ControlServer::State::Serve() {
+    std::string buffer;
+    char chunk[512];
+    for (;;) {
+        while (std::optional<std::string> line = TakeControlLine(buffer)) {
+            const std::string response = FormatControlResponse(handler(ParseControlRequest(*line)));
+            DWORD written = 0;
+            ResetEvent(overlapped.hEvent);
+            if (!Complete(WriteFile(pipe, response.data(), static_cast<DWORD>(response.size()), nullptr, &overlapped),
+                          written) ||
+                written != response.size()) {
+                return;
+            }
+        }
+        if (buffer.size() > CONTROL_MAX_LINE) {
+            return;
+        }
+        DWORD received = 0;
+        ResetEvent(overlapped.hEvent);
+        if (!Complete(ReadFile(pipe, chunk, sizeof(chunk), nullptr, &overlapped), received) || received == 0) {
+            return;
+        }
+        buffer.append(chunk, received);
+    }
+}
+
+ControlServer::ControlServer() = default;
+
+// The thread is gone by the time static destructors run at process exit
+ControlServer::~ControlServer() = default;
+
+bool ControlServer::Start(uint32_t processId, Handler handler) {
+    if (m_state) {
+        return false;
+    }
+    auto state = std::make_unique<State>();
+    state->handler = std::move(handler);
+
+    // FIRST_PIPE_INSTANCE fails if another process already squats on the name; remote clients are refused
+    state->pipe = CreateNamedPipeA(ControlEndpointName(processId).c_str(),
+                                   PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED | FILE_FLAG_FIRST_PIPE_INSTANCE,
+                                   PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS, 1,
+                                   4096, 4096, 0, nullptr);
+    if (state->pipe == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    state->stopEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    if (!state->stopEvent) {
+        CloseHandle(state->pipe);
+        return false;
+    }
+
+    state->thread = CreateThread(nullptr, 0, State::ThreadProc, state.get(), 0, nullptr);
+    if (!state->thread) {
+        CloseHandle(state->stopEvent);
+        CloseHandle(state->pipe);
+        return false;
+    }
+    m_state = std::move(state);
+    return true;
+}
+
+void ControlServer::Stop() {
+    if (m_state && m_state->stopEvent) {
+        SetEvent(m_state->stopEvent);
+    }
+}
+
+bool ControlClient::Connect(uint32_t processId) {
+    Close();
+    const std::string name = ControlEndpointName(processId);
+    for (;;) {
+        HANDLE pipe = CreateFileA(name.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, 0, nullptr);
+        if (pipe != INVALID_HANDLE_VALUE) {
+            m_handle = reinterpret_cast<intptr_t>(pipe);
+            return true;
+        }
+
+        // The single pipe instance is serving another client
+        if (GetLastError() != ERROR_PIPE_BUSY || !WaitNamedPipeA(name.c_str(), 5000)) {
+            return false;
+        }
+    }
+}
+
+void ControlClient::Close() {
+    if (m_handle != -1) {
+        CloseHandle(reinterpret_cast<HANDLE>(m_handle));
+        m_handle = -1;
+    }
+    m_buffer.clear();
+}
+
+bool ControlClient::Write(std::string_view data) {
+    DWORD written = 0;
+    return WriteFile(reinterpret_cast<HANDLE>(m_handle), data.data(), static_cast<DWORD>(data.size()), &written,
+                     nullptr) &&
+           written == data.size();
+}
+
+bool ControlClient::Read(std::string &buffer) {
+    char chunk[512];
+    DWORD received = 0;
+    if (!ReadFile(reinterpret_cast<HANDLE>(m_handle), chunk, sizeof(chunk), &received, nullptr) || received == 0) {
+        return false;
+    }
+    buffer.append(chunk, received);
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,195 @@
+#include "hook_stats.h"
+#include "topology.h"
+#include <algorithm>
+#include <bit>
+
+namespace {
+
+HookCounters *Shards(std::byte *block) {
+    return reinterpret_cast<HookCounters *>(block + sizeof(StatsBlockHeader));
+}
+
+// The writer only ever increments, so relaxed per-counter loads give a consistent enough picture for rates
+std::array<HookTotals, STATS_HOOKS> SumShards(std::byte *block, uint32_t shardCount) {
+    std::array<HookTotals, STATS_HOOKS> totals = {};
+    HookCounters *shards = Shards(block);
+    for (uint32_t shard = 0; shard < shardCount; ++shard) {
+        for (uint32_t hook = 0; hook < STATS_HOOKS; ++hook) {
+            HookCounters &counters = shards[shard * STATS_HOOKS + hook];
+            HookTotals &total = totals[hook];
+            total.calls += std::atomic_ref(counters.calls).load(std::memory_order_relaxed);
+            total.rewrites += std::atomic_ref(counters.rewrites).load(std::memory_order_relaxed);
+            total.failures += std::atomic_ref(counters.failures).load(std::memory_order_relaxed);
+            for (uint32_t bucket = 0; bucket < LATENCY_BUCKETS; ++bucket) {
+                total.latency[bucket] += std::atomic_ref(counters.latency[bucket]).load(std::memory_order_relaxed);
+            }
+        }
+    }
+    return totals;
+}
+
+// The three fields are read independently; a reader may see two different samples mixed for one refresh
+AddressSpaceUsage LoadAddressSpace(StatsBlockHeader &header) {
+    AddressSpaceUsage usage;
+    usage.total = std::atomic_ref(header.addressSpace.total).load(std::memory_order_relaxed);
+    usage.free = std::atomic_ref(header.addressSpace.free).load(std::memory_order_relaxed);
+    usage.largestFree = std::atomic_ref(header.addressSpace.largestFree).load(std::memory_order_relaxed);
+    return usage;
+}
+
+} // namespace
+
+size_t StatsBlockBytes(uint32_t shardCount) {
+    return sizeof(StatsBlockHeader) + size_t{shardCount} * STATS_HOOKS * sizeof(HookCounters);
+}
+
+std::string StatsSectionName(uint32_t processId) {
+    return "SplinterCellPatchStats." + std::to_string(processId);
+}
+
+uint32_t LatencyBucket(uint64_t ticks) {
+    return std::min(static_cast<uint32_t>(std::bit_width(ticks)), LATENCY_BUCKETS - 1);
+}
+
+bool HookStats::Create(uint32_t processId, uint64_t ticksPerSecond, std::span<const uint32_t> processorsPerGroup) {
+    if (Active()) {
+        return false;
+    }
+    m_shardCount = 0;
+    m_groupFirstShard = {};
+    m_groupProcessors = {};
+    for (size_t group = 0; group < processorsPerGroup.size() && group < STATS_MAX_GROUPS; ++group) {
+        m_groupFirstShard[group] = m_shardCount;
+        m_groupProcessors[group] = processorsPerGroup[group];
+        m_shardCount += processorsPerGroup[group];
+    }
+    m_shardCount = std::max(m_shardCount, 1u);
+    if (!m_memory.Create(StatsSectionName(processId), StatsBlockBytes(m_shardCount))) {
+        return false;
+    }
+    StatsBlockHeader header;
+    header.shardCount = m_shardCount;
+    header.ticksPerSecond = ticksPerSecond;
+    header.processId = processId;
+    *reinterpret_cast<StatsBlockHeader *>(m_memory.Data()) = header;
+    m_active.store(true, std::memory_order_release);
+    return true;
+}
+
+void HookStats::Close() {
+    if (m_active.exchange(false, std::memory_order_acq_rel)) {
+        m_memory.Close();
+    }
+}
+
+void HookStats::RecordCall(uint32_t processor, TraceHook hook, bool rewritten, bool failed) {
+    if (!Active() || hook >= TraceHook::Count) {
+        return;
+    }
+    HookCounters &counters = Counters(processor, hook);
+    std::atomic_ref(counters.calls).fetch_add(1, std::memory_order_relaxed);
+    if (rewritten) {
+        std::atomic_ref(counters.rewrites).fetch_add(1, std::memory_order_relaxed);
+    }
+    if (failed) {
+        std::atomic_ref(counters.failures).fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void HookStats::RecordLatency(uint32_t processor, TraceHook hook, uint64_t ticks) {
+    if (!Active() || hook >= TraceHook::Count) {
+        return;
+    }
+    std::atomic_ref(Counters(processor, hook).latency[LatencyBucket(ticks)]).fetch_add(1, std::memory_order_relaxed);
+}
+
+std::array<HookTotals, STATS_HOOKS> HookStats::Snapshot() const {
+    if (!Active()) {
+        return {};
+    }
+    return SumShards(m_memory.Data(), m_shardCount);
+}
+
+uint32_t HookStats::Shard(uint32_t processor) const {
+    const uint32_t group = processor / PROCESSORS_PER_GROUP;
+    const uint32_t number = processor % PROCESSORS_PER_GROUP;
+    if (group < STATS_MAX_GROUPS && number < m_groupProcessors[group]) {
+        return m_groupFirstShard[group] + number;
+    }
+    return processor % m_shardCount;
+}
+
+void HookStats::RecordAddressSpace(const AddressSpaceUsage &usage) {
+    if (!Active()) {
+        return;
+    }
+    StatsBlockHeader &header = *reinterpret_cast<StatsBlockHeader *>(m_memory.Data());
+    std::atomic_ref(header.addressSpace.free).store(usage.free, std::memory_order_relaxed);
+    std::atomic_ref(header.addressSpace.largestFree).store(usage.largestFree, std::memory_order_relaxed);
+    std::atomic_ref(header.addressSpace.total).store(usage.total, std::memory_order_relaxed);
+}
+
+AddressSpaceUsage HookStats::AddressSpace() const {
+    if (!Active()) {
+        return {};
+    }
+    return LoadAddressSpace(*reinterpret_cast<StatsBlockHeader *>(m_memory.Data()));
+}
+
+HookCounters &HookStats::Counters(uint32_t processor, TraceHook hook) const {
+    return Shards(m_memory.Data())[Shard(processor) * STATS_HOOKS + static_cast<size_t>(hook)];
+}
+
+bool HookStatsReader::Open(uint32_t processId) {
+    // The header says how many shards follow, so it is mapped on its own first
+    const std::string name = StatsSectionName(processId);
+    if (!m_memory.OpenReadOnly(name, sizeof(StatsBlockHeader))) {
+        return false;
+    }
+    const StatsBlockHeader header = *reinterpret_cast<const StatsBlockHeader *>(m_memory.Data());
+    if (header.magic != STATS_MAGIC || header.version != STATS_VERSION || header.hookCount != STATS_HOOKS ||
+        header.shardCount == 0 || header.bucketCount != LATENCY_BUCKETS ||
+        !m_memory.OpenReadOnly(name, StatsBlockBytes(header.shardCount))) {
+        m_memory.Close();
+        return false;
+    }
+    m_shardCount = header.shardCount;
+    return true;
+}
+
+std::array<HookTotals, STATS_HOOKS> HookStatsReader::Snapshot() const {
+    if (!m_memory.Data()) {
+        return {};
+    }
+    return SumShards(m_memory.Data(), m_shardCount);
+}
+
+uint64_t HookStatsReader::TicksPerSecond() const {
+    return m_memory.Data() ? reinterpret_cast<const StatsBlockHeader *>(m_memory.Data())->ticksPerSecond : 0;
+}
+
+AddressSpaceUsage HookStatsReader::AddressSpace() const {
+    if (!m_memory.Data()) {
+        return {};
+    }
+    return LoadAddressSpace(*reinterpret_cast<StatsBlockHeader *>(m_memory.Data()));
+}
+
+uint64_t LatencyPercentile(const std::array<uint64_t, LATENCY_BUCKETS> &latency, double fraction) {
+    uint64_t count = 0;
+    for (const uint64_t calls : latency) {
+        count += calls;
+    }
+    if (count == 0) {
+        return 0;
+    }
+    const auto target = static_cast<uint64_t>(static_cast<double>(count) * fraction);
+    uint64_t seen = 0;
+    for (uint32_t bucket = 0; bucket < LATENCY_BUCKETS; ++bucket) {
+        seen += latency[bucket];
+        if (seen >= std::max<uint64_t>(target, 1)) {
+            return bucket == 0 ? 0 : (uint64_t{1} << bucket) - 1;
+        }
+    }
+    return (uint64_t{1} << (LATENCY_BUCKETS - 1)) - 1;
+}
\ No newline at end of file
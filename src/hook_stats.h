@@ -0,0 +1,127 @@
+#ifndef SPLINTERCELLPATCH_HOOK_STATS_H
+#define SPLINTERCELLPATCH_HOOK_STATS_H
+
+#include "shared_memory.h"
+#include "trace_format.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+// Live hook statistics in a named shared-memory section ("SplinterCellPatchStats.<pid>"), so SplinterCellStats can
+// watch any injected process without attaching to it. Counters are sharded by the processor the hook runs on, one
+// shard per active processor, and every shard is cache-line aligned, so hooks on different cores never contend for a
+// line. Processors are numbered densely across groups (group 1 starts after the last processor of group 0), so the
+// block has exactly as many shards as the machine has processors.
+
+inline constexpr std::array<char, 8> STATS_MAGIC = {'S', 'C', 'S', 'T', 'A', 'T', 'S', '\0'};
+inline constexpr uint32_t STATS_VERSION = 2;
+inline constexpr uint32_t STATS_MAX_GROUPS = 32; // Processor groups a block tells apart; later groups share shards
+inline constexpr uint32_t STATS_HOOKS = static_cast<uint32_t>(TraceHook::Count);
+
+// Bucket b counts real-function calls that took [2^(b-1), 2^b) performance counter ticks (bucket 0: zero ticks)
+inline constexpr uint32_t LATENCY_BUCKETS = 32;
+
+// User-mode address space of the process, sampled periodically by the DLL. Only touched through std::atomic_ref;
+// total stays 0 until the first sample (and with DLLs that predate these fields).
+struct AddressSpaceUsage {
+    uint64_t total = 0;
+    uint64_t free = 0;
+    uint64_t largestFree = 0; // Largest free region, i.e. the biggest reservation that can still succeed
+};
+
+struct StatsBlockHeader {
+    std::array<char, 8> magic = STATS_MAGIC;
+    uint32_t version = STATS_VERSION;
+    uint32_t hookCount = STATS_HOOKS;
+    uint32_t shardCount = 0; // HookCounters[shardCount][hookCount] follow the header
+    uint32_t bucketCount = LATENCY_BUCKETS;
+    uint64_t ticksPerSecond = 0; // Latency bucket unit
+    uint32_t processId = 0;
+    uint32_t reserved = 0;
+    AddressSpaceUsage addressSpace;
+};
+static_assert(sizeof(StatsBlockHeader) == 64);
+
+// One hook's counters in one shard. Only touched through std::atomic_ref, so the block stays a plain layout that
+// another process can map.
+struct HookCounters {
+    uint64_t calls = 0;
+    uint64_t rewrites = 0; // Calls whose arguments were changed before reaching Windows
+    uint64_t failures = 0; // Calls the real function failed
+    uint64_t padding[5] = {};
+    std::array<uint64_t, LATENCY_BUCKETS> latency = {};
+};
+static_assert(sizeof(HookCounters) % 64 == 0);
+
+// Size of a block with shardCount shards
+[[nodiscard]] size_t StatsBlockBytes(uint32_t shardCount);
+
+// Section name for a process; the platform layer adds the Local\ or / prefix
+[[nodiscard]] std::string StatsSectionName(uint32_t processId);
+
+// Bucket index for a real-function duration
+[[nodiscard]] uint32_t LatencyBucket(uint64_t ticks);
+
+// Per-hook totals summed over every shard
+struct HookTotals {
+    uint64_t calls = 0;
+    uint64_t rewrites = 0;
+    uint64_t failures = 0;
+    std::array<uint64_t, LATENCY_BUCKETS> latency = {};
+};
+
+class HookStats {
+public:
+    // processorsPerGroup holds the active processor count of each processor group; one shard is made per processor
+    [[nodiscard]] bool Create(uint32_t processId, uint64_t ticksPerSecond,
+                              std::span<const uint32_t> processorsPerGroup);
+    void Close();
+
+    [[nodiscard]] bool Active() const { return m_active.load(std::memory_order_acquire); }
+
+    // Lock-free, safe from any thread. processor is the global index (group * 64 + number) of the current processor.
+    void RecordCall(uint32_t processor, TraceHook hook, bool rewritten, bool failed);
+    void RecordLatency(uint32_t processor, TraceHook hook, uint64_t ticks);
+
+    [[nodiscard]] uint32_t ShardCount() const { return m_shardCount; }
+
+    // Shard holding a processor's counters. Distinct for every processor of the groups given to Create; others
+    // wrap around.
+    [[nodiscard]] uint32_t Shard(uint32_t processor) const;
+
+    [[nodiscard]] std::array<HookTotals, STATS_HOOKS> Snapshot() const;
+
+    void RecordAddressSpace(const AddressSpaceUsage &usage);
+    [[nodiscard]] AddressSpaceUsage AddressSpace() const;
+
+private:
+    [[nodiscard]] HookCounters &Counters(uint32_t processor, TraceHook hook) const;
+
+    SharedMemory m_memory;
+    uint32_t m_shardCount = 0;
+    std::array<uint32_t, STATS_MAX_GROUPS> m_groupFirstShard = {};
+    std::array<uint32_t, STATS_MAX_GROUPS> m_groupProcessors = {};
+    std::atomic<bool> m_active = false; // Set after the fields above, which hooks read once they see it
+};
+
+class HookStatsReader {
+public:
+    // Fails when the process has no stats block or it was written by an incompatible version
+    [[nodiscard]] bool Open(uint32_t processId);
+
+    [[nodiscard]] std::array<HookTotals, STATS_HOOKS> Snapshot() const;
+    [[nodiscard]] uint64_t TicksPerSecond() const;
+    [[nodiscard]] AddressSpaceUsage AddressSpace() const;
+
+private:
+    SharedMemory m_memory;
+    uint32_t m_shardCount = 0;
+};
+
+// Upper bound, in ticks, of the bucket holding the given fraction (0..1] of the histogram's calls
+[[nodiscard]] uint64_t LatencyPercentile(const std::array<uint64_t, LATENCY_BUCKETS> &latency, double fraction);
+
+#endif // SPLINTERCELLPATCH_HOOK_STATS_H
\ No newline at end of file
@@ -0,0 +1,297 @@
+#include "hook_table.h"
+#include "logging.h"
+#include "pe_image.h"
+#include "string_utils.h"
+#include <tlhelp32.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#include "detours_x64.h"
+#else
+#include "detours_x86.h"
+#endif
+
+namespace {
+
+using DetourOperation = LONG (WINAPI *)(PVOID *, PVOID);
+
+bool Selected(HookMask entries, size_t index) {
+    return (entries >> index) & 1;
+}
+
+std::string_view SymbolOfSlot(std::span<const HookEntry> table, PVOID *slot) {
+    for (const HookEntry &entry : table) {
+        if (entry.real() == slot) {
+            return entry.symbol;
+        }
+    }
+    return "unknown";
+}
+
+// Other threads of the process, opened for DetourUpdateThread. A thread started after the snapshot is not suspended;
+// it could only reach a patched prologue if it is created while the transaction runs.
+std::vector<HANDLE> OpenOtherThreads() {
+    std::vector<HANDLE> threads;
+    HANDLE snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, 0);
+    if (snapshot == INVALID_HANDLE_VALUE) {
+        LOG_ERROR("CreateToolhelp32Snapshot failed (error: 0x{:X}), updating the current thread only", GetLastError());
+        return threads;
+    }
+
+    const DWORD processId = GetCurrentProcessId();
+    const DWORD currentThreadId = GetCurrentThreadId();
+    THREADENTRY32 entry = {};
+    entry.dwSize = sizeof(entry);
+    for (BOOL more = Thread32First(snapshot, &entry); more; more = Thread32Next(snapshot, &entry)) {
+        if (entry.th32OwnerProcessID != processId || entry.th32ThreadID == currentThreadId) {
+            continue;
+        }
+        // Threads that exited since the snapshot simply fail to open
+        if (HANDLE hThread = OpenThread(THREAD_SUSPEND_RESUME | THREAD_GET_CONTEXT | THREAD_SET_CONTEXT, FALSE,
+                                        entry.th32ThreadID)) {
+            threads.push_back(hThread);
+        }
+    }
+    CloseHandle(snapshot);
+    return threads;
+}
+
+bool RunTransaction(std::span<const HookEntry> table, HookMask entries, DetourOperation operation,
+                    std::string_view operationName, HookThreads threads, HookTransactionStats &stats) {
+    stats = {};
+
+    // Opened before the transaction: nothing that can take a lock runs while threads are suspended
+    std::vector<HANDLE> otherThreads;
+    if (threads == HookThreads::All) {
+        otherThreads = OpenOtherThreads();
+    }
+    const auto closeThreads = [&] {
+        for (HANDLE hThread : otherThreads) {
+            CloseHandle(hThread);
+        }
+    };
+
+    LONG error = DetourTransactionBegin();
+    if (error != NO_ERROR) {
+        LOG_ERROR("DetourTransactionBegin failed with error: 0x{:X}", error);
+        closeThreads();
+        return false;
+    }
+
+    // Detours suspends each updated thread and resumes it when the transaction commits or aborts
+    const auto suspended = std::chrono::steady_clock::now();
+    const auto finish = [&] {
+        stats.suspendedMicroseconds = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - suspended).count());
+        closeThreads();
+    };
+
+    error = DetourUpdateThread(GetCurrentThread());
+    for (HANDLE hThread : otherThreads) {
+        if (error != NO_ERROR) {
+            break;
+        }
+        error = DetourUpdateThread(hThread);
+        stats.threads += error == NO_ERROR;
+    }
+    if (error != NO_ERROR) {
+        LOG_ERROR("DetourUpdateThread failed with error: 0x{:X}", error);
+        DetourTransactionAbort();
+        finish();
+        return false;
+    }
+
+    for (size_t i = 0; i < table.size(); ++i) {
+        if (!Selected(entries, i)) {
+            continue;
+        }
+        error = operation(table[i].real(), table[i].detour());
+        if (error != NO_ERROR) {
+            LOG_ERROR("{}({}) failed with error: 0x{:X}", operationName, table[i].symbol, error);
+            DetourTransactionAbort();
+            finish();
+            return false;
+        }
+    }
+
+    // Detours restores every patched function itself when the commit fails
+    PVOID *failed = nullptr;
+    error = DetourTransactionCommitEx(&failed);
+    finish();
+    if (error != NO_ERROR) {
+        LOG_ERROR(
+            "{} transaction failed at {} with error: 0x{:X}", operationName, SymbolOfSlot(table, failed), error
+        );
+        return false;
+    }
+    return true;
+}
+
+// Import address table entry and the pointer the loader stored in it
+struct ImportPatch {
+    size_t entry = 0;
+    PVOID *slot = nullptr;
+    PVOID original = nullptr;
+};
+
+// Patches applied by AttachImportTable, in order. Install and uninstall never run concurrently.
+std::vector<ImportPatch> g_importPatches;
+
+// Windows 7+ executables import many kernel32 functions through api-ms-win-* API set contracts
+bool IsApiSetModule(std::string_view module) {
+    const std::string_view prefix = module.substr(0, 11);
+    return EqualsIgnoreCase(prefix, "api-ms-win-") || EqualsIgnoreCase(prefix, "ext-ms-win-");
+}
+
+bool SlotImportsEntry(const PeImportSlot &slot, PVOID current, const HookEntry &entry) {
+    if (current == *entry.real()) {
+        return true;
+    }
+    return !slot.symbol.empty() && slot.symbol == entry.symbol &&
+           (EqualsIgnoreCase(slot.module, entry.module) || IsApiSetModule(slot.module));
+}
+
+// Import address tables usually sit in a read-only section once the loader is done with them
+bool WriteSlot(PVOID *slot, PVOID value) {
+    // Some linkers merge the import address table into .text; PAGE_READWRITE would take the execute right away from
+    // the code sharing the page while the slot is written
+    MEMORY_BASIC_INFORMATION region = {};
+    if (!VirtualQuery(slot, &region, sizeof(region))) {
+        return false;
+    }
+    constexpr DWORD EXECUTABLE = PAGE_EXECUTE | PAGE_EXECUTE_READ | PAGE_EXECUTE_READWRITE | PAGE_EXECUTE_WRITECOPY;
+    const DWORD writable = (region.Protect & EXECUTABLE) ? PAGE_EXECUTE_READWRITE : PAGE_READWRITE;
+    DWORD protection = 0;
+    if (!VirtualProtect(slot, sizeof(PVOID), writable, &protection)) {
+        return false;
+    }
+    InterlockedExchangePointer(slot, value);
+    VirtualProtect(slot, sizeof(PVOID), protection, &protection);
+    return true;
+}
+
+void RestoreSlots(std::span<const ImportPatch> patches) {
+    for (auto it = patches.rbegin(); it != patches.rend(); ++it) {
+        if (!WriteSlot(it->slot, it->original)) {
+            LOG_ERROR("Cannot restore an import slot (error: 0x{:X})", GetLastError());
+        }
+    }
+}
+
+bool AttachImportTable(std::span<const HookEntry> table, HookMask entries, HookTransactionStats &stats) {
+    stats = {};
+    const auto *base = reinterpret_cast<const uint8_t *>(GetModuleHandleA(nullptr));
+    const auto *dosHeader = reinterpret_cast<const IMAGE_DOS_HEADER *>(base);
+    const auto *ntHeaders = reinterpret_cast<const IMAGE_NT_HEADERS *>(base + dosHeader->e_lfanew);
+    const std::span image(base, ntHeaders->OptionalHeader.SizeOfImage);
+
+    std::vector<PeImportSlot> slots;
+    if (const PeStatus status = ReadPeImportSlots(image, PeView::Mapped, slots); status != PeStatus::Ok) {
+        LOG_ERROR("Cannot read the executable's import table ({})", PeStatusName(status));
+        return false;
+    }
+
+    std::vector<ImportPatch> patches;
+    for (const PeImportSlot &slot : slots) {
+        auto *address = reinterpret_cast<PVOID *>(const_cast<uint8_t *>(base) + slot.slotRva);
+        const PVOID current = *address;
+        for (size_t i = 0; i < table.size(); ++i) {
+            if (!Selected(entries, i) || !SlotImportsEntry(slot, current, table[i])) {
+                continue;
+            }
+            if (!WriteSlot(address, table[i].detour())) {
+                LOG_ERROR("Cannot patch the import slot of {} (error: 0x{:X})", table[i].symbol, GetLastError());
+                RestoreSlots(patches);
+                return false;
+            }
+            patches.push_back({i, address, current});
+            break;
+        }
+    }
+
+    for (size_t i = 0; i < table.size(); ++i) {
+        if (Selected(entries, i) &&
+            std::ranges::none_of(patches, [i](const ImportPatch &patch) { return patch.entry == i; })) {
+            LOG_INFO("{}!{} is not imported by the executable, calls to it are not intercepted", table[i].module,
+                     table[i].symbol);
+        }
+    }
+    stats.slots = static_cast<uint32_t>(patches.size());
+    g_importPatches.insert(g_importPatches.end(), patches.begin(), patches.end());
+    return true;
+}
+
+bool DetachImportTable(HookMask entries, HookTransactionStats &stats) {
+    stats = {};
+    std::vector<ImportPatch> detached;
+    std::erase_if(g_importPatches, [&](const ImportPatch &patch) {
+        if (!Selected(entries, patch.entry)) {
+            return false;
+        }
+        detached.push_back(patch);
+        return true;
+    });
+    RestoreSlots(detached);
+    stats.slots = static_cast<uint32_t>(detached.size());
+    return true;
+}
+
+} // namespace
+
+bool ResolveHooks(std::span<const HookEntry> table) {
+    if (table.size() > MAX_HOOKS) {
+        LOG_ERROR("Hook table has {} entries, at most {} are supported", table.size(), MAX_HOOKS);
+        return false;
+    }
+
+    std::string_view missingModule; // Reported once for all of its entries
+    for (const HookEntry &entry : table) {
+        HMODULE module = GetModuleHandleA(entry.module.data());
+        PVOID address = module ? reinterpret_cast<PVOID>(GetProcAddress(module, entry.symbol.data())) : nullptr;
+        *entry.real() = address;
+        if (address) {
+            continue;
+        }
+        if (!entry.optional) {
+            LOG_ERROR("Cannot resolve {}!{}", entry.module, entry.symbol);
+            return false;
+        }
+        if (module) {
+            LOG_INFO("{}!{} not found, left unhooked", entry.module, entry.symbol);
+        } else if (entry.module != missingModule) {
+            LOG_INFO("{} is not loaded, its functions are left unhooked", entry.module);
+            missingModule = entry.module;
+        }
+    }
+    return true;
+}
+
+HookMask SelectHooks(std::span<const HookEntry> table, HookScopeMask scopes) {
+    HookMask entries = 0;
+    for (size_t i = 0; i < table.size(); ++i) {
+        const HookEntry &entry = table[i];
+        const bool enabled = entry.scope == HookScope::Always || (scopes & HookScopeBit(entry.scope)) != 0;
+        if (enabled && *entry.real() != nullptr) {
+            entries |= HookMask{1} << i;
+        }
+    }
+    return entries;
+}
+
+bool AttachHooks(std::span<const HookEntry> table, HookMask entries, HookBackend backend, HookThreads threads,
+                 HookTransactionStats &stats) {
+    if (backend == HookBackend::ImportTable) {
+        return AttachImportTable(table, entries, stats);
+    }
+    return RunTransaction(table, entries, DetourAttach, "DetourAttach", threads, stats);
+}
+
+bool DetachHooks(std::span<const HookEntry> table, HookMask entries, HookBackend backend, HookThreads threads,
+                 HookTransactionStats &stats) {
+    if (backend == HookBackend::ImportTable) {
+        return DetachImportTable(entries, stats);
+    }
+    return RunTransaction(table, entries, DetourDetach, "DetourDetach", threads, stats);
+}
\ No newline at end of file
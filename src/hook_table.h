@@ -0,0 +1,95 @@
+#ifndef SPLINTERCELLPATCH_HOOK_TABLE_H
+#define SPLINTERCELLPATCH_HOOK_TABLE_H
+
+#include "settings.h"
+#include <windows.h>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+// Declarative hook table. Each entry names an export and binds it to its typed Real_ pointer and Hooked_ function at
+// compile time; the table is resolved in one pass and attached or detached in a single Detours transaction, so the
+// window in which threads are suspended does not grow with the number of hooks.
+//
+// With HookBackend::ImportTable the same entries are installed by rewriting the main executable's import address
+// table instead: every slot importing the entry's function (by address, or by name through an API set) points at
+// the hook. Real_ pointers keep the resolved export, so hooks call it the same way with either backend.
+
+// When an entry is attached. Every entry is resolved regardless, so Real_ pointers can always be called.
+enum class HookScope : uint8_t {
+    Always,
+    MonotonicTimers,      // Profile's monotonicTimers
+    Tracing,              // A trace file is open
+    ReplacementHeap,      // Profile's heap.enabled and the slab heap was created
+    SpinTuning,           // Profile's spinTuning.enabled
+    LockProfiling,        // Profile's lockProfiling.enabled
+    CriticalSectionEnter, // Spin tuning or lock profiling, which share the EnterCriticalSection hook
+};
+
+// Bit per enabled HookScope; Always needs none
+using HookScopeMask = uint32_t;
+
+constexpr HookScopeMask HookScopeBit(HookScope scope) {
+    return HookScopeMask{1} << static_cast<uint32_t>(scope);
+}
+
+struct HookEntry {
+    std::string_view module; // Null-terminated literal. Must already be loaded; DllMain never loads modules.
+    std::string_view symbol; // Null-terminated literal
+    HookScope scope = HookScope::Always;
+    bool optional = false; // A module or export that is missing leaves the entry out instead of failing
+    PVOID *(*real)() = nullptr; // Slot of the Real_ pointer, which Detours redirects to the trampoline
+    PVOID (*detour)() = nullptr;
+};
+
+// Bit per table entry
+using HookMask = uint64_t;
+inline constexpr size_t MAX_HOOKS = 64;
+
+template <auto &Real>
+PVOID *RealSlot() {
+    return reinterpret_cast<PVOID *>(&Real);
+}
+
+template <auto Hook>
+PVOID DetourAddress() {
+    return reinterpret_cast<PVOID>(Hook);
+}
+
+// The hook must have exactly the type of the real function pointer it replaces
+template <auto &Real, auto Hook>
+consteval HookEntry MakeHook(std::string_view module, std::string_view symbol, HookScope scope = HookScope::Always,
+                             bool optional = false) {
+    static_assert(std::is_same_v<std::remove_cvref_t<decltype(Real)>, decltype(Hook)>,
+                  "hook signature does not match the real function");
+    return {module, symbol, scope, optional, &RealSlot<Real>, &DetourAddress<Hook>};
+}
+
+// Stores every entry's export in its Real_ pointer. Fails if a required entry cannot be resolved.
+[[nodiscard]] bool ResolveHooks(std::span<const HookEntry> table);
+
+// Entries that are resolved and whose scope is enabled
+[[nodiscard]] HookMask SelectHooks(std::span<const HookEntry> table, HookScopeMask scopes);
+
+// Threads a transaction suspends and updates. With Current, another thread executing a function while its prologue
+// is rewritten can crash; All suspends every thread of the process and moves any that sit in a patched prologue.
+enum class HookThreads : uint8_t {
+    Current,
+    All,
+};
+
+struct HookTransactionStats {
+    uint32_t threads = 0; // Threads other than the caller suspended and updated
+    uint32_t slots = 0;   // Import address table entries rewritten (HookBackend::ImportTable)
+    uint64_t suspendedMicroseconds = 0; // From the first DetourUpdateThread until every thread was resumed
+};
+
+// Attaches or detaches the selected entries in one transaction. On failure the transaction is aborted and no entry
+// changes state. threads only applies to HookBackend::Detours; import table writes are single pointer stores.
+[[nodiscard]] bool AttachHooks(std::span<const HookEntry> table, HookMask entries, HookBackend backend,
+                               HookThreads threads, HookTransactionStats &stats);
+[[nodiscard]] bool DetachHooks(std::span<const HookEntry> table, HookMask entries, HookBackend backend,
+                               HookThreads threads, HookTransactionStats &stats);
+
+#endif // SPLINTERCELLPATCH_HOOK_TABLE_H
\ No newline at end of file
@@ -0,0 +1,62 @@
+#include "hot_threads.h"
+#include <algorithm>
+#include <unordered_set>
+
+bool HotThreadDetector::Update(std::span<const ThreadCycles> samples) {
+    // Cycle deltas since the previous sample; a thread seen for the first time only establishes its baseline
+    std::unordered_map<uint32_t, History> threads;
+    uint64_t totalDelta = 0;
+    for (const ThreadCycles &sample : samples) {
+        History history;
+        if (const auto it = m_threads.find(sample.threadId); it != m_threads.end()) {
+            history = it->second;
+            history.delta = sample.cycles >= history.cycles ? sample.cycles - history.cycles : 0;
+        } else {
+            history.delta = 0;
+        }
+        history.cycles = sample.cycles;
+        totalDelta += history.delta;
+        threads.emplace(sample.threadId, history);
+    }
+
+    std::vector<std::pair<uint64_t, uint32_t>> ranked; // (delta, thread)
+    for (const auto &[threadId, history] : threads) {
+        ranked.emplace_back(history.delta, threadId);
+    }
+    std::ranges::sort(ranked, std::greater{});
+
+    // Candidates are the busiest threads that each own a large enough share of the process's cycles
+    std::unordered_set<uint32_t> candidates;
+    for (size_t i = 0; i < ranked.size() && i < m_settings.maxHotThreads; ++i) {
+        if (totalDelta != 0 && ranked[i].first * 100 >= totalDelta * m_settings.minSharePercent) {
+            candidates.insert(ranked[i].second);
+        }
+    }
+
+    for (auto &[threadId, history] : threads) {
+        if (candidates.contains(threadId)) {
+            ++history.hotStreak;
+            history.coldStreak = 0;
+        } else {
+            ++history.coldStreak;
+            history.hotStreak = 0;
+        }
+        history.hot = history.hot ? history.coldStreak < m_settings.demoteSamples
+                                  : history.hotStreak >= m_settings.promoteSamples;
+    }
+
+    // Demoted threads can linger for a few samples, so cap the set to the busiest hot threads
+    std::vector<uint32_t> hot;
+    for (const auto &[delta, threadId] : ranked) {
+        if (threads[threadId].hot && hot.size() < m_settings.maxHotThreads) {
+            hot.push_back(threadId);
+        } else {
+            threads[threadId].hot = false;
+        }
+    }
+
+    const bool changed = !std::ranges::is_permutation(hot, m_hot);
+    m_threads = std::move(threads);
+    m_hot = std::move(hot);
+    return changed;
+}
\ No newline at end of file
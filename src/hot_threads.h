@@ -0,0 +1,51 @@
+#ifndef SPLINTERCELLPATCH_HOT_THREADS_H
+#define SPLINTERCELLPATCH_HOT_THREADS_H
+
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+// Hot-thread detection. The sampler feeds cumulative per-thread CPU cycle counts at a fixed interval; the
+// detector picks the one or two threads that dominate, with hysteresis so short bursts do not cause migrations.
+
+struct HotThreadSettings {
+    bool enabled = true;
+    uint32_t intervalMs = 500;     // Time between samples
+    uint32_t maxHotThreads = 2;    // Threads given a dedicated fastest core
+    uint32_t minSharePercent = 25; // Share of the process's cycles a thread needs to count as hot
+    uint32_t promoteSamples = 2;   // Consecutive hot samples before a thread is promoted
+    uint32_t demoteSamples = 6;    // Consecutive cold samples before a thread is demoted
+};
+
+struct ThreadCycles {
+    uint32_t threadId = 0;
+    uint64_t cycles = 0; // Cumulative, as returned by QueryThreadCycleTime
+};
+
+class HotThreadDetector {
+public:
+    explicit HotThreadDetector(const HotThreadSettings &settings = {}) : m_settings(settings) {}
+
+    // Feeds one sample covering every live thread. Threads missing from the sample are considered exited.
+    // Returns true when the set of hot threads changed.
+    bool Update(std::span<const ThreadCycles> samples);
+
+    // Hot threads, hottest first as of the last sample
+    [[nodiscard]] const std::vector<uint32_t> &HotThreads() const { return m_hot; }
+
+private:
+    struct History {
+        uint64_t cycles = 0;
+        uint64_t delta = 0;
+        uint32_t hotStreak = 0;
+        uint32_t coldStreak = 0;
+        bool hot = false;
+    };
+
+    HotThreadSettings m_settings;
+    std::unordered_map<uint32_t, History> m_threads;
+    std::vector<uint32_t> m_hot;
+};
+
+#endif // SPLINTERCELLPATCH_HOT_THREADS_H
\ No newline at end of file
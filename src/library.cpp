@@ -1,7 +1,43 @@
 #include "library.h"
+#include "config_file.h"
+#include "config_payload.h"
+#include "config_watcher.h"
+#include "control_channel.h"
+#include "hook_stats.h"
+#include "hook_table.h"
+#include "lock_profiler.h"
+#include "logging.h"
+#include "monotonic_clock.h"
+#include "priority_rules.h"
+#include "processor_groups.h"
+#include "rcu_pointer.h"
+#include "settings.h"
+#include "slab_heap.h"
+#include "spin_tuner.h"
+#include "string_utils.h"
+#include "thread_placement.h"
+#include "thread_sampler.h"
+#include "topology.h"
+#include "trace_writer.h"
 #include <windows.h>
+#include <tlhelp32.h>
+#include <intrin.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <cstring>
+#include <deque>
 #include <format>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #if defined(_M_X64) || defined(__x86_64__)
 #include "detours_x64.h"
@@ -9,16 +45,78 @@
 #include "detours_x86.h"
 #endif
 
+// Spread the process over every processor group (and past processor 31 in WOW64 builds) using group affinity and
+// CPU Sets. Only takes effect on machines the legacy DWORD_PTR mask cannot fully address.
+inline constexpr bool SPAN_ALL_PROCESSOR_GROUPS = true;
+
+// Fallback mask used when the topology cannot be discovered
 inline constexpr DWORD_PTR ALL_CORES_MASK = 0xFFFFFFFFFFFFFFFF;
 
+// How often the address space headroom published with the hook statistics is refreshed
+inline constexpr DWORD ADDRESS_SPACE_INTERVAL_MS = 1000;
+
 // Dummy export function for DLL injectors that require at least one export
 extern "C" __declspec(dllexport) void DummyExport() {
     // This function exists solely to satisfy DLL injectors
     // It is never called
-    OutputDebugStringA("[AffinityHook] DummyExport called - this should never happen!");
+    LOG_ERROR("DummyExport called - this should never happen!");
 }
 
 static HMODULE g_hModule = nullptr;
+static std::once_flag g_initOnce;
+static std::atomic<bool> g_initialized = false; // Hooks are installed
+static uint64_t g_loaderLockTicks = 0;          // Time DllMain spent on DLL_PROCESS_ATTACH
+static char g_executablePath[MAX_PATH] = {}; // Outlives queued log records that reference it
+static std::string g_configPath; // Outlives queued log records that reference it
+
+// Decisions the hooks make on every call. Rebuilt from the config file on every change and swapped in as a whole,
+// so hooks read it lock-free through g_policy.Read() and never see half of a reload.
+struct PolicySnapshot {
+    std::shared_ptr<const ProfileConfig> config;
+    DWORD_PTR affinityMask = ALL_CORES_MASK;
+    ProcessorSet policySet;    // Processors selected by the policy across every group
+    bool spanGroups = false;   // Policy reaches processors a DWORD_PTR mask cannot address
+    ProcessorSet placementSet; // Processors individual threads may be placed on
+    std::shared_ptr<const PlacementCores> placementCores; // Cores threads are placed on, null when they stay put
+    uint32_t bypassedHooks = 0; // Bit per TraceHook whose calls go to Windows unchanged (control "hook" command)
+
+    [[nodiscard]] const ExecutableProfile &Profile() const { return config->profile; }
+    [[nodiscard]] bool Bypassed(TraceHook hook) const { return (bypassedHooks >> static_cast<uint32_t>(hook)) & 1; }
+
+    [[nodiscard]] bool PlacesThreads() const { return placementCores && !placementCores->cores.empty(); }
+
+    // Placement goes through CPU Sets rather than hard masks
+    [[nodiscard]] bool UseCpuSets() const { return spanGroups || Profile().placement == PlacementMode::SoftCpuSets; }
+};
+// Everything the hooks reach is allocated once and never destroyed: static destructors run after DLL_PROCESS_DETACH
+// even when the detours could not be removed, and the heap hooks are never removed at all
+static RcuPointer<PolicySnapshot> &g_policy = *new RcuPointer<PolicySnapshot>;
+
+// Load-time settings (timers, logging, tracing, statistics, thread sampler) keep the values the DLL started with.
+// g_profile's string views point into g_startupConfig.
+static std::shared_ptr<const ProfileConfig> g_startupConfig;
+static ExecutableProfile g_profile = DEFAULT_PROFILE;
+static CpuTopology &g_topology = *new CpuTopology; // Discovered once at attach
+static ConfigWatcher g_configWatcher;
+static ThreadPlacer &g_threadPlacer = *new ThreadPlacer;
+static ThreadSampler g_threadSampler;
+static PriorityRebalancer g_priorityRebalancer;
+static DWORD g_mainThreadId = 0;
+static MonotonicCounter<uint64_t> g_performanceCounter;
+static MonotonicCounter<uint32_t> g_tickCount;
+static MonotonicCounter<uint32_t> g_multimediaTime;
+static bool g_timersHooked = false;
+static TraceWriter &g_traceWriter = *new TraceWriter;
+static HookMask g_attachedHooks = 0; // Bit per HOOK_TABLE entry
+static HookStats &g_hookStats = *new HookStats;
+static PTP_TIMER g_addressSpaceTimer = nullptr; // Refreshes the address space figures in g_hookStats
+static ControlServer g_controlServer;
+// Blocks outlive every static destructor, and the heap hooks stay attached until the process is gone
+static SlabHeap &g_slabHeap = *new SlabHeap;
+static HANDLE g_processHeap = nullptr;             // The only heap whose allocations are routed to g_slabHeap
+static std::atomic<uint64_t> g_slabHeapFallbacks = 0; // Slab-sized requests the slab heap could not serve
+static SpinTuner &g_spinTuner = *new SpinTuner;
+static LockProfiler &g_lockProfiler = *new LockProfiler;
 
 typedef BOOL (WINAPI *PFN_SetProcessAffinityMask)(HANDLE, DWORD_PTR);
 static PFN_SetProcessAffinityMask Real_SetProcessAffinityMask = nullptr;
@@ -26,160 +124,1481 @@ static PFN_SetProcessAffinityMask Real_SetProcessAffinityMask = nullptr;
 typedef BOOL (WINAPI *PFN_FreeLibrary)(HMODULE hModule);
 static PFN_FreeLibrary Real_FreeLibrary = nullptr;
 
+typedef DWORD_PTR (WINAPI *PFN_SetThreadAffinityMask)(HANDLE, DWORD_PTR);
+static PFN_SetThreadAffinityMask Real_SetThreadAffinityMask = nullptr;
+
+typedef DWORD (WINAPI *PFN_SetThreadIdealProcessor)(HANDLE, DWORD);
+static PFN_SetThreadIdealProcessor Real_SetThreadIdealProcessor = nullptr;
+
+typedef BOOL (WINAPI *PFN_SetPriorityClass)(HANDLE, DWORD);
+static PFN_SetPriorityClass Real_SetPriorityClass = nullptr;
+
+typedef BOOL (WINAPI *PFN_SetThreadPriority)(HANDLE, int);
+static PFN_SetThreadPriority Real_SetThreadPriority = nullptr;
+
+typedef BOOL (WINAPI *PFN_QueryPerformanceCounter)(LARGE_INTEGER *);
+static PFN_QueryPerformanceCounter Real_QueryPerformanceCounter = nullptr;
+
+typedef DWORD (WINAPI *PFN_GetTickCount)();
+static PFN_GetTickCount Real_GetTickCount = nullptr;
+
+typedef DWORD (WINAPI *PFN_timeGetTime)();
+static PFN_timeGetTime Real_timeGetTime = nullptr;
+
+typedef HANDLE (WINAPI *PFN_CreateThread)(LPSECURITY_ATTRIBUTES, SIZE_T, LPTHREAD_START_ROUTINE, LPVOID, DWORD, LPDWORD);
+static PFN_CreateThread Real_CreateThread = nullptr;
+
+// HeapAlloc, HeapReAlloc and HeapSize are exported by kernel32 as forwarders to these, and HeapFree, LocalFree and
+// the loader call them directly, so only hooking them here catches every path a process heap block can take
+typedef PVOID (NTAPI *PFN_RtlAllocateHeap)(PVOID, ULONG, SIZE_T);
+static PFN_RtlAllocateHeap Real_RtlAllocateHeap = nullptr;
+
+typedef BOOLEAN (NTAPI *PFN_RtlFreeHeap)(PVOID, ULONG, PVOID);
+static PFN_RtlFreeHeap Real_RtlFreeHeap = nullptr;
+
+typedef PVOID (NTAPI *PFN_RtlReAllocateHeap)(PVOID, ULONG, PVOID, SIZE_T);
+static PFN_RtlReAllocateHeap Real_RtlReAllocateHeap = nullptr;
+
+typedef SIZE_T (NTAPI *PFN_RtlSizeHeap)(PVOID, ULONG, PVOID);
+static PFN_RtlSizeHeap Real_RtlSizeHeap = nullptr;
+
+typedef void *(__cdecl *PFN_malloc)(size_t);
+typedef void (__cdecl *PFN_free)(void *);
+typedef void *(__cdecl *PFN_realloc)(void *, size_t);
+typedef void *(__cdecl *PFN_calloc)(size_t, size_t);
+typedef size_t (__cdecl *PFN_msize)(void *);
+
+typedef void (WINAPI *PFN_InitializeCriticalSection)(LPCRITICAL_SECTION);
+static PFN_InitializeCriticalSection Real_InitializeCriticalSection = nullptr;
+
+typedef BOOL (WINAPI *PFN_InitializeCriticalSectionAndSpinCount)(LPCRITICAL_SECTION, DWORD);
+static PFN_InitializeCriticalSectionAndSpinCount Real_InitializeCriticalSectionAndSpinCount = nullptr;
+
+typedef BOOL (WINAPI *PFN_InitializeCriticalSectionEx)(LPCRITICAL_SECTION, DWORD, DWORD);
+static PFN_InitializeCriticalSectionEx Real_InitializeCriticalSectionEx = nullptr;
+
+typedef void (WINAPI *PFN_EnterCriticalSection)(LPCRITICAL_SECTION);
+static PFN_EnterCriticalSection Real_EnterCriticalSection = nullptr;
+
+typedef DWORD (WINAPI *PFN_WaitForSingleObject)(HANDLE, DWORD);
+static PFN_WaitForSingleObject Real_WaitForSingleObject = nullptr;
+
+typedef int (WINAPI *PFN_EntryPoint)();
+static PFN_EntryPoint Real_EntryPoint = nullptr;
+
+// Shard key for the live statistics: the processor the hook runs on, so concurrent hooks never share a cache line
+uint32_t StatsShard() {
+    PROCESSOR_NUMBER processor = {};
+    GetCurrentProcessorNumberEx(&processor);
+    return processor.Group * PROCESSORS_PER_GROUP + processor.Number;
+}
+
+// Before the hook table is resolved (DllMain)
+uint64_t ReadRawPerformanceCounter() {
+    LARGE_INTEGER now = {};
+    QueryPerformanceCounter(&now);
+    return static_cast<uint64_t>(now.QuadPart);
+}
+
+uint64_t ReadPerformanceCounter() {
+    LARGE_INTEGER now = {};
+    Real_QueryPerformanceCounter(&now);
+    return static_cast<uint64_t>(now.QuadPart);
+}
+
+// Accounts for one intercepted call: live statistics (call, rewrite, failure, time spent in the real function) and,
+// when tracing, a record stamped when the hook was entered. Hooks return through Return() so every path is counted;
+// rewritten arguments default to the original ones. Nothing here touches the caller's last-error value.
+class HookCall {
+public:
+    explicit HookCall(TraceHook hook, uint64_t original0 = 0, uint64_t original1 = 0) {
+        m_record.hook = hook;
+        m_record.original = {original0, original1};
+        m_record.rewritten = m_record.original;
+        m_traced = g_traceWriter.Active();
+        if (m_traced) {
+            m_record.timestamp = ReadPerformanceCounter();
+            m_record.threadId = GetCurrentThreadId();
+        }
+    }
+
+    // Thread the call acts on
+    void Target(DWORD threadId) { m_record.targetThreadId = threadId; }
+
+    void Rewritten(uint64_t rewritten0, uint64_t rewritten1 = 0) { m_record.rewritten = {rewritten0, rewritten1}; }
+
+    // Calls the real function (or the placement helper standing in for it), timing it when statistics are on
+    template <typename Fn, typename... Args>
+    auto Real(Fn &&fn, Args &&...args) {
+        if (!g_hookStats.Active()) {
+            return fn(std::forward<Args>(args)...);
+        }
+        const uint64_t start = ReadPerformanceCounter();
+        auto result = fn(std::forward<Args>(args)...);
+        g_hookStats.RecordLatency(StatsShard(), m_record.hook, ReadPerformanceCounter() - start);
+        return result;
+    }
+
+    // A zero (FALSE, 0 mask, null handle) result counts as a failure
+    template <typename T>
+    T Return(T result) {
+        return Return(result, result == T{});
+    }
+
+    template <typename T>
+    T Return(T result, bool failed) {
+        if constexpr (std::is_pointer_v<T>) {
+            m_record.result = reinterpret_cast<uintptr_t>(result);
+        } else {
+            m_record.result = static_cast<uint64_t>(result);
+        }
+        Finish(failed);
+        return result;
+    }
+
+    void Finish(bool failed) {
+        g_hookStats.RecordCall(StatsShard(), m_record.hook, m_record.rewritten != m_record.original, failed);
+        if (m_traced) {
+            g_traceWriter.Append(m_record);
+        }
+    }
+
+private:
+    TraceRecord m_record;
+    bool m_traced = false;
+};
+
+// Timer hooks count every reading but only trace the ones the monotonic clamp changed
+void CountTimerReading(TraceHook hook, uint64_t raw, uint64_t returned) {
+    g_hookStats.RecordCall(StatsShard(), hook, raw != returned, false);
+    if (raw != returned && g_traceWriter.Active()) {
+        TraceRecord record;
+        record.timestamp = ReadPerformanceCounter();
+        record.threadId = GetCurrentThreadId();
+        record.hook = hook;
+        record.original = {raw, 0};
+        record.rewritten = {returned, 0};
+        g_traceWriter.Append(record);
+    }
+}
+
 BOOL WINAPI Hooked_SetProcessAffinityMask(HANDLE hProcess, DWORD_PTR dwProcessAffinityMask) {
+    HookCall call(TraceHook::SetProcessAffinityMask, dwProcessAffinityMask);
+    const auto policy = g_policy.Read();
+    if (policy->Bypassed(TraceHook::SetProcessAffinityMask)) {
+        return call.Return(call.Real(Real_SetProcessAffinityMask, hProcess, dwProcessAffinityMask));
+    }
     if (hProcess == nullptr || hProcess == INVALID_HANDLE_VALUE) {
-        OutputDebugStringA("[AffinityHook] Invalid hProcess handle detected");
+        LOG_ERROR("Invalid hProcess handle detected");
         SetLastError(ERROR_INVALID_HANDLE);
-        return FALSE;
+        return call.Return(FALSE);
     }
 
     // Preserve caller's error state
     DWORD lastError = GetLastError();
 
     // Log the interception with original mask
-    std::string logMsg = std::format(
-        "[AffinityHook] Intercepted SetProcessAffinityMask call - Original mask: 0x{:X}",
+    LOG_TRACE(
+        "Intercepted SetProcessAffinityMask call - Original mask: 0x{:X}",
         dwProcessAffinityMask
     );
-    OutputDebugStringA(logMsg.c_str());
 
-    // Override the affinity mask to use all cores
-    logMsg = std::format(
-        "[AffinityHook] Modifying mask to: 0x{:X} (all cores)",
-        ALL_CORES_MASK
+    // Override the affinity mask with the one computed from the affinity policy
+    LOG_DEBUG(
+        "Modifying mask to: 0x{:X} ({})",
+        policy->affinityMask, AffinityPolicyName(policy->Profile().policy)
     );
-    OutputDebugStringA(logMsg.c_str());
+
+    // Soft placement leaves the hard mask alone so the scheduler can still balance around busy cores. When the
+    // policy spans groups (or processors a WOW64 mask cannot express), a hard mask would also confine the process
+    // to part of group 0. Default CPU Sets steer it over every group instead; hard masks are the fallback.
+    if (policy->UseCpuSets()) {
+        if (call.Real(SetProcessCpuSets, hProcess, g_topology, policy->policySet)) {
+            SetLastError(lastError);
+            call.Rewritten(0); // The hard mask is left alone
+            return call.Return(TRUE);
+        }
+        LOG_ERROR(
+            "SetProcessDefaultCpuSets failed with error: 0x{:X}, falling back to the hard mask",
+            GetLastError()
+        );
+    }
 
     // Restore error state before calling original function
     SetLastError(lastError);
 
     // Call the original function with modified mask
-    return Real_SetProcessAffinityMask(hProcess, ALL_CORES_MASK);
+    call.Rewritten(policy->affinityMask);
+    return call.Return(call.Real(Real_SetProcessAffinityMask, hProcess, policy->affinityMask));
+}
+
+// Steers the thread with CPU Sets and leaves its hard affinity untouched.
+// Returns the process mask in place of the thread's previous affinity mask, or 0 on failure.
+DWORD_PTR PlaceThreadWithCpuSets(HANDLE hThread, const ProcessorSet &processors) {
+    if (!SetThreadCpuSets(hThread, g_topology, processors)) {
+        return 0;
+    }
+    DWORD_PTR processMask = 0;
+    DWORD_PTR systemMask = 0;
+    if (GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask)) {
+        return processMask;
+    }
+    return g_policy.Read()->affinityMask;
+}
+
+// Applies a placement that may lie outside the primary group or beyond the reach of a DWORD_PTR mask.
+// Returns the thread's previous affinity mask like SetThreadAffinityMask does, or 0 on failure.
+DWORD_PTR PlaceThreadAcrossGroups(HANDLE hThread, const ThreadPlacement &placement) {
+    if (IsMaskAddressable(placement.processors)) {
+        GROUP_AFFINITY previous;
+        return SetThreadPlacementAffinity(hThread, placement, previous) ? static_cast<DWORD_PTR>(previous.Mask) : 0;
+    }
+
+    // WOW64 processes cannot express processors 32-63 in a mask, CPU Sets are addressed by id instead
+    return PlaceThreadWithCpuSets(hThread, placement.processors);
+}
+
+DWORD_PTR WINAPI Hooked_SetThreadAffinityMask(HANDLE hThread, DWORD_PTR dwThreadAffinityMask) {
+    // Preserve caller's error state
+    DWORD lastError = GetLastError();
+
+    const DWORD threadId = GetThreadId(hThread);
+    HookCall call(TraceHook::SetThreadAffinityMask, dwThreadAffinityMask);
+    call.Target(threadId);
+    const auto policy = g_policy.Read();
+    const DWORD_PTR affinityMask = policy->affinityMask;
+    if (threadId == 0 || !policy->PlacesThreads() || policy->Bypassed(TraceHook::SetThreadAffinityMask)) {
+        SetLastError(lastError);
+        return call.Return(call.Real(Real_SetThreadAffinityMask, hThread, dwThreadAffinityMask));
+    }
+
+    // Anything at least as wide as the process policy is clamped to the policy mask
+    if ((dwThreadAffinityMask & affinityMask) == affinityMask) {
+        if (dwThreadAffinityMask != affinityMask) {
+            g_threadPlacer.RecordRewrite({threadId, PlacementApi::SetThreadAffinityMask, dwThreadAffinityMask, affinityMask});
+        }
+        call.Rewritten(affinityMask);
+        SetLastError(lastError);
+        if (policy->Profile().placement == PlacementMode::SoftCpuSets) {
+            return call.Return(call.Real(PlaceThreadWithCpuSets, hThread, policy->policySet));
+        }
+        return call.Return(call.Real(Real_SetThreadAffinityMask, hThread, affinityMask));
+    }
+
+    // A narrower mask is a legacy pin: give the thread its own physical core
+    const ThreadPlacement &placement = g_threadPlacer.Place(threadId, policy->placementCores);
+    const uint16_t group = static_cast<uint16_t>(placement.idealProcessor / PROCESSORS_PER_GROUP);
+    const uint64_t mask = placement.processors.GroupMask(group);
+    g_threadPlacer.RecordRewrite({threadId, PlacementApi::SetThreadAffinityMask, dwThreadAffinityMask, mask, group});
+
+    LOG_DEBUG(
+        "SetThreadAffinityMask(thread {}) - Original mask: 0x{:X}, placed on: group {} mask 0x{:X}",
+        threadId, dwThreadAffinityMask, group, mask
+    );
+
+    // Restore error state before calling original function
+    call.Rewritten(mask, group);
+    SetLastError(lastError);
+    if (policy->Profile().placement == PlacementMode::SoftCpuSets) {
+        return call.Return(call.Real(PlaceThreadWithCpuSets, hThread, placement.processors));
+    }
+    if (policy->spanGroups) {
+        return call.Return(call.Real(PlaceThreadAcrossGroups, hThread, placement));
+    }
+    return call.Return(call.Real(Real_SetThreadAffinityMask, hThread, static_cast<DWORD_PTR>(mask)));
+}
+
+DWORD WINAPI Hooked_SetThreadIdealProcessor(HANDLE hThread, DWORD dwIdealProcessor) {
+    // Preserve caller's error state
+    DWORD lastError = GetLastError();
+
+    // MAXIMUM_PROCESSORS only queries the current ideal processor
+    const DWORD threadId = GetThreadId(hThread);
+    HookCall call(TraceHook::SetThreadIdealProcessor, dwIdealProcessor);
+    call.Target(threadId);
+    const auto policy = g_policy.Read();
+    if (dwIdealProcessor == MAXIMUM_PROCESSORS || threadId == 0 || !policy->PlacesThreads() ||
+        policy->Bypassed(TraceHook::SetThreadIdealProcessor)) {
+        SetLastError(lastError);
+        const DWORD previous = call.Real(Real_SetThreadIdealProcessor, hThread, dwIdealProcessor);
+        return call.Return(previous, previous == static_cast<DWORD>(-1));
+    }
+
+    const ThreadPlacement &placement = g_threadPlacer.Place(threadId, policy->placementCores);
+    const uint16_t group = static_cast<uint16_t>(placement.idealProcessor / PROCESSORS_PER_GROUP);
+    const DWORD idealProcessor = placement.idealProcessor % PROCESSORS_PER_GROUP;
+    if (idealProcessor != dwIdealProcessor || group != 0) {
+        g_threadPlacer.RecordRewrite({threadId, PlacementApi::SetThreadIdealProcessor, dwIdealProcessor, idealProcessor, group});
+
+        LOG_DEBUG(
+            "SetThreadIdealProcessor(thread {}) - Original processor: {}, placed on: group {} processor {}",
+            threadId, dwIdealProcessor, group, idealProcessor
+        );
+    }
+
+    // Restore error state before calling original function
+    call.Rewritten(idealProcessor, group);
+    SetLastError(lastError);
+    if (policy->spanGroups) {
+        PROCESSOR_NUMBER ideal = {group, static_cast<BYTE>(idealProcessor), 0};
+        PROCESSOR_NUMBER previous = {};
+        if (!call.Real(SetThreadIdealProcessorEx, hThread, &ideal, &previous)) {
+            return call.Return(static_cast<DWORD>(-1), true);
+        }
+        return call.Return(DWORD{previous.Number}, false);
+    }
+    const DWORD previous = call.Real(Real_SetThreadIdealProcessor, hThread, idealProcessor);
+    return call.Return(previous, previous == static_cast<DWORD>(-1));
+}
+
+BOOL WINAPI Hooked_SetPriorityClass(HANDLE hProcess, DWORD dwPriorityClass) {
+    // Preserve caller's error state
+    DWORD lastError = GetLastError();
+
+    // Only the target's own priority is rebalanced; child processes keep what they are given
+    const auto policy = g_policy.Read();
+    DWORD priorityClass = dwPriorityClass;
+    if (GetProcessId(hProcess) == GetCurrentProcessId() && !policy->Bypassed(TraceHook::SetPriorityClass)) {
+        priorityClass = g_priorityRebalancer.RemapPriorityClass(policy->Profile().priority, dwPriorityClass);
+    }
+
+    if (priorityClass != dwPriorityClass) {
+        LOG_DEBUG(
+            "SetPriorityClass - Original class: 0x{:X}, clamped to: 0x{:X}",
+            dwPriorityClass, priorityClass
+        );
+    }
+
+    HookCall call(TraceHook::SetPriorityClass, dwPriorityClass);
+    call.Rewritten(priorityClass);
+
+    // Restore error state before calling original function
+    SetLastError(lastError);
+    return call.Return(call.Real(Real_SetPriorityClass, hProcess, priorityClass));
+}
+
+BOOL WINAPI Hooked_SetThreadPriority(HANDLE hThread, int nPriority) {
+    // Preserve caller's error state
+    DWORD lastError = GetLastError();
+
+    const auto policy = g_policy.Read();
+    int priority = nPriority;
+    if (GetProcessIdOfThread(hThread) == GetCurrentProcessId() && !policy->Bypassed(TraceHook::SetThreadPriority)) {
+        const ThreadRole role = GetThreadId(hThread) == g_mainThreadId ? ThreadRole::Main : ThreadRole::Worker;
+        priority = g_priorityRebalancer.RemapThreadPriority(policy->Profile().priority, role, nPriority);
+    }
+
+    if (priority != nPriority) {
+        LOG_DEBUG(
+            "SetThreadPriority(thread {}) - Original priority: {}, clamped to: {}",
+            GetThreadId(hThread), nPriority, priority
+        );
+    }
+
+    HookCall call(TraceHook::SetThreadPriority, static_cast<uint64_t>(nPriority));
+    call.Target(GetThreadId(hThread));
+    call.Rewritten(static_cast<uint64_t>(priority));
+
+    // Restore error state before calling original function
+    SetLastError(lastError);
+    return call.Return(call.Real(Real_SetThreadPriority, hThread, priority));
+}
+
+// Timer hooks run on every frame and must stay cheap: no logging, no locks. QueryPerformanceCounter already reads
+// the TSC in user mode on invariant-TSC machines, so the real call stays the time source (and stays consistent with
+// QueryPerformanceFrequency); the hooks only add the monotonic clamp.
+BOOL WINAPI Hooked_QueryPerformanceCounter(LARGE_INTEGER *lpPerformanceCount) {
+    if (!Real_QueryPerformanceCounter(lpPerformanceCount)) {
+        return FALSE;
+    }
+    const uint64_t raw = static_cast<uint64_t>(lpPerformanceCount->QuadPart);
+    const uint64_t counter = g_performanceCounter.Advance(raw);
+    CountTimerReading(TraceHook::QueryPerformanceCounter, raw, counter);
+    lpPerformanceCount->QuadPart = static_cast<LONGLONG>(counter);
+    return TRUE;
+}
+
+DWORD WINAPI Hooked_GetTickCount() {
+    const DWORD raw = Real_GetTickCount();
+    const DWORD ticks = g_tickCount.Advance(raw);
+    CountTimerReading(TraceHook::GetTickCount, raw, ticks);
+    return ticks;
+}
+
+DWORD WINAPI Hooked_timeGetTime() {
+    const DWORD raw = Real_timeGetTime();
+    const DWORD time = g_multimediaTime.Advance(raw);
+    CountTimerReading(TraceHook::timeGetTime, raw, time);
+    return time;
 }
 
 BOOL WINAPI Hooked_FreeLibrary(HMODULE hModule) {
-    OutputDebugStringA("[AffinityHook] Intercepted FreeLibrary call");
+    LOG_TRACE("Intercepted FreeLibrary call");
+    HookCall call(TraceHook::FreeLibrary, reinterpret_cast<uintptr_t>(hModule));
     if (g_hModule != nullptr && g_hModule == hModule) {
-        OutputDebugStringA("[AffinityHook] Preventing unload of my module");
+        LOG_DEBUG("Preventing unload of my module");
+        call.Rewritten(reinterpret_cast<uintptr_t>(hModule), 1);
         SetLastError(ERROR_SUCCESS);
-        return TRUE; // pretend success, but do not unload
+        return call.Return(TRUE); // pretend success, but do not unload
     }
-    return Real_FreeLibrary(hModule);
+    return call.Return(call.Real(Real_FreeLibrary, hModule));
 }
 
-[[nodiscard]] bool LoadFunctionReferences() {
-    OutputDebugStringA("[AffinityHook] Loading references to original functions...");
+HANDLE WINAPI Hooked_CreateThread(LPSECURITY_ATTRIBUTES lpThreadAttributes, SIZE_T dwStackSize,
+                                  LPTHREAD_START_ROUTINE lpStartAddress, LPVOID lpParameter, DWORD dwCreationFlags,
+                                  LPDWORD lpThreadId) {
+    // Stamped before the thread exists, so its creation precedes anything the new thread does
+    HookCall call(TraceHook::CreateThread, reinterpret_cast<uintptr_t>(lpStartAddress),
+                  reinterpret_cast<uintptr_t>(lpParameter));
+    DWORD threadId = 0;
+    HANDLE hThread = call.Real(Real_CreateThread, lpThreadAttributes, dwStackSize, lpStartAddress, lpParameter,
+                               dwCreationFlags, &threadId);
+    if (lpThreadId) {
+        *lpThreadId = threadId;
+    }
+    call.Return(threadId);
+    return hThread;
+}
 
-    HMODULE hKernel32 = GetModuleHandleA("kernel32.dll");
-    if (!hKernel32) {
-        OutputDebugStringA("[AffinityHook] GetModuleHandleA(kernel32) failed");
-        return false;
+// The heap hooks are not traced or counted per call: they run far more often than any other hook, and the slab heap's
+// fast path takes no lock, so an atomic counter would be the most expensive part of it
+
+void *AllocateFromSlabHeap(size_t size) {
+    if (size > SlabHeap::MAX_BLOCK_SIZE) {
+        return nullptr;
+    }
+    void *block = g_slabHeap.Allocate(size);
+    if (!block) {
+        g_slabHeapFallbacks.fetch_add(1, std::memory_order_relaxed);
     }
+    return block;
+}
 
-    Real_SetProcessAffinityMask = reinterpret_cast<PFN_SetProcessAffinityMask>(GetProcAddress(hKernel32, "SetProcessAffinityMask"));
-    if (!Real_SetProcessAffinityMask) {
-        OutputDebugStringA("[AffinityHook] GetProcAddress(SetProcessAffinityMask) failed");
-        return false;
+// Moves an owned block to the original heap once it grows past what the slab heap serves
+void *MoveFromSlabHeap(void *block, size_t size, void *(*allocate)(size_t)) {
+    void *moved = allocate(size);
+    if (moved) {
+        std::memcpy(moved, block, std::min(g_slabHeap.Size(block), size));
+        g_slabHeap.Free(block);
     }
+    return moved;
+}
 
-    Real_FreeLibrary = reinterpret_cast<PFN_FreeLibrary>(GetProcAddress(hKernel32, "FreeLibrary"));
-    if (!Real_FreeLibrary) {
-        OutputDebugStringA("[AffinityHook] GetProcAddress(FreeLibrary) failed");
-        return false;
+// Flags the slab heap honors. Others make ntdll keep data of its own with the block (HEAP_SETTABLE_USER_VALUE for
+// moveable GlobalAlloc/LocalAlloc memory, read back by GlobalHandle, GlobalFlags and GlobalReAlloc through
+// RtlGetUserInfoHeap), so such requests stay with the real heap.
+constexpr ULONG SLAB_HEAP_FLAGS = HEAP_ZERO_MEMORY | HEAP_NO_SERIALIZE;
+
+PVOID NTAPI Hooked_RtlAllocateHeap(PVOID hHeap, ULONG dwFlags, SIZE_T dwBytes) {
+    if (hHeap == g_processHeap && (dwFlags & ~SLAB_HEAP_FLAGS) == 0) {
+        if (void *block = AllocateFromSlabHeap(dwBytes)) {
+            if (dwFlags & HEAP_ZERO_MEMORY) {
+                std::memset(block, 0, dwBytes);
+            }
+            return block;
+        }
+    }
+    return Real_RtlAllocateHeap(hHeap, dwFlags, dwBytes);
+}
+
+// Owned blocks are recognized by address, whatever heap handle the caller passes
+BOOLEAN NTAPI Hooked_RtlFreeHeap(PVOID hHeap, ULONG dwFlags, PVOID lpMem) {
+    if (g_slabHeap.Owns(lpMem)) {
+        g_slabHeap.Free(lpMem);
+        return TRUE;
+    }
+    return Real_RtlFreeHeap(hHeap, dwFlags, lpMem);
+}
+
+PVOID NTAPI Hooked_RtlReAllocateHeap(PVOID hHeap, ULONG dwFlags, PVOID lpMem, SIZE_T dwBytes) {
+    if (!g_slabHeap.Owns(lpMem)) {
+        return Real_RtlReAllocateHeap(hHeap, dwFlags, lpMem, dwBytes);
+    }
+    // A slab block never moves in place-only mode, and with flags the slab heap does not honor it moves to the real
+    // heap, which does
+    const size_t oldSize = g_slabHeap.Size(lpMem);
+    const bool slabFlags = (dwFlags & ~(SLAB_HEAP_FLAGS | HEAP_REALLOC_IN_PLACE_ONLY)) == 0;
+    void *block = nullptr;
+    if (dwFlags & HEAP_REALLOC_IN_PLACE_ONLY) {
+        block = slabFlags && g_slabHeap.Resize(lpMem, dwBytes) ? lpMem : nullptr;
+    } else {
+        block = slabFlags ? g_slabHeap.Reallocate(lpMem, dwBytes) : nullptr;
+        if (!block) {
+            const ULONG flags = dwFlags & ~HEAP_ZERO_MEMORY;
+            block = Real_RtlAllocateHeap(g_processHeap, flags, dwBytes);
+            if (block) {
+                std::memcpy(block, lpMem, std::min(oldSize, dwBytes));
+                g_slabHeap.Free(lpMem);
+            }
+        }
+    }
+    if (block && (dwFlags & HEAP_ZERO_MEMORY) && dwBytes > oldSize) {
+        std::memset(static_cast<std::byte *>(block) + oldSize, 0, dwBytes - oldSize);
+    }
+    return block;
+}
+
+SIZE_T NTAPI Hooked_RtlSizeHeap(PVOID hHeap, ULONG dwFlags, PVOID lpMem) {
+    if (g_slabHeap.Owns(lpMem)) {
+        return g_slabHeap.Size(lpMem);
+    }
+    return Real_RtlSizeHeap(hHeap, dwFlags, lpMem);
+}
+
+// The malloc family of one dynamically linked C runtime. Its heap is not necessarily the process heap, so it is
+// routed separately; each runtime gets its own Real_ pointers to fall back to.
+template <size_t Runtime>
+struct CrtHeapHooks {
+    static inline PFN_malloc Real_malloc = nullptr;
+    static inline PFN_free Real_free = nullptr;
+    static inline PFN_realloc Real_realloc = nullptr;
+    static inline PFN_calloc Real_calloc = nullptr;
+    static inline PFN_msize Real_msize = nullptr;
+
+    static void *__cdecl Hooked_malloc(size_t size) {
+        void *block = AllocateFromSlabHeap(size);
+        return block ? block : Real_malloc(size);
+    }
+
+    static void __cdecl Hooked_free(void *block) {
+        if (g_slabHeap.Owns(block)) {
+            g_slabHeap.Free(block);
+            return;
+        }
+        Real_free(block);
+    }
+
+    // realloc(block, 0) frees the block and returns null, as the runtimes of the era do
+    static void *__cdecl Hooked_realloc(void *block, size_t size) {
+        if (!g_slabHeap.Owns(block)) {
+            return block ? Real_realloc(block, size) : Hooked_malloc(size);
+        }
+        if (size == 0) {
+            g_slabHeap.Free(block);
+            return nullptr;
+        }
+        void *moved = g_slabHeap.Reallocate(block, size);
+        return moved ? moved : MoveFromSlabHeap(block, size, Real_malloc);
+    }
+
+    static void *__cdecl Hooked_calloc(size_t count, size_t size) {
+        if (count != 0 && size > SIZE_MAX / count) {
+            return Real_calloc(count, size); // Sets errno as the runtime does
+        }
+        void *block = AllocateFromSlabHeap(count * size);
+        if (!block) {
+            return Real_calloc(count, size);
+        }
+        std::memset(block, 0, count * size);
+        return block;
+    }
+
+    static size_t __cdecl Hooked_msize(void *block) {
+        return g_slabHeap.Owns(block) ? g_slabHeap.Size(block) : Real_msize(block);
+    }
+};
+
+// The runtimes the games link against: VC6 and the system's, VC7 and VC7.1
+using MsvcrtHeapHooks = CrtHeapHooks<0>;
+using Msvcr70HeapHooks = CrtHeapHooks<1>;
+using Msvcr71HeapHooks = CrtHeapHooks<2>;
+
+// The spin count lives in the low 24 bits; the bits above are flags (RTL_CRITICAL_SECTION_FLAG_*) that pass through
+constexpr DWORD SPIN_COUNT_MASK = 0x00FFFFFF;
+
+DWORD TunedSpinCount(LPCRITICAL_SECTION lpCriticalSection, DWORD dwSpinCount) {
+    return (dwSpinCount & ~SPIN_COUNT_MASK) | g_spinTuner.Initialize(lpCriticalSection, dwSpinCount & SPIN_COUNT_MASK);
+}
+
+void WINAPI Hooked_InitializeCriticalSection(LPCRITICAL_SECTION lpCriticalSection) {
+    // Cannot fail since Windows Vista
+    Real_InitializeCriticalSectionAndSpinCount(lpCriticalSection, TunedSpinCount(lpCriticalSection, 0));
+}
+
+BOOL WINAPI Hooked_InitializeCriticalSectionAndSpinCount(LPCRITICAL_SECTION lpCriticalSection, DWORD dwSpinCount) {
+    return Real_InitializeCriticalSectionAndSpinCount(lpCriticalSection,
+                                                      TunedSpinCount(lpCriticalSection, dwSpinCount));
+}
+
+BOOL WINAPI Hooked_InitializeCriticalSectionEx(LPCRITICAL_SECTION lpCriticalSection, DWORD dwSpinCount,
+                                               DWORD Flags) {
+    return Real_InitializeCriticalSectionEx(lpCriticalSection, TunedSpinCount(lpCriticalSection, dwSpinCount), Flags);
+}
+
+// An uncontended enter costs one extra try. Only a contended enter is timed, and the kernel wait it ends in dwarfs
+// the two counter reads; the spin count is applied while the lock is held, which SetCriticalSectionSpinCount allows.
+// Serves spin tuning and lock profiling, whichever are on.
+void WINAPI Hooked_EnterCriticalSection(LPCRITICAL_SECTION lpCriticalSection) {
+    if (TryEnterCriticalSection(lpCriticalSection)) {
+        if (g_lockProfiler.Active()) {
+            g_lockProfiler.RecordAcquire(LockKind::CriticalSection, lpCriticalSection);
+        }
+        return;
+    }
+    const uint64_t start = ReadPerformanceCounter();
+    Real_EnterCriticalSection(lpCriticalSection);
+    const uint64_t waited = ReadPerformanceCounter() - start;
+    if (g_lockProfiler.Active()) {
+        g_lockProfiler.RecordWait(LockKind::CriticalSection, lpCriticalSection,
+                                  reinterpret_cast<uintptr_t>(_ReturnAddress()), waited, true);
+    }
+    if (!g_spinTuner.Active()) {
+        return;
+    }
+    if (const std::optional<uint32_t> spinCount = g_spinTuner.RecordContended(lpCriticalSection, waited)) {
+        SetCriticalSectionSpinCount(lpCriticalSection, *spinCount);
+    }
+}
+
+// A zero-timeout try first takes the object exactly as the wait would have, so a wait that would not have blocked is
+// counted as an uncontended acquire; anything else is timed. Waits with a zero timeout (polls) are only counted when
+// they get the object, and failed waits (a closed handle) not at all.
+DWORD WINAPI Hooked_WaitForSingleObject(HANDLE hHandle, DWORD dwMilliseconds) {
+    const DWORD tried = Real_WaitForSingleObject(hHandle, 0);
+    if (tried == WAIT_OBJECT_0 || tried == WAIT_ABANDONED) {
+        g_lockProfiler.RecordAcquire(LockKind::WaitObject, hHandle);
+        return tried;
+    }
+    if (tried != WAIT_TIMEOUT || dwMilliseconds == 0) {
+        return tried;
+    }
+    const uint64_t start = ReadPerformanceCounter();
+    const DWORD result = Real_WaitForSingleObject(hHandle, dwMilliseconds);
+    const uint64_t waited = ReadPerformanceCounter() - start;
+    if (result != WAIT_FAILED) {
+        g_lockProfiler.RecordWait(LockKind::WaitObject, hHandle, reinterpret_cast<uintptr_t>(_ReturnAddress()), waited,
+                                  result != WAIT_TIMEOUT);
+    }
+    return result;
+}
+
+// Every detoured function. Entries are resolved at attach, so Real_ pointers are valid even for hooks that end up
+// not attached (ReadPerformanceCounter relies on that).
+constexpr HookEntry HOOK_TABLE[] = {
+    MakeHook<Real_SetProcessAffinityMask, Hooked_SetProcessAffinityMask>("kernel32.dll", "SetProcessAffinityMask"),
+    MakeHook<Real_FreeLibrary, Hooked_FreeLibrary>("kernel32.dll", "FreeLibrary"),
+    MakeHook<Real_SetThreadAffinityMask, Hooked_SetThreadAffinityMask>("kernel32.dll", "SetThreadAffinityMask"),
+    MakeHook<Real_SetThreadIdealProcessor, Hooked_SetThreadIdealProcessor>("kernel32.dll", "SetThreadIdealProcessor"),
+    MakeHook<Real_SetPriorityClass, Hooked_SetPriorityClass>("kernel32.dll", "SetPriorityClass"),
+    MakeHook<Real_SetThreadPriority, Hooked_SetThreadPriority>("kernel32.dll", "SetThreadPriority"),
+    MakeHook<Real_QueryPerformanceCounter, Hooked_QueryPerformanceCounter>(
+        "kernel32.dll", "QueryPerformanceCounter", HookScope::MonotonicTimers),
+    MakeHook<Real_GetTickCount, Hooked_GetTickCount>("kernel32.dll", "GetTickCount", HookScope::MonotonicTimers),
+    // winmm is only hooked when the target already imports it; loading it from DllMain is not safe
+    MakeHook<Real_timeGetTime, Hooked_timeGetTime>("winmm.dll", "timeGetTime", HookScope::MonotonicTimers, true),
+    MakeHook<Real_CreateThread, Hooked_CreateThread>("kernel32.dll", "CreateThread", HookScope::Tracing),
+    MakeHook<Real_InitializeCriticalSection, Hooked_InitializeCriticalSection>(
+        "kernel32.dll", "InitializeCriticalSection", HookScope::SpinTuning),
+    MakeHook<Real_InitializeCriticalSectionAndSpinCount, Hooked_InitializeCriticalSectionAndSpinCount>(
+        "kernel32.dll", "InitializeCriticalSectionAndSpinCount", HookScope::SpinTuning),
+    MakeHook<Real_InitializeCriticalSectionEx, Hooked_InitializeCriticalSectionEx>(
+        "kernel32.dll", "InitializeCriticalSectionEx", HookScope::SpinTuning),
+    MakeHook<Real_EnterCriticalSection, Hooked_EnterCriticalSection>(
+        "kernel32.dll", "EnterCriticalSection", HookScope::CriticalSectionEnter),
+    MakeHook<Real_WaitForSingleObject, Hooked_WaitForSingleObject>(
+        "kernel32.dll", "WaitForSingleObject", HookScope::LockProfiling),
+    MakeHook<Real_RtlAllocateHeap, Hooked_RtlAllocateHeap>("ntdll.dll", "RtlAllocateHeap", HookScope::ReplacementHeap),
+    MakeHook<Real_RtlFreeHeap, Hooked_RtlFreeHeap>("ntdll.dll", "RtlFreeHeap", HookScope::ReplacementHeap),
+    MakeHook<Real_RtlReAllocateHeap, Hooked_RtlReAllocateHeap>(
+        "ntdll.dll", "RtlReAllocateHeap", HookScope::ReplacementHeap),
+    MakeHook<Real_RtlSizeHeap, Hooked_RtlSizeHeap>("ntdll.dll", "RtlSizeHeap", HookScope::ReplacementHeap),
+    // Runtimes are only hooked when the target already loaded them
+    MakeHook<MsvcrtHeapHooks::Real_malloc, MsvcrtHeapHooks::Hooked_malloc>(
+        "msvcrt.dll", "malloc", HookScope::ReplacementHeap, true),
+    MakeHook<MsvcrtHeapHooks::Real_free, MsvcrtHeapHooks::Hooked_free>(
+        "msvcrt.dll", "free", HookScope::ReplacementHeap, true),
+    MakeHook<MsvcrtHeapHooks::Real_realloc, MsvcrtHeapHooks::Hooked_realloc>(
+        "msvcrt.dll", "realloc", HookScope::ReplacementHeap, true),
+    MakeHook<MsvcrtHeapHooks::Real_calloc, MsvcrtHeapHooks::Hooked_calloc>(
+        "msvcrt.dll", "calloc", HookScope::ReplacementHeap, true),
+    MakeHook<MsvcrtHeapHooks::Real_msize, MsvcrtHeapHooks::Hooked_msize>(
+        "msvcrt.dll", "_msize", HookScope::ReplacementHeap, true),
+    MakeHook<Msvcr70HeapHooks::Real_malloc, Msvcr70HeapHooks::Hooked_malloc>(
+        "msvcr70.dll", "malloc", HookScope::ReplacementHeap, true),
+    MakeHook<Msvcr70HeapHooks::Real_free, Msvcr70HeapHooks::Hooked_free>(
+        "msvcr70.dll", "free", HookScope::ReplacementHeap, true),
+    MakeHook<Msvcr70HeapHooks::Real_realloc, Msvcr70HeapHooks::Hooked_realloc>(
+        "msvcr70.dll", "realloc", HookScope::ReplacementHeap, true),
+    MakeHook<Msvcr70HeapHooks::Real_calloc, Msvcr70HeapHooks::Hooked_calloc>(
+        "msvcr70.dll", "calloc", HookScope::ReplacementHeap, true),
+    MakeHook<Msvcr70HeapHooks::Real_msize, Msvcr70HeapHooks::Hooked_msize>(
+        "msvcr70.dll", "_msize", HookScope::ReplacementHeap, true),
+    MakeHook<Msvcr71HeapHooks::Real_malloc, Msvcr71HeapHooks::Hooked_malloc>(
+        "msvcr71.dll", "malloc", HookScope::ReplacementHeap, true),
+    MakeHook<Msvcr71HeapHooks::Real_free, Msvcr71HeapHooks::Hooked_free>(
+        "msvcr71.dll", "free", HookScope::ReplacementHeap, true),
+    MakeHook<Msvcr71HeapHooks::Real_realloc, Msvcr71HeapHooks::Hooked_realloc>(
+        "msvcr71.dll", "realloc", HookScope::ReplacementHeap, true),
+    MakeHook<Msvcr71HeapHooks::Real_calloc, Msvcr71HeapHooks::Hooked_calloc>(
+        "msvcr71.dll", "calloc", HookScope::ReplacementHeap, true),
+    MakeHook<Msvcr71HeapHooks::Real_msize, Msvcr71HeapHooks::Hooked_msize>(
+        "msvcr71.dll", "_msize", HookScope::ReplacementHeap, true),
+};
+static_assert(std::size(HOOK_TABLE) <= MAX_HOOKS);
+
+// Starts every clamp at the current reading so the first hooked call cannot be clamped against zero
+void SeedMonotonicTimers() {
+    LARGE_INTEGER counter = {};
+    if (Real_QueryPerformanceCounter(&counter)) {
+        g_performanceCounter.Seed(static_cast<uint64_t>(counter.QuadPart));
+    }
+    g_tickCount.Seed(Real_GetTickCount());
+    if (Real_timeGetTime) {
+        g_multimediaTime.Seed(Real_timeGetTime());
+    }
+}
+
+// Applies the config file over the executable's compiled-in profile; without a file the profile is used as is
+std::unique_ptr<ProfileConfig> LoadProfileConfig() {
+    const std::string_view executablePath = g_executablePath;
+    const ExecutableProfile &base = FindExecutableProfile(executablePath);
+    std::string text;
+    if (!ReadConfigFile(g_configPath, text)) {
+        return ParseProfileConfig({}, executablePath, base);
+    }
+
+    std::unique_ptr<ProfileConfig> config = ParseProfileConfig(text, executablePath, base);
+    for (const ConfigError &error : config->errors) {
+        LOG_ERROR("{} line {}: {}, line ignored", CONFIG_FILE_NAME, error.line, error.message);
+    }
+    return config;
+}
+
+// Profile SplinterCellLauncher resolved and copied into the process. Null when the DLL was loaded another way or the
+// payload cannot be read, in which case the config file is read instead.
+std::unique_ptr<ProfileConfig> LoadPayloadConfig() {
+    DWORD size = 0;
+    const PVOID payload = DetourFindPayloadEx(std::bit_cast<GUID>(CONFIG_PAYLOAD_GUID), &size);
+    if (!payload) {
+        return nullptr;
+    }
+
+    auto config = std::make_unique<ProfileConfig>();
+    config->profile = FindExecutableProfile(g_executablePath);
+    const ConfigPayloadStatus status = ReadConfigPayload({static_cast<const uint8_t *>(payload), size}, *config);
+    if (status != ConfigPayloadStatus::Ok) {
+        LOG_ERROR("Launcher profile rejected ({}), reading {}", ConfigPayloadStatusName(status), CONFIG_FILE_NAME);
+        return nullptr;
+    }
+    LOG_INFO("Profile received from the launcher ({} bytes), {} not read", size, CONFIG_FILE_NAME);
+    return config;
+}
+
+// Computes what the hooks apply for a profile. Without a topology, or when the policy selects nothing, the snapshot
+// keeps every core and leaves thread placement alone.
+std::unique_ptr<PolicySnapshot> BuildPolicySnapshot(std::shared_ptr<const ProfileConfig> config) {
+    auto snapshot = std::make_unique<PolicySnapshot>();
+    snapshot->config = std::move(config);
+    const CpuTopology &topology = g_topology;
+    if (topology.processors.empty()) {
+        return snapshot;
     }
 
+    // Legacy affinity calls only address the first DWORD_PTR bits of the process's primary group (group 0)
+    const ProcessorSet processors = ComputePolicySet(topology, snapshot->Profile().policy);
+    const DWORD_PTR mask = static_cast<DWORD_PTR>(processors.GroupMask(0));
+    const ProcessorSet addressable = ProcessorSet::FromGroupMask(0, mask);
+    const bool spanGroups = SPAN_ALL_PROCESSOR_GROUPS && !(addressable == processors);
+    if (mask == 0 && !spanGroups) {
+        LOG_ERROR("Affinity policy selected no processor in group 0, using all cores");
+        return snapshot;
+    }
+
+    // A policy living entirely outside group 0 still needs a valid legacy mask for the primary group
+    snapshot->affinityMask = mask != 0
+        ? mask
+        : static_cast<DWORD_PTR>(topology.All().GroupMask(0));
+    snapshot->policySet = processors;
+    snapshot->spanGroups = spanGroups;
+    snapshot->placementSet = spanGroups ? processors : addressable;
+
+    LOG_INFO(
+        "Topology: {} logical processors in {} group(s), policy selected {} -> mask 0x{:X}",
+        topology.processors.size(), topology.All().GroupCount(), processors.Count(), snapshot->affinityMask
+    );
+
+    if (spanGroups) {
+        LOG_INFO(
+            "Policy reaches beyond the legacy mask ({}), placing across groups with CPU Sets",
+            std::string_view(IsRunningUnderWow64() ? "WOW64" : "multiple processor groups")
+        );
+    }
+    return snapshot;
+}
+
+void ResolveAffinityMask() {
+    GetModuleFileNameA(nullptr, g_executablePath, MAX_PATH);
+    const std::string_view executablePath = g_executablePath;
+    g_configPath = ConfigFilePath(executablePath);
+    g_startupConfig = LoadPayloadConfig();
+    if (!g_startupConfig) {
+        g_startupConfig = LoadProfileConfig();
+    }
+    g_profile = g_startupConfig->profile;
+
+    LOG_INFO(
+        "Profile for '{}': policy '{}', placement '{}'",
+        executablePath, AffinityPolicyName(g_profile.policy), PlacementModeName(g_profile.placement)
+    );
+
+    if (!LoadTopologyFromSystem(g_topology)) {
+        LOG_ERROR(
+            "Topology discovery failed (error: 0x{:X}), using all cores", GetLastError()
+        );
+        g_topology = {};
+    }
+
+    std::unique_ptr<PolicySnapshot> snapshot = BuildPolicySnapshot(g_startupConfig);
+    if (snapshot->placementSet.Count() != 0) {
+        snapshot->placementCores = BuildPlacementCores(g_topology, snapshot->placementSet, g_profile.locality.enabled);
+    }
+    g_policy.Publish(std::move(snapshot));
+}
+
+// Serializes policy changes: the config watcher and the control channel both derive the next snapshot from the current
+// one
+static std::mutex g_policyUpdateMutex;
+
+// Publishes the snapshot build(current) returns, unless it returns null. Threads are placed again only if the
+// processors they may use changed; otherwise the snapshot keeps the current core list and with it every assignment.
+template <typename Build>
+bool UpdatePolicy(Build &&build) {
+    std::lock_guard lock(g_policyUpdateMutex);
+    std::unique_ptr<PolicySnapshot> snapshot;
+    bool placementChanged = false;
+    {
+        const auto current = g_policy.Read(); // Released before Publish, which waits for readers
+        snapshot = build(*current);
+        if (!snapshot) {
+            return false;
+        }
+        placementChanged = !(current->placementSet == snapshot->placementSet);
+        snapshot->placementCores = current->placementCores;
+    }
+    if (placementChanged && snapshot->placementSet.Count() != 0) {
+        snapshot->placementCores = BuildPlacementCores(g_topology, snapshot->placementSet, g_profile.locality.enabled);
+    }
+
+    LOG_INFO(
+        "Policy applied: policy '{}', placement '{}', mask 0x{:X}",
+        AffinityPolicyName(snapshot->Profile().policy), PlacementModeName(snapshot->Profile().placement),
+        snapshot->affinityMask
+    );
+    g_policy.Publish(std::move(snapshot));
     return true;
 }
 
-[[nodiscard]] bool InstallHook() {
-    if (!Real_SetProcessAffinityMask || !Real_FreeLibrary) {
-        OutputDebugStringA("[AffinityHook] ERROR: Function pointers not initialized");
-        return false;
+// Runs on the config watcher thread. Policy, placement and priority rules apply from the next hooked call; load-time
+// settings keep their startup values. Hooks turned off through the control channel stay off.
+void ReloadConfig() {
+    LOG_INFO("{} changed, reloading", CONFIG_FILE_NAME);
+    std::shared_ptr<const ProfileConfig> config = LoadProfileConfig();
+    (void)UpdatePolicy([&](const PolicySnapshot &current) {
+        std::unique_ptr<PolicySnapshot> snapshot = BuildPolicySnapshot(config);
+        snapshot->bypassedHooks = current.bypassedHooks;
+        return snapshot;
+    });
+}
+
+void StartConfigWatcher() {
+    if (!g_configWatcher.Start(g_configPath, ReloadConfig)) {
+        LOG_ERROR("Cannot watch {} for changes (error: 0x{:X})", CONFIG_FILE_NAME, GetLastError());
+        return;
     }
+    LOG_INFO("Watching '{}' for changes", std::string_view(g_configPath));
+}
 
-    DWORD error = NO_ERROR;
+// Applies a processor set to a thread with the active placement mechanism, bypassing the hooks
+bool ApplyThreadProcessors(HANDLE hThread, const ProcessorSet &processors) {
+    if (g_policy.Read()->UseCpuSets()) {
+        return SetThreadCpuSets(hThread, g_topology, processors);
+    }
+    return Real_SetThreadAffinityMask(hThread, static_cast<DWORD_PTR>(processors.GroupMask(0))) != 0;
+}
 
-    error = DetourRestoreAfterWith();
-    if (error != NO_ERROR) {
-        std::string errorMsg = std::format("[AffinityHook] DetourRestoreAfterWith failed with error: 0x{:X}", error);
-        OutputDebugStringA(errorMsg.c_str());
-        return false;
+// The sampler keeps the processors of the startup policy
+void StartThreadSampler() {
+    if (!g_profile.hotThreads.enabled && !g_profile.locality.enabled) {
+        return;
     }
+    const auto policy = g_policy.Read();
+    if (!policy->PlacesThreads()) {
+        return;
+    }
+    if (g_threadSampler.Start(g_profile.hotThreads, g_profile.locality, g_topology, policy->placementSet,
+                              g_threadPlacer, ApplyThreadProcessors)) {
+        LOG_INFO(
+            "Thread sampler started ({} ms interval, hot threads: {}, L3 locality: {})",
+            g_profile.hotThreads.intervalMs, g_profile.hotThreads.enabled, g_profile.locality.enabled
+        );
+    }
+}
 
-    error = DetourTransactionBegin();
-    if (error != NO_ERROR) {
-        std::string errorMsg = std::format("[AffinityHook] DetourTransactionBegin failed with error: 0x{:X}", error);
-        OutputDebugStringA(errorMsg.c_str());
+HookThreads HookInstallThreads() {
+    return g_profile.suspendAllThreads ? HookThreads::All : HookThreads::Current;
+}
+
+// Reserves the slab heap the ReplacementHeap hooks route to. False leaves every heap with Windows.
+bool CreateReplacementHeap() {
+    if (!g_profile.heap.enabled) {
         return false;
     }
-    error = DetourUpdateThread(GetCurrentThread());
-    if (error != NO_ERROR) {
-        std::string errorMsg = std::format("[AffinityHook] DetourUpdateThread failed with error: 0x{:X}", error);
-        OutputDebugStringA(errorMsg.c_str());
-        DetourTransactionAbort();
+    // With the import table only the executable's own calls are routed, and a block it allocates but a system DLL
+    // frees would reach the Windows heap
+    if (g_profile.hookBackend != HookBackend::Detours) {
+        LOG_INFO("Heap replacement needs the detours hook backend, heap left alone");
         return false;
     }
+    const uint64_t arenaBytes = uint64_t{g_profile.heap.arenaMiB} << 20;
+    if (!g_slabHeap.Create(static_cast<size_t>(std::min<uint64_t>(arenaBytes, SIZE_MAX)))) {
+        LOG_ERROR("Cannot reserve a {} MiB slab heap arena, heap left alone", g_profile.heap.arenaMiB);
+        return false;
+    }
+    g_processHeap = GetProcessHeap();
+    LOG_INFO(
+        "Process heap and C runtime allocations up to {} bytes go to the slab heap ({} MiB arena)",
+        SlabHeap::MAX_BLOCK_SIZE, g_profile.heap.arenaMiB
+    );
+    return true;
+}
 
-    error = DetourAttach(reinterpret_cast<PVOID *>(&Real_SetProcessAffinityMask), reinterpret_cast<PVOID>(Hooked_SetProcessAffinityMask));
-    if (error == NO_ERROR) error = DetourAttach(reinterpret_cast<PVOID *>(&Real_FreeLibrary), reinterpret_cast<PVOID>(Hooked_FreeLibrary));
+bool CreateSpinTuner() {
+    if (!g_profile.spinTuning.enabled) {
+        return false;
+    }
+    LARGE_INTEGER frequency = {};
+    QueryPerformanceFrequency(&frequency);
+    const SpinTuningSettings &settings = g_profile.spinTuning;
+    if (!g_spinTuner.Create(settings, static_cast<uint64_t>(frequency.QuadPart))) {
+        LOG_ERROR("Invalid spin tuning settings, critical sections left alone");
+        return false;
+    }
+    LOG_INFO(
+        "Critical sections start spinning {} times, tuned between {} and {} (up to {} locks tracked)",
+        settings.initialSpinCount, settings.minSpinCount, settings.maxSpinCount, settings.maxLocks
+    );
+    return true;
+}
 
-    if (error != NO_ERROR) {
-        std::string errorMsg = std::format("[AffinityHook] DetourAttach failed with error: 0x{:X}", error);
-        OutputDebugStringA(errorMsg.c_str());
-        DetourTransactionAbort();
+bool CreateLockProfiler() {
+    if (!g_profile.lockProfiling.enabled) {
         return false;
     }
+    LARGE_INTEGER frequency = {};
+    QueryPerformanceFrequency(&frequency);
+    if (!g_lockProfiler.Create(g_profile.lockProfiling, static_cast<uint64_t>(frequency.QuadPart))) {
+        LOG_ERROR("Invalid lock profiling settings, locks not profiled");
+        return false;
+    }
+    LOG_INFO(
+        "Profiling critical sections and WaitForSingleObject (up to {} locks tracked)", g_profile.lockProfiling.maxLocks
+    );
+    return true;
+}
+
+// Scopes of the hooks to attach. Creates what their hooks rely on.
+HookScopeMask EnabledHookScopes() {
+    HookScopeMask scopes = 0;
+    scopes |= g_profile.monotonicTimers ? HookScopeBit(HookScope::MonotonicTimers) : 0;
+    scopes |= g_traceWriter.Active() ? HookScopeBit(HookScope::Tracing) : 0;
+    scopes |= CreateReplacementHeap() ? HookScopeBit(HookScope::ReplacementHeap) : 0;
+    scopes |= CreateSpinTuner() ? HookScopeBit(HookScope::SpinTuning) : 0;
+    scopes |= CreateLockProfiler() ? HookScopeBit(HookScope::LockProfiling) : 0;
+    if (scopes & (HookScopeBit(HookScope::SpinTuning) | HookScopeBit(HookScope::LockProfiling))) {
+        scopes |= HookScopeBit(HookScope::CriticalSectionEnter);
+    }
+    return scopes;
+}
+
+// Heap hooks are never detached: blocks the slab heap handed out can be freed until the process is gone
+HookMask ReplacementHeapHooks() {
+    return SelectHooks(HOOK_TABLE, HookScopeBit(HookScope::ReplacementHeap)) & ~SelectHooks(HOOK_TABLE, 0);
+}
 
-    error = DetourTransactionCommit();
-    if (error != NO_ERROR) {
-        std::string errorMsg = std::format("[AffinityHook] ERROR: Hook installation failed with error: 0x{:X}", error);
-        OutputDebugStringA(errorMsg.c_str());
+[[nodiscard]] bool InstallHook() {
+    // Undoes the import table change DetourCreateProcessWithDllEx made (SplinterCellLauncher). Without its restore
+    // payload (an injector, or the import SplinterCellPatcher adds for good) there is nothing to undo and the call
+    // returns FALSE, which is not an error.
+    if (!DetourRestoreAfterWith()) {
+        DWORD size = 0;
+        if (DetourFindPayloadEx(DETOUR_EXE_RESTORE_GUID, &size)) {
+            LOG_ERROR("DetourRestoreAfterWith failed with error: 0x{:X}", GetLastError());
+            return false;
+        }
+    }
+
+    if (g_profile.monotonicTimers) {
+        SeedMonotonicTimers();
+    }
+    const HookMask entries = SelectHooks(HOOK_TABLE, EnabledHookScopes());
+    HookTransactionStats stats;
+    if (!AttachHooks(HOOK_TABLE, entries, g_profile.hookBackend, HookInstallThreads(), stats)) {
+        LOG_ERROR("ERROR: Hook installation failed, no function was detoured");
         return false;
     }
+    g_attachedHooks = entries;
+    g_timersHooked = g_profile.monotonicTimers;
 
-    OutputDebugStringA("[AffinityHook] Hook installed successfully");
+    if (g_profile.hookBackend == HookBackend::ImportTable) {
+        LOG_INFO(
+            "Hook installed successfully ({} functions, {} import slots rewritten)", std::popcount(entries), stats.slots
+        );
+        return true;
+    }
+    LOG_INFO(
+        "Hook installed successfully ({} functions, {} other threads suspended for {} us)",
+        std::popcount(entries), stats.threads, stats.suspendedMicroseconds
+    );
     return true;
 }
 
 [[nodiscard]] bool UninstallHook() {
-    DWORD error = NO_ERROR;
-
-    error = DetourTransactionBegin();
-    if (error != NO_ERROR) {
-        std::string errorMsg = std::format("[AffinityHook] DetourTransactionBegin failed with error: 0x{:X}", error);
-        OutputDebugStringA(errorMsg.c_str());
+    HookTransactionStats stats;
+    const HookMask entries = g_attachedHooks & ~ReplacementHeapHooks();
+    if (!DetachHooks(HOOK_TABLE, entries, g_profile.hookBackend, HookInstallThreads(), stats)) {
+        LOG_ERROR("ERROR: Hook uninstall failed");
         return false;
     }
+    g_attachedHooks &= ~entries;
+    if (g_attachedHooks != 0) {
+        LOG_INFO("{} heap hooks stay attached", std::popcount(g_attachedHooks));
+    }
 
-    error = DetourUpdateThread(GetCurrentThread());
-    if (error != NO_ERROR) {
-        std::string errorMsg = std::format("[AffinityHook] DetourUpdateThread failed with error: 0x{:X}", error);
-        OutputDebugStringA(errorMsg.c_str());
-        DetourTransactionAbort();
-        return false;
+    if (g_profile.hookBackend == HookBackend::ImportTable) {
+        LOG_INFO("Hook uninstalled successfully ({} import slots restored)", stats.slots);
+        return true;
     }
+    LOG_INFO(
+        "Hook uninstalled successfully ({} other threads suspended for {} us)",
+        stats.threads, stats.suspendedMicroseconds
+    );
+    return true;
+}
 
-    error = DetourDetach(reinterpret_cast<PVOID *>(&Real_SetProcessAffinityMask), reinterpret_cast<PVOID>(Hooked_SetProcessAffinityMask));
-    if (error == NO_ERROR) {
-        error = DetourDetach(reinterpret_cast<PVOID *>(&Real_FreeLibrary), reinterpret_cast<PVOID>(Hooked_FreeLibrary));
+void DumpPlacementAudit() {
+    const std::vector<PlacementRewrite> rewrites = g_threadPlacer.Rewrites();
+    LOG_INFO(
+        "Thread placement audit: {} rewrites ({} not recorded)",
+        rewrites.size(), g_threadPlacer.DroppedRewrites()
+    );
+
+    for (const PlacementRewrite &rewrite : rewrites) {
+        if (rewrite.api == PlacementApi::SetThreadAffinityMask) {
+            LOG_DEBUG("  thread {}: SetThreadAffinityMask 0x{:X} -> group {} mask 0x{:X}",
+                rewrite.threadId, rewrite.requested, rewrite.group, rewrite.applied);
+        } else {
+            LOG_DEBUG("  thread {}: SetThreadIdealProcessor {} -> group {} processor {}",
+                rewrite.threadId, rewrite.requested, rewrite.group, rewrite.applied);
+        }
     }
+}
 
-    if (error != NO_ERROR) {
-        std::string errorMsg = std::format("[AffinityHook] DetourDetach failed with error: 0x{:X}", error);
-        OutputDebugStringA(errorMsg.c_str());
-        DetourTransactionAbort();
-        return false;
+void DumpPriorityCounters() {
+    LOG_INFO("Priority remaps:");
+    g_priorityRebalancer.ForEachCounter([](std::string_view api, std::string_view role, std::string_view requested,
+                                           uint64_t count) {
+        if (role.empty()) {
+            LOG_INFO("  {} {}: clamped {} time(s)", api, requested, count);
+        } else {
+            LOG_INFO("  {} {} ({} thread): clamped {} time(s)", api, requested, role, count);
+        }
+    });
+}
+
+void DumpTimerCounters() {
+    if (!g_timersHooked) {
+        return;
     }
+    LOG_INFO(
+        "Timer readings clamped: QueryPerformanceCounter {}, GetTickCount {}, timeGetTime {}",
+        g_performanceCounter.Clamped(), g_tickCount.Clamped(), g_multimediaTime.Clamped()
+    );
+}
 
-    error = DetourTransactionCommit();
-    if (error != NO_ERROR) {
-        std::string errorMsg = std::format("[AffinityHook] ERROR: Hook uninstall failed with error: 0x{:X}", error);
-        OutputDebugStringA(errorMsg.c_str());
-        return false;
+// Walks the user-mode address space. A few thousand regions in a 32-bit process, well under a millisecond.
+AddressSpaceUsage MeasureAddressSpace() {
+    SYSTEM_INFO system = {};
+    GetSystemInfo(&system);
+    const auto first = reinterpret_cast<uintptr_t>(system.lpMinimumApplicationAddress);
+    const auto last = reinterpret_cast<uintptr_t>(system.lpMaximumApplicationAddress);
+
+    AddressSpaceUsage usage;
+    usage.total = last - first + 1;
+    MEMORY_BASIC_INFORMATION region = {};
+    for (uintptr_t address = first;
+         address < last && VirtualQuery(reinterpret_cast<LPCVOID>(address), &region, sizeof(region)) != 0;
+         address = reinterpret_cast<uintptr_t>(region.BaseAddress) + region.RegionSize) {
+        if (region.State == MEM_FREE) {
+            usage.free += region.RegionSize;
+            usage.largestFree = std::max<uint64_t>(usage.largestFree, region.RegionSize);
+        }
     }
+    return usage;
+}
 
-    OutputDebugStringA("[AffinityHook] Hook uninstalled successfully");
-    return true;
+void CALLBACK SampleAddressSpace(PTP_CALLBACK_INSTANCE, PVOID, PTP_TIMER) {
+    g_hookStats.RecordAddressSpace(MeasureAddressSpace());
+}
+
+bool ExecutableIsLargeAddressAware() {
+    const auto *base = reinterpret_cast<const uint8_t *>(GetModuleHandleA(nullptr));
+    const auto *dosHeader = reinterpret_cast<const IMAGE_DOS_HEADER *>(base);
+    const auto *ntHeaders = reinterpret_cast<const IMAGE_NT_HEADERS *>(base + dosHeader->e_lfanew);
+    return (ntHeaders->FileHeader.Characteristics & IMAGE_FILE_LARGE_ADDRESS_AWARE) != 0;
+}
+
+void DumpAddressSpace() {
+    const AddressSpaceUsage usage = MeasureAddressSpace();
+    constexpr uint64_t MIB = 1024 * 1024;
+    LOG_INFO(
+        "Address space: {} MiB free of {} MiB, largest free region {} MiB",
+        usage.free / MIB, usage.total / MIB, usage.largestFree / MIB
+    );
+}
+
+void DumpSpinTuning() {
+    if (!g_spinTuner.Active()) {
+        return;
+    }
+    LOG_INFO(
+        "Spin tuning: {} critical sections tracked{}", g_spinTuner.TrackedLocks(),
+        std::string_view(g_spinTuner.Full() ? ", table full" : "")
+    );
+    for (const SpinTuner::LockSummary &lock : g_spinTuner.MostContended(10)) {
+        LOG_INFO(
+            "  0x{:X}: {} contended enters, average wait {} us, spin count {} ({} raises, {} cuts)",
+            reinterpret_cast<uintptr_t>(lock.lock), lock.contended, lock.averageWaitNs / 1000, lock.spinCount,
+            lock.raised, lock.lowered
+        );
+    }
+}
+
+// A code address as module and offset. Module names are kept for the rest of the process, as log records only take
+// strings that outlive it. An address outside every module is reported as an offset from "unknown".
+struct CodeLocation {
+    std::string_view module;
+    uintptr_t offset = 0;
+};
+
+CodeLocation LocateCode(uintptr_t address) {
+    static std::mutex namesMutex;
+    static auto &names = *new std::deque<std::pair<HMODULE, std::string>>; // A deque never moves its elements
+    HMODULE module = nullptr;
+    if (!GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+                            reinterpret_cast<LPCSTR>(address), &module)) {
+        return {"unknown", address};
+    }
+    const uintptr_t offset = address - reinterpret_cast<uintptr_t>(module);
+    std::lock_guard lock(namesMutex);
+    for (const auto &[known, name] : names) {
+        if (known == module) {
+            return {name, offset};
+        }
+    }
+    char path[MAX_PATH] = {};
+    const DWORD length = GetModuleFileNameA(module, path, MAX_PATH);
+    const std::string_view fullPath(path, length);
+    const std::string &name = names.emplace_back(module, fullPath.substr(fullPath.find_last_of("\\/") + 1)).second;
+    return {name, offset};
+}
+
+void DumpLockProfile() {
+    if (!g_lockProfiler.Active()) {
+        return;
+    }
+    const std::vector<LockProfiler::LockReport> locks = g_lockProfiler.Report(g_profile.lockProfiling.reportLocks);
+    LOG_INFO(
+        "Lock profile: {} locks tracked{}, longest total wait first", g_lockProfiler.TrackedLocks(),
+        std::string_view(g_lockProfiler.Full() ? ", table full" : "")
+    );
+    for (const LockProfiler::LockReport &lock : locks) {
+        LOG_INFO(
+            "  {} 0x{:X}: {} acquires, {} contended, {} timed out", LockKindName(lock.kind),
+            reinterpret_cast<uintptr_t>(lock.lock), lock.acquires, lock.contended, lock.timeouts
+        );
+        LOG_INFO(
+            "    waited {} ms in total, p50 {} us, p99 {} us, max {} us", lock.totalWaitNs / 1'000'000,
+            WaitPercentileUs(lock.waitHistogram, 0.5), WaitPercentileUs(lock.waitHistogram, 0.99),
+            lock.maxWaitNs / 1000
+        );
+        for (const LockProfiler::CallSiteReport &site : lock.callSites) {
+            const CodeLocation location = LocateCode(site.address);
+            LOG_INFO(
+                "    from {}+0x{:X}: {} waits, {} us", location.module, location.offset, site.waits, site.waitNs / 1000
+            );
+        }
+    }
+}
+
+void DumpSlabHeap() {
+    if (!g_processHeap) {
+        return;
+    }
+    const SlabHeap::Statistics statistics = g_slabHeap.Snapshot();
+    LOG_INFO(
+        "Slab heap: {} thread caches, {} of {} spans in use (peak {}), {} abandoned, {} requests fell back",
+        statistics.threadCaches, statistics.spansUsed, statistics.spansTotal, statistics.spansPeak,
+        statistics.spansAbandoned, g_slabHeapFallbacks.load(std::memory_order_relaxed)
+    );
+}
+
+// Config keys the control channel may change: the ones read from the policy snapshot on every hooked call
+constexpr std::string_view LIVE_CONFIG_KEYS[] = {
+    "policy", "placement", "priority.maxClass", "priority.maxMainThread", "priority.maxWorkerThread",
+};
+
+// Hooks the control channel can turn off: the ones that rewrite what the target asked for
+constexpr TraceHook TOGGLEABLE_HOOKS[] = {
+    TraceHook::SetProcessAffinityMask, TraceHook::SetThreadAffinityMask, TraceHook::SetThreadIdealProcessor,
+    TraceHook::SetPriorityClass, TraceHook::SetThreadPriority,
+};
+
+std::string_view HookName(TraceHook hook) {
+    return TRACE_HOOKS[static_cast<size_t>(hook)].name;
+}
+
+ControlResponse ControlStatus(const ControlRequest &) {
+    const auto policy = g_policy.Read();
+    ControlResponse response;
+    response.lines.push_back(std::format("policy {}", AffinityPolicyName(policy->Profile().policy)));
+    response.lines.push_back(std::format("placement {}", PlacementModeName(policy->Profile().placement)));
+    response.lines.push_back(std::format("mask 0x{:X} ({} processors)", policy->affinityMask, policy->policySet.Count()));
+    const PriorityRules &priority = policy->Profile().priority;
+    response.lines.push_back(std::format(
+        "priority.maxClass 0x{:X}, maxMainThread {}, maxWorkerThread {}",
+        priority.maxPriorityClass, priority.maxMainThreadPriority, priority.maxWorkerThreadPriority
+    ));
+    for (const TraceHook hook : TOGGLEABLE_HOOKS) {
+        response.lines.push_back(std::format("hook {} {}", HookName(hook), policy->Bypassed(hook) ? "off" : "on"));
+    }
+    return response;
+}
+
+// "set <key> <value>": same syntax as the config file, on top of the current profile
+ControlResponse ControlSet(const ControlRequest &request) {
+    const ControlRequest assignment = ParseControlRequest(request.argument);
+    const auto live = std::ranges::find_if(LIVE_CONFIG_KEYS, [&](std::string_view key) {
+        return EqualsIgnoreCase(key, assignment.command);
+    });
+    if (live == std::end(LIVE_CONFIG_KEYS)) {
+        return ControlResponse::Error("unknown key or not changeable at run time");
+    }
+    if (assignment.argument.empty()) {
+        return ControlResponse::Error("missing value");
+    }
+
+    const std::string line = std::string(assignment.command) + " = " + std::string(assignment.argument);
+    const bool applied = UpdatePolicy([&](const PolicySnapshot &current) -> std::unique_ptr<PolicySnapshot> {
+        std::shared_ptr<const ProfileConfig> config = ParseProfileConfig(line, g_executablePath, current.Profile());
+        if (!config->errors.empty()) {
+            return nullptr;
+        }
+        std::unique_ptr<PolicySnapshot> snapshot = BuildPolicySnapshot(config);
+        snapshot->bypassedHooks = current.bypassedHooks;
+        return snapshot;
+    });
+    return applied ? ControlStatus(request) : ControlResponse::Error("invalid value");
+}
+
+// "hook <name> on|off": an "off" hook passes calls to Windows unchanged but still counts them
+ControlResponse ControlHook(const ControlRequest &request) {
+    const ControlRequest toggle = ParseControlRequest(request.argument);
+    const auto hook = std::ranges::find_if(TOGGLEABLE_HOOKS, [&](TraceHook candidate) {
+        return EqualsIgnoreCase(HookName(candidate), toggle.command);
+    });
+    if (hook == std::end(TOGGLEABLE_HOOKS)) {
+        return ControlResponse::Error("unknown hook");
+    }
+    if (!EqualsIgnoreCase(toggle.argument, "on") && !EqualsIgnoreCase(toggle.argument, "off")) {
+        return ControlResponse::Error("expected on or off");
+    }
+
+    const uint32_t bit = 1u << static_cast<uint32_t>(*hook);
+    const bool bypass = EqualsIgnoreCase(toggle.argument, "off");
+    (void)UpdatePolicy([&](const PolicySnapshot &current) {
+        auto snapshot = std::make_unique<PolicySnapshot>(current);
+        snapshot->bypassedHooks = bypass ? (current.bypassedHooks | bit) : (current.bypassedHooks & ~bit);
+        return snapshot;
+    });
+    LOG_INFO("Control: hook {} turned {}", HookName(*hook), std::string_view(bypass ? "off" : "on"));
+    return ControlStatus(request);
+}
+
+ControlResponse ControlStats(const ControlRequest &) {
+    if (!g_hookStats.Active()) {
+        return ControlResponse::Error("statistics are turned off");
+    }
+    ControlResponse response;
+    const std::array<HookTotals, STATS_HOOKS> totals = g_hookStats.Snapshot();
+    for (size_t hook = 1; hook < STATS_HOOKS; ++hook) {
+        if (totals[hook].calls != 0) {
+            response.lines.push_back(std::format(
+                "{} {} calls, {} rewritten, {} failed",
+                TRACE_HOOKS[hook].name, totals[hook].calls, totals[hook].rewrites, totals[hook].failures
+            ));
+        }
+    }
+    constexpr uint64_t MIB = 1024 * 1024;
+    const AddressSpaceUsage usage = MeasureAddressSpace();
+    response.lines.push_back(std::format(
+        "address space {} MiB free of {} MiB, largest free region {} MiB",
+        usage.free / MIB, usage.total / MIB, usage.largestFree / MIB
+    ));
+    if (g_spinTuner.Active()) {
+        response.lines.push_back(std::format("spin tuning {} critical sections tracked", g_spinTuner.TrackedLocks()));
+        for (const SpinTuner::LockSummary &lock : g_spinTuner.MostContended(5)) {
+            response.lines.push_back(std::format(
+                "critical section 0x{:X} {} contended enters, average wait {} us, spin count {}",
+                reinterpret_cast<uintptr_t>(lock.lock), lock.contended, lock.averageWaitNs / 1000, lock.spinCount
+            ));
+        }
+    }
+    if (g_processHeap) {
+        const SlabHeap::Statistics heap = g_slabHeap.Snapshot();
+        response.lines.push_back(std::format(
+            "slab heap {} thread caches, {} of {} spans in use, {} abandoned, {} requests fell back",
+            heap.threadCaches, heap.spansUsed, heap.spansTotal, heap.spansAbandoned,
+            g_slabHeapFallbacks.load(std::memory_order_relaxed)
+        ));
+    }
+    return response;
+}
+
+ControlResponse ControlReload(const ControlRequest &request) {
+    ReloadConfig();
+    return ControlStatus(request);
+}
+
+ControlResponse ControlDump(const ControlRequest &) {
+    DumpPlacementAudit();
+    DumpPriorityCounters();
+    DumpTimerCounters();
+    DumpAddressSpace();
+    DumpSpinTuning();
+    DumpLockProfile();
+    DumpSlabHeap();
+    return {true, {"written to the log"}};
+}
+
+// "locks [<count>]": the lock profile, longest total wait first
+ControlResponse ControlLocks(const ControlRequest &request) {
+    if (!g_lockProfiler.Active()) {
+        return ControlResponse::Error("lock profiling is turned off");
+    }
+    uint32_t count = g_profile.lockProfiling.reportLocks;
+    if (!request.argument.empty()) {
+        const char *end = request.argument.data() + request.argument.size();
+        const auto [last, error] = std::from_chars(request.argument.data(), end, count);
+        if (error != std::errc() || last != end) {
+            return ControlResponse::Error("expected a lock count");
+        }
+    }
+    ControlResponse response;
+    response.lines.push_back(std::format(
+        "{} locks tracked{}", g_lockProfiler.TrackedLocks(), g_lockProfiler.Full() ? ", table full" : ""
+    ));
+    for (const LockProfiler::LockReport &lock : g_lockProfiler.Report(count)) {
+        response.lines.push_back(std::format(
+            "{} 0x{:X} {} acquires, {} contended, {} timed out, waited {} ms (p50 {} us, p99 {} us, max {} us)",
+            LockKindName(lock.kind), reinterpret_cast<uintptr_t>(lock.lock), lock.acquires, lock.contended,
+            lock.timeouts, lock.totalWaitNs / 1'000'000, WaitPercentileUs(lock.waitHistogram, 0.5),
+            WaitPercentileUs(lock.waitHistogram, 0.99), lock.maxWaitNs / 1000
+        ));
+        for (const LockProfiler::CallSiteReport &site : lock.callSites) {
+            const CodeLocation location = LocateCode(site.address);
+            response.lines.push_back(std::format(
+                "  from {}+0x{:X} {} waits, {} us", location.module, location.offset, site.waits, site.waitNs / 1000
+            ));
+        }
+    }
+    return response;
+}
+
+ControlResponse ControlPing(const ControlRequest &) {
+    return {};
+}
+
+ControlResponse ControlHelp(const ControlRequest &);
+
+struct ControlCommand {
+    std::string_view name;
+    std::string_view usage;
+    ControlResponse (*handle)(const ControlRequest &request);
+};
+
+constexpr ControlCommand CONTROL_COMMANDS[] = {
+    {"status", "status                     current policy and hook states", ControlStatus},
+    {"set", "set <key> <value>          change a policy, placement or priority key", ControlSet},
+    {"hook", "hook <name> on|off         pass a hook's calls through unchanged (off) or rewrite them", ControlHook},
+    {"stats", "stats                      calls, rewrites and failures per hook", ControlStats},
+    {"reload", "reload                     re-read the config file", ControlReload},
+    {"dump", "dump                       write placement, priority and timer counters to the log", ControlDump},
+    {"locks", "locks [<count>]            lock contention profile, longest total wait first", ControlLocks},
+    {"ping", "ping                       empty response", ControlPing},
+    {"help", "help                       this list", ControlHelp},
+};
+
+ControlResponse ControlHelp(const ControlRequest &) {
+    ControlResponse response;
+    for (const ControlCommand &command : CONTROL_COMMANDS) {
+        response.lines.emplace_back(command.usage);
+    }
+    return response;
+}
+
+// Runs on the control server thread
+ControlResponse HandleControlRequest(const ControlRequest &request) {
+    for (const ControlCommand &command : CONTROL_COMMANDS) {
+        if (EqualsIgnoreCase(request.command, command.name)) {
+            return command.handle(request);
+        }
+    }
+    return ControlResponse::Error("unknown command, try help");
+}
+
+void StartControlServer() {
+    if (!g_profile.control) {
+        return;
+    }
+    if (!g_controlServer.Start(GetCurrentProcessId(), HandleControlRequest)) {
+        LOG_ERROR("Cannot start the control channel (error: 0x{:X})", GetLastError());
+        return;
+    }
+    LOG_INFO("Control channel listening for process {}", GetCurrentProcessId());
+}
+
+// The main thread is the oldest thread of the process, which is not necessarily the one running DllMain
+// (injectors call LoadLibrary from a remote thread)
+DWORD FindMainThreadId() {
+    HANDLE snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, 0);
+    if (snapshot == INVALID_HANDLE_VALUE) {
+        return GetCurrentThreadId();
+    }
+
+    DWORD mainThreadId = GetCurrentThreadId();
+    ULONGLONG oldestCreation = ~0ULL;
+    THREADENTRY32 entry = {};
+    entry.dwSize = sizeof(entry);
+    for (BOOL more = Thread32First(snapshot, &entry); more; more = Thread32Next(snapshot, &entry)) {
+        if (entry.th32OwnerProcessID != GetCurrentProcessId()) {
+            continue;
+        }
+        HANDLE hThread = OpenThread(THREAD_QUERY_LIMITED_INFORMATION, FALSE, entry.th32ThreadID);
+        if (!hThread) {
+            continue;
+        }
+        FILETIME creation, exit, kernel, user;
+        if (GetThreadTimes(hThread, &creation, &exit, &kernel, &user)) {
+            const ULONGLONG created = (static_cast<ULONGLONG>(creation.dwHighDateTime) << 32) | creation.dwLowDateTime;
+            if (created < oldestCreation) {
+                oldestCreation = created;
+                mainThreadId = entry.th32ThreadID;
+            }
+        }
+        CloseHandle(hThread);
+    }
+    CloseHandle(snapshot);
+    return mainThreadId;
 }
 
 bool PinDllToMemory(LPCWSTR lpModuleName) {
@@ -191,57 +1610,253 @@ bool PinDllToMemory(LPCWSTR lpModuleName) {
     );
     if (!success) {
         DWORD error = GetLastError();
-        std::string errorMsg = std::format("[AffinityHook] CRITICAL: Failed to pin DLL in memory (error: 0x{:X})", error);
-        OutputDebugStringA(errorMsg.c_str());
+        LOG_ERROR("CRITICAL: Failed to pin DLL in memory (error: 0x{:X})", error);
         return false;
     }
-    OutputDebugStringA("[AffinityHook] DLL pinned in memory");
+    LOG_DEBUG("DLL pinned in memory");
 
     return true;
 }
 
+void OpenTrace() {
+    if (g_profile.trace.file.empty()) {
+        return;
+    }
+    if (TraceFileBytes(g_profile.trace.maxRecords) > MAX_TRACE_FILE_BYTES) {
+        LOG_ERROR("Cannot trace to '{}': {} records do not fit in the address space", g_profile.trace.file,
+                  g_profile.trace.maxRecords);
+        return;
+    }
+    LARGE_INTEGER frequency = {};
+    LARGE_INTEGER now = {};
+    QueryPerformanceFrequency(&frequency);
+    Real_QueryPerformanceCounter(&now);
+    if (!g_traceWriter.Open(g_profile.trace, static_cast<uint64_t>(frequency.QuadPart),
+                            static_cast<uint64_t>(now.QuadPart), GetCurrentProcessId())) {
+        LOG_ERROR("Cannot create trace file '{}' (error: 0x{:X})", g_profile.trace.file, GetLastError());
+        return;
+    }
+    LOG_INFO("Tracing hook calls to '{}' (up to {} records)", g_profile.trace.file, g_profile.trace.maxRecords);
+}
+
+void CloseTrace() {
+    if (!g_traceWriter.Active()) {
+        return;
+    }
+    LOG_INFO("Trace: {} records written, {} dropped", g_traceWriter.Written(), g_traceWriter.Dropped());
+    g_traceWriter.Close();
+}
+
+void OpenStats() {
+    if (!g_profile.statistics) {
+        return;
+    }
+    LARGE_INTEGER frequency = {};
+    QueryPerformanceFrequency(&frequency);
+    std::vector<uint32_t> processorsPerGroup(GetActiveProcessorGroupCount());
+    for (WORD group = 0; group < processorsPerGroup.size(); ++group) {
+        processorsPerGroup[group] = GetActiveProcessorCount(group);
+    }
+    if (!g_hookStats.Create(GetCurrentProcessId(), static_cast<uint64_t>(frequency.QuadPart), processorsPerGroup)) {
+        LOG_ERROR("Cannot create the hook statistics section (error: 0x{:X})", GetLastError());
+        return;
+    }
+    LOG_INFO("Hook statistics published for process {}", GetCurrentProcessId());
+
+    g_hookStats.RecordAddressSpace(MeasureAddressSpace());
+    DumpAddressSpace();
+    if (sizeof(void *) == 4 && !ExecutableIsLargeAddressAware()) {
+        LOG_INFO("Executable is not large address aware; 'SplinterCellPatcher laa' raises its limit to 4 GiB");
+    }
+
+    g_addressSpaceTimer = CreateThreadpoolTimer(SampleAddressSpace, nullptr, nullptr);
+    if (!g_addressSpaceTimer) {
+        LOG_ERROR("Cannot create the address space timer (error: 0x{:X})", GetLastError());
+        return;
+    }
+    // Relative due time in 100 ns units
+    FILETIME due = {};
+    const auto dueTime = static_cast<uint64_t>(-static_cast<int64_t>(ADDRESS_SPACE_INTERVAL_MS) * 10000);
+    due.dwLowDateTime = static_cast<DWORD>(dueTime);
+    due.dwHighDateTime = static_cast<DWORD>(dueTime >> 32);
+    SetThreadpoolTimer(g_addressSpaceTimer, &due, ADDRESS_SPACE_INTERVAL_MS, ADDRESS_SPACE_INTERVAL_MS / 10);
+}
+
+// Does not wait for a running callback (safe under the loader lock); the DLL is pinned, so its code stays mapped
+void StopAddressSpaceTimer() {
+    if (g_addressSpaceTimer) {
+        SetThreadpoolTimer(g_addressSpaceTimer, nullptr, 0, 0);
+        CloseThreadpoolTimer(g_addressSpaceTimer);
+        g_addressSpaceTimer = nullptr;
+    }
+}
+
+void WriteDebugOutput(const char *line) {
+    OutputDebugStringA(line);
+}
+
+uint64_t TicksToMicroseconds(uint64_t ticks) {
+    LARGE_INTEGER frequency = {};
+    QueryPerformanceFrequency(&frequency);
+    return ticks * 1000000 / static_cast<uint64_t>(frequency.QuadPart);
+}
+
+// Everything DllMain used to do under the loader lock: config, topology, logging, tracing, statistics and the hook
+// transaction. Runs once, on the main thread before the target's entry point or on a one-shot thread.
+void InitializeHooks() {
+    const uint64_t start = ReadRawPerformanceCounter();
+
+    ResolveAffinityMask();
+    if (!ProcessLogger().Start(WriteDebugOutput, g_profile.logFile)) {
+        OutputDebugStringA("[AffinityHook] Log thread failed to start, logging synchronously");
+        ProcessLogger().Stop();
+    }
+
+    // The DLL is pinned, so on failure it stays loaded with every function left alone
+    if (!ResolveHooks(HOOK_TABLE)) {
+        LOG_ERROR("ERROR: Hooked functions could not be resolved, nothing was hooked");
+        return;
+    }
+    OpenTrace();
+    OpenStats();
+    g_mainThreadId = FindMainThreadId();
+
+    if (!InstallHook()) {
+        return;
+    }
+    g_initialized = true;
+
+    StartThreadSampler();
+    StartConfigWatcher();
+    StartControlServer();
+
+    LOG_INFO(
+        "Setup took {} us outside the loader lock; DllMain held it for {} us",
+        TicksToMicroseconds(ReadPerformanceCounter() - start), TicksToMicroseconds(g_loaderLockTicks)
+    );
+}
+
+void EnsureInitialized() {
+    std::call_once(g_initOnce, InitializeHooks);
+}
+
+// Detoured process entry point: setup finishes on the main thread before any of the target's own code runs. The
+// detour stays attached; the DLL is pinned and the process exits from inside it.
+int WINAPI Hooked_EntryPoint() {
+    EnsureInitialized();
+    return Real_EntryPoint();
+}
+
+[[nodiscard]] bool HookEntryPoint() {
+    Real_EntryPoint = reinterpret_cast<PFN_EntryPoint>(DetourGetEntryPoint(nullptr));
+    if (!Real_EntryPoint) {
+        return false;
+    }
+    if (DetourTransactionBegin() != NO_ERROR) {
+        return false;
+    }
+    if (DetourUpdateThread(GetCurrentThread()) != NO_ERROR ||
+        DetourAttach(reinterpret_cast<PVOID *>(&Real_EntryPoint), reinterpret_cast<PVOID>(Hooked_EntryPoint)) != NO_ERROR) {
+        DetourTransactionAbort();
+        return false;
+    }
+    return DetourTransactionCommit() == NO_ERROR;
+}
+
+DWORD WINAPI InitThreadProc(LPVOID) {
+    EnsureInitialized();
+    return 0;
+}
+
+// Init entry point for injectors, shaped as a thread procedure: after LoadLibrary returns in the target, start a
+// remote thread here and wait for it. It returns once the hooks are installed (0) or setup gave up
+// (ERROR_FUNCTION_FAILED), whether it ran setup itself or waited for the init thread DllMain started.
+extern "C" __declspec(dllexport) DWORD WINAPI InitializePatch(LPVOID) {
+    EnsureInitialized();
+    return g_initialized ? ERROR_SUCCESS : ERROR_FUNCTION_FAILED;
+}
+
 // DLL entry point
-BOOL WINAPI DllMain(HINSTANCE hinstDLL, DWORD fdwReason, [[maybe_unused]] LPVOID lpvReserved) {
+BOOL WINAPI DllMain(HINSTANCE hinstDLL, DWORD fdwReason, LPVOID lpvReserved) {
     // Skip hooking in Detours helper processes
     if (DetourIsHelperProcess()) {
         return TRUE;
     }
 
     switch (fdwReason) {
-        case DLL_PROCESS_ATTACH:
-            DisableThreadLibraryCalls(hinstDLL);
-            OutputDebugStringA("[AffinityHook] DLL loaded, installing hook...");
-
+        case DLL_PROCESS_ATTACH: {
+            // Only the minimum runs under the loader lock; every LoadLibrary in the process waits for it
+            const uint64_t start = ReadRawPerformanceCounter();
             g_hModule = hinstDLL;
 
-            if (!LoadFunctionReferences()) {
+            if (!PinDllToMemory(reinterpret_cast<LPCWSTR>(hinstDLL))) {
                 return FALSE;
             }
 
-            if (!PinDllToMemory(reinterpret_cast<LPCWSTR>(hinstDLL))) {
-                return FALSE;
+            // A static load (import table, e.g. DetourCreateProcessWithDll) happens before the target's entry point,
+            // which is detoured so setup completes before the target can make its first affinity call. A DLL
+            // injected into a running process finishes on a thread that starts once the loader lock is released;
+            // LoadLibrary returns before that, so only an injector that waits on InitializePatch closes the gap.
+            const bool staticLoad = lpvReserved != nullptr;
+            if (!(staticLoad && HookEntryPoint())) {
+                HANDLE hThread = CreateThread(nullptr, 0, InitThreadProc, nullptr, 0, nullptr);
+                if (!hThread) {
+                    return FALSE;
+                }
+                CloseHandle(hThread);
             }
 
-            if (!InstallHook()) {
-                return FALSE;
+            g_loaderLockTicks = ReadRawPerformanceCounter() - start;
+            if (staticLoad) {
+                LOG_INFO("DLL loaded, setup deferred to the process entry point");
+            } else {
+                LOG_INFO(
+                    "DLL loaded, setup deferred to an init thread; calls made before it finishes reach Windows "
+                    "unhooked unless the injector waits on InitializePatch"
+                );
             }
             break;
+        }
 
         case DLL_PROCESS_DETACH:
-            OutputDebugStringA("[AffinityHook] DLL unloading, removing hook...");
+            // Records from here on are written synchronously; the drain thread may already be gone
+            ProcessLogger().Stop();
+            if (!g_initialized) {
+                break;
+            }
+            LOG_INFO("DLL unloading, removing hook...");
+            g_configWatcher.Stop();
+            g_controlServer.Stop();
+            g_threadSampler.Stop();
+            StopAddressSpaceTimer();
 
+            // A hook may still be running or about to run until the detours are gone, so the trace and the
+            // statistics stay mapped if they cannot be removed. The heap hooks stay attached either way and keep
+            // using the slab heap, which is never torn down.
             if (!UninstallHook()) {
+                LOG_ERROR("Hooks still attached, leaving the trace and statistics open");
                 return FALSE;
             }
+
+            DumpPlacementAudit();
+            DumpPriorityCounters();
+            DumpTimerCounters();
+            DumpAddressSpace();
+            DumpSpinTuning();
+            DumpLockProfile();
+            DumpSlabHeap();
+            CloseTrace();
+            g_hookStats.Close();
             break;
 
         case DLL_THREAD_ATTACH:
         case DLL_THREAD_DETACH:
-            // These should not occur due to DisableThreadLibraryCalls, but handle gracefully
+            // Thread notifications stay on: the slab heap's thread_local state is torn down through them when a
+            // thread exits (and DisableThreadLibraryCalls fails for a DLL with static TLS anyway). Nothing to do here.
             break;
 
         default:
-            OutputDebugStringA("[AffinityHook] DLL event with unknown fdwReason - ignoring");
+            LOG_DEBUG("DLL event with unknown fdwReason - ignoring");
             break;
     }
 
@@ -0,0 +1,184 @@
+#include "lock_profiler.h"
+#include <algorithm>
+#include <bit>
+#include <tuple>
+#include <utility>
+
+namespace {
+
+constexpr std::pair<LockKind, std::string_view> LOCK_KIND_NAMES[] = {
+    {LockKind::CriticalSection, "critical section"},
+    {LockKind::WaitObject, "wait object"},
+};
+
+size_t WaitBucket(uint64_t waitNs) {
+    return std::min<size_t>(std::bit_width(waitNs / 1000), LockProfiler::WAIT_BUCKETS - 1);
+}
+
+template <typename T>
+void RaiseTo(std::atomic<T> &maximum, T value) {
+    T current = maximum.load(std::memory_order_relaxed);
+    while (current < value && !maximum.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+} // namespace
+
+std::string_view LockKindName(LockKind kind) {
+    for (const auto &[candidate, name] : LOCK_KIND_NAMES) {
+        if (candidate == kind) {
+            return name;
+        }
+    }
+    return "unknown";
+}
+
+bool LockProfiler::Create(const LockProfilingSettings &settings, uint64_t ticksPerSecond) {
+    if (ticksPerSecond == 0 || !m_locks.Create(settings.maxLocks)) {
+        return false;
+    }
+    m_ticksPerSecond = ticksPerSecond;
+    return true;
+}
+
+LockProfiler::LockRecord *LockProfiler::Find(LockKind kind, const void *lock) {
+    bool inserted = false;
+    LockRecord *record = m_locks.FindOrInsert(lock, inserted);
+    if (!record) {
+        m_full.store(true, std::memory_order_relaxed);
+    } else if (inserted) {
+        record->kind.store(kind, std::memory_order_relaxed);
+    }
+    return record;
+}
+
+void LockProfiler::RecordAcquire(LockKind kind, const void *lock) {
+    if (LockRecord *record = Find(kind, lock)) {
+        record->acquires.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void LockProfiler::RecordWait(LockKind kind, const void *lock, uintptr_t returnAddress, uint64_t ticks,
+                              bool acquired) {
+    LockRecord *record = Find(kind, lock);
+    if (!record) {
+        return;
+    }
+    // Split so that waits of any length convert without overflowing
+    const uint64_t waitNs = ticks / m_ticksPerSecond * 1'000'000'000 +
+                            ticks % m_ticksPerSecond * 1'000'000'000 / m_ticksPerSecond;
+    (acquired ? record->acquires : record->timeouts).fetch_add(1, std::memory_order_relaxed);
+    record->contended.fetch_add(1, std::memory_order_relaxed);
+    record->totalWaitNs.fetch_add(waitNs, std::memory_order_relaxed);
+    RaiseTo(record->maxWaitNs, waitNs);
+    record->waitHistogram[WaitBucket(waitNs)].fetch_add(1, std::memory_order_relaxed);
+    RecordCallSite(*record, returnAddress, waitNs);
+}
+
+// Two threads bringing the same new address can claim a slot each; Report merges them. A takeover lost to another
+// thread drops the wait from the call sites only.
+void LockProfiler::RecordCallSite(LockRecord &record, uintptr_t returnAddress, uint64_t waitNs) {
+    if (returnAddress == 0) {
+        return;
+    }
+    CallSite *site = nullptr;
+    for (CallSite &candidate : record.callSites) {
+        if (candidate.address.load(std::memory_order_relaxed) == returnAddress) {
+            site = &candidate;
+            break;
+        }
+    }
+    for (size_t i = 0; !site && i < CALL_SITES; ++i) {
+        uintptr_t current = 0;
+        if (record.callSites[i].address.compare_exchange_strong(current, returnAddress, std::memory_order_relaxed) ||
+            current == returnAddress) {
+            site = &record.callSites[i];
+        }
+    }
+    if (!site) {
+        CallSite *least = &record.callSites[0];
+        for (CallSite &candidate : record.callSites) {
+            if (candidate.waitNs.load(std::memory_order_relaxed) < least->waitNs.load(std::memory_order_relaxed)) {
+                least = &candidate;
+            }
+        }
+        uintptr_t evicted = least->address.load(std::memory_order_relaxed);
+        if (!least->address.compare_exchange_strong(evicted, returnAddress, std::memory_order_relaxed)) {
+            return;
+        }
+        site = least;
+    }
+    site->waits.fetch_add(1, std::memory_order_relaxed);
+    site->waitNs.fetch_add(waitNs, std::memory_order_relaxed);
+}
+
+std::vector<LockProfiler::LockReport> LockProfiler::Report(size_t count) const {
+    std::vector<LockReport> locks;
+    m_locks.ForEach([&](const void *lock, const LockRecord &record) {
+        LockReport report;
+        report.lock = lock;
+        report.kind = record.kind.load(std::memory_order_relaxed);
+        report.acquires = record.acquires.load(std::memory_order_relaxed);
+        report.contended = record.contended.load(std::memory_order_relaxed);
+        report.timeouts = record.timeouts.load(std::memory_order_relaxed);
+        report.totalWaitNs = record.totalWaitNs.load(std::memory_order_relaxed);
+        report.maxWaitNs = record.maxWaitNs.load(std::memory_order_relaxed);
+        if (report.acquires == 0 && report.contended == 0) {
+            return;
+        }
+        for (size_t bucket = 0; bucket < WAIT_BUCKETS; ++bucket) {
+            report.waitHistogram[bucket] = record.waitHistogram[bucket].load(std::memory_order_relaxed);
+        }
+        locks.push_back(std::move(report));
+    });
+    const auto byWait = [](const LockReport &a, const LockReport &b) {
+        return std::tie(a.totalWaitNs, a.contended, a.acquires) > std::tie(b.totalWaitNs, b.contended, b.acquires);
+    };
+    if (locks.size() > count) {
+        std::ranges::partial_sort(locks, locks.begin() + static_cast<ptrdiff_t>(count), byWait);
+        locks.resize(count);
+    } else {
+        std::ranges::sort(locks, byWait);
+    }
+
+    // Call sites only for the locks that made the cut
+    for (LockReport &report : locks) {
+        const LockRecord *record = m_locks.Find(report.lock);
+        for (const CallSite &site : record->callSites) {
+            const uintptr_t address = site.address.load(std::memory_order_relaxed);
+            const uint64_t waits = site.waits.load(std::memory_order_relaxed);
+            if (address == 0 || waits == 0) {
+                continue;
+            }
+            const uint64_t waitNs = site.waitNs.load(std::memory_order_relaxed);
+            const auto same = std::ranges::find(report.callSites, address, &CallSiteReport::address);
+            if (same != report.callSites.end()) {
+                same->waits += waits;
+                same->waitNs += waitNs;
+            } else {
+                report.callSites.push_back({address, waits, waitNs});
+            }
+        }
+        std::ranges::sort(report.callSites, std::ranges::greater(), &CallSiteReport::waitNs);
+    }
+    return locks;
+}
+
+uint64_t WaitPercentileUs(const std::array<uint64_t, LockProfiler::WAIT_BUCKETS> &histogram, double fraction) {
+    uint64_t count = 0;
+    for (const uint64_t waits : histogram) {
+        count += waits;
+    }
+    if (count == 0) {
+        return 0;
+    }
+    const auto target = std::max<uint64_t>(static_cast<uint64_t>(static_cast<double>(count) * fraction), 1);
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < LockProfiler::WAIT_BUCKETS; ++bucket) {
+        seen += histogram[bucket];
+        if (seen >= target) {
+            return bucket == 0 ? 0 : (uint64_t{1} << bucket) - 1;
+        }
+    }
+    return (uint64_t{1} << (LockProfiler::WAIT_BUCKETS - 1)) - 1;
+}
\ No newline at end of file
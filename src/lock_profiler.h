@@ -0,0 +1,108 @@
+#ifndef SPLINTERCELLPATCH_LOCK_PROFILER_H
+#define SPLINTERCELLPATCH_LOCK_PROFILER_H
+
+#include "address_table.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// Lock contention profiling: which of the game's locks turned hot once it ran on every core. Every critical section
+// entered and every object waited on with WaitForSingleObject gets a record of its acquires, contended acquires,
+// the time spent waiting as a histogram, and the return addresses that waited the longest.
+//
+// Recording never locks or allocates (the records live in an AddressTable and are updated with atomics), so it is
+// safe in the hooks on the lock functions themselves and portable, which lets tools/lock_stress.cpp exercise it with
+// pthread mutexes. Counters of one record are updated independently, so a report taken while threads run can be a
+// few events out of step between fields.
+//
+// Call sites are kept per lock in a fixed number of slots with the Space-Saving scheme, weighted by wait time: a
+// return address without a slot takes over the one with the least wait and inherits its totals, so the sites that
+// wait longest keep a slot and their figures err on the high side by at most what they inherited.
+
+struct LockProfilingSettings {
+    bool enabled = false;
+    uint32_t maxLocks = 4096;  // Locks tracked; later ones are not profiled
+    uint32_t reportLocks = 20; // Locks in the report written at exit
+};
+
+enum class LockKind : uint8_t {
+    CriticalSection,
+    WaitObject, // A handle passed to WaitForSingleObject
+};
+
+[[nodiscard]] std::string_view LockKindName(LockKind kind);
+
+class LockProfiler {
+public:
+    // Bucket b counts waits of [2^(b-1), 2^b) microseconds; bucket 0 those under one and the last one everything
+    // from about 4 seconds up
+    static constexpr size_t WAIT_BUCKETS = 24;
+    static constexpr size_t CALL_SITES = 8;
+
+    struct CallSiteReport {
+        uintptr_t address = 0; // Return address of the call that waited
+        uint64_t waits = 0;
+        uint64_t waitNs = 0;
+    };
+
+    struct LockReport {
+        const void *lock = nullptr;
+        LockKind kind = LockKind::CriticalSection;
+        uint64_t acquires = 0;
+        uint64_t contended = 0; // Acquires that had to wait, and waits that timed out
+        uint64_t timeouts = 0;  // Waits that ended without the object
+        uint64_t totalWaitNs = 0;
+        uint64_t maxWaitNs = 0;
+        std::array<uint64_t, WAIT_BUCKETS> waitHistogram = {};
+        std::vector<CallSiteReport> callSites; // Longest total wait first
+    };
+
+    // ticksPerSecond converts the wait times passed to RecordWait
+    [[nodiscard]] bool Create(const LockProfilingSettings &settings, uint64_t ticksPerSecond);
+    [[nodiscard]] bool Active() const { return m_locks.Active(); }
+
+    // An acquire that succeeded without waiting
+    void RecordAcquire(LockKind kind, const void *lock);
+
+    // A wait of `ticks` made from returnAddress; acquired is false when it ended without the lock (a timeout)
+    void RecordWait(LockKind kind, const void *lock, uintptr_t returnAddress, uint64_t ticks, bool acquired);
+
+    // Longest total wait first (then most contended, then most acquired), at most `count`
+    [[nodiscard]] std::vector<LockReport> Report(size_t count) const;
+
+    [[nodiscard]] size_t TrackedLocks() const { return m_locks.Size(); }
+    [[nodiscard]] bool Full() const { return m_full.load(std::memory_order_relaxed); }
+
+private:
+    struct CallSite {
+        std::atomic<uintptr_t> address = 0;
+        std::atomic<uint64_t> waits = 0;
+        std::atomic<uint64_t> waitNs = 0;
+    };
+
+    struct LockRecord {
+        std::atomic<LockKind> kind = LockKind::CriticalSection;
+        std::atomic<uint64_t> acquires = 0;
+        std::atomic<uint64_t> contended = 0;
+        std::atomic<uint64_t> timeouts = 0;
+        std::atomic<uint64_t> totalWaitNs = 0;
+        std::atomic<uint64_t> maxWaitNs = 0;
+        std::array<std::atomic<uint64_t>, WAIT_BUCKETS> waitHistogram = {};
+        std::array<CallSite, CALL_SITES> callSites = {};
+    };
+
+    LockRecord *Find(LockKind kind, const void *lock);
+    static void RecordCallSite(LockRecord &record, uintptr_t returnAddress, uint64_t waitNs);
+
+    uint64_t m_ticksPerSecond = 0;
+    AddressTable<LockRecord> m_locks;
+    std::atomic<bool> m_full = false; // An insert was refused
+};
+
+// Upper bound in microseconds of the bucket holding the given fraction of the waits (0 for under one microsecond)
+[[nodiscard]] uint64_t WaitPercentileUs(const std::array<uint64_t, LockProfiler::WAIT_BUCKETS> &histogram,
+                                        double fraction);
+
+#endif // SPLINTERCELLPATCH_LOCK_PROFILER_H
\ No newline at end of file
@@ -0,0 +1,43 @@
+#include "log_ring.h"
+#include <algorithm>
+#include <bit>
+
+LogRing::LogRing(size_t capacity)
+    : m_slots(std::make_unique<Slot[]>(std::bit_ceil(std::max<size_t>(capacity, 2)))),
+      m_mask(std::bit_ceil(std::max<size_t>(capacity, 2)) - 1) {
+    for (size_t i = 0; i <= m_mask; ++i) {
+        m_slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+bool LogRing::TryPush(const LogRecord &record) {
+    size_t position = m_head.load(std::memory_order_relaxed);
+    for (;;) {
+        Slot &slot = m_slots[position & m_mask];
+        const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+        const auto lag = static_cast<std::ptrdiff_t>(sequence - position);
+        if (lag == 0) {
+            // Slot is free for this position; claim it before writing
+            if (m_head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                slot.record = record;
+                slot.sequence.store(position + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (lag < 0) {
+            return false; // The consumer has not freed this slot yet: ring is full
+        } else {
+            position = m_head.load(std::memory_order_relaxed); // Another producer claimed it
+        }
+    }
+}
+
+bool LogRing::TryPop(LogRecord &record) {
+    Slot &slot = m_slots[m_tail & m_mask];
+    if (slot.sequence.load(std::memory_order_acquire) != m_tail + 1) {
+        return false;
+    }
+    record = slot.record;
+    slot.sequence.store(m_tail + m_mask + 1, std::memory_order_release);
+    ++m_tail;
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,62 @@
+#ifndef SPLINTERCELLPATCH_LOG_RING_H
+#define SPLINTERCELLPATCH_LOG_RING_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+// Lock-free multi-producer/single-consumer ring of fixed-size log records. Hook paths copy their raw arguments into
+// a record without allocating or formatting; AsyncLogger turns them into text on its own thread.
+
+inline constexpr size_t CACHE_LINE_BYTES = 64;
+inline constexpr size_t LOG_PAYLOAD_BYTES = 64;
+
+struct LogRecord;
+
+// Appends the text of a record to out
+using LogFormatFn = void (*)(const LogRecord &record, std::string &out);
+
+struct LogRecord {
+    LogFormatFn format = nullptr;
+    std::string_view pattern; // Format string; always a literal, so it outlives the record
+    uint64_t timestamp = 0;   // steady_clock ticks
+    alignas(8) std::array<std::byte, LOG_PAYLOAD_BYTES> payload = {};
+};
+
+[[nodiscard]] inline uint64_t LogTimestamp() {
+    return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+}
+
+class LogRing {
+public:
+    // The capacity is rounded up to a power of two
+    explicit LogRing(size_t capacity);
+
+    // Safe from any number of threads; never blocks. Returns false when the ring is full.
+    [[nodiscard]] bool TryPush(const LogRecord &record);
+
+    // Single consumer only. Returns false when the ring is empty or the oldest record is still being written.
+    [[nodiscard]] bool TryPop(LogRecord &record);
+
+    [[nodiscard]] size_t Capacity() const { return m_mask + 1; }
+
+private:
+    // Each slot carries a sequence number: position when free, position + 1 once the record is published
+    struct Slot {
+        std::atomic<size_t> sequence = 0;
+        LogRecord record;
+    };
+
+    std::unique_ptr<Slot[]> m_slots;
+    size_t m_mask = 0;
+    std::atomic<size_t> m_head = 0; // Next position producers claim
+    std::array<std::byte, CACHE_LINE_BYTES> m_padding = {}; // Keeps producers and the consumer on separate lines
+    size_t m_tail = 0;              // Next position the consumer reads
+};
+
+#endif // SPLINTERCELLPATCH_LOG_RING_H
\ No newline at end of file
@@ -0,0 +1,80 @@
+#ifndef SPLINTERCELLPATCH_LOGGING_H
+#define SPLINTERCELLPATCH_LOGGING_H
+
+#include "async_logger.h"
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <iterator>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+// Logging front end. Log() checks the format string at compile time, copies the arguments into a LogRecord and
+// hands it to the process logger; formatting happens later on the drain thread. Arguments must be arithmetic or
+// std::string_view over storage that outlives the process (literals, static tables).
+//
+// Call sites use the LOG_<LEVEL> macros. Levels below SPLINTERCELLPATCH_MIN_LOG_LEVEL (set by the
+// SPLINTERCELLPATCH_LOG_LEVEL CMake option) are discarded at compile time: the arguments are not evaluated and the
+// format string never reaches the binary, though it is still checked.
+
+enum class LogLevel : uint8_t {
+    Trace, // Every intercepted call
+    Debug, // Rewritten calls and placement decisions
+    Info,  // Configuration and summaries
+    Error,
+};
+
+#ifndef SPLINTERCELLPATCH_MIN_LOG_LEVEL
+#define SPLINTERCELLPATCH_MIN_LOG_LEVEL 0
+#endif
+
+inline constexpr LogLevel MIN_LOG_LEVEL = static_cast<LogLevel>(SPLINTERCELLPATCH_MIN_LOG_LEVEL);
+
+template <typename T>
+inline constexpr bool IS_LOG_ARGUMENT = std::is_arithmetic_v<T> || std::is_same_v<T, std::string_view>;
+
+template <typename... Args>
+void FormatLogRecord(const LogRecord &record, std::string &out) {
+    [[maybe_unused]] size_t offset = 0;
+    [[maybe_unused]] const auto read = [&]<typename T>() {
+        T value{};
+        std::memcpy(&value, record.payload.data() + offset, sizeof(T));
+        offset += sizeof(T);
+        return value;
+    };
+    // Braced initialization reads the arguments in order
+    const std::tuple<Args...> values{read.template operator()<Args>()...};
+    std::apply([&](const Args &...args) {
+        std::vformat_to(std::back_inserter(out), record.pattern, std::make_format_args(args...));
+    }, values);
+}
+
+template <typename... Args>
+void Log(std::format_string<Args...> format, Args... args) {
+    static_assert((IS_LOG_ARGUMENT<Args> && ...), "log arguments must be arithmetic or std::string_view");
+    static_assert((sizeof(Args) + ... + 0) <= LOG_PAYLOAD_BYTES, "log arguments do not fit in one record");
+
+    LogRecord record;
+    record.format = &FormatLogRecord<Args...>;
+    record.pattern = format.get();
+    record.timestamp = LogTimestamp();
+    [[maybe_unused]] size_t offset = 0;
+    ((std::memcpy(record.payload.data() + offset, &args, sizeof(Args)), offset += sizeof(Args)), ...);
+    ProcessLogger().Push(record);
+}
+
+// A macro rather than a function so that discarded calls do not evaluate their arguments
+#define SPLINTERCELLPATCH_LOG(level, ...)      \
+    do {                                       \
+        if constexpr ((level) >= MIN_LOG_LEVEL) { \
+            Log(__VA_ARGS__);                  \
+        }                                      \
+    } while (false)
+
+#define LOG_TRACE(...) SPLINTERCELLPATCH_LOG(LogLevel::Trace, __VA_ARGS__)
+#define LOG_DEBUG(...) SPLINTERCELLPATCH_LOG(LogLevel::Debug, __VA_ARGS__)
+#define LOG_INFO(...) SPLINTERCELLPATCH_LOG(LogLevel::Info, __VA_ARGS__)
+#define LOG_ERROR(...) SPLINTERCELLPATCH_LOG(LogLevel::Error, __VA_ARGS__)
+
+#endif // SPLINTERCELLPATCH_LOGGING_H
\ No newline at end of file
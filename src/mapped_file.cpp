@@ -0,0 +1,43 @@
+#include "mapped_file.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+bool MappedFile::Create(const std::string &path, size_t size) {
+    Close(m_size);
+    const int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        close(fd);
+        return false;
+    }
+    void *data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) {
+        close(fd);
+        return false;
+    }
+    m_file = fd;
+    m_data = static_cast<std::byte *>(data);
+    m_size = size;
+    return true;
+}
+
+void MappedFile::Close(size_t keepBytes) {
+    if (m_data) {
+        munmap(m_data, m_size);
+        m_data = nullptr;
+    }
+    if (m_file >= 0) {
+        const int fd = static_cast<int>(m_file);
+        // On failure the file keeps its mapped size; readers stop at the header's record count
+        [[maybe_unused]] const int truncated = ftruncate(fd, static_cast<off_t>(keepBytes));
+        close(fd);
+        m_file = -1;
+    }
+    m_size = 0;
+}
+#endif
\ No newline at end of file
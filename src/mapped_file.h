@@ -0,0 +1,33 @@
+#ifndef SPLINTERCELLPATCH_MAPPED_FILE_H
+#define SPLINTERCELLPATCH_MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Read-write file mapping of a fixed size (CreateFileMapping on Windows, mmap elsewhere)
+
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    ~MappedFile() { Close(m_size); }
+
+    // Creates or truncates the file, extends it to size bytes and maps all of it
+    [[nodiscard]] bool Create(const std::string &path, size_t size);
+
+    // Unmaps the view and truncates the file to keepBytes
+    void Close(size_t keepBytes);
+
+    [[nodiscard]] std::byte *Data() const { return m_data; }
+    [[nodiscard]] size_t Size() const { return m_size; }
+
+private:
+    std::byte *m_data = nullptr;
+    size_t m_size = 0;
+    intptr_t m_file = -1;    // File descriptor or HANDLE
+    intptr_t m_mapping = -1; // File mapping HANDLE (Windows only)
+};
+
+#endif // SPLINTERCELLPATCH_MAPPED_FILE_H
\ No newline at end of file
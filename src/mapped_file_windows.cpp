@@ -0,0 +1,52 @@
+#include "mapped_file.h"
+#include <windows.h>
+
+bool MappedFile::Create(const std::string &path, size_t size) {
+    Close(m_size);
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    const uint64_t size64 = size;
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE, static_cast<DWORD>(size64 >> 32),
+                                        static_cast<DWORD>(size64), nullptr);
+    if (!mapping) {
+        CloseHandle(file);
+        return false;
+    }
+    void *data = MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, size);
+    if (!data) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    m_file = reinterpret_cast<intptr_t>(file);
+    m_mapping = reinterpret_cast<intptr_t>(mapping);
+    m_data = static_cast<std::byte *>(data);
+    m_size = size;
+    return true;
+}
+
+void MappedFile::Close(size_t keepBytes) {
+    if (m_data) {
+        UnmapViewOfFile(m_data);
+        m_data = nullptr;
+    }
+    if (m_mapping != -1) {
+        CloseHandle(reinterpret_cast<HANDLE>(m_mapping));
+        m_mapping = -1;
+    }
+    if (m_file != -1) {
+        // The file can only shrink once no view or mapping refers to it
+        HANDLE file = reinterpret_cast<HANDLE>(m_file);
+        LARGE_INTEGER end = {};
+        end.QuadPart = static_cast<LONGLONG>(keepBytes);
+        if (SetFilePointerEx(file, end, nullptr, FILE_BEGIN)) {
+            SetEndOfFile(file);
+        }
+        CloseHandle(file);
+        m_file = -1;
+    }
+    m_size = 0;
+}
\ No newline at end of file
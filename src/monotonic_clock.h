@@ -0,0 +1,61 @@
+#ifndef SPLINTERCELLPATCH_MONOTONIC_CLOCK_H
+#define SPLINTERCELLPATCH_MONOTONIC_CLOCK_H
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+// Process-wide monotonic timers. The games assume QueryPerformanceCounter, GetTickCount and timeGetTime never run
+// backwards, which only held while they were confined to one CPU. On machines whose per-core counters are not
+// synchronized, a thread migrating between cores can read a value below one another thread has already seen, and
+// the games pass timestamps between threads.
+//
+// Every reading is clamped to the highest value handed out so far, by any thread, so time can stall for a moment but
+// never rewinds. The shared maximum is only written when a reading moves past it: a reading at or behind it costs one
+// relaxed load, which stays in the reader's cache until the clock next moves forward. A reading behind the maximum by
+// more than the clamp window is not drift but a counter that wrapped past it while nobody read the clock, and is
+// taken as the new maximum.
+
+template <typename T>
+class MonotonicCounter {
+    static_assert(std::is_unsigned_v<T>, "MonotonicCounter compares with wrap-around arithmetic");
+
+public:
+    // Readings at most this far behind the maximum are clamped: for the millisecond counters 70 minutes, far more
+    // than cores ever drift apart, and a small part of their 49.7-day wrap
+    static constexpr T CLAMP_WINDOW = std::numeric_limits<T>::max() / 1024;
+
+    // Starts the clock at a current reading. Required for wrapping counters, whose readings may be anywhere in the
+    // value range when the hooks are installed.
+    void Seed(T value) { m_maximum.store(value, std::memory_order_relaxed); }
+
+    // Returns raw, or the highest value any thread has already been returned when raw is behind it. Lock-free: one
+    // relaxed load, plus a compare-exchange whenever the clock moved forward. Relaxed is enough, the maximum is a
+    // single location: once a thread has returned a value, a thread that learns of it reads the maximum at or past it.
+    [[nodiscard]] T Advance(T raw) {
+        T maximum = m_maximum.load(std::memory_order_relaxed);
+        for (;;) {
+            const T behind = static_cast<T>(maximum - raw); // Wraps to a large value when raw is ahead
+            if (behind == 0) {
+                return raw;
+            }
+            if (behind <= CLAMP_WINDOW) {
+                m_clamped.fetch_add(1, std::memory_order_relaxed);
+                return maximum;
+            }
+            if (m_maximum.compare_exchange_weak(maximum, raw, std::memory_order_relaxed)) {
+                return raw;
+            }
+        }
+    }
+
+    // Number of readings that would have gone backwards
+    [[nodiscard]] uint64_t Clamped() const { return m_clamped.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<T> m_maximum = 0;
+    std::atomic<uint64_t> m_clamped = 0;
+};
+
+#endif // SPLINTERCELLPATCH_MONOTONIC_CLOCK_H
\ No newline at end of file
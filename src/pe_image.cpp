@@ -0,0 +1,536 @@
+#include "pe_image.h"
+#include "string_utils.h"
+#include <algorithm>
+#include <cstring>
+#include <optional>
+
+namespace {
+
+constexpr uint16_t DOS_SIGNATURE = 0x5A4D; // "MZ"
+constexpr uint32_t NT_SIGNATURE = 0x00004550; // "PE\0\0"
+constexpr uint16_t PE32_MAGIC = 0x10B;
+constexpr uint16_t PE32_PLUS_MAGIC = 0x20B;
+
+constexpr size_t FILE_HEADER_SIZE = 20;
+constexpr size_t FILE_HEADER_CHARACTERISTICS = 18;
+constexpr size_t SECTION_HEADER_SIZE = 40;
+constexpr size_t IMPORT_DESCRIPTOR_SIZE = 20;
+
+constexpr uint32_t DIRECTORY_IMPORT = 1;
+constexpr uint32_t DIRECTORY_SECURITY = 4;
+constexpr uint32_t DIRECTORY_BOUND_IMPORT = 11;
+
+constexpr uint32_t SECTION_INITIALIZED_DATA = 0x00000040;
+constexpr uint32_t SECTION_READ = 0x40000000;
+constexpr uint32_t SECTION_WRITE = 0x80000000; // The loader writes the new import address table
+
+// Optional header field offsets shared by PE32 and PE32+
+constexpr size_t OPTIONAL_SIZE_OF_INITIALIZED_DATA = 8;
+constexpr size_t OPTIONAL_SECTION_ALIGNMENT = 32;
+constexpr size_t OPTIONAL_FILE_ALIGNMENT = 36;
+constexpr size_t OPTIONAL_SIZE_OF_IMAGE = 56;
+constexpr size_t OPTIONAL_SIZE_OF_HEADERS = 60;
+constexpr size_t OPTIONAL_CHECKSUM = 64;
+
+// Header values AddPeImport changed, stored at the start of the patch section
+struct PatchRecord {
+    std::array<char, 8> magic = {'S', 'C', 'P', 'A', 'T', 'C', 'H', '1'};
+    uint32_t importRva = 0;
+    uint32_t importSize = 0;
+    uint32_t boundImportRva = 0;
+    uint32_t boundImportSize = 0;
+    uint32_t checksum = 0;
+    uint32_t sizeOfImage = 0;
+    uint32_t sizeOfInitializedData = 0;
+    uint32_t fileSize = 0;
+    uint16_t sectionCount = 0;
+    uint16_t reserved = 0;
+    std::array<uint8_t, SECTION_HEADER_SIZE> sectionHeaderSlot = {}; // Header bytes the new section header replaced
+    uint32_t reserved2 = 0;
+};
+static_assert(sizeof(PatchRecord) == 88);
+constexpr PatchRecord PATCH_RECORD_TEMPLATE = {};
+
+struct Section {
+    uint32_t virtualSize = 0;
+    uint32_t virtualAddress = 0;
+    uint32_t rawSize = 0;
+    uint32_t rawOffset = 0;
+};
+
+// Offsets of the parts of the headers the editor touches
+struct Layout {
+    bool mapped = false; // PeView::Mapped
+    bool pe32Plus = false;
+    size_t fileHeader = 0;
+    size_t optionalHeader = 0;
+    size_t directories = 0;
+    uint32_t directoryCount = 0;
+    size_t sectionHeaders = 0;
+    uint16_t sectionCount = 0;
+    uint32_t sectionAlignment = 0;
+    uint32_t fileAlignment = 0;
+    uint32_t sizeOfHeaders = 0;
+    std::vector<Section> sections;
+};
+
+template <typename T>
+T Get(std::span<const uint8_t> file, size_t offset) {
+    T value{};
+    std::memcpy(&value, file.data() + offset, sizeof(T));
+    return value;
+}
+
+template <typename T>
+void Put(std::vector<uint8_t> &file, size_t offset, T value) {
+    std::memcpy(file.data() + offset, &value, sizeof(T));
+}
+
+bool InBounds(std::span<const uint8_t> file, size_t offset, size_t size) {
+    return offset <= file.size() && size <= file.size() - offset;
+}
+
+uint32_t AlignUp(uint32_t value, uint32_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+PeStatus ParseLayout(std::span<const uint8_t> file, Layout &layout) {
+    if (!InBounds(file, 0, 64) || Get<uint16_t>(file, 0) != DOS_SIGNATURE) {
+        return PeStatus::NotPe;
+    }
+    const uint32_t ntOffset = Get<uint32_t>(file, 0x3C);
+    if (!InBounds(file, ntOffset, 4 + FILE_HEADER_SIZE + 2) || Get<uint32_t>(file, ntOffset) != NT_SIGNATURE) {
+        return PeStatus::NotPe;
+    }
+
+    layout.fileHeader = ntOffset + 4;
+    layout.optionalHeader = layout.fileHeader + FILE_HEADER_SIZE;
+    layout.sectionCount = Get<uint16_t>(file, layout.fileHeader + 2);
+    const uint16_t optionalSize = Get<uint16_t>(file, layout.fileHeader + 16);
+    const uint16_t magic = Get<uint16_t>(file, layout.optionalHeader);
+    if (magic != PE32_MAGIC && magic != PE32_PLUS_MAGIC) {
+        return PeStatus::NotPe;
+    }
+    layout.pe32Plus = magic == PE32_PLUS_MAGIC;
+
+    const size_t countOffset = layout.optionalHeader + (layout.pe32Plus ? 108 : 92);
+    layout.directories = countOffset + 4;
+    if (!InBounds(file, layout.optionalHeader, optionalSize) || countOffset + 4 > layout.optionalHeader + optionalSize) {
+        return PeStatus::Malformed;
+    }
+    layout.directoryCount = Get<uint32_t>(file, countOffset);
+    if (layout.directories + size_t{layout.directoryCount} * 8 > layout.optionalHeader + optionalSize) {
+        return PeStatus::Malformed;
+    }
+    layout.sectionAlignment = Get<uint32_t>(file, layout.optionalHeader + OPTIONAL_SECTION_ALIGNMENT);
+    layout.fileAlignment = Get<uint32_t>(file, layout.optionalHeader + OPTIONAL_FILE_ALIGNMENT);
+    layout.sizeOfHeaders = Get<uint32_t>(file, layout.optionalHeader + OPTIONAL_SIZE_OF_HEADERS);
+    if (layout.sectionAlignment == 0 || layout.fileAlignment == 0) {
+        return PeStatus::Malformed;
+    }
+
+    layout.sectionHeaders = layout.optionalHeader + optionalSize;
+    if (!InBounds(file, layout.sectionHeaders, size_t{layout.sectionCount} * SECTION_HEADER_SIZE)) {
+        return PeStatus::Malformed;
+    }
+    layout.sections.clear();
+    for (uint16_t i = 0; i < layout.sectionCount; ++i) {
+        const size_t header = layout.sectionHeaders + size_t{i} * SECTION_HEADER_SIZE;
+        layout.sections.push_back({Get<uint32_t>(file, header + 8), Get<uint32_t>(file, header + 12),
+                                   Get<uint32_t>(file, header + 16), Get<uint32_t>(file, header + 20)});
+    }
+    return PeStatus::Ok;
+}
+
+size_t DirectoryOffset(const Layout &layout, uint32_t index) {
+    return layout.directories + size_t{index} * 8;
+}
+
+std::optional<size_t> RvaToOffset(std::span<const uint8_t> file, const Layout &layout, uint32_t rva, size_t size) {
+    if (rva < layout.sizeOfHeaders || layout.mapped) {
+        return InBounds(file, rva, size) ? std::optional<size_t>(rva) : std::nullopt;
+    }
+    for (const Section &section : layout.sections) {
+        if (rva >= section.virtualAddress && rva - section.virtualAddress < section.rawSize) {
+            const size_t offset = size_t{section.rawOffset} + (rva - section.virtualAddress);
+            return InBounds(file, offset, size) ? std::optional(offset) : std::nullopt;
+        }
+    }
+    return std::nullopt;
+}
+
+// Reads the NUL-terminated string at rva
+std::optional<std::string> ReadString(std::span<const uint8_t> file, const Layout &layout, uint32_t rva) {
+    const std::optional<size_t> offset = RvaToOffset(file, layout, rva, 1);
+    if (!offset) {
+        return std::nullopt;
+    }
+    const auto begin = file.begin() + static_cast<ptrdiff_t>(*offset);
+    const auto end = std::find(begin, file.end(), uint8_t{0});
+    if (end == file.end()) {
+        return std::nullopt;
+    }
+    return std::string(begin, end);
+}
+
+// Raw descriptors of the current import table, without the terminating null descriptor
+PeStatus ReadImportDescriptors(std::span<const uint8_t> file, const Layout &layout,
+                               std::vector<std::array<uint8_t, IMPORT_DESCRIPTOR_SIZE>> &descriptors) {
+    descriptors.clear();
+    if (layout.directoryCount <= DIRECTORY_IMPORT) {
+        return PeStatus::Ok;
+    }
+    const uint32_t rva = Get<uint32_t>(file, DirectoryOffset(layout, DIRECTORY_IMPORT));
+    if (rva == 0) {
+        return PeStatus::Ok;
+    }
+    for (uint32_t entry = rva;; entry += IMPORT_DESCRIPTOR_SIZE) {
+        const std::optional<size_t> offset = RvaToOffset(file, layout, entry, IMPORT_DESCRIPTOR_SIZE);
+        if (!offset) {
+            return PeStatus::Malformed;
+        }
+        std::array<uint8_t, IMPORT_DESCRIPTOR_SIZE> descriptor = {};
+        std::memcpy(descriptor.data(), file.data() + *offset, IMPORT_DESCRIPTOR_SIZE);
+        if (std::ranges::all_of(descriptor, [](uint8_t byte) { return byte == 0; })) {
+            return PeStatus::Ok;
+        }
+        descriptors.push_back(descriptor);
+    }
+}
+
+PeStatus ReadImportNames(std::span<const uint8_t> file, const Layout &layout, std::vector<std::string> &names) {
+    std::vector<std::array<uint8_t, IMPORT_DESCRIPTOR_SIZE>> descriptors;
+    if (const PeStatus status = ReadImportDescriptors(file, layout, descriptors); status != PeStatus::Ok) {
+        return status;
+    }
+    names.clear();
+    for (const auto &descriptor : descriptors) {
+        std::optional<std::string> name = ReadString(file, layout, Get<uint32_t>(descriptor, 12));
+        if (!name) {
+            return PeStatus::Malformed;
+        }
+        names.push_back(std::move(*name));
+    }
+    return PeStatus::Ok;
+}
+
+// The patch section is always the last one
+std::optional<PatchRecord> FindPatchRecord(std::span<const uint8_t> file, const Layout &layout) {
+    if (layout.sections.empty()) {
+        return std::nullopt;
+    }
+    const size_t header = layout.sectionHeaders + (size_t{layout.sectionCount} - 1) * SECTION_HEADER_SIZE;
+    const Section &section = layout.sections.back();
+    if (std::memcmp(file.data() + header, PE_PATCH_SECTION_NAME.data(), PE_PATCH_SECTION_NAME.size()) != 0 ||
+        section.rawSize < sizeof(PatchRecord) || !InBounds(file, section.rawOffset, sizeof(PatchRecord))) {
+        return std::nullopt;
+    }
+    const auto record = Get<PatchRecord>(file, section.rawOffset);
+    if (record.magic != PATCH_RECORD_TEMPLATE.magic) {
+        return std::nullopt;
+    }
+    return record;
+}
+
+template <typename Thunk>
+PeStatus ReadThunks(std::span<const uint8_t> image, const Layout &layout, const std::string &module, uint32_t lookupRva,
+                    uint32_t addressRva, std::vector<PeImportSlot> &slots) {
+    constexpr Thunk ORDINAL_FLAG = Thunk{1} << (sizeof(Thunk) * 8 - 1);
+    for (uint32_t index = 0;; ++index) {
+        const uint32_t step = index * static_cast<uint32_t>(sizeof(Thunk));
+        const std::optional<size_t> offset = RvaToOffset(image, layout, lookupRva + step, sizeof(Thunk));
+        if (!offset) {
+            return PeStatus::Malformed;
+        }
+        const auto thunk = Get<Thunk>(image, *offset);
+        if (thunk == 0) {
+            return PeStatus::Ok;
+        }
+
+        PeImportSlot slot;
+        slot.module = module;
+        slot.slotRva = addressRva + step;
+        if (thunk & ORDINAL_FLAG) {
+            slot.ordinal = static_cast<uint16_t>(thunk & 0xFFFF);
+        } else {
+            const auto hintName = static_cast<uint32_t>(thunk & 0x7FFFFFFF);
+            std::optional<std::string> symbol = ReadString(image, layout, hintName + 2); // After the 2-byte hint
+            if (!symbol) {
+                return PeStatus::Malformed;
+            }
+            slot.symbol = std::move(*symbol);
+        }
+        slots.push_back(std::move(slot));
+    }
+}
+
+bool IsSigned(std::span<const uint8_t> file, const Layout &layout) {
+    return layout.directoryCount > DIRECTORY_SECURITY &&
+           Get<uint32_t>(file, DirectoryOffset(layout, DIRECTORY_SECURITY) + 4) != 0;
+}
+
+void StoreChecksum(std::vector<uint8_t> &file, const Layout &layout) {
+    Put<uint32_t>(file, layout.optionalHeader + OPTIONAL_CHECKSUM, 0);
+    Put<uint32_t>(file, layout.optionalHeader + OPTIONAL_CHECKSUM, ComputePeChecksum(file));
+}
+
+} // namespace
+
+std::string_view PeStatusName(PeStatus status) {
+    switch (status) {
+        case PeStatus::Ok: return "ok";
+        case PeStatus::NotPe: return "not a PE executable";
+        case PeStatus::Malformed: return "malformed headers";
+        case PeStatus::Signed: return "signed, patching would break the signature";
+        case PeStatus::NoHeaderRoom: return "no room for another section header";
+        case PeStatus::AlreadyPatched: return "already patched";
+        case PeStatus::AlreadyImported: return "already imports the DLL";
+        case PeStatus::NotPatched: return "not patched";
+        case PeStatus::AlreadySet: return "already set";
+    }
+    return "unknown";
+}
+
+uint32_t ComputePeChecksum(std::span<const uint8_t> file) {
+    Layout layout;
+    const bool hasHeaders = ParseLayout(file, layout) == PeStatus::Ok;
+    const size_t checksumOffset = hasHeaders ? layout.optionalHeader + OPTIONAL_CHECKSUM : file.size();
+
+    uint64_t sum = 0;
+    for (size_t offset = 0; offset < file.size(); offset += 2) {
+        if (offset >= checksumOffset && offset < checksumOffset + 4) {
+            continue;
+        }
+        uint32_t word = file[offset];
+        if (offset + 1 < file.size()) {
+            word |= uint32_t{file[offset + 1]} << 8;
+        }
+        sum += word;
+        sum = (sum & 0xFFFF) + (sum >> 16);
+    }
+    sum = (sum & 0xFFFF) + (sum >> 16);
+    return static_cast<uint32_t>(sum + file.size());
+}
+
+PeStatus ReadPeInfo(std::span<const uint8_t> file, PeInfo &info) {
+    Layout layout;
+    if (const PeStatus status = ParseLayout(file, layout); status != PeStatus::Ok) {
+        return status;
+    }
+    info.machine = Get<uint16_t>(file, layout.fileHeader);
+    info.pe32Plus = layout.pe32Plus;
+    info.characteristics = Get<uint16_t>(file, layout.fileHeader + FILE_HEADER_CHARACTERISTICS);
+    info.sizeOfImage = Get<uint32_t>(file, layout.optionalHeader + OPTIONAL_SIZE_OF_IMAGE);
+    info.storedChecksum = Get<uint32_t>(file, layout.optionalHeader + OPTIONAL_CHECKSUM);
+    info.computedChecksum = ComputePeChecksum(file);
+    info.patched = FindPatchRecord(file, layout).has_value();
+    return ReadImportNames(file, layout, info.imports);
+}
+
+uint64_t PeUserAddressSpace(const PeInfo &info) {
+    constexpr uint64_t GIB = uint64_t{1} << 30;
+    if (!(info.characteristics & PE_LARGE_ADDRESS_AWARE)) {
+        return 2 * GIB;
+    }
+    return info.pe32Plus ? 128 * 1024 * GIB : 4 * GIB;
+}
+
+PeStatus SetPeLargeAddressAware(std::vector<uint8_t> &file, bool enable) {
+    Layout layout;
+    if (const PeStatus status = ParseLayout(file, layout); status != PeStatus::Ok) {
+        return status;
+    }
+    const size_t offset = layout.fileHeader + FILE_HEADER_CHARACTERISTICS;
+    const auto characteristics = Get<uint16_t>(file, offset);
+    if (((characteristics & PE_LARGE_ADDRESS_AWARE) != 0) == enable) {
+        return PeStatus::AlreadySet;
+    }
+    if (IsSigned(file, layout)) {
+        return PeStatus::Signed;
+    }
+    Put<uint16_t>(file, offset, static_cast<uint16_t>(enable ? characteristics | PE_LARGE_ADDRESS_AWARE
+                                                             : characteristics & ~PE_LARGE_ADDRESS_AWARE));
+    StoreChecksum(file, layout);
+    return PeStatus::Ok;
+}
+
+PeStatus ReadPeImportSlots(std::span<const uint8_t> image, PeView view, std::vector<PeImportSlot> &slots) {
+    Layout layout;
+    if (const PeStatus status = ParseLayout(image, layout); status != PeStatus::Ok) {
+        return status;
+    }
+    layout.mapped = view == PeView::Mapped;
+
+    std::vector<std::array<uint8_t, IMPORT_DESCRIPTOR_SIZE>> descriptors;
+    if (const PeStatus status = ReadImportDescriptors(image, layout, descriptors); status != PeStatus::Ok) {
+        return status;
+    }
+    slots.clear();
+    for (const auto &descriptor : descriptors) {
+        const std::optional<std::string> module = ReadString(image, layout, Get<uint32_t>(descriptor, 12));
+        if (!module) {
+            return PeStatus::Malformed;
+        }
+        const uint32_t addressRva = Get<uint32_t>(descriptor, 16);
+        uint32_t lookupRva = Get<uint32_t>(descriptor, 0);
+        if (lookupRva == 0) {
+            if (layout.mapped) {
+                continue; // The address table already holds resolved pointers
+            }
+            lookupRva = addressRva;
+        }
+        const PeStatus status = layout.pe32Plus
+            ? ReadThunks<uint64_t>(image, layout, *module, lookupRva, addressRva, slots)
+            : ReadThunks<uint32_t>(image, layout, *module, lookupRva, addressRva, slots);
+        if (status != PeStatus::Ok) {
+            return status;
+        }
+    }
+    return PeStatus::Ok;
+}
+
+PeStatus AddPeImport(std::vector<uint8_t> &file, std::string_view dllName, std::string_view symbol) {
+    Layout layout;
+    if (const PeStatus status = ParseLayout(file, layout); status != PeStatus::Ok) {
+        return status;
+    }
+    if (FindPatchRecord(file, layout)) {
+        return PeStatus::AlreadyPatched;
+    }
+    if (layout.directoryCount <= DIRECTORY_IMPORT) {
+        return PeStatus::Malformed;
+    }
+    if (IsSigned(file, layout)) {
+        return PeStatus::Signed;
+    }
+
+    std::vector<std::array<uint8_t, IMPORT_DESCRIPTOR_SIZE>> descriptors;
+    if (const PeStatus status = ReadImportDescriptors(file, layout, descriptors); status != PeStatus::Ok) {
+        return status;
+    }
+    std::vector<std::string> names;
+    if (const PeStatus status = ReadImportNames(file, layout, names); status != PeStatus::Ok) {
+        return status;
+    }
+    if (std::ranges::any_of(names, [&](const std::string &name) { return EqualsIgnoreCase(name, dllName); })) {
+        return PeStatus::AlreadyImported;
+    }
+
+    // The new section header has to fit before the first section's raw data
+    const size_t newHeader = layout.sectionHeaders + size_t{layout.sectionCount} * SECTION_HEADER_SIZE;
+    size_t headerLimit = layout.sizeOfHeaders;
+    for (const Section &section : layout.sections) {
+        if (section.rawSize != 0) {
+            headerLimit = std::min<size_t>(headerLimit, section.rawOffset);
+        }
+    }
+    if (newHeader + SECTION_HEADER_SIZE > headerLimit) {
+        return PeStatus::NoHeaderRoom;
+    }
+
+    // Section contents: patch record, import descriptors (ours first), lookup table, address table, hint/name, DLL name
+    const size_t thunkSize = layout.pe32Plus ? 8 : 4;
+    const size_t descriptorsOffset = sizeof(PatchRecord);
+    const size_t lookupOffset = AlignUp(static_cast<uint32_t>(
+        descriptorsOffset + (descriptors.size() + 2) * IMPORT_DESCRIPTOR_SIZE), 8);
+    const size_t addressOffset = lookupOffset + 2 * thunkSize;
+    const size_t hintNameOffset = addressOffset + 2 * thunkSize;
+    const size_t dllNameOffset = hintNameOffset + 2 + symbol.size() + 1 + ((symbol.size() + 1) & 1);
+    const size_t contentSize = dllNameOffset + dllName.size() + 1;
+
+    uint32_t imageEnd = 0;
+    for (const Section &section : layout.sections) {
+        imageEnd = std::max(imageEnd, section.virtualAddress + std::max(section.virtualSize, section.rawSize));
+    }
+    const uint32_t sectionRva = AlignUp(std::max(imageEnd, layout.sizeOfHeaders), layout.sectionAlignment);
+    const uint32_t rawSize = AlignUp(static_cast<uint32_t>(contentSize), layout.fileAlignment);
+    const uint32_t rawOffset = AlignUp(static_cast<uint32_t>(file.size()), layout.fileAlignment);
+
+    PatchRecord record;
+    record.importRva = Get<uint32_t>(file, DirectoryOffset(layout, DIRECTORY_IMPORT));
+    record.importSize = Get<uint32_t>(file, DirectoryOffset(layout, DIRECTORY_IMPORT) + 4);
+    if (layout.directoryCount > DIRECTORY_BOUND_IMPORT) {
+        record.boundImportRva = Get<uint32_t>(file, DirectoryOffset(layout, DIRECTORY_BOUND_IMPORT));
+        record.boundImportSize = Get<uint32_t>(file, DirectoryOffset(layout, DIRECTORY_BOUND_IMPORT) + 4);
+    }
+    record.checksum = Get<uint32_t>(file, layout.optionalHeader + OPTIONAL_CHECKSUM);
+    record.sizeOfImage = Get<uint32_t>(file, layout.optionalHeader + OPTIONAL_SIZE_OF_IMAGE);
+    record.sizeOfInitializedData = Get<uint32_t>(file, layout.optionalHeader + OPTIONAL_SIZE_OF_INITIALIZED_DATA);
+    record.fileSize = static_cast<uint32_t>(file.size());
+    record.sectionCount = layout.sectionCount;
+    std::memcpy(record.sectionHeaderSlot.data(), file.data() + newHeader, SECTION_HEADER_SIZE);
+
+    std::vector<uint8_t> content(rawSize, 0);
+    std::memcpy(content.data(), &record, sizeof(record));
+    const auto putContent = [&](size_t offset, uint32_t value) { std::memcpy(content.data() + offset, &value, 4); };
+    putContent(descriptorsOffset + 0, sectionRva + static_cast<uint32_t>(lookupOffset));  // OriginalFirstThunk
+    putContent(descriptorsOffset + 12, sectionRva + static_cast<uint32_t>(dllNameOffset)); // Name
+    putContent(descriptorsOffset + 16, sectionRva + static_cast<uint32_t>(addressOffset)); // FirstThunk
+    for (size_t i = 0; i < descriptors.size(); ++i) {
+        std::memcpy(content.data() + descriptorsOffset + (i + 1) * IMPORT_DESCRIPTOR_SIZE, descriptors[i].data(),
+                    IMPORT_DESCRIPTOR_SIZE);
+    }
+    // Import by name; the upper half of a PE32+ thunk stays zero
+    putContent(lookupOffset, sectionRva + static_cast<uint32_t>(hintNameOffset));
+    putContent(addressOffset, sectionRva + static_cast<uint32_t>(hintNameOffset));
+    std::memcpy(content.data() + hintNameOffset + 2, symbol.data(), symbol.size());
+    std::memcpy(content.data() + dllNameOffset, dllName.data(), dllName.size());
+
+    file.resize(rawOffset, 0);
+    file.insert(file.end(), content.begin(), content.end());
+
+    std::array<uint8_t, SECTION_HEADER_SIZE> header = {};
+    std::memcpy(header.data(), PE_PATCH_SECTION_NAME.data(), PE_PATCH_SECTION_NAME.size());
+    const uint32_t headerFields[] = {static_cast<uint32_t>(contentSize), sectionRva, rawSize, rawOffset};
+    std::memcpy(header.data() + 8, headerFields, sizeof(headerFields));
+    const uint32_t characteristics = SECTION_INITIALIZED_DATA | SECTION_READ | SECTION_WRITE;
+    std::memcpy(header.data() + 36, &characteristics, 4);
+    std::memcpy(file.data() + newHeader, header.data(), SECTION_HEADER_SIZE);
+
+    Put<uint16_t>(file, layout.fileHeader + 2, static_cast<uint16_t>(layout.sectionCount + 1));
+    Put<uint32_t>(file, DirectoryOffset(layout, DIRECTORY_IMPORT), sectionRva + static_cast<uint32_t>(descriptorsOffset));
+    Put<uint32_t>(file, DirectoryOffset(layout, DIRECTORY_IMPORT) + 4,
+                  static_cast<uint32_t>((descriptors.size() + 2) * IMPORT_DESCRIPTOR_SIZE));
+    // Bound imports describe the old table; the loader resolves everything normally without them
+    if (layout.directoryCount > DIRECTORY_BOUND_IMPORT) {
+        Put<uint64_t>(file, DirectoryOffset(layout, DIRECTORY_BOUND_IMPORT), 0);
+    }
+    Put<uint32_t>(file, layout.optionalHeader + OPTIONAL_SIZE_OF_IMAGE,
+                  AlignUp(sectionRva + static_cast<uint32_t>(contentSize), layout.sectionAlignment));
+    Put<uint32_t>(file, layout.optionalHeader + OPTIONAL_SIZE_OF_INITIALIZED_DATA,
+                  record.sizeOfInitializedData + rawSize);
+    StoreChecksum(file, layout);
+    return PeStatus::Ok;
+}
+
+PeStatus RemovePeImport(std::vector<uint8_t> &file) {
+    Layout layout;
+    if (const PeStatus status = ParseLayout(file, layout); status != PeStatus::Ok) {
+        return status;
+    }
+    const std::optional<PatchRecord> record = FindPatchRecord(file, layout);
+    if (!record) {
+        return PeStatus::NotPatched;
+    }
+    if (record->fileSize > layout.sections.back().rawOffset || record->sectionCount + 1 != layout.sectionCount) {
+        return PeStatus::Malformed;
+    }
+
+    const size_t patchHeader = layout.sectionHeaders + size_t{record->sectionCount} * SECTION_HEADER_SIZE;
+    std::memcpy(file.data() + patchHeader, record->sectionHeaderSlot.data(), SECTION_HEADER_SIZE);
+    Put<uint16_t>(file, layout.fileHeader + 2, record->sectionCount);
+    Put<uint32_t>(file, DirectoryOffset(layout, DIRECTORY_IMPORT), record->importRva);
+    Put<uint32_t>(file, DirectoryOffset(layout, DIRECTORY_IMPORT) + 4, record->importSize);
+    if (layout.directoryCount > DIRECTORY_BOUND_IMPORT) {
+        Put<uint32_t>(file, DirectoryOffset(layout, DIRECTORY_BOUND_IMPORT), record->boundImportRva);
+        Put<uint32_t>(file, DirectoryOffset(layout, DIRECTORY_BOUND_IMPORT) + 4, record->boundImportSize);
+    }
+    Put<uint32_t>(file, layout.optionalHeader + OPTIONAL_SIZE_OF_IMAGE, record->sizeOfImage);
+    Put<uint32_t>(file, layout.optionalHeader + OPTIONAL_SIZE_OF_INITIALIZED_DATA, record->sizeOfInitializedData);
+    Put<uint32_t>(file, layout.optionalHeader + OPTIONAL_CHECKSUM, record->checksum);
+    file.resize(record->fileSize);
+    if (record->checksum != 0 && ComputePeChecksum(file) != record->checksum) {
+        StoreChecksum(file, layout);
+    }
+    return PeStatus::Ok;
+}
\ No newline at end of file
@@ -0,0 +1,87 @@
+#ifndef SPLINTERCELLPATCH_PE_IMAGE_H
+#define SPLINTERCELLPATCH_PE_IMAGE_H
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Offline PE editing, in the spirit of DetourBinaryEditImports: adds a DLL to an executable's import table so the
+// loader maps it before the program starts, and removes it again. Works on the file bytes only (no Windows APIs),
+// so it builds and runs anywhere; fields are read as little-endian.
+//
+// The new import table lives in an extra section appended after every other section. That section also records
+// every header value the patch changed, so removing the import restores the original file byte for byte.
+
+inline constexpr std::array<char, 8> PE_PATCH_SECTION_NAME = {'.', 's', 'c', 'p', 'a', 't', 'c', 'h'};
+
+// IMAGE_FILE_LARGE_ADDRESS_AWARE: the image handles addresses above 2 GiB
+inline constexpr uint16_t PE_LARGE_ADDRESS_AWARE = 0x0020;
+
+enum class PeStatus : uint8_t {
+    Ok,
+    NotPe,           // No MZ/PE signature or unsupported optional header
+    Malformed,       // Headers or the import table point outside the file
+    Signed,          // Has an Authenticode signature, which the patch would invalidate
+    NoHeaderRoom,    // No space left in the headers for another section header
+    AlreadyPatched,
+    AlreadyImported, // Imports the DLL without our patch section
+    NotPatched,
+    AlreadySet,      // The flag already has the requested value
+};
+
+[[nodiscard]] std::string_view PeStatusName(PeStatus status);
+
+struct PeInfo {
+    uint16_t machine = 0;
+    bool pe32Plus = false;
+    uint16_t characteristics = 0;
+    uint32_t sizeOfImage = 0;
+    uint32_t storedChecksum = 0;   // 0 when the linker did not set one
+    uint32_t computedChecksum = 0; // What the checksum should be for the current bytes
+    bool patched = false;          // Has our import section
+    std::vector<std::string> imports; // Imported DLL names, in load order
+};
+
+[[nodiscard]] PeStatus ReadPeInfo(std::span<const uint8_t> file, PeInfo &info);
+
+// User-mode address space the image gets on 64-bit Windows: 2 GiB unless it is large address aware, then 4 GiB
+// for PE32 (under WOW64) and 128 TiB for PE32+. 32-bit Windows grants a large address aware PE32 3 GiB at most,
+// and only when booted with increaseuserva.
+[[nodiscard]] uint64_t PeUserAddressSpace(const PeInfo &info);
+
+// Sets or clears PE_LARGE_ADDRESS_AWARE and updates the checksum
+[[nodiscard]] PeStatus SetPeLargeAddressAware(std::vector<uint8_t> &file, bool enable);
+
+// How the bytes are laid out: as stored on disk, or as mapped by the loader, where RVAs are offsets
+enum class PeView : uint8_t {
+    File,
+    Mapped,
+};
+
+struct PeImportSlot {
+    std::string module;
+    std::string symbol;   // Empty for imports by ordinal
+    uint16_t ordinal = 0; // Set for imports by ordinal
+    uint32_t slotRva = 0; // Import address table entry the loader fills in
+};
+
+// Every imported function with the import address table entry that holds it. Names come from the import lookup
+// table, which the loader leaves alone, so this also works on a running module. Descriptors without a lookup table
+// (some old linkers) can only be read from a file.
+[[nodiscard]] PeStatus ReadPeImportSlots(std::span<const uint8_t> image, PeView view, std::vector<PeImportSlot> &slots);
+
+// The algorithm of CheckSumMappedFile: 16-bit one's-complement sum of the file with the checksum field skipped,
+// plus the file length
+[[nodiscard]] uint32_t ComputePeChecksum(std::span<const uint8_t> file);
+
+// Adds dllName, importing symbol by name, ahead of every other import and updates the checksum
+[[nodiscard]] PeStatus AddPeImport(std::vector<uint8_t> &file, std::string_view dllName, std::string_view symbol);
+
+// Undoes AddPeImport, restoring the original bytes. Header flags changed after the patch (SetPeLargeAddressAware)
+// are kept; the checksum is then recomputed instead of restored.
+[[nodiscard]] PeStatus RemovePeImport(std::vector<uint8_t> &file);
+
+#endif // SPLINTERCELLPATCH_PE_IMAGE_H
\ No newline at end of file
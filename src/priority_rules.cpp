@@ -0,0 +1,34 @@
+#include "priority_rules.h"
+#include <algorithm>
+#include <optional>
+
+namespace {
+
+template <typename Value, size_t N>
+std::optional<size_t> RankOf(const std::array<std::pair<Value, std::string_view>, N> &names, Value value) {
+    const auto it = std::ranges::find(names, value, &std::pair<Value, std::string_view>::first);
+    return it != names.end() ? std::optional<size_t>(static_cast<size_t>(it - names.begin())) : std::nullopt;
+}
+
+} // namespace
+
+uint32_t PriorityRebalancer::RemapPriorityClass(const PriorityRules &rules, uint32_t requested) {
+    const std::optional<size_t> rank = RankOf(PRIORITY_CLASS_NAMES, requested);
+    const std::optional<size_t> maxRank = RankOf(PRIORITY_CLASS_NAMES, rules.maxPriorityClass);
+    if (!rank || !maxRank || *rank <= *maxRank) {
+        return requested;
+    }
+    m_classRemaps[*rank].fetch_add(1, std::memory_order_relaxed);
+    return rules.maxPriorityClass;
+}
+
+int PriorityRebalancer::RemapThreadPriority(const PriorityRules &rules, ThreadRole role, int requested) {
+    const int maxPriority = role == ThreadRole::Main ? rules.maxMainThreadPriority : rules.maxWorkerThreadPriority;
+    const std::optional<size_t> rank = RankOf(THREAD_PRIORITY_NAMES, requested);
+    const std::optional<size_t> maxRank = RankOf(THREAD_PRIORITY_NAMES, maxPriority);
+    if (!rank || !maxRank || *rank <= *maxRank) {
+        return requested;
+    }
+    m_threadRemaps[static_cast<size_t>(role)][*rank].fetch_add(1, std::memory_order_relaxed);
+    return maxPriority;
+}
\ No newline at end of file
@@ -0,0 +1,105 @@
+#ifndef SPLINTERCELLPATCH_PRIORITY_RULES_H
+#define SPLINTERCELLPATCH_PRIORITY_RULES_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+
+// Priority rebalancing. Legacy games raise themselves to REALTIME/HIGH and TIME_CRITICAL, which was harmless on
+// one core but starves the audio stack and input threads once the process runs on every core. Requested
+// priorities are clamped per thread role and every remap is counted.
+
+// Windows priority values, mirrored here so the rules stay platform-neutral
+inline constexpr uint32_t PRIORITY_CLASS_IDLE = 0x00000040;
+inline constexpr uint32_t PRIORITY_CLASS_BELOW_NORMAL = 0x00004000;
+inline constexpr uint32_t PRIORITY_CLASS_NORMAL = 0x00000020;
+inline constexpr uint32_t PRIORITY_CLASS_ABOVE_NORMAL = 0x00008000;
+inline constexpr uint32_t PRIORITY_CLASS_HIGH = 0x00000080;
+inline constexpr uint32_t PRIORITY_CLASS_REALTIME = 0x00000100;
+
+inline constexpr int THREAD_PRIORITY_LEVEL_IDLE = -15;
+inline constexpr int THREAD_PRIORITY_LEVEL_LOWEST = -2;
+inline constexpr int THREAD_PRIORITY_LEVEL_BELOW_NORMAL = -1;
+inline constexpr int THREAD_PRIORITY_LEVEL_NORMAL = 0;
+inline constexpr int THREAD_PRIORITY_LEVEL_ABOVE_NORMAL = 1;
+inline constexpr int THREAD_PRIORITY_LEVEL_HIGHEST = 2;
+inline constexpr int THREAD_PRIORITY_LEVEL_TIME_CRITICAL = 15;
+
+enum class ThreadRole : uint8_t {
+    Main,   // The process's initial thread (game loop)
+    Worker, // Every other thread
+};
+inline constexpr size_t THREAD_ROLE_COUNT = 2;
+
+struct PriorityRules {
+    uint32_t maxPriorityClass = PRIORITY_CLASS_ABOVE_NORMAL;
+    int maxMainThreadPriority = THREAD_PRIORITY_LEVEL_HIGHEST;
+    int maxWorkerThreadPriority = THREAD_PRIORITY_LEVEL_ABOVE_NORMAL;
+};
+
+// Rules are passed on every call so they can be swapped (config reload) while hooks run; only the counters live here
+class PriorityRebalancer {
+public:
+    // Returns the priority class to apply. Unknown values and background-mode requests pass through unchanged.
+    [[nodiscard]] uint32_t RemapPriorityClass(const PriorityRules &rules, uint32_t requested);
+
+    // Returns the thread priority to apply. Unknown values and background-mode requests pass through unchanged.
+    [[nodiscard]] int RemapThreadPriority(const PriorityRules &rules, ThreadRole role, int requested);
+
+    // Calls fn(api, role, requested priority, count) for every remap that fired at least once; role is empty for
+    // priority class remaps
+    template <typename Fn>
+    void ForEachCounter(Fn &&fn) const;
+
+    static constexpr size_t PRIORITY_CLASS_COUNT = 6;
+    static constexpr size_t THREAD_PRIORITY_COUNT = 7;
+
+private:
+    std::array<std::atomic<uint64_t>, PRIORITY_CLASS_COUNT> m_classRemaps = {};
+    std::array<std::array<std::atomic<uint64_t>, THREAD_PRIORITY_COUNT>, THREAD_ROLE_COUNT> m_threadRemaps = {};
+};
+
+// Ordered from lowest to highest
+inline constexpr std::array<std::pair<uint32_t, std::string_view>, PriorityRebalancer::PRIORITY_CLASS_COUNT>
+PRIORITY_CLASS_NAMES = {{
+    {PRIORITY_CLASS_IDLE, "IDLE"},
+    {PRIORITY_CLASS_BELOW_NORMAL, "BELOW_NORMAL"},
+    {PRIORITY_CLASS_NORMAL, "NORMAL"},
+    {PRIORITY_CLASS_ABOVE_NORMAL, "ABOVE_NORMAL"},
+    {PRIORITY_CLASS_HIGH, "HIGH"},
+    {PRIORITY_CLASS_REALTIME, "REALTIME"},
+}};
+
+// Ordered from lowest to highest
+inline constexpr std::array<std::pair<int, std::string_view>, PriorityRebalancer::THREAD_PRIORITY_COUNT>
+THREAD_PRIORITY_NAMES = {{
+    {THREAD_PRIORITY_LEVEL_IDLE, "IDLE"},
+    {THREAD_PRIORITY_LEVEL_LOWEST, "LOWEST"},
+    {THREAD_PRIORITY_LEVEL_BELOW_NORMAL, "BELOW_NORMAL"},
+    {THREAD_PRIORITY_LEVEL_NORMAL, "NORMAL"},
+    {THREAD_PRIORITY_LEVEL_ABOVE_NORMAL, "ABOVE_NORMAL"},
+    {THREAD_PRIORITY_LEVEL_HIGHEST, "HIGHEST"},
+    {THREAD_PRIORITY_LEVEL_TIME_CRITICAL, "TIME_CRITICAL"},
+}};
+
+inline constexpr std::array<std::string_view, THREAD_ROLE_COUNT> THREAD_ROLE_NAMES = {"main", "worker"};
+
+template <typename Fn>
+void PriorityRebalancer::ForEachCounter(Fn &&fn) const {
+    for (size_t i = 0; i < PRIORITY_CLASS_COUNT; ++i) {
+        if (const uint64_t count = m_classRemaps[i].load(std::memory_order_relaxed); count != 0) {
+            fn(std::string_view("SetPriorityClass"), std::string_view{}, PRIORITY_CLASS_NAMES[i].second, count);
+        }
+    }
+    for (size_t role = 0; role < THREAD_ROLE_COUNT; ++role) {
+        for (size_t i = 0; i < THREAD_PRIORITY_COUNT; ++i) {
+            if (const uint64_t count = m_threadRemaps[role][i].load(std::memory_order_relaxed); count != 0) {
+                fn(std::string_view("SetThreadPriority"), THREAD_ROLE_NAMES[role], THREAD_PRIORITY_NAMES[i].second, count);
+            }
+        }
+    }
+}
+
+#endif // SPLINTERCELLPATCH_PRIORITY_RULES_H
\ No newline at end of file
@@ -0,0 +1,60 @@
+#include "processor_groups.h"
+
+bool IsRunningUnderWow64() {
+    BOOL wow64 = FALSE;
+    return IsWow64Process(GetCurrentProcess(), &wow64) && wow64;
+}
+
+bool IsMaskAddressable(const ProcessorSet &processors) {
+    if constexpr (AFFINITY_MASK_BITS >= PROCESSORS_PER_GROUP) {
+        return true;
+    } else {
+        for (uint16_t group = 0; group < processors.GroupCount(); ++group) {
+            if (processors.GroupMask(group) >> AFFINITY_MASK_BITS != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+std::vector<ULONG> ToCpuSetIds(const CpuTopology &topology, const ProcessorSet &processors) {
+    std::vector<ULONG> ids;
+    for (const LogicalProcessor &processor : topology.processors) {
+        if (processor.cpuSetId != 0 && processors.Test(processor.index)) {
+            ids.push_back(processor.cpuSetId);
+        }
+    }
+    return ids;
+}
+
+bool SetProcessCpuSets(HANDLE hProcess, const CpuTopology &topology, const ProcessorSet &processors) {
+    const std::vector<ULONG> ids = ToCpuSetIds(topology, processors);
+    if (ids.empty()) {
+        SetLastError(ERROR_NOT_SUPPORTED);
+        return false;
+    }
+    return SetProcessDefaultCpuSets(hProcess, ids.data(), static_cast<ULONG>(ids.size()));
+}
+
+bool SetThreadCpuSets(HANDLE hThread, const CpuTopology &topology, const ProcessorSet &processors) {
+    const std::vector<ULONG> ids = ToCpuSetIds(topology, processors);
+    if (ids.empty()) {
+        SetLastError(ERROR_NOT_SUPPORTED);
+        return false;
+    }
+    return SetThreadSelectedCpuSets(hThread, ids.data(), static_cast<ULONG>(ids.size()));
+}
+
+bool SetThreadPlacementAffinity(HANDLE hThread, const ThreadPlacement &placement, GROUP_AFFINITY &previous) {
+    const uint16_t group = static_cast<uint16_t>(placement.idealProcessor / PROCESSORS_PER_GROUP);
+    GROUP_AFFINITY affinity = {};
+    affinity.Group = group;
+    affinity.Mask = static_cast<KAFFINITY>(placement.processors.GroupMask(group));
+    if (affinity.Mask == 0) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return false;
+    }
+    previous = {};
+    return SetThreadGroupAffinity(hThread, &affinity, &previous);
+}
\ No newline at end of file
@@ -0,0 +1,29 @@
+#ifndef SPLINTERCELLPATCH_PROCESSOR_GROUPS_H
+#define SPLINTERCELLPATCH_PROCESSOR_GROUPS_H
+
+#include "thread_placement.h"
+#include "topology.h"
+#include <windows.h>
+#include <vector>
+
+// Processor group and CPU Set helpers. Legacy affinity APIs take a single DWORD_PTR, which addresses at most
+// 64 processors of one group (32 in x86/WOW64 builds); these helpers reach every processor on the machine.
+
+// Processors per group that a DWORD_PTR affinity mask can address in this build
+inline constexpr uint32_t AFFINITY_MASK_BITS = sizeof(DWORD_PTR) * 8;
+
+[[nodiscard]] bool IsRunningUnderWow64();
+
+// True if every processor in the set can be expressed in a DWORD_PTR/KAFFINITY mask of its group
+[[nodiscard]] bool IsMaskAddressable(const ProcessorSet &processors);
+
+[[nodiscard]] std::vector<ULONG> ToCpuSetIds(const CpuTopology &topology, const ProcessorSet &processors);
+
+// Default CPU Sets for threads of the process that have no explicit selection; these may span groups
+[[nodiscard]] bool SetProcessCpuSets(HANDLE hProcess, const CpuTopology &topology, const ProcessorSet &processors);
+[[nodiscard]] bool SetThreadCpuSets(HANDLE hThread, const CpuTopology &topology, const ProcessorSet &processors);
+
+// Moves the thread into its placement's processor group; previous receives the thread's former affinity
+[[nodiscard]] bool SetThreadPlacementAffinity(HANDLE hThread, const ThreadPlacement &placement, GROUP_AFFINITY &previous);
+
+#endif // SPLINTERCELLPATCH_PROCESSOR_GROUPS_H
\ No newline at end of file
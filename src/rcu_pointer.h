@@ -0,0 +1,95 @@
+#ifndef SPLINTERCELLPATCH_RCU_POINTER_H
+#define SPLINTERCELLPATCH_RCU_POINTER_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// Read-copy-update pointer to an immutable snapshot. Readers never lock or wait: they count themselves in one of
+// two epoch counters and load the pointer. Publish swaps in the new snapshot, then flips the epoch twice, each time
+// waiting for the readers counted under the previous epoch to leave. After that no reader can still hold the
+// replaced snapshot, so it is freed.
+
+inline constexpr size_t RCU_READER_SHARDS = 16;
+
+template <typename T>
+class RcuPointer {
+    // One counter per cache line; readers pick a shard by thread, so concurrent readers rarely share a line
+    struct ReaderCount {
+        std::atomic<int64_t> count = 0;
+        char padding[56] = {};
+    };
+
+public:
+    // Keeps the snapshot alive until destroyed; hold it for as short as possible, the writer waits for it
+    class ReadGuard {
+    public:
+        ReadGuard(const ReadGuard &) = delete;
+        ReadGuard &operator=(const ReadGuard &) = delete;
+        ~ReadGuard() { m_count.count.fetch_sub(1, std::memory_order_release); }
+
+        [[nodiscard]] const T *Get() const { return m_snapshot; }
+        const T *operator->() const { return m_snapshot; }
+        const T &operator*() const { return *m_snapshot; }
+
+    private:
+        friend class RcuPointer;
+        ReadGuard(ReaderCount &count, const T *snapshot) : m_count(count), m_snapshot(snapshot) {}
+
+        ReaderCount &m_count;
+        const T *m_snapshot;
+    };
+
+    RcuPointer() = default;
+    RcuPointer(const RcuPointer &) = delete;
+    RcuPointer &operator=(const RcuPointer &) = delete;
+    ~RcuPointer() { delete m_current.load(std::memory_order_acquire); }
+
+    // Null until the first Publish
+    [[nodiscard]] ReadGuard Read() const {
+        const size_t shard = std::hash<std::thread::id>{}(std::this_thread::get_id()) % RCU_READER_SHARDS;
+        ReaderCount &count = m_readers[m_epoch.load(std::memory_order_relaxed)][shard];
+
+        // Sequentially consistent with the writer's swap: a reader the writer missed sees the new snapshot
+        count.count.fetch_add(1, std::memory_order_seq_cst);
+        return ReadGuard(count, m_current.load(std::memory_order_seq_cst));
+    }
+
+    // Blocks until no reader holds the replaced snapshot. Publishers are serialized with each other.
+    void Publish(std::unique_ptr<const T> next) {
+        std::lock_guard lock(m_writerMutex);
+        std::unique_ptr<const T> previous(m_current.exchange(next.release(), std::memory_order_seq_cst));
+        if (!previous) {
+            return;
+        }
+
+        // A reader may have picked its epoch just before a flip, so one flip is not enough to drain both counters
+        for (int flip = 0; flip < 2; ++flip) {
+            const uint32_t epoch = m_epoch.load(std::memory_order_relaxed);
+            m_epoch.store(epoch ^ 1, std::memory_order_seq_cst);
+            while (Readers(epoch) != 0) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+private:
+    [[nodiscard]] int64_t Readers(uint32_t epoch) const {
+        int64_t readers = 0;
+        for (const ReaderCount &count : m_readers[epoch]) {
+            readers += count.count.load(std::memory_order_seq_cst);
+        }
+        return readers;
+    }
+
+    std::atomic<const T *> m_current = nullptr;
+    std::atomic<uint32_t> m_epoch = 0;
+    mutable std::array<std::array<ReaderCount, RCU_READER_SHARDS>, 2> m_readers = {};
+    std::mutex m_writerMutex;
+};
+
+#endif // SPLINTERCELLPATCH_RCU_POINTER_H
\ No newline at end of file
@@ -0,0 +1,66 @@
+#include "settings.h"
+#include "string_utils.h"
+#include <utility>
+
+namespace {
+
+constexpr std::pair<PlacementMode, std::string_view> PLACEMENT_MODE_NAMES[] = {
+    {PlacementMode::HardAffinity, "hard-affinity"},
+    {PlacementMode::SoftCpuSets, "soft-cpu-sets"},
+};
+
+constexpr std::pair<HookBackend, std::string_view> HOOK_BACKEND_NAMES[] = {
+    {HookBackend::Detours, "detours"},
+    {HookBackend::ImportTable, "import-table"},
+};
+
+} // namespace
+
+const ExecutableProfile &FindExecutableProfile(std::string_view executablePath) {
+    const size_t separator = executablePath.find_last_of("\\/");
+    const std::string_view fileName =
+        separator == std::string_view::npos ? executablePath : executablePath.substr(separator + 1);
+
+    for (const ExecutableProfile &profile : EXECUTABLE_PROFILES) {
+        if (EqualsIgnoreCase(fileName, profile.executable)) {
+            return profile;
+        }
+    }
+    return DEFAULT_PROFILE;
+}
+
+std::optional<PlacementMode> ParsePlacementMode(std::string_view name) {
+    for (const auto &[mode, modeName] : PLACEMENT_MODE_NAMES) {
+        if (EqualsIgnoreCase(name, modeName)) {
+            return mode;
+        }
+    }
+    return std::nullopt;
+}
+
+std::string_view PlacementModeName(PlacementMode mode) {
+    for (const auto &[candidate, name] : PLACEMENT_MODE_NAMES) {
+        if (candidate == mode) {
+            return name;
+        }
+    }
+    return "unknown";
+}
+
+std::optional<HookBackend> ParseHookBackend(std::string_view name) {
+    for (const auto &[backend, backendName] : HOOK_BACKEND_NAMES) {
+        if (EqualsIgnoreCase(name, backendName)) {
+            return backend;
+        }
+    }
+    return std::nullopt;
+}
+
+std::string_view HookBackendName(HookBackend backend) {
+    for (const auto &[candidate, name] : HOOK_BACKEND_NAMES) {
+        if (candidate == backend) {
+            return name;
+        }
+    }
+    return "unknown";
+}
\ No newline at end of file
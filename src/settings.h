@@ -0,0 +1,66 @@
+#ifndef SPLINTERCELLPATCH_SETTINGS_H
+#define SPLINTERCELLPATCH_SETTINGS_H
+
+#include "cache_locality.h"
+#include "hot_threads.h"
+#include "lock_profiler.h"
+#include "priority_rules.h"
+#include "slab_heap.h"
+#include "spin_tuner.h"
+#include "topology.h"
+#include "trace_writer.h"
+#include <optional>
+#include <string_view>
+
+// Per-executable hook settings. The DLL looks up the profile matching the target's file name
+// and falls back to DEFAULT_PROFILE; SplinterCellPatch.ini can override it (see config_file.h).
+
+enum class PlacementMode {
+    HardAffinity, // Replace the requested mask with the policy mask (SetProcessAffinityMask/SetThreadAffinityMask)
+    SoftCpuSets,  // Leave hard masks alone and express the policy as CPU Set preferences the scheduler can balance
+};
+
+enum class HookBackend {
+    Detours,     // Rewrite the functions themselves, so every caller in the process is intercepted
+    ImportTable, // Rewrite the executable's import address table: no code is patched and no thread is suspended, but
+                 // calls made by other modules or through GetProcAddress bypass the hooks
+};
+
+struct ExecutableProfile {
+    std::string_view executable; // File name of the target, matched case-insensitively
+    AffinityPolicy policy = AffinityPolicy::PhysicalCoresOnly;
+    PlacementMode placement = PlacementMode::HardAffinity;
+    PriorityRules priority = {};
+    HotThreadSettings hotThreads = {};
+    CacheLocalitySettings locality = {};
+    bool monotonicTimers = true; // Clamp QueryPerformanceCounter/GetTickCount/timeGetTime so they never run backwards
+    std::string_view logFile = {}; // Also write the log to this file (relative to the working directory)
+    TraceSettings trace = {};      // Binary trace of every intercepted call
+    bool statistics = true;        // Publish live hook counters for SplinterCellStats (see hook_stats.h)
+    bool control = true;           // Accept SplinterCellControl commands (see control_channel.h)
+    bool suspendAllThreads = true; // Suspend every thread while functions are patched, not only the installing one
+    HookBackend hookBackend = HookBackend::Detours;
+    SlabHeapSettings heap = {};    // Experimental heap replacement, off by default (see slab_heap.h)
+    SpinTuningSettings spinTuning = {}; // Adaptive CRITICAL_SECTION spin counts, off by default (see spin_tuner.h)
+    LockProfilingSettings lockProfiling = {}; // Lock contention report, off by default (see lock_profiler.h)
+};
+
+inline constexpr ExecutableProfile DEFAULT_PROFILE = {.executable = "*"};
+
+inline constexpr ExecutableProfile EXECUTABLE_PROFILES[] = {
+    {.executable = "SplinterCell.exe", .locality = {.enabled = true}},
+    {.executable = "splintercell3.exe", .placement = PlacementMode::SoftCpuSets, .locality = {.enabled = true}},
+};
+
+// Accepts a full path or a bare file name
+[[nodiscard]] const ExecutableProfile &FindExecutableProfile(std::string_view executablePath);
+
+// Mode names are matched case-insensitively: "hard-affinity", "soft-cpu-sets"
+[[nodiscard]] std::optional<PlacementMode> ParsePlacementMode(std::string_view name);
+[[nodiscard]] std::string_view PlacementModeName(PlacementMode mode);
+
+// Backend names are matched case-insensitively: "detours", "import-table"
+[[nodiscard]] std::optional<HookBackend> ParseHookBackend(std::string_view name);
+[[nodiscard]] std::string_view HookBackendName(HookBackend backend);
+
+#endif // SPLINTERCELLPATCH_SETTINGS_H
\ No newline at end of file
@@ -0,0 +1,69 @@
+#include "shared_memory.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+bool SharedMemory::Create(const std::string &name, size_t size) {
+    Close();
+    const std::string path = "/" + name;
+    const int fd = shm_open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    void *data = ftruncate(fd, static_cast<off_t>(size)) == 0
+        ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)
+        : MAP_FAILED;
+    if (data == MAP_FAILED) {
+        close(fd);
+        shm_unlink(path.c_str());
+        return false;
+    }
+    m_handle = fd;
+    m_data = static_cast<std::byte *>(data);
+    m_size = size;
+    m_unlinkName = path;
+    return true;
+}
+
+bool SharedMemory::OpenReadOnly(const std::string &name, size_t size) {
+    Close();
+    const std::string path = "/" + name;
+    const int fd = shm_open(path.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        return false;
+    }
+    // Mapping past the end of the object succeeds but faults on access, so a short section is refused up front, as
+    // MapViewOfFile does
+    struct stat status = {};
+    void *data = fstat(fd, &status) == 0 && static_cast<uint64_t>(status.st_size) >= size
+        ? mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0)
+        : MAP_FAILED;
+    if (data == MAP_FAILED) {
+        close(fd);
+        return false;
+    }
+    m_handle = fd;
+    m_data = static_cast<std::byte *>(data);
+    m_size = size;
+    return true;
+}
+
+void SharedMemory::Close() {
+    if (m_data) {
+        munmap(m_data, m_size);
+        m_data = nullptr;
+    }
+    if (m_handle >= 0) {
+        close(static_cast<int>(m_handle));
+        m_handle = -1;
+    }
+    if (!m_unlinkName.empty()) {
+        shm_unlink(m_unlinkName.c_str());
+        m_unlinkName.clear();
+    }
+    m_size = 0;
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,36 @@
+#ifndef SPLINTERCELLPATCH_SHARED_MEMORY_H
+#define SPLINTERCELLPATCH_SHARED_MEMORY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Named shared-memory section other processes can map by name (a Local\ file mapping on Windows, shm_open
+// elsewhere). The creator's section disappears once it closes it.
+
+class SharedMemory {
+public:
+    SharedMemory() = default;
+    SharedMemory(const SharedMemory &) = delete;
+    SharedMemory &operator=(const SharedMemory &) = delete;
+    ~SharedMemory() { Close(); }
+
+    // Creates a zero-filled read-write section
+    [[nodiscard]] bool Create(const std::string &name, size_t size);
+
+    // Maps an existing section read-only
+    [[nodiscard]] bool OpenReadOnly(const std::string &name, size_t size);
+
+    void Close();
+
+    [[nodiscard]] std::byte *Data() const { return m_data; }
+    [[nodiscard]] size_t Size() const { return m_size; }
+
+private:
+    std::byte *m_data = nullptr;
+    size_t m_size = 0;
+    intptr_t m_handle = -1; // File descriptor or file mapping HANDLE
+    std::string m_unlinkName; // POSIX name to remove on close when this process created the section
+};
+
+#endif // SPLINTERCELLPATCH_SHARED_MEMORY_H
\ No newline at end of file
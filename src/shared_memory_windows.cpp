@@ -0,0 +1,59 @@
+#include "shared_memory.h"
+#include <windows.h>
+
+namespace {
+
+// Sections live in the session namespace, so readers need no privileges
+std::string SectionName(const std::string &name) {
+    return "Local\\" + name;
+}
+
+} // namespace
+
+bool SharedMemory::Create(const std::string &name, size_t size) {
+    Close();
+    const uint64_t size64 = size;
+    HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, static_cast<DWORD>(size64 >> 32),
+                                        static_cast<DWORD>(size64), SectionName(name).c_str());
+    if (!mapping) {
+        return false;
+    }
+    void *data = MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, size);
+    if (!data) {
+        CloseHandle(mapping);
+        return false;
+    }
+    m_handle = reinterpret_cast<intptr_t>(mapping);
+    m_data = static_cast<std::byte *>(data);
+    m_size = size;
+    return true;
+}
+
+bool SharedMemory::OpenReadOnly(const std::string &name, size_t size) {
+    Close();
+    HANDLE mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, SectionName(name).c_str());
+    if (!mapping) {
+        return false;
+    }
+    void *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, size);
+    if (!data) {
+        CloseHandle(mapping);
+        return false;
+    }
+    m_handle = reinterpret_cast<intptr_t>(mapping);
+    m_data = static_cast<std::byte *>(data);
+    m_size = size;
+    return true;
+}
+
+void SharedMemory::Close() {
+    if (m_data) {
+        UnmapViewOfFile(m_data);
+        m_data = nullptr;
+    }
+    if (m_handle != -1) {
+        CloseHandle(reinterpret_cast<HANDLE>(m_handle));
+        m_handle = -1;
+    }
+    m_size = 0;
+}
\ No newline at end of file
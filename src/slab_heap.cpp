@@ -0,0 +1,469 @@
+#include "slab_heap.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <thread>
+
+namespace {
+
+struct SizeClass {
+    uint32_t blockSize = 0;
+    uint32_t blockCount = 0;
+    uint32_t firstBlock = 0; // Offset of the first block, after the requested-size table
+};
+
+constexpr uint32_t ClassBlockSize(size_t sizeClass) {
+    if (sizeClass < 8) {
+        return static_cast<uint32_t>(16 * (sizeClass + 1));
+    }
+    const size_t step = sizeClass - 8;
+    const uint32_t base = 128u << (step / 4);
+    return base + base / 4 * static_cast<uint32_t>(step % 4 + 1);
+}
+
+constexpr std::array<SizeClass, SlabHeap::CLASS_COUNT> SIZE_CLASSES = [] {
+    std::array<SizeClass, SlabHeap::CLASS_COUNT> classes = {};
+    for (size_t i = 0; i < classes.size(); ++i) {
+        SizeClass &sizeClass = classes[i];
+        sizeClass.blockSize = ClassBlockSize(i);
+        sizeClass.blockCount = static_cast<uint32_t>(SlabHeap::SPAN_SIZE / (sizeClass.blockSize + sizeof(uint16_t)));
+        for (;; --sizeClass.blockCount) {
+            sizeClass.firstBlock = (sizeClass.blockCount * static_cast<uint32_t>(sizeof(uint16_t)) + 15) / 16 * 16;
+            if (sizeClass.firstBlock + sizeClass.blockCount * sizeClass.blockSize <= SlabHeap::SPAN_SIZE) {
+                break;
+            }
+        }
+    }
+    return classes;
+}();
+static_assert(SIZE_CLASSES.back().blockSize == SlabHeap::MAX_BLOCK_SIZE);
+static_assert(SIZE_CLASSES.back().blockCount >= 3);
+
+size_t SizeClassOf(size_t size) {
+    if (size <= 128) {
+        return size == 0 ? 0 : (size - 1) / 16;
+    }
+    const size_t last = size - 1;
+    const size_t log2 = std::bit_width(last) - 1;
+    const size_t base = size_t{1} << log2;
+    return 8 + (log2 - 7) * 4 + (last - base) / (base / 4);
+}
+
+// Free blocks are linked through their first word
+void *&NextFree(void *block) {
+    return *static_cast<void **>(block);
+}
+
+constexpr uint8_t METADATA_CLASS = 0xFF; // Spans holding thread cache records
+
+} // namespace
+
+// Every field except remoteFree and owner is only touched by the owning thread, or under the lock while the span is
+// unowned
+struct alignas(64) SlabHeap::Span {
+    std::atomic<void *> remoteFree = nullptr;  // Blocks freed by other threads
+    std::atomic<ThreadHeap *> owner = nullptr; // Null while pooled or abandoned
+    void *localFree = nullptr;
+    uint32_t prev = NO_SPAN; // Owner's list for the size class
+    uint32_t next = NO_SPAN; // Owner's list, or the pool / abandoned list
+    uint32_t carved = 0;     // Blocks handed out so far by bumping; the rest of the span has never been touched
+    uint32_t used = 0;       // Blocks allocated and not yet freed back to the owner
+    uint8_t sizeClass = 0;
+};
+
+struct SlabHeap::ThreadHeap {
+    SlabHeap *heap = nullptr;
+    std::array<uint32_t, CLASS_COUNT> spans = {}; // Most recently used span per class first
+    ThreadHeap *nextFree = nullptr;
+};
+
+thread_local SlabHeap::ThreadHeap *SlabHeap::t_threadHeap = nullptr;
+thread_local SlabHeap::ThreadState SlabHeap::t_threadState = SlabHeap::ThreadState::None;
+thread_local SlabHeap::ThreadExit SlabHeap::t_threadExit;
+
+SlabHeap::ThreadExit::~ThreadExit() {
+    if (t_threadState == ThreadState::Live) {
+        t_threadHeap->heap->Abandon(*t_threadHeap);
+    }
+    t_threadHeap = nullptr;
+    t_threadState = ThreadState::Exited;
+}
+
+SlabHeap::~SlabHeap() {
+    if (m_size != 0) {
+        ReleaseArena(reinterpret_cast<std::byte *>(m_base), m_size);
+    }
+}
+
+bool SlabHeap::Create(size_t arenaBytes) {
+    const size_t spanCount = std::min<size_t>(arenaBytes / SPAN_SIZE, NO_SPAN);
+    const size_t metadataSpans = (spanCount * sizeof(Span) + SPAN_SIZE - 1) / SPAN_SIZE;
+    if (m_size != 0 || spanCount <= metadataSpans + 1) {
+        return false;
+    }
+    std::byte *arena = ReserveArena(spanCount * SPAN_SIZE);
+    if (!arena) {
+        return false;
+    }
+    if (!CommitArena(arena, metadataSpans * SPAN_SIZE)) {
+        ReleaseArena(arena, spanCount * SPAN_SIZE);
+        return false;
+    }
+
+    m_spans = reinterpret_cast<Span *>(arena);
+    std::uninitialized_default_construct_n(m_spans, spanCount);
+    m_spanCount = static_cast<uint32_t>(spanCount);
+    m_nextSpan = static_cast<uint32_t>(metadataSpans);
+    for (size_t i = 0; i < metadataSpans; ++i) {
+        m_spans[i].sizeClass = METADATA_CLASS;
+    }
+    m_base = reinterpret_cast<uintptr_t>(arena);
+    m_size = spanCount * SPAN_SIZE;
+    return true;
+}
+
+void SlabHeap::Lock() const {
+    while (m_locked.exchange(true, std::memory_order_acquire)) {
+        while (m_locked.load(std::memory_order_relaxed)) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void SlabHeap::Unlock() const {
+    m_locked.store(false, std::memory_order_release);
+}
+
+std::byte *SlabHeap::SpanData(uint32_t index) const {
+    return reinterpret_cast<std::byte *>(m_base) + size_t{index} * SPAN_SIZE;
+}
+
+uint32_t SlabHeap::SpanIndex(const void *block) const {
+    return static_cast<uint32_t>((reinterpret_cast<uintptr_t>(block) - m_base) / SPAN_SIZE);
+}
+
+uint16_t *SlabHeap::SizeSlot(const void *block) const {
+    const uint32_t index = SpanIndex(block);
+    const SizeClass &sizeClass = SIZE_CLASSES[m_spans[index].sizeClass];
+    std::byte *data = SpanData(index);
+    const auto offset = static_cast<uint32_t>(static_cast<const std::byte *>(block) - data);
+    return reinterpret_cast<uint16_t *>(data) + (offset - sizeClass.firstBlock) / sizeClass.blockSize;
+}
+
+SlabHeap::ThreadHeap *SlabHeap::CurrentThreadHeap() {
+    if (t_threadState == ThreadState::Live) {
+        return t_threadHeap->heap == this ? t_threadHeap : nullptr;
+    }
+    if (t_threadState != ThreadState::None) {
+        return nullptr;
+    }
+
+    // Registering the exit destructor may itself allocate
+    t_threadState = ThreadState::Initializing;
+    t_threadExit.armed = true;
+
+    Lock();
+    ThreadHeap *heap = m_freeThreadHeaps;
+    if (heap) {
+        m_freeThreadHeaps = heap->nextFree;
+    } else {
+        if (m_threadHeapEnd - m_threadHeapCursor < static_cast<ptrdiff_t>(sizeof(ThreadHeap))) {
+            const uint32_t index = NewSpan();
+            if (index != NO_SPAN) {
+                m_spans[index].sizeClass = METADATA_CLASS;
+                m_threadHeapCursor = SpanData(index);
+                m_threadHeapEnd = m_threadHeapCursor + SPAN_SIZE;
+            }
+        }
+        if (m_threadHeapEnd - m_threadHeapCursor >= static_cast<ptrdiff_t>(sizeof(ThreadHeap))) {
+            heap = reinterpret_cast<ThreadHeap *>(m_threadHeapCursor);
+            m_threadHeapCursor += sizeof(ThreadHeap);
+        }
+    }
+    if (heap) {
+        new (heap) ThreadHeap{this, {}, nullptr};
+        heap->spans.fill(NO_SPAN);
+        ++m_threadCaches;
+    }
+    Unlock();
+
+    t_threadHeap = heap;
+    t_threadState = heap ? ThreadState::Live : ThreadState::None;
+    return heap;
+}
+
+// Moves the remote free queue onto the local list. The whole queue is taken at once: pushers only ever add to the
+// head, so there is no ABA to worry about.
+bool SlabHeap::CollectRemoteFrees(Span &span) {
+    if (!span.remoteFree.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    void *block = span.remoteFree.exchange(nullptr, std::memory_order_acquire);
+    while (block) {
+        void *next = NextFree(block);
+        NextFree(block) = span.localFree;
+        span.localFree = block;
+        --span.used;
+        block = next;
+    }
+    return true;
+}
+
+void *SlabHeap::TakeBlock(uint32_t index) {
+    Span &span = m_spans[index];
+    if (!span.localFree) {
+        const SizeClass &sizeClass = SIZE_CLASSES[span.sizeClass];
+        if (span.carved < sizeClass.blockCount) {
+            ++span.used;
+            return SpanData(index) + sizeClass.firstBlock + size_t{span.carved++} * sizeClass.blockSize;
+        }
+        if (!CollectRemoteFrees(span)) {
+            return nullptr;
+        }
+    }
+    void *block = span.localFree;
+    span.localFree = NextFree(block);
+    ++span.used;
+    return block;
+}
+
+void *SlabHeap::Allocate(size_t size) {
+    if (size > MAX_BLOCK_SIZE) {
+        return nullptr;
+    }
+    ThreadHeap *heap = CurrentThreadHeap();
+    if (!heap) {
+        return nullptr;
+    }
+    const size_t sizeClass = SizeClassOf(size);
+    const uint32_t first = heap->spans[sizeClass];
+    void *block = first != NO_SPAN ? TakeBlock(first) : nullptr;
+    if (!block) {
+        block = AllocateSlow(*heap, sizeClass);
+        if (!block) {
+            return nullptr;
+        }
+    }
+    *SizeSlot(block) = static_cast<uint16_t>(size);
+    return block;
+}
+
+// The first span is exhausted: use the next one with a free block, moving it to the front, or a new one
+void *SlabHeap::AllocateSlow(ThreadHeap &heap, size_t sizeClass) {
+    const uint32_t first = heap.spans[sizeClass];
+    for (uint32_t index = first != NO_SPAN ? m_spans[first].next : NO_SPAN; index != NO_SPAN;
+         index = m_spans[index].next) {
+        if (void *block = TakeBlock(index)) {
+            Unlink(heap, sizeClass, index);
+            LinkFront(heap, sizeClass, index);
+            return block;
+        }
+    }
+    const uint32_t index = AcquireSpan(heap, sizeClass);
+    if (index == NO_SPAN) {
+        return nullptr;
+    }
+    LinkFront(heap, sizeClass, index);
+    return TakeBlock(index);
+}
+
+// An abandoned span of the class first, as it still holds blocks, then a pooled one, then a new one
+uint32_t SlabHeap::AcquireSpan(ThreadHeap &heap, size_t sizeClass) {
+    Lock();
+    // Blocks of abandoned spans keep being freed by other threads; spans that got every block back are pooled here
+    uint32_t index = NO_SPAN;
+    for (uint32_t *link = &m_abandoned; *link != NO_SPAN;) {
+        Span &span = m_spans[*link];
+        CollectRemoteFrees(span);
+        if (span.used != 0 && (index != NO_SPAN || span.sizeClass != sizeClass)) {
+            link = &span.next;
+            continue;
+        }
+        const uint32_t found = *link;
+        *link = span.next;
+        --m_abandonedSpans;
+        if (span.used == 0) {
+            span.next = m_pool;
+            m_pool = found;
+            ++m_pooledSpans;
+        } else {
+            index = found;
+        }
+    }
+    if (index == NO_SPAN) {
+        index = NewSpan();
+        if (index != NO_SPAN) {
+            Span &span = m_spans[index];
+            span.localFree = nullptr;
+            span.carved = 0;
+            span.used = 0;
+            span.sizeClass = static_cast<uint8_t>(sizeClass);
+        }
+    }
+    if (index != NO_SPAN) {
+        m_spans[index].owner.store(&heap, std::memory_order_relaxed);
+    }
+    Unlock();
+    return index;
+}
+
+uint32_t SlabHeap::NewSpan() {
+    if (m_pool != NO_SPAN) {
+        const uint32_t index = m_pool;
+        m_pool = m_spans[index].next;
+        --m_pooledSpans;
+        return index;
+    }
+    if (m_nextSpan >= m_spanCount || !CommitArena(SpanData(m_nextSpan), SPAN_SIZE)) {
+        return NO_SPAN;
+    }
+    return m_nextSpan++;
+}
+
+void SlabHeap::LinkFront(ThreadHeap &heap, size_t sizeClass, uint32_t index) {
+    Span &span = m_spans[index];
+    span.prev = NO_SPAN;
+    span.next = heap.spans[sizeClass];
+    if (span.next != NO_SPAN) {
+        m_spans[span.next].prev = index;
+    }
+    heap.spans[sizeClass] = index;
+}
+
+void SlabHeap::Unlink(ThreadHeap &heap, size_t sizeClass, uint32_t index) {
+    Span &span = m_spans[index];
+    if (span.prev != NO_SPAN) {
+        m_spans[span.prev].next = span.next;
+    } else {
+        heap.spans[sizeClass] = span.next;
+    }
+    if (span.next != NO_SPAN) {
+        m_spans[span.next].prev = span.prev;
+    }
+    span.prev = NO_SPAN;
+    span.next = NO_SPAN;
+}
+
+void SlabHeap::Free(void *block) {
+    const uint32_t index = SpanIndex(block);
+    Span &span = m_spans[index];
+    ThreadHeap *heap = t_threadState == ThreadState::Live ? t_threadHeap : nullptr;
+    if (heap && span.owner.load(std::memory_order_relaxed) == heap) {
+        NextFree(block) = span.localFree;
+        span.localFree = block;
+        // The front span stays even when empty, so a thread freeing and allocating one block does not churn spans
+        if (--span.used == 0 && heap->spans[span.sizeClass] != index) {
+            ReleaseSpan(*heap, index);
+        }
+        return;
+    }
+
+    void *head = span.remoteFree.load(std::memory_order_relaxed);
+    do {
+        NextFree(block) = head;
+    } while (!span.remoteFree.compare_exchange_weak(head, block, std::memory_order_release,
+                                                    std::memory_order_relaxed));
+}
+
+// No block of the span is in use, so no other thread can push to it any more
+void SlabHeap::ReleaseSpan(ThreadHeap &heap, uint32_t index) {
+    Span &span = m_spans[index];
+    Unlink(heap, span.sizeClass, index);
+    span.owner.store(nullptr, std::memory_order_relaxed);
+    Lock();
+    span.next = m_pool;
+    m_pool = index;
+    ++m_pooledSpans;
+    Unlock();
+}
+
+void SlabHeap::Abandon(ThreadHeap &heap) {
+    Lock();
+    for (uint32_t &first : heap.spans) {
+        for (uint32_t index = first; index != NO_SPAN;) {
+            Span &span = m_spans[index];
+            const uint32_t next = span.next;
+            span.owner.store(nullptr, std::memory_order_relaxed);
+            span.prev = NO_SPAN;
+            CollectRemoteFrees(span);
+            if (span.used == 0) {
+                span.next = m_pool;
+                m_pool = index;
+                ++m_pooledSpans;
+            } else {
+                span.next = m_abandoned;
+                m_abandoned = index;
+                ++m_abandonedSpans;
+            }
+            index = next;
+        }
+        first = NO_SPAN;
+    }
+    heap.nextFree = m_freeThreadHeaps;
+    m_freeThreadHeaps = &heap;
+    --m_threadCaches;
+    Unlock();
+}
+
+size_t SlabHeap::Size(const void *block) const {
+    return *SizeSlot(block);
+}
+
+bool SlabHeap::Resize(void *block, size_t size) {
+    if (size > SIZE_CLASSES[m_spans[SpanIndex(block)].sizeClass].blockSize) {
+        return false;
+    }
+    *SizeSlot(block) = static_cast<uint16_t>(size);
+    return true;
+}
+
+void *SlabHeap::Reallocate(void *block, size_t size) {
+    if (size > MAX_BLOCK_SIZE) {
+        return nullptr;
+    }
+    // A block shrinking to a much smaller class moves, so it does not pin a large block
+    const size_t oldSize = Size(block);
+    if (SizeClassOf(size) + 4 >= m_spans[SpanIndex(block)].sizeClass && Resize(block, size)) {
+        return block;
+    }
+    void *moved = Allocate(size);
+    if (!moved) {
+        return nullptr;
+    }
+    std::memcpy(moved, block, std::min(oldSize, size));
+    Free(block);
+    return moved;
+}
+
+SlabHeap::Statistics SlabHeap::Snapshot() const {
+    Lock();
+    Statistics statistics;
+    statistics.threadCaches = m_threadCaches;
+    statistics.spansPeak = m_nextSpan;
+    statistics.spansTotal = m_spanCount;
+    statistics.spansUsed = m_nextSpan - m_pooledSpans;
+    statistics.spansAbandoned = m_abandonedSpans;
+    Unlock();
+    return statistics;
+}
+
+#ifndef _WIN32
+#include <sys/mman.h>
+
+// Pages are committed by the kernel on first touch
+std::byte *SlabHeap::ReserveArena(size_t size) {
+    void *address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    return address == MAP_FAILED ? nullptr : static_cast<std::byte *>(address);
+}
+
+bool SlabHeap::CommitArena(std::byte *, size_t) {
+    return true;
+}
+
+void SlabHeap::ReleaseArena(std::byte *address, size_t size) {
+    munmap(address, size);
+}
+#endif
\ No newline at end of file
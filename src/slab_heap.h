@@ -0,0 +1,132 @@
+#ifndef SPLINTERCELLPATCH_SLAB_HEAP_H
+#define SPLINTERCELLPATCH_SLAB_HEAP_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Thread-caching size-class allocator standing in for the process heap and the CRT heap (see library.cpp). Legacy
+// heaps serialize every call on one lock; here each thread allocates from spans it owns without any atomic
+// operation, and a block freed by another thread is pushed lock-free onto its span's remote free queue, which the
+// owner takes over in one exchange once its local list runs dry.
+//
+// Every block lives in one reserved arena, so Owns() tells the hooks which allocator a pointer belongs to. The
+// arena is cut into 64 KiB spans; each span serves one size class and starts with a table of requested sizes, so
+// Size() reports exactly what was asked for, as HeapSize and _msize do. Spans a thread no longer uses go back to a
+// shared pool, and the spans of an exiting thread are adopted by the next thread that needs their size class.
+
+struct SlabHeapSettings {
+    bool enabled = false;     // Route process heap and CRT allocations to the slab heap
+    uint32_t arenaMiB = 256;  // Address space reserved for the arena; allocations fall back once it is used up
+};
+
+class SlabHeap {
+public:
+    static constexpr size_t SPAN_SIZE = 64 * 1024;
+    static constexpr size_t MAX_BLOCK_SIZE = 16 * 1024; // Larger requests are left to the original heap
+    static constexpr size_t CLASS_COUNT = 36;           // 16-byte steps to 128, then four classes per doubling
+
+    SlabHeap() = default;
+    SlabHeap(const SlabHeap &) = delete;
+    SlabHeap &operator=(const SlabHeap &) = delete;
+    ~SlabHeap(); // Releases the arena; only call once no block is used any more
+
+    // Reserves the arena. Thread caches bind to the first SlabHeap a thread allocates from, so a process normally
+    // has one.
+    [[nodiscard]] bool Create(size_t arenaBytes);
+
+    // Lock-free and valid before Create (nothing is owned then)
+    [[nodiscard]] bool Owns(const void *block) const {
+        return reinterpret_cast<uintptr_t>(block) - m_base < m_size;
+    }
+
+    // Null when the size is above MAX_BLOCK_SIZE, the arena is used up, or the calling thread is exiting; the caller
+    // then uses the original heap
+    [[nodiscard]] void *Allocate(size_t size);
+
+    // block must be owned; any thread may free it
+    void Free(void *block);
+
+    // Size requested for an owned block
+    [[nodiscard]] size_t Size(const void *block) const;
+
+    // Changes the recorded size when the block can hold it, without ever moving it
+    [[nodiscard]] bool Resize(void *block, size_t size);
+
+    // Resizes in place when the size class allows it, else moves the block. Null when the new size cannot come from
+    // the slab heap, in which case the block is left untouched.
+    [[nodiscard]] void *Reallocate(void *block, size_t size);
+
+    struct Statistics {
+        uint32_t threadCaches = 0; // Threads currently owning spans
+        uint32_t spansUsed = 0;    // Spans holding blocks, owned by a thread or holding metadata
+        uint32_t spansPeak = 0;    // Spans ever carved from the arena (including metadata)
+        uint32_t spansTotal = 0;
+        uint32_t spansAbandoned = 0; // Left by exited threads with blocks still in use
+    };
+    [[nodiscard]] Statistics Snapshot() const;
+
+private:
+    struct Span;
+    struct ThreadHeap;
+
+    static constexpr uint32_t NO_SPAN = UINT32_MAX;
+
+    // Destructor runs when a thread exits and hands its spans back
+    struct ThreadExit {
+        bool armed = false;
+        ~ThreadExit();
+    };
+    enum class ThreadState : uint8_t {
+        None,
+        Initializing, // Allocations made while the thread cache is set up go to the original heap
+        Live,
+        Exited,
+    };
+
+    [[nodiscard]] ThreadHeap *CurrentThreadHeap();
+    [[nodiscard]] std::byte *SpanData(uint32_t index) const;
+    [[nodiscard]] uint32_t SpanIndex(const void *block) const;
+    [[nodiscard]] uint16_t *SizeSlot(const void *block) const;
+    static bool CollectRemoteFrees(Span &span);
+    [[nodiscard]] void *TakeBlock(uint32_t index);
+    [[nodiscard]] void *AllocateSlow(ThreadHeap &heap, size_t sizeClass);
+    [[nodiscard]] uint32_t AcquireSpan(ThreadHeap &heap, size_t sizeClass);
+    [[nodiscard]] uint32_t NewSpan(); // Under the lock
+    void LinkFront(ThreadHeap &heap, size_t sizeClass, uint32_t index);
+    void Unlink(ThreadHeap &heap, size_t sizeClass, uint32_t index);
+    void ReleaseSpan(ThreadHeap &heap, uint32_t index);
+    void Abandon(ThreadHeap &heap);
+
+    // Guards the span pool, the abandoned list and thread cache records. Taken only when a thread needs a new span,
+    // starts or exits. A spin lock because it may be taken inside HeapAlloc, where a lock that allocates recurses.
+    void Lock() const;
+    void Unlock() const;
+
+    // Platform layer: reserve address space, commit part of it, release it
+    [[nodiscard]] static std::byte *ReserveArena(size_t size);
+    [[nodiscard]] static bool CommitArena(std::byte *address, size_t size);
+    static void ReleaseArena(std::byte *address, size_t size);
+
+    static thread_local ThreadHeap *t_threadHeap;
+    static thread_local ThreadState t_threadState;
+    static thread_local ThreadExit t_threadExit;
+
+    uintptr_t m_base = 0;
+    size_t m_size = 0;
+    Span *m_spans = nullptr;
+    uint32_t m_spanCount = 0;
+
+    mutable std::atomic<bool> m_locked = false;
+    uint32_t m_nextSpan = 0;        // First span never carved
+    uint32_t m_pool = NO_SPAN;      // Free spans, linked through Span::next
+    uint32_t m_abandoned = NO_SPAN; // Spans of exited threads, linked through Span::next
+    uint32_t m_pooledSpans = 0;
+    uint32_t m_abandonedSpans = 0;
+    ThreadHeap *m_freeThreadHeaps = nullptr;
+    std::byte *m_threadHeapCursor = nullptr; // Carving thread cache records from a metadata span
+    std::byte *m_threadHeapEnd = nullptr;
+    uint32_t m_threadCaches = 0;
+};
+
+#endif // SPLINTERCELLPATCH_SLAB_HEAP_H
\ No newline at end of file
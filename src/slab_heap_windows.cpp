@@ -0,0 +1,15 @@
+#include "slab_heap.h"
+#include <windows.h>
+
+// Reserved up front so Owns() is a range check; spans are committed as they are first carved
+std::byte *SlabHeap::ReserveArena(size_t size) {
+    return static_cast<std::byte *>(VirtualAlloc(nullptr, size, MEM_RESERVE, PAGE_NOACCESS));
+}
+
+bool SlabHeap::CommitArena(std::byte *address, size_t size) {
+    return VirtualAlloc(address, size, MEM_COMMIT, PAGE_READWRITE) != nullptr;
+}
+
+void SlabHeap::ReleaseArena(std::byte *address, size_t) {
+    VirtualFree(address, 0, MEM_RELEASE);
+}
\ No newline at end of file
@@ -0,0 +1,99 @@
+#include "spin_tuner.h"
+#include <algorithm>
+
+bool SpinTuner::Create(const SpinTuningSettings &settings, uint64_t ticksPerSecond) {
+    if (ticksPerSecond == 0 || settings.minSpinCount > settings.maxSpinCount || !m_locks.Create(settings.maxLocks)) {
+        return false;
+    }
+    m_settings = settings;
+    m_settings.initialSpinCount = std::clamp(settings.initialSpinCount, settings.minSpinCount, settings.maxSpinCount);
+    m_ticksPerSecond = ticksPerSecond;
+    return true;
+}
+
+void SpinTuner::Reset(LockState &state, uint32_t spinCount) const {
+    state.spinCount.store(spinCount, std::memory_order_relaxed);
+    state.averageWaitNs.store(0, std::memory_order_relaxed);
+    state.contended.store(0, std::memory_order_relaxed);
+    state.raised.store(0, std::memory_order_relaxed);
+    state.lowered.store(0, std::memory_order_relaxed);
+}
+
+uint32_t SpinTuner::Initialize(const void *lock, uint32_t requested) {
+    const uint32_t spinCount = requested != 0
+                                   ? std::clamp(requested, m_settings.minSpinCount, m_settings.maxSpinCount)
+                                   : m_settings.initialSpinCount;
+    bool inserted = false;
+    if (LockState *state = m_locks.FindOrInsert(lock, inserted)) {
+        Reset(*state, spinCount);
+    } else {
+        m_full.store(true, std::memory_order_relaxed);
+    }
+    return spinCount;
+}
+
+// Updates race between threads entering the same lock; a lost sample only delays the next decision
+std::optional<uint32_t> SpinTuner::RecordContended(const void *lock, uint64_t ticks) {
+    bool inserted = false;
+    LockState *state = m_locks.FindOrInsert(lock, inserted);
+    if (!state) {
+        m_full.store(true, std::memory_order_relaxed);
+        return std::nullopt;
+    }
+    if (inserted) {
+        Reset(*state, m_settings.initialSpinCount);
+    }
+
+    // Clamped before converting, so the multiplication cannot overflow
+    const uint64_t waitNs = ticks >= m_ticksPerSecond * 4
+                                ? UINT32_MAX
+                                : std::min<uint64_t>(ticks * 1'000'000'000 / m_ticksPerSecond, UINT32_MAX);
+    const uint32_t average = state->averageWaitNs.load(std::memory_order_relaxed);
+    const int64_t delta = (static_cast<int64_t>(waitNs) - static_cast<int64_t>(average)) / 8;
+    const auto updated = static_cast<uint32_t>(static_cast<int64_t>(average) + delta);
+    state->averageWaitNs.store(updated, std::memory_order_relaxed);
+
+    const uint64_t contended = state->contended.fetch_add(1, std::memory_order_relaxed) + 1;
+    if (inserted) {
+        return m_settings.initialSpinCount;
+    }
+    if (contended % ADAPT_INTERVAL != 0) {
+        return std::nullopt;
+    }
+
+    const uint32_t spinCount = state->spinCount.load(std::memory_order_relaxed);
+    uint32_t next = spinCount;
+    if (updated < SHORT_WAIT_NS) {
+        next = static_cast<uint32_t>(std::min<uint64_t>(uint64_t{spinCount} * 2 + 64, m_settings.maxSpinCount));
+    } else if (updated > LONG_WAIT_NS) {
+        next = std::max(spinCount / 2, m_settings.minSpinCount);
+    }
+    if (next == spinCount) {
+        return std::nullopt;
+    }
+    state->spinCount.store(next, std::memory_order_relaxed);
+    (next > spinCount ? state->raised : state->lowered).fetch_add(1, std::memory_order_relaxed);
+    return next;
+}
+
+std::vector<SpinTuner::LockSummary> SpinTuner::MostContended(size_t count) const {
+    std::vector<LockSummary> locks;
+    m_locks.ForEach([&](const void *lock, const LockState &state) {
+        const uint64_t contended = state.contended.load(std::memory_order_relaxed);
+        if (contended == 0) {
+            return;
+        }
+        locks.push_back({
+            lock, state.spinCount.load(std::memory_order_relaxed), state.averageWaitNs.load(std::memory_order_relaxed),
+            contended, state.raised.load(std::memory_order_relaxed), state.lowered.load(std::memory_order_relaxed)
+        });
+    });
+    const auto byContention = [](const LockSummary &a, const LockSummary &b) { return a.contended > b.contended; };
+    if (locks.size() > count) {
+        std::ranges::partial_sort(locks, locks.begin() + static_cast<ptrdiff_t>(count), byContention);
+        locks.resize(count);
+    } else {
+        std::ranges::sort(locks, byContention);
+    }
+    return locks;
+}
\ No newline at end of file
@@ -0,0 +1,79 @@
+#ifndef SPLINTERCELLPATCH_SPIN_TUNER_H
+#define SPLINTERCELLPATCH_SPIN_TUNER_H
+
+#include "address_table.h"
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+// Adaptive CRITICAL_SECTION spin counts. Legacy code initializes its locks without a spin count, so on many cores
+// every contended enter goes straight to a kernel wait and a wake-up that cost more than most of the game's lock
+// holds. Every lock gets a spin count when it is initialized (or first seen contended), which is then tuned per lock.
+//
+// Only contended enters are observed: the hook tries the lock first and takes no measurement when that succeeds.
+// How long a contended enter waits is the rest of the owner's hold time, so it stands in for the hold time:
+// - waits that stay short mean the owner lets go within a spin, so the spin count grows and more enters avoid the
+//   kernel;
+// - waits that stay long mean spinning only burns the core before blocking anyway, so the spin count shrinks.
+// Decisions are made every ADAPT_INTERVAL contended enters from a moving average of the wait.
+
+struct SpinTuningSettings {
+    bool enabled = false;
+    uint32_t initialSpinCount = 4000; // What the Windows heap uses for its own lock
+    uint32_t minSpinCount = 0;
+    uint32_t maxSpinCount = 64000;
+    uint32_t maxLocks = 4096; // Locks tracked; later ones keep the initial spin count
+};
+
+class SpinTuner {
+public:
+    static constexpr uint32_t ADAPT_INTERVAL = 32;
+    static constexpr uint64_t SHORT_WAIT_NS = 10'000;  // About the cost of a kernel wait and wake-up
+    static constexpr uint64_t LONG_WAIT_NS = 200'000;
+
+    struct LockState {
+        std::atomic<uint32_t> spinCount = 0;
+        std::atomic<uint32_t> averageWaitNs = 0;
+        std::atomic<uint64_t> contended = 0;
+        std::atomic<uint32_t> raised = 0;
+        std::atomic<uint32_t> lowered = 0;
+    };
+
+    // ticksPerSecond converts the wait times passed to RecordContended
+    [[nodiscard]] bool Create(const SpinTuningSettings &settings, uint64_t ticksPerSecond);
+    [[nodiscard]] bool Active() const { return m_locks.Active(); }
+
+    // The spin count to give a lock on initialization: the one the caller asked for, if any, within the configured
+    // range, else the initial one. Resets a lock whose address is reused.
+    uint32_t Initialize(const void *lock, uint32_t requested = 0);
+
+    // Records a contended enter that waited `ticks`. Returns the spin count to apply when it changes; a lock seen
+    // for the first time gets the initial one.
+    [[nodiscard]] std::optional<uint32_t> RecordContended(const void *lock, uint64_t ticks);
+
+    struct LockSummary {
+        const void *lock = nullptr;
+        uint32_t spinCount = 0;
+        uint32_t averageWaitNs = 0;
+        uint64_t contended = 0;
+        uint32_t raised = 0;
+        uint32_t lowered = 0;
+    };
+
+    // Most contended first, at most `count`
+    [[nodiscard]] std::vector<LockSummary> MostContended(size_t count) const;
+
+    [[nodiscard]] size_t TrackedLocks() const { return m_locks.Size(); }
+    [[nodiscard]] bool Full() const { return m_full.load(std::memory_order_relaxed); }
+
+private:
+    void Reset(LockState &state, uint32_t spinCount) const;
+
+    SpinTuningSettings m_settings;
+    uint64_t m_ticksPerSecond = 0;
+    AddressTable<LockState> m_locks;
+    std::atomic<bool> m_full = false; // An insert was refused
+};
+
+#endif // SPLINTERCELLPATCH_SPIN_TUNER_H
\ No newline at end of file
@@ -0,0 +1,14 @@
+#ifndef SPLINTERCELLPATCH_STRING_UTILS_H
+#define SPLINTERCELLPATCH_STRING_UTILS_H
+
+#include <algorithm>
+#include <cctype>
+#include <string_view>
+
+inline bool EqualsIgnoreCase(std::string_view a, std::string_view b) {
+    return std::ranges::equal(a, b, [](char x, char y) {
+        return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+    });
+}
+
+#endif // SPLINTERCELLPATCH_STRING_UTILS_H
\ No newline at end of file
@@ -0,0 +1,118 @@
+#include "thread_placement.h"
+#include <algorithm>
+#include <atomic>
+#include <map>
+
+std::vector<ThreadPlacement> OrderCoresBySpeed(const CpuTopology &topology, const ProcessorSet &allowed) {
+    struct Candidate {
+        uint8_t efficiencyClass = 0;
+        uint8_t schedulingClass = 0;
+        uint32_t firstIndex = 0;
+        ThreadPlacement placement;
+    };
+
+    std::map<uint32_t, Candidate> cores; // physical core -> candidate
+    for (const LogicalProcessor &processor : topology.processors) {
+        if (!allowed.Test(processor.index)) {
+            continue;
+        }
+        auto [it, inserted] = cores.try_emplace(processor.core);
+        Candidate &candidate = it->second;
+        if (inserted) {
+            candidate.efficiencyClass = processor.efficiencyClass;
+            candidate.firstIndex = processor.index;
+            candidate.placement.idealProcessor = processor.index;
+        }
+        if (processor.smtPrimary) {
+            candidate.placement.idealProcessor = processor.index;
+        }
+        candidate.schedulingClass = std::max(candidate.schedulingClass, processor.schedulingClass);
+        candidate.placement.processors.Set(processor.index);
+    }
+
+    std::vector<Candidate> ordered;
+    for (auto &[core, candidate] : cores) {
+        ordered.push_back(std::move(candidate));
+    }
+    std::ranges::stable_sort(ordered, [](const Candidate &a, const Candidate &b) {
+        if (a.efficiencyClass != b.efficiencyClass) {
+            return a.efficiencyClass > b.efficiencyClass;
+        }
+        if (a.schedulingClass != b.schedulingClass) {
+            return a.schedulingClass > b.schedulingClass;
+        }
+        return (a.firstIndex == 0) < (b.firstIndex == 0);
+    });
+
+    std::vector<ThreadPlacement> placements;
+    for (Candidate &candidate : ordered) {
+        placements.push_back(std::move(candidate.placement));
+    }
+    return placements;
+}
+
+std::vector<ThreadPlacement> OrderCoresByL3Domain(const CpuTopology &topology, const ProcessorSet &allowed) {
+    std::vector<ThreadPlacement> placements;
+    for (const ProcessorSet &domain : RankL3Domains(topology, allowed)) {
+        for (ThreadPlacement &placement : OrderCoresBySpeed(topology, domain)) {
+            placements.push_back(std::move(placement));
+        }
+    }
+    return placements;
+}
+
+std::shared_ptr<const PlacementCores> BuildPlacementCores(
+    const CpuTopology &topology, const ProcessorSet &allowed, bool groupByL3Domain) {
+    static std::atomic<uint64_t> generation = 0;
+    auto cores = std::make_shared<PlacementCores>();
+    cores->cores = groupByL3Domain ? OrderCoresByL3Domain(topology, allowed) : OrderCoresBySpeed(topology, allowed);
+    cores->generation = generation.fetch_add(1, std::memory_order_relaxed) + 1;
+    return cores;
+}
+
+const ThreadPlacement &ThreadPlacer::Place(uint32_t threadId, const std::shared_ptr<const PlacementCores> &cores) {
+    std::lock_guard lock(m_mutex);
+    if (!m_cores || cores->generation > m_cores->generation) {
+        m_cores = cores;
+        m_threads.assign(cores->cores.size(), 0);
+        m_threadCores.clear();
+    } else if (cores->generation < m_cores->generation) {
+        // The caller still holds the snapshot a reload replaced; spread it over the old list without recording
+        return cores->cores[threadId % cores->cores.size()];
+    }
+
+    // The placer does not observe thread exits, so a recycled thread id simply inherits the previous owner's core
+    if (const auto it = m_threadCores.find(threadId); it != m_threadCores.end()) {
+        return cores->cores[it->second];
+    }
+
+    const size_t slot = static_cast<size_t>(std::ranges::min_element(m_threads) - m_threads.begin());
+    ++m_threads[slot];
+    m_threadCores.emplace(threadId, slot);
+    return cores->cores[slot];
+}
+
+std::optional<ThreadPlacement> ThreadPlacer::Find(uint32_t threadId) const {
+    std::lock_guard lock(m_mutex);
+    const auto it = m_threadCores.find(threadId);
+    return it != m_threadCores.end() ? std::optional(m_cores->cores[it->second]) : std::nullopt;
+}
+
+void ThreadPlacer::RecordRewrite(const PlacementRewrite &rewrite) {
+    std::lock_guard lock(m_rewriteMutex);
+    if (m_rewrites.size() < MAX_AUDITED_REWRITES) {
+        m_rewrites.push_back(rewrite);
+    } else {
+        ++m_droppedRewrites;
+    }
+}
+
+std::vector<PlacementRewrite> ThreadPlacer::Rewrites() const {
+    std::lock_guard lock(m_rewriteMutex);
+    return m_rewrites;
+}
+
+size_t ThreadPlacer::DroppedRewrites() const {
+    std::lock_guard lock(m_rewriteMutex);
+    return m_droppedRewrites;
+}
\ No newline at end of file
@@ -0,0 +1,82 @@
+#ifndef SPLINTERCELLPATCH_THREAD_PLACEMENT_H
+#define SPLINTERCELLPATCH_THREAD_PLACEMENT_H
+
+#include "topology.h"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+// Per-thread placement scheduler. Threads that the target pins with SetThreadAffinityMask or
+// SetThreadIdealProcessor are each given their own physical core instead of piling onto core 0.
+
+struct ThreadPlacement {
+    ProcessorSet processors;      // Hardware threads of the assigned core that the affinity policy allows
+    uint32_t idealProcessor = 0;  // Global index of the preferred hardware thread on that core
+};
+
+// One placement per physical core the allowed set touches, fastest first: highest efficiency class, then highest
+// CPPC scheduling class (preferred cores). The core hosting processor 0 goes last among equals because Windows
+// routes most interrupts and DPCs there.
+[[nodiscard]] std::vector<ThreadPlacement> OrderCoresBySpeed(const CpuTopology &topology, const ProcessorSet &allowed);
+
+// Same as OrderCoresBySpeed, but every core of the best L3 domain comes before any core of the next one
+// (see RankL3Domains), so threads placed in order share a cache until the domain is full
+[[nodiscard]] std::vector<ThreadPlacement> OrderCoresByL3Domain(const CpuTopology &topology, const ProcessorSet &allowed);
+
+// Immutable list of the cores threads are placed on. Hooks reach it through the policy snapshot, so a reload swaps in
+// a new list without blocking them.
+struct PlacementCores {
+    std::vector<ThreadPlacement> cores; // Preferred cores first
+    uint64_t generation = 0;            // Higher for lists built later
+};
+
+// Builds the core list from the processors the affinity policy allows. With groupByL3Domain, threads fill the best
+// L3 domain before spilling into the next one.
+[[nodiscard]] std::shared_ptr<const PlacementCores> BuildPlacementCores(
+    const CpuTopology &topology, const ProcessorSet &allowed, bool groupByL3Domain = false);
+
+enum class PlacementApi : uint8_t {
+    SetThreadAffinityMask,
+    SetThreadIdealProcessor,
+};
+
+// One audited rewrite of a thread placement call
+struct PlacementRewrite {
+    uint32_t threadId = 0;
+    PlacementApi api = PlacementApi::SetThreadAffinityMask;
+    uint64_t requested = 0; // Mask or ideal processor number passed by the target
+    uint64_t applied = 0;   // Mask or ideal processor number actually passed to Windows
+    uint16_t group = 0;     // Processor group the applied value refers to
+};
+
+class ThreadPlacer {
+public:
+    // Maximum number of rewrites kept for auditing; later rewrites are only counted
+    static constexpr size_t MAX_AUDITED_REWRITES = 4096;
+
+    // Returns the thread's placement on a non-empty core list, assigning the least loaded core the first time the
+    // thread is seen. A newer list than the last one drops every assignment. The reference points into cores.
+    [[nodiscard]] const ThreadPlacement &Place(uint32_t threadId, const std::shared_ptr<const PlacementCores> &cores);
+
+    // Returns the thread's placement if it has already been placed on the newest core list
+    [[nodiscard]] std::optional<ThreadPlacement> Find(uint32_t threadId) const;
+
+    void RecordRewrite(const PlacementRewrite &rewrite);
+    [[nodiscard]] std::vector<PlacementRewrite> Rewrites() const;
+    [[nodiscard]] size_t DroppedRewrites() const;
+
+private:
+    mutable std::mutex m_mutex; // Assignments only, never held while a core list is built
+    std::shared_ptr<const PlacementCores> m_cores; // List the assignments refer to
+    std::vector<uint32_t> m_threads;               // Threads assigned to each core of m_cores
+    std::unordered_map<uint32_t, size_t> m_threadCores;
+
+    mutable std::mutex m_rewriteMutex;
+    std::vector<PlacementRewrite> m_rewrites;
+    size_t m_droppedRewrites = 0;
+};
+
+#endif // SPLINTERCELLPATCH_THREAD_PLACEMENT_H
\ No newline at end of file
@@ -0,0 +1,253 @@
+#include "thread_sampler.h"
+#include "logging.h"
+#include <tlhelp32.h>
+#include <algorithm>
+
+// The thread list is refreshed every REFRESH_SAMPLES samples; in between only cached handles are queried
+inline constexpr uint64_t REFRESH_SAMPLES = 8;
+
+namespace {
+
+ULONGLONG ToUInt64(const FILETIME &time) {
+    return (static_cast<ULONGLONG>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+}
+
+} // namespace
+
+bool ThreadSampler::Start(const HotThreadSettings &hotThreads, const CacheLocalitySettings &locality,
+                          const CpuTopology &topology, const ProcessorSet &allowed, const ThreadPlacer &placer,
+                          ApplyFn apply) {
+    m_hotSettings = hotThreads;
+    m_localitySettings = locality;
+    m_allowed = allowed;
+    m_restProcessors = allowed;
+    m_placer = &placer;
+    m_apply = apply;
+
+    // With cache locality the fastest cores of the best L3 domain are handed out first
+    if (locality.enabled) {
+        m_domains.Configure(topology, allowed, locality);
+        m_fastCores = OrderCoresByL3Domain(topology, allowed);
+    } else {
+        m_fastCores = OrderCoresBySpeed(topology, allowed);
+    }
+
+    // Dedicating cores only makes sense if some remain for everything else
+    if (!hotThreads.enabled || m_fastCores.size() <= hotThreads.maxHotThreads) {
+        if (hotThreads.enabled) {
+            LOG_INFO("Hot-thread migration disabled: not enough cores to dedicate");
+        }
+        m_hotSettings.maxHotThreads = 0;
+    }
+    m_detector = HotThreadDetector(m_hotSettings);
+
+    if (m_hotSettings.maxHotThreads == 0 && !(locality.enabled && m_domains.DomainCount() > 1)) {
+        return false;
+    }
+
+    m_stopEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    if (!m_stopEvent) {
+        return false;
+    }
+
+    m_startTick = GetTickCount64();
+    m_thread = CreateThread(nullptr, 0, ThreadProc, this, 0, nullptr);
+    if (!m_thread) {
+        CloseHandle(m_stopEvent);
+        m_stopEvent = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void ThreadSampler::Stop() {
+    if (!m_thread) {
+        return;
+    }
+    SetEvent(m_stopEvent);
+
+    // Report the sampler's own CPU time against wall time (FILETIME units are 100 ns)
+    FILETIME creation, exit, kernel, user;
+    if (GetThreadTimes(m_thread, &creation, &exit, &kernel, &user)) {
+        const ULONGLONG busy100ns = ToUInt64(kernel) + ToUInt64(user);
+        const ULONGLONG elapsedMs = GetTickCount64() - m_startTick;
+        const double percent =
+            elapsedMs != 0 ? static_cast<double>(busy100ns) / 100.0 / static_cast<double>(elapsedMs) : 0.0;
+        LOG_INFO(
+            "Thread sampler: {} samples, {} migrations, {} L3 domain changes, {:.4f}% of one CPU",
+            m_samples, m_migrations, m_domainChanges, percent
+        );
+    }
+}
+
+DWORD WINAPI ThreadSampler::ThreadProc(LPVOID parameter) {
+    static_cast<ThreadSampler *>(parameter)->Run();
+    return 0;
+}
+
+void ThreadSampler::Run() {
+    std::vector<ThreadCycles> samples;
+    SampleBusyProcessors(); // Baseline
+
+    // Cache locality confines the process to the first domain right away
+    bool rebalance = m_localitySettings.enabled;
+    while (WaitForSingleObject(m_stopEvent, m_hotSettings.intervalMs) == WAIT_TIMEOUT) {
+        if (m_samples % REFRESH_SAMPLES == 0) {
+            RefreshThreads();
+        }
+
+        if (m_localitySettings.enabled && m_domains.Update(SampleBusyProcessors())) {
+            ++m_domainChanges;
+            rebalance = true;
+
+            LOG_DEBUG(
+                "Process now uses {} of {} L3 domain(s) ({} processors)",
+                m_domains.ActiveDomains(), m_domains.DomainCount(), m_domains.Active().Count()
+            );
+        }
+
+        samples.clear();
+        for (const auto &[threadId, thread] : m_threads) {
+            ULONG64 cycles = 0;
+            if (QueryThreadCycleTime(thread.handle, &cycles)) {
+                samples.push_back({threadId, cycles});
+            }
+        }
+
+        if (m_detector.Update(samples) || rebalance) {
+            Rebalance();
+            rebalance = false;
+        }
+        ++m_samples;
+    }
+
+    for (auto &[threadId, thread] : m_threads) {
+        CloseHandle(thread.handle);
+    }
+    m_threads.clear();
+}
+
+void ThreadSampler::RefreshThreads() {
+    HANDLE snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, 0);
+    if (snapshot == INVALID_HANDLE_VALUE) {
+        return;
+    }
+
+    std::unordered_map<DWORD, TrackedThread> threads;
+    THREADENTRY32 entry = {};
+    entry.dwSize = sizeof(entry);
+    for (BOOL more = Thread32First(snapshot, &entry); more; more = Thread32Next(snapshot, &entry)) {
+        if (entry.th32OwnerProcessID != GetCurrentProcessId() || entry.th32ThreadID == GetCurrentThreadId()) {
+            continue;
+        }
+        if (const auto it = m_threads.find(entry.th32ThreadID); it != m_threads.end()) {
+            threads.insert(m_threads.extract(it));
+            continue;
+        }
+
+        HANDLE hThread = OpenThread(THREAD_QUERY_LIMITED_INFORMATION | THREAD_SET_INFORMATION |
+                                    THREAD_SET_LIMITED_INFORMATION, FALSE, entry.th32ThreadID);
+        if (!hThread) {
+            continue;
+        }
+        TrackedThread &thread = threads[entry.th32ThreadID];
+        thread.handle = hThread;
+
+        // Threads created while others are hot (or the process is confined to some L3 domains) follow the rest
+        if (Restricting()) {
+            ApplyRest(entry.th32ThreadID, thread);
+        }
+    }
+    CloseHandle(snapshot);
+
+    // Whatever is left has exited
+    for (auto &[threadId, thread] : m_threads) {
+        CloseHandle(thread.handle);
+        m_hotCores.erase(threadId);
+    }
+    m_threads = std::move(threads);
+}
+
+double ThreadSampler::SampleBusyProcessors() {
+    FILETIME creation, exit, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) {
+        return 0.0;
+    }
+
+    // Process CPU time is in 100 ns units, wall time in milliseconds
+    const ULONGLONG processTime = ToUInt64(kernel) + ToUInt64(user);
+    const ULONGLONG tick = GetTickCount64();
+    const ULONGLONG elapsed = (tick - m_lastTick) * 10000;
+    const double busy = m_lastTick != 0 && elapsed != 0
+        ? static_cast<double>(processTime - m_lastProcessTime) / static_cast<double>(elapsed)
+        : 0.0;
+    m_lastTick = tick;
+    m_lastProcessTime = processTime;
+    return busy;
+}
+
+const ProcessorSet &ThreadSampler::Base() const {
+    return m_localitySettings.enabled ? m_domains.Active() : m_allowed;
+}
+
+bool ThreadSampler::Restricting() const {
+    return !m_hotCores.empty() || !(Base() == m_allowed);
+}
+
+void ThreadSampler::ApplyRest(DWORD threadId, TrackedThread &thread) {
+    // Threads the target pinned keep the core the placer gave them
+    if (const std::optional<ThreadPlacement> placement = m_placer->Find(threadId)) {
+        thread.restricted = m_apply(thread.handle, placement->processors);
+        return;
+    }
+    thread.restricted = m_apply(thread.handle, m_restProcessors);
+}
+
+void ThreadSampler::Rebalance() {
+    const std::vector<uint32_t> &hot = m_detector.HotThreads();
+
+    // Threads that stay hot keep their core; newly hot threads take the fastest free ones
+    std::unordered_map<DWORD, size_t> hotCores;
+    std::vector<bool> taken(m_fastCores.size(), false);
+    for (const uint32_t threadId : hot) {
+        if (const auto it = m_hotCores.find(threadId); it != m_hotCores.end()) {
+            hotCores.emplace(threadId, it->second);
+            taken[it->second] = true;
+        }
+    }
+    for (const uint32_t threadId : hot) {
+        if (!hotCores.contains(threadId)) {
+            const size_t core = static_cast<size_t>(std::ranges::find(taken, false) - taken.begin());
+            hotCores.emplace(threadId, core);
+            taken[core] = true;
+        }
+    }
+
+    m_restProcessors = Base();
+    for (const auto &[threadId, core] : hotCores) {
+        m_restProcessors = m_restProcessors.Without(m_fastCores[core].processors);
+    }
+
+    for (auto &[threadId, thread] : m_threads) {
+        if (const auto it = hotCores.find(threadId); it != hotCores.end()) {
+            const auto previous = m_hotCores.find(threadId);
+            if (previous == m_hotCores.end() || previous->second != it->second) {
+                thread.restricted = m_apply(thread.handle, m_fastCores[it->second].processors);
+                ++m_migrations;
+
+                LOG_DEBUG(
+                    "Hot thread {} pinned to fast core (processor {})",
+                    threadId, m_fastCores[it->second].idealProcessor
+                );
+            }
+        } else if (!hotCores.empty() || !(Base() == m_allowed)) {
+            ApplyRest(threadId, thread);
+        } else if (thread.restricted) {
+            // Nothing to keep apart any more: give everything back the whole policy
+            const std::optional<ThreadPlacement> placement = m_placer->Find(threadId);
+            m_apply(thread.handle, placement ? placement->processors : m_allowed);
+            thread.restricted = false;
+        }
+    }
+    m_hotCores = std::move(hotCores);
+}
\ No newline at end of file
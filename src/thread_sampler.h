@@ -0,0 +1,69 @@
+#ifndef SPLINTERCELLPATCH_THREAD_SAMPLER_H
+#define SPLINTERCELLPATCH_THREAD_SAMPLER_H
+
+#include "cache_locality.h"
+#include "hot_threads.h"
+#include "thread_placement.h"
+#include "topology.h"
+#include <windows.h>
+#include <unordered_map>
+#include <vector>
+
+// Background sampler. It reads per-thread CPU time (QueryThreadCycleTime), pins the dominating threads to the
+// fastest cores and moves every other thread to the remaining ones. With cache locality enabled it also keeps
+// the process inside the best L3 domain, adding domains only while the active ones are saturated. Thread handles
+// are cached and the thread list is only refreshed every few samples, so a sample costs one QueryThreadCycleTime
+// per thread.
+
+class ThreadSampler {
+public:
+    // Applies a processor set to a thread with the active placement mechanism (hard mask or CPU Sets)
+    using ApplyFn = bool (*)(HANDLE hThread, const ProcessorSet &processors);
+
+    [[nodiscard]] bool Start(const HotThreadSettings &hotThreads, const CacheLocalitySettings &locality,
+                             const CpuTopology &topology, const ProcessorSet &allowed, const ThreadPlacer &placer,
+                             ApplyFn apply);
+
+    // Signals the sampler thread and reports its cost; does not wait (safe under the loader lock)
+    void Stop();
+
+private:
+    struct TrackedThread {
+        HANDLE handle = nullptr;
+        bool restricted = false; // Placement changed by the sampler (pinned to a fast core or kept off them)
+    };
+
+    static DWORD WINAPI ThreadProc(LPVOID parameter);
+    void Run();
+    void RefreshThreads();
+    double SampleBusyProcessors(); // Average busy processors since the previous call
+    void Rebalance();
+    void ApplyRest(DWORD threadId, TrackedThread &thread);
+
+    // Processors every non-hot thread may use: the active L3 domains, or the whole policy
+    [[nodiscard]] const ProcessorSet &Base() const;
+    [[nodiscard]] bool Restricting() const;
+
+    HotThreadSettings m_hotSettings;
+    CacheLocalitySettings m_localitySettings;
+    HotThreadDetector m_detector;
+    L3DomainSelector m_domains;
+    std::vector<ThreadPlacement> m_fastCores;
+    ProcessorSet m_allowed;
+    ProcessorSet m_restProcessors;
+    const ThreadPlacer *m_placer = nullptr;
+    ApplyFn m_apply = nullptr;
+
+    HANDLE m_thread = nullptr;
+    HANDLE m_stopEvent = nullptr;
+    ULONGLONG m_startTick = 0;
+    ULONGLONG m_lastTick = 0;
+    ULONGLONG m_lastProcessTime = 0;
+    std::unordered_map<DWORD, TrackedThread> m_threads;
+    std::unordered_map<DWORD, size_t> m_hotCores; // hot thread -> index into m_fastCores
+    uint64_t m_samples = 0;
+    uint64_t m_migrations = 0;
+    uint64_t m_domainChanges = 0;
+};
+
+#endif // SPLINTERCELLPATCH_THREAD_SAMPLER_H
\ No newline at end of file
@@ -0,0 +1,393 @@
+#include "topology.h"
+#include "string_utils.h"
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <utility>
+
+ProcessorSet ProcessorSet::FromGroupMask(uint16_t group, uint64_t mask) {
+    ProcessorSet set;
+    if (mask != 0) {
+        set.m_groups.resize(group + 1, 0);
+        set.m_groups[group] = mask;
+    }
+    return set;
+}
+
+void ProcessorSet::Set(uint32_t index) {
+    const size_t group = index / PROCESSORS_PER_GROUP;
+    if (group >= m_groups.size()) {
+        m_groups.resize(group + 1, 0);
+    }
+    m_groups[group] |= uint64_t{1} << (index % PROCESSORS_PER_GROUP);
+}
+
+bool ProcessorSet::Test(uint32_t index) const {
+    const size_t group = index / PROCESSORS_PER_GROUP;
+    return group < m_groups.size() && (m_groups[group] >> (index % PROCESSORS_PER_GROUP)) & 1;
+}
+
+bool ProcessorSet::Empty() const {
+    return std::ranges::all_of(m_groups, [](uint64_t mask) { return mask == 0; });
+}
+
+uint32_t ProcessorSet::Count() const {
+    uint32_t count = 0;
+    for (const uint64_t mask : m_groups) {
+        count += static_cast<uint32_t>(std::popcount(mask));
+    }
+    return count;
+}
+
+ProcessorSet ProcessorSet::Intersect(const ProcessorSet &other) const {
+    ProcessorSet set = *this;
+    for (size_t group = 0; group < set.m_groups.size(); ++group) {
+        set.m_groups[group] &= other.GroupMask(static_cast<uint16_t>(group));
+    }
+    return set;
+}
+
+ProcessorSet ProcessorSet::Union(const ProcessorSet &other) const {
+    ProcessorSet set = *this;
+    if (other.m_groups.size() > set.m_groups.size()) {
+        set.m_groups.resize(other.m_groups.size(), 0);
+    }
+    for (size_t group = 0; group < other.m_groups.size(); ++group) {
+        set.m_groups[group] |= other.m_groups[group];
+    }
+    return set;
+}
+
+ProcessorSet ProcessorSet::Without(const ProcessorSet &other) const {
+    ProcessorSet set = *this;
+    for (size_t group = 0; group < set.m_groups.size(); ++group) {
+        set.m_groups[group] &= ~other.GroupMask(static_cast<uint16_t>(group));
+    }
+    return set;
+}
+
+uint64_t ProcessorSet::GroupMask(uint16_t group) const {
+    return group < m_groups.size() ? m_groups[group] : 0;
+}
+
+bool ProcessorSet::operator==(const ProcessorSet &other) const {
+    const size_t groups = std::max(m_groups.size(), other.m_groups.size());
+    for (size_t group = 0; group < groups; ++group) {
+        if (GroupMask(static_cast<uint16_t>(group)) != other.GroupMask(static_cast<uint16_t>(group))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+ProcessorSet CpuTopology::All() const {
+    ProcessorSet set;
+    for (const LogicalProcessor &processor : processors) {
+        set.Set(processor.index);
+    }
+    return set;
+}
+
+uint8_t CpuTopology::MaxEfficiencyClass() const {
+    uint8_t maxClass = 0;
+    for (const LogicalProcessor &processor : processors) {
+        maxClass = std::max(maxClass, processor.efficiencyClass);
+    }
+    return maxClass;
+}
+
+const LogicalProcessor *CpuTopology::Find(uint32_t index) const {
+    const auto it = std::ranges::lower_bound(processors, index, {}, &LogicalProcessor::index);
+    return it != processors.end() && it->index == index ? &*it : nullptr;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// Policies
+// ---------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+constexpr std::pair<AffinityPolicy, std::string_view> POLICY_NAMES[] = {
+    {AffinityPolicy::AllCores, "all-cores"},
+    {AffinityPolicy::PhysicalCoresOnly, "physical-cores-only"},
+    {AffinityPolicy::SingleL3Domain, "single-L3-domain"},
+    {AffinityPolicy::PerformanceCoresOnly, "P-cores-only"},
+};
+
+} // namespace
+
+std::vector<ProcessorSet> RankL3Domains(const CpuTopology &topology, const ProcessorSet &allowed) {
+    const uint8_t fastClass = topology.MaxEfficiencyClass();
+    struct Domain {
+        uint32_t id = 0;
+        uint32_t fast = 0;
+        uint32_t total = 0;
+        ProcessorSet processors;
+    };
+
+    std::map<uint32_t, Domain> domains;
+    for (const LogicalProcessor &processor : topology.processors) {
+        if (!allowed.Test(processor.index)) {
+            continue;
+        }
+        Domain &domain = domains[processor.l3Domain];
+        domain.id = processor.l3Domain;
+        domain.fast += processor.efficiencyClass == fastClass ? 1 : 0;
+        domain.total += 1;
+        domain.processors.Set(processor.index);
+    }
+
+    std::vector<Domain> ordered;
+    for (auto &[id, domain] : domains) {
+        ordered.push_back(std::move(domain));
+    }
+    // Most fast processors first, then most processors; the stable sort keeps ties in domain id order
+    std::ranges::stable_sort(ordered, [](const Domain &a, const Domain &b) {
+        return std::pair(a.fast, a.total) > std::pair(b.fast, b.total);
+    });
+
+    std::vector<ProcessorSet> ranked;
+    for (Domain &domain : ordered) {
+        ranked.push_back(std::move(domain.processors));
+    }
+    return ranked;
+}
+
+std::optional<AffinityPolicy> ParseAffinityPolicy(std::string_view name) {
+    for (const auto &[policy, policyName] : POLICY_NAMES) {
+        if (EqualsIgnoreCase(name, policyName)) {
+            return policy;
+        }
+    }
+    return std::nullopt;
+}
+
+std::string_view AffinityPolicyName(AffinityPolicy policy) {
+    for (const auto &[candidate, name] : POLICY_NAMES) {
+        if (candidate == policy) {
+            return name;
+        }
+    }
+    return "unknown";
+}
+
+ProcessorSet ComputePolicySet(const CpuTopology &topology, AffinityPolicy policy) {
+    if (topology.processors.empty()) {
+        return {};
+    }
+
+    ProcessorSet set;
+    switch (policy) {
+        case AffinityPolicy::AllCores:
+            return topology.All();
+
+        case AffinityPolicy::PhysicalCoresOnly:
+            for (const LogicalProcessor &processor : topology.processors) {
+                if (processor.smtPrimary) {
+                    set.Set(processor.index);
+                }
+            }
+            break;
+
+        case AffinityPolicy::SingleL3Domain:
+            set = RankL3Domains(topology, topology.All()).front();
+            break;
+
+        case AffinityPolicy::PerformanceCoresOnly: {
+            const uint8_t fastClass = topology.MaxEfficiencyClass();
+            for (const LogicalProcessor &processor : topology.processors) {
+                if (processor.efficiencyClass == fastClass) {
+                    set.Set(processor.index);
+                }
+            }
+            break;
+        }
+    }
+
+    // A policy must never leave the process without a processor to run on
+    return set.Empty() ? topology.All() : set;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// Linux sysfs reader
+// ---------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+namespace fs = std::filesystem;
+
+bool ReadFirstLine(const fs::path &path, std::string &line) {
+    std::ifstream file(path);
+    return file && std::getline(file, line);
+}
+
+bool ReadUnsigned(const fs::path &path, uint64_t &value) {
+    std::string line;
+    if (!ReadFirstLine(path, line)) {
+        return false;
+    }
+    try {
+        value = std::stoull(line);
+    } catch (...) {
+        return false;
+    }
+    return true;
+}
+
+// Parses the kernel cpulist format, e.g. "0-3,8,10-11"
+bool ParseCpuList(std::string_view text, std::vector<uint32_t> &cpus) {
+    cpus.clear();
+    while (!text.empty()) {
+        const size_t comma = text.find(',');
+        std::string_view range = text.substr(0, comma);
+        text = comma == std::string_view::npos ? std::string_view{} : text.substr(comma + 1);
+
+        while (!range.empty() && std::isspace(static_cast<unsigned char>(range.back()))) {
+            range.remove_suffix(1);
+        }
+        if (range.empty()) {
+            continue;
+        }
+
+        const size_t dash = range.find('-');
+        try {
+            const uint32_t first = static_cast<uint32_t>(std::stoul(std::string(range.substr(0, dash))));
+            const uint32_t last = dash == std::string_view::npos
+                ? first
+                : static_cast<uint32_t>(std::stoul(std::string(range.substr(dash + 1))));
+            if (last < first) {
+                return false;
+            }
+            for (uint32_t cpu = first; cpu <= last; ++cpu) {
+                cpus.push_back(cpu);
+            }
+        } catch (...) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ReadCpuList(const fs::path &path, std::vector<uint32_t> &cpus) {
+    std::string line;
+    return ReadFirstLine(path, line) && ParseCpuList(line, cpus);
+}
+
+std::vector<uint32_t> EnumerateCpus(const fs::path &root) {
+    std::vector<uint32_t> cpus;
+    if (ReadCpuList(root / "online", cpus) && !cpus.empty()) {
+        return cpus;
+    }
+
+    std::error_code error;
+    for (const fs::directory_entry &entry : fs::directory_iterator(root, error)) {
+        const std::string name = entry.path().filename().string();
+        if (name.size() > 3 && name.starts_with("cpu") &&
+            std::all_of(name.begin() + 3, name.end(), [](char c) { return std::isdigit(static_cast<unsigned char>(c)); })) {
+            cpus.push_back(static_cast<uint32_t>(std::stoul(name.substr(3))));
+        }
+    }
+    std::ranges::sort(cpus);
+    return cpus;
+}
+
+// Returns the lowest CPU sharing this CPU's L3 cache, or nullopt if sysfs does not describe one
+std::optional<uint32_t> FindL3Leader(const fs::path &cpuDir) {
+    std::error_code error;
+    for (const fs::directory_entry &entry : fs::directory_iterator(cpuDir / "cache", error)) {
+        uint64_t level = 0;
+        std::vector<uint32_t> shared;
+        if (entry.path().filename().string().starts_with("index") && ReadUnsigned(entry.path() / "level", level) &&
+            level == 3 && ReadCpuList(entry.path() / "shared_cpu_list", shared) && !shared.empty()) {
+            return *std::ranges::min_element(shared);
+        }
+    }
+    return std::nullopt;
+}
+
+} // namespace
+
+bool LoadTopologyFromSysfs(const std::string &root, CpuTopology &topology) {
+    const fs::path rootPath(root);
+    const std::vector<uint32_t> cpus = EnumerateCpus(rootPath);
+    if (cpus.empty()) {
+        return false;
+    }
+
+    std::map<std::pair<uint64_t, uint64_t>, uint32_t> coreIds;  // (package, core_id) -> unique core
+    std::map<std::pair<uint64_t, uint32_t>, uint32_t> domainIds; // (package, L3 leader) -> unique domain
+    std::map<uint64_t, uint8_t> capacityClasses;                  // cpu_capacity -> efficiency class
+    std::map<uint64_t, uint8_t> performanceClasses;               // acpi_cppc/highest_perf -> scheduling class
+    struct Discovered {
+        LogicalProcessor processor;
+        uint64_t capacity = 0;
+        uint64_t highestPerf = 0;
+    };
+    std::vector<Discovered> processors;
+
+    for (const uint32_t cpu : cpus) {
+        const fs::path cpuDir = rootPath / ("cpu" + std::to_string(cpu));
+        uint64_t package = 0;
+        uint64_t coreId = 0;
+        if (!ReadUnsigned(cpuDir / "topology" / "physical_package_id", package) ||
+            !ReadUnsigned(cpuDir / "topology" / "core_id", coreId)) {
+            return false;
+        }
+
+        LogicalProcessor processor;
+        processor.index = cpu;
+        processor.package = static_cast<uint32_t>(package);
+        processor.core = coreIds.try_emplace({package, coreId}, static_cast<uint32_t>(coreIds.size())).first->second;
+
+        std::vector<uint32_t> siblings;
+        if (ReadCpuList(cpuDir / "topology" / "thread_siblings_list", siblings) && !siblings.empty()) {
+            processor.smtPrimary = *std::ranges::min_element(siblings) == cpu;
+        }
+
+        // Without an L3 description (some VMs) the whole package is treated as one cache domain
+        const uint32_t leader = FindL3Leader(cpuDir).value_or(UINT32_MAX);
+        processor.l3Domain =
+            domainIds.try_emplace({package, leader}, static_cast<uint32_t>(domainIds.size())).first->second;
+
+        // cpu_capacity is exported on asymmetric (big.LITTLE / hybrid) systems; absent means all CPUs are equal
+        uint64_t capacity = 0;
+        if (ReadUnsigned(cpuDir / "cpu_capacity", capacity)) {
+            capacityClasses.try_emplace(capacity, 0);
+        }
+
+        // CPPC highest_perf differs between cores that boost further ("preferred cores")
+        uint64_t highestPerf = 0;
+        if (ReadUnsigned(cpuDir / "acpi_cppc" / "highest_perf", highestPerf)) {
+            performanceClasses.try_emplace(highestPerf, 0);
+        }
+        processors.push_back({processor, capacity, highestPerf});
+    }
+
+    // Rank distinct values so classes follow the Windows convention (0 = most efficient / least boost)
+    for (auto *classes : {&capacityClasses, &performanceClasses}) {
+        uint8_t nextClass = 0;
+        for (auto &[value, rank] : *classes) {
+            rank = nextClass++;
+        }
+    }
+
+    topology.processors.clear();
+    for (auto &[processor, capacity, highestPerf] : processors) {
+        const auto capacityIt = capacityClasses.find(capacity);
+        processor.efficiencyClass = capacityIt != capacityClasses.end() ? capacityIt->second : 0;
+        const auto performanceIt = performanceClasses.find(highestPerf);
+        processor.schedulingClass = performanceIt != performanceClasses.end() ? performanceIt->second : 0;
+        topology.processors.push_back(processor);
+    }
+    std::ranges::sort(topology.processors, {}, &LogicalProcessor::index);
+    return true;
+}
+
+#ifndef _WIN32
+bool LoadTopologyFromSystem(CpuTopology &topology) {
+    return LoadTopologyFromSysfs("/sys/devices/system/cpu", topology);
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,90 @@
+#ifndef SPLINTERCELLPATCH_TOPOLOGY_H
+#define SPLINTERCELLPATCH_TOPOLOGY_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Platform-neutral CPU topology model and affinity policy engine.
+// Filled from GetLogicalProcessorInformationEx on Windows (topology_windows.cpp) and from
+// /sys/devices/system/cpu on Linux, so the mask computation can be exercised on either platform.
+
+// Logical processors are addressed by a global index of (group * 64 + number within group).
+// This maps 1:1 onto Windows processor groups; Linux CPUs are folded into pseudo-groups of 64.
+inline constexpr uint32_t PROCESSORS_PER_GROUP = 64;
+
+struct LogicalProcessor {
+    uint32_t index = 0;          // group * PROCESSORS_PER_GROUP + number
+    uint32_t package = 0;        // Physical package (socket)
+    uint32_t core = 0;           // Physical core, unique across packages
+    uint32_t l3Domain = 0;       // L3 cache domain (CCD/CCX on Ryzen), unique across packages
+    uint8_t efficiencyClass = 0; // Higher is faster; identical for every processor on non-hybrid parts
+    uint8_t schedulingClass = 0; // CPPC preferred-core rank, higher boosts further; 0 when not reported
+    bool smtPrimary = true;      // First hardware thread of its physical core
+    uint32_t cpuSetId = 0;       // Windows CPU Set id (0 when CPU Sets are unavailable or on Linux)
+
+    [[nodiscard]] uint16_t Group() const { return static_cast<uint16_t>(index / PROCESSORS_PER_GROUP); }
+    [[nodiscard]] uint8_t Number() const { return static_cast<uint8_t>(index % PROCESSORS_PER_GROUP); }
+};
+
+// Set of logical processors, stored as one 64-bit mask per processor group
+class ProcessorSet {
+public:
+    [[nodiscard]] static ProcessorSet FromGroupMask(uint16_t group, uint64_t mask);
+
+    void Set(uint32_t index);
+    [[nodiscard]] bool Test(uint32_t index) const;
+    [[nodiscard]] bool Empty() const;
+    [[nodiscard]] uint32_t Count() const;
+
+    [[nodiscard]] ProcessorSet Intersect(const ProcessorSet &other) const;
+    [[nodiscard]] ProcessorSet Union(const ProcessorSet &other) const;
+
+    // Processors of this set that are not in other
+    [[nodiscard]] ProcessorSet Without(const ProcessorSet &other) const;
+
+    // Affinity mask for a single processor group (0 if the set has no processor in that group)
+    [[nodiscard]] uint64_t GroupMask(uint16_t group) const;
+    [[nodiscard]] uint16_t GroupCount() const { return static_cast<uint16_t>(m_groups.size()); }
+
+    bool operator==(const ProcessorSet &other) const;
+
+private:
+    std::vector<uint64_t> m_groups;
+};
+
+struct CpuTopology {
+    std::vector<LogicalProcessor> processors; // Sorted by index
+
+    [[nodiscard]] ProcessorSet All() const;
+    [[nodiscard]] uint8_t MaxEfficiencyClass() const;
+    [[nodiscard]] const LogicalProcessor *Find(uint32_t index) const;
+};
+
+enum class AffinityPolicy {
+    AllCores,             // Every logical processor (the original ALL_CORES_MASK behavior)
+    PhysicalCoresOnly,    // One hardware thread per physical core, no SMT siblings
+    SingleL3Domain,       // Every processor sharing the best L3 cache domain
+    PerformanceCoresOnly, // Only processors of the highest efficiency class (P-cores on hybrid parts)
+};
+
+// Policy names are matched case-insensitively: "all-cores", "physical-cores-only", "single-L3-domain", "P-cores-only"
+[[nodiscard]] std::optional<AffinityPolicy> ParseAffinityPolicy(std::string_view name);
+[[nodiscard]] std::string_view AffinityPolicyName(AffinityPolicy policy);
+
+// Splits the allowed processors by L3 cache domain, best domain first: most processors of the highest efficiency
+// class, then most processors overall, then lowest domain id
+[[nodiscard]] std::vector<ProcessorSet> RankL3Domains(const CpuTopology &topology, const ProcessorSet &allowed);
+
+// Computes the processors a policy selects. Never returns an empty set for a non-empty topology.
+[[nodiscard]] ProcessorSet ComputePolicySet(const CpuTopology &topology, AffinityPolicy policy);
+
+// Reads the topology from a sysfs CPU directory (normally "/sys/devices/system/cpu", or a copy of one)
+[[nodiscard]] bool LoadTopologyFromSysfs(const std::string &root, CpuTopology &topology);
+
+// Reads the topology of the running machine (GetLogicalProcessorInformationEx on Windows, sysfs elsewhere)
+[[nodiscard]] bool LoadTopologyFromSystem(CpuTopology &topology);
+
+#endif // SPLINTERCELLPATCH_TOPOLOGY_H
\ No newline at end of file
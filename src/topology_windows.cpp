@@ -0,0 +1,163 @@
+#include "topology.h"
+#include <windows.h>
+#include <algorithm>
+#include <bit>
+#include <map>
+
+namespace {
+
+template <typename Fn>
+void ForEachProcessor(const GROUP_AFFINITY &affinity, Fn &&fn) {
+    for (uint64_t mask = affinity.Mask; mask != 0; mask &= mask - 1) {
+        fn(affinity.Group * PROCESSORS_PER_GROUP + static_cast<uint32_t>(std::countr_zero(mask)));
+    }
+}
+
+template <typename Fn>
+void ForEachRelation(const std::vector<BYTE> &buffer, Fn &&fn) {
+    for (size_t offset = 0; offset < buffer.size();) {
+        const auto *info = reinterpret_cast<const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX *>(buffer.data() + offset);
+        fn(*info);
+        offset += info->Size;
+    }
+}
+
+// The id recorded for key, or the next unused one, which is then recorded
+uint32_t IdFor(std::map<uint32_t, uint32_t> &ids, uint32_t key, uint32_t &next) {
+    const auto [it, inserted] = ids.try_emplace(key, next);
+    next += inserted ? 1 : 0;
+    return it->second;
+}
+
+} // namespace
+
+bool LoadTopologyFromSystem(CpuTopology &topology) {
+    DWORD length = 0;
+    GetLogicalProcessorInformationEx(RelationAll, nullptr, &length);
+    if (GetLastError() != ERROR_INSUFFICIENT_BUFFER) {
+        return false;
+    }
+
+    std::vector<BYTE> buffer(length);
+    if (!GetLogicalProcessorInformationEx(
+        RelationAll, reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data()), &length)) {
+        return false;
+    }
+    buffer.resize(length);
+
+    // First pass: physical cores define the logical processors themselves
+    std::map<uint32_t, LogicalProcessor> processors;
+    uint32_t coreId = 0;
+    ForEachRelation(buffer, [&](const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX &info) {
+        if (info.Relationship != RelationProcessorCore) {
+            return;
+        }
+        bool primary = true;
+        for (WORD i = 0; i < info.Processor.GroupCount; ++i) {
+            ForEachProcessor(info.Processor.GroupMask[i], [&](uint32_t index) {
+                LogicalProcessor &processor = processors[index];
+                processor.index = index;
+                processor.core = coreId;
+                processor.efficiencyClass = info.Processor.EfficiencyClass;
+                processor.smtPrimary = primary;
+                primary = false;
+            });
+        }
+        ++coreId;
+    });
+
+    // Second pass: packages and L3 cache domains
+    const auto lookup = [&](uint32_t index) -> LogicalProcessor * {
+        const auto it = processors.find(index);
+        return it != processors.end() ? &it->second : nullptr;
+    };
+    uint32_t packageId = 0;
+    uint32_t domainId = 0;
+    ForEachRelation(buffer, [&](const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX &info) {
+        if (info.Relationship == RelationProcessorPackage) {
+            for (WORD i = 0; i < info.Processor.GroupCount; ++i) {
+                ForEachProcessor(info.Processor.GroupMask[i], [&](uint32_t index) {
+                    if (LogicalProcessor *processor = lookup(index)) {
+                        processor->package = packageId;
+                    }
+                });
+            }
+            ++packageId;
+        } else if (info.Relationship == RelationCache && info.Cache.Level == 3) {
+            ForEachProcessor(info.Cache.GroupMask, [&](uint32_t index) {
+                if (LogicalProcessor *processor = lookup(index)) {
+                    processor->l3Domain = domainId;
+                }
+            });
+            ++domainId;
+        }
+    });
+
+    // Machines without an L3 report fall back to one cache domain per package
+    if (domainId == 0) {
+        for (auto &[index, processor] : processors) {
+            processor.l3Domain = processor.package;
+        }
+    }
+
+    // CPU Set ids address every processor, including those a 32-bit (WOW64) affinity mask cannot reach: in a WOW64
+    // process the masks above stop at processor 31 of each group, so the processors beyond it are created here from
+    // their CPU Set. The scheduling class carries the CPPC preferred-core ranking.
+    ULONG cpuSetLength = 0;
+    GetSystemCpuSetInformation(nullptr, 0, &cpuSetLength, GetCurrentProcess(), 0);
+    std::vector<BYTE> cpuSetBuffer(cpuSetLength);
+    std::vector<const SYSTEM_CPU_SET_INFORMATION *> cpuSets;
+    if (cpuSetLength != 0 && GetSystemCpuSetInformation(
+        reinterpret_cast<PSYSTEM_CPU_SET_INFORMATION>(cpuSetBuffer.data()), cpuSetLength, &cpuSetLength,
+        GetCurrentProcess(), 0)) {
+        for (size_t offset = 0; offset < cpuSetLength;) {
+            const auto *info = reinterpret_cast<const SYSTEM_CPU_SET_INFORMATION *>(cpuSetBuffer.data() + offset);
+            if (info->Type == CpuSetInformation) {
+                cpuSets.push_back(info);
+            }
+            offset += info->Size;
+        }
+    }
+
+    // Core and cache indexes are group-relative processor numbers, keyed here like processor indexes
+    const auto cpuSetIndex = [](const SYSTEM_CPU_SET_INFORMATION &info, BYTE number) {
+        return info.CpuSet.Group * PROCESSORS_PER_GROUP + number;
+    };
+    std::map<uint32_t, uint32_t> coreOfCpuSetCore;
+    std::map<uint32_t, uint32_t> domainOfCpuSetCache;
+    std::map<uint32_t, uint32_t> packageOfNode;
+    for (const SYSTEM_CPU_SET_INFORMATION *info : cpuSets) {
+        if (LogicalProcessor *processor = lookup(cpuSetIndex(*info, info->CpuSet.LogicalProcessorIndex))) {
+            processor->cpuSetId = info->CpuSet.Id;
+            processor->schedulingClass = info->CpuSet.SchedulingClass;
+            coreOfCpuSetCore.try_emplace(cpuSetIndex(*info, info->CpuSet.CoreIndex), processor->core);
+            domainOfCpuSetCache.try_emplace(cpuSetIndex(*info, info->CpuSet.LastLevelCacheIndex), processor->l3Domain);
+            packageOfNode.try_emplace(info->CpuSet.NumaNodeIndex, processor->package);
+        }
+    }
+    for (const SYSTEM_CPU_SET_INFORMATION *info : cpuSets) {
+        const uint32_t index = cpuSetIndex(*info, info->CpuSet.LogicalProcessorIndex);
+        if (lookup(index)) {
+            continue;
+        }
+        LogicalProcessor &processor = processors[index];
+        processor.index = index;
+        processor.cpuSetId = info->CpuSet.Id;
+        processor.efficiencyClass = info->CpuSet.EfficiencyClass;
+        processor.schedulingClass = info->CpuSet.SchedulingClass;
+        processor.smtPrimary = info->CpuSet.LogicalProcessorIndex == info->CpuSet.CoreIndex;
+        processor.core = IdFor(coreOfCpuSetCore, cpuSetIndex(*info, info->CpuSet.CoreIndex), coreId);
+        // A NUMA node no known processor belongs to is taken as a package of its own
+        processor.package = IdFor(packageOfNode, info->CpuSet.NumaNodeIndex, packageId);
+        processor.l3Domain = domainId == 0
+                                 ? processor.package
+                                 : IdFor(domainOfCpuSetCache, cpuSetIndex(*info, info->CpuSet.LastLevelCacheIndex),
+                                         domainId);
+    }
+
+    topology.processors.clear();
+    for (const auto &[index, processor] : processors) {
+        topology.processors.push_back(processor);
+    }
+    return !topology.processors.empty();
+}
\ No newline at end of file
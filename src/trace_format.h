@@ -0,0 +1,100 @@
+#ifndef SPLINTERCELLPATCH_TRACE_FORMAT_H
+#define SPLINTERCELLPATCH_TRACE_FORMAT_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Binary hook trace. A file is a TraceFileHeader followed by fixed-size TraceRecords in append order, all
+// little-endian. The writer fills records through a memory-mapped view (see TraceWriter); ConvertTraceToChromeJson
+// turns a file into Chrome/Perfetto JSON.
+
+inline constexpr std::array<char, 8> TRACE_MAGIC = {'S', 'C', 'T', 'R', 'A', 'C', 'E', '\0'};
+inline constexpr uint32_t TRACE_VERSION = 2;
+
+enum class TraceHook : uint16_t {
+    None, // Slot claimed but never committed (writer stopped mid-record)
+    SetProcessAffinityMask,
+    SetThreadAffinityMask,
+    SetThreadIdealProcessor,
+    SetPriorityClass,
+    SetThreadPriority,
+    FreeLibrary,
+    CreateThread,
+    QueryPerformanceCounter, // Timer hooks only record readings the monotonic clamp changed
+    GetTickCount,
+    timeGetTime,
+    Count,
+};
+
+struct TraceFileHeader {
+    std::array<char, 8> magic = TRACE_MAGIC;
+    uint32_t version = TRACE_VERSION;
+    uint32_t recordSize = 0;
+    uint64_t ticksPerSecond = 0; // Timestamp clock frequency
+    uint64_t startTicks = 0;     // Timestamp when the trace was opened
+    uint64_t recordCount = 0;    // Set when the trace is closed; 0 after a crash, readers then scan the whole file
+    uint32_t processId = 0;
+    uint32_t reserved = 0;
+    std::array<uint64_t, 2> reserved2 = {};
+};
+static_assert(sizeof(TraceFileHeader) == 64);
+
+struct TraceRecord {
+    uint64_t timestamp = 0;
+    uint32_t threadId = 0; // Calling thread
+    TraceHook hook = TraceHook::None; // Stored last, so a record is complete once its hook is set
+    uint16_t reserved = 0;
+    std::array<uint64_t, 2> original = {};  // Arguments as passed by the target
+    std::array<uint64_t, 2> rewritten = {}; // Same arguments as passed to Windows; differs from original on a rewrite
+    uint64_t result = 0;
+    uint64_t targetThreadId = 0; // Thread the call acts on (thread affinity, ideal processor and priority calls)
+};
+static_assert(sizeof(TraceRecord) == 64);
+
+// How the converter labels and prints each record field. Fields without a name are omitted.
+enum class TraceValueFormat : uint8_t {
+    Unsigned,
+    Signed,
+    Hex,
+};
+
+struct TraceField {
+    std::string_view name;
+    TraceValueFormat format = TraceValueFormat::Unsigned;
+};
+
+struct TraceHookInfo {
+    std::string_view name;
+    bool targetsThread = false; // targetThreadId is set
+    std::array<TraceField, 2> original;
+    std::array<TraceField, 2> rewritten;
+    TraceField result;
+};
+
+inline constexpr std::array<TraceHookInfo, static_cast<size_t>(TraceHook::Count)> TRACE_HOOKS = {{
+    {"None", false, {}, {}, {}},
+    {"SetProcessAffinityMask", false,
+     {{{"mask", TraceValueFormat::Hex}, {}}}, {{{"applied mask", TraceValueFormat::Hex}, {}}}, {"result"}},
+    {"SetThreadAffinityMask", true,
+     {{{"mask", TraceValueFormat::Hex}, {}}},
+     {{{"applied mask", TraceValueFormat::Hex}, {"applied group"}}},
+     {"previous mask", TraceValueFormat::Hex}},
+    {"SetThreadIdealProcessor", true,
+     {{{"processor"}, {}}}, {{{"applied processor"}, {"applied group"}}}, {"previous processor"}},
+    {"SetPriorityClass", false,
+     {{{"class", TraceValueFormat::Hex}, {}}}, {{{"applied class", TraceValueFormat::Hex}, {}}}, {"result"}},
+    {"SetThreadPriority", true,
+     {{{"priority", TraceValueFormat::Signed}, {}}}, {{{"applied priority", TraceValueFormat::Signed}, {}}},
+     {"result"}},
+    {"FreeLibrary", false,
+     {{{"module", TraceValueFormat::Hex}, {}}}, {{{}, {"blocked"}}}, {"result"}},
+    {"CreateThread", false,
+     {{{"start address", TraceValueFormat::Hex}, {"parameter", TraceValueFormat::Hex}}}, {}, {"new thread"}},
+    {"QueryPerformanceCounter", false, {{{"counter"}, {}}}, {{{"clamped to"}, {}}}, {}},
+    {"GetTickCount", false, {{{"ticks"}, {}}}, {{{"clamped to"}, {}}}, {}},
+    {"timeGetTime", false, {{{"time"}, {}}}, {{{"clamped to"}, {}}}, {}},
+}};
+
+#endif // SPLINTERCELLPATCH_TRACE_FORMAT_H
\ No newline at end of file
@@ -0,0 +1,63 @@
+#include "trace_writer.h"
+#include <algorithm>
+#include <string>
+
+bool TraceWriter::Open(const TraceSettings &settings, uint64_t ticksPerSecond, uint64_t startTicks,
+                       uint32_t processId) {
+    if (settings.file.empty() || settings.maxRecords == 0 || Active()) {
+        return false;
+    }
+    const uint64_t size = TraceFileBytes(settings.maxRecords);
+    if (size > MAX_TRACE_FILE_BYTES || !m_file.Create(std::string(settings.file), static_cast<size_t>(size))) {
+        return false;
+    }
+
+    TraceFileHeader header;
+    header.recordSize = sizeof(TraceRecord);
+    header.ticksPerSecond = ticksPerSecond;
+    header.startTicks = startTicks;
+    header.processId = processId;
+    *Header() = header;
+
+    m_capacity = settings.maxRecords;
+    m_next.store(0, std::memory_order_relaxed);
+    m_dropped.store(0, std::memory_order_relaxed);
+    m_active.store(true, std::memory_order_release);
+    return true;
+}
+
+void TraceWriter::Close() {
+    if (!m_active.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+    const uint64_t count = Written();
+    Header()->recordCount = count;
+    m_file.Close(static_cast<size_t>(TraceFileBytes(count)));
+}
+
+bool TraceWriter::Append(const TraceRecord &record) {
+    if (!Active()) {
+        return false;
+    }
+    const uint64_t index = m_next.fetch_add(1, std::memory_order_relaxed);
+    if (index >= m_capacity) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // Publish the hook id last: a reader of a crashed trace skips slots that were claimed but never completed
+    TraceRecord &slot = Records()[index];
+    TraceRecord pending = record;
+    pending.hook = TraceHook::None;
+    slot = pending;
+    std::atomic_ref(slot.hook).store(record.hook, std::memory_order_release);
+    return true;
+}
+
+uint64_t TraceWriter::Written() const {
+    return std::min(m_next.load(std::memory_order_relaxed), m_capacity);
+}
+
+TraceRecord *TraceWriter::Records() const {
+    return reinterpret_cast<TraceRecord *>(m_file.Data() + sizeof(TraceFileHeader));
+}
\ No newline at end of file
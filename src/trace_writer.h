@@ -0,0 +1,54 @@
+#ifndef SPLINTERCELLPATCH_TRACE_WRITER_H
+#define SPLINTERCELLPATCH_TRACE_WRITER_H
+
+#include "mapped_file.h"
+#include "trace_format.h"
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <string_view>
+
+struct TraceSettings {
+    std::string_view file;          // Empty disables tracing; relative to the working directory
+    uint32_t maxRecords = 1u << 18; // 16 MiB of records; later calls are counted as dropped
+};
+
+// Size of a trace file with room for records, in 64 bits so it cannot wrap around in 32-bit builds
+[[nodiscard]] constexpr uint64_t TraceFileBytes(uint64_t records) {
+    return sizeof(TraceFileHeader) + records * sizeof(TraceRecord);
+}
+
+// Largest trace file the writer maps: half the address space, more than a 32-bit process has contiguous room for
+inline constexpr uint64_t MAX_TRACE_FILE_BYTES = std::numeric_limits<size_t>::max() / 2;
+
+// Append-only hook trace. The whole file is mapped up front, so appending is a slot claim (one atomic add) and a
+// 64-byte copy into the view: hooks never wait for I/O, the OS writes pages back on its own.
+class TraceWriter {
+public:
+    // Fails if the file cannot be created or settings.maxRecords makes it larger than MAX_TRACE_FILE_BYTES
+    [[nodiscard]] bool Open(const TraceSettings &settings, uint64_t ticksPerSecond, uint64_t startTicks,
+                            uint32_t processId);
+
+    // Fills the record count and shrinks the file to the records written. No Append may run concurrently.
+    void Close();
+
+    [[nodiscard]] bool Active() const { return m_active.load(std::memory_order_relaxed); }
+
+    // Lock-free, safe from any thread. Returns false when the trace is closed or full.
+    bool Append(const TraceRecord &record);
+
+    [[nodiscard]] uint64_t Written() const;
+    [[nodiscard]] uint64_t Dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+    [[nodiscard]] TraceFileHeader *Header() const { return reinterpret_cast<TraceFileHeader *>(m_file.Data()); }
+    [[nodiscard]] TraceRecord *Records() const;
+
+    MappedFile m_file;
+    uint64_t m_capacity = 0;
+    std::atomic<bool> m_active = false;
+    std::atomic<uint64_t> m_next = 0;
+    std::atomic<uint64_t> m_dropped = 0;
+};
+
+#endif // SPLINTERCELLPATCH_TRACE_WRITER_H
\ No newline at end of file
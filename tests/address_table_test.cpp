@@ -0,0 +1,156 @@
+// AddressTable: capacity rounding, lookups of missing keys, and threads inserting and finding concurrently on a table
+// that fills up and on one where every key hashes to the same slot
+
+#include "address_table.h"
+#include "check.h"
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr size_t THREADS = 8;
+
+using Table = AddressTable<std::atomic<uint32_t>>;
+
+const void *Address(uintptr_t value) {
+    return reinterpret_cast<const void *>(value);
+}
+
+void TestCreate() {
+    Table table;
+    CHECK(!table.Active() && table.Find(Address(64)) == nullptr);
+    CHECK(!table.Create(0));
+    CHECK(table.Create(100));
+    CHECK(table.Active() && table.Capacity() == 128);
+    CHECK(!table.Create(100)); // Once only
+
+    bool inserted = false;
+    CHECK(table.FindOrInsert(nullptr, inserted) == nullptr && !inserted);
+    std::atomic<uint32_t> *value = table.FindOrInsert(Address(64), inserted);
+    CHECK(value != nullptr && inserted);
+    CHECK(table.FindOrInsert(Address(64), inserted) == value && !inserted);
+    CHECK(table.Find(Address(64)) == value && table.Find(Address(128)) == nullptr);
+
+    size_t visited = 0;
+    table.ForEach([&](const void *address, const std::atomic<uint32_t> &) {
+        CHECK(address == Address(64));
+        ++visited;
+    });
+    CHECK(visited == 1 && table.Size() == 1);
+}
+
+// Every thread inserts its own keys, twice as many as the table takes in total. Exactly the limit gets in, and each
+// key that got in is found again by every thread.
+void TestConcurrentFull() {
+    Table table;
+    CHECK(table.Create(64));
+    const size_t limit = table.Capacity() / 4 * 3;
+    const size_t keysPerThread = limit * 2 / THREADS;
+
+    std::atomic<size_t> inserts = 0;
+    std::vector<std::vector<std::atomic<uint32_t> *>> values(THREADS);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < THREADS; ++t) {
+        threads.emplace_back([&, t] {
+            for (size_t i = 0; i < keysPerThread; ++i) {
+                const void *key = Address((t * keysPerThread + i + 1) * 64);
+                bool inserted = false;
+                std::atomic<uint32_t> *value = table.FindOrInsert(key, inserted);
+                CHECK(value == nullptr || inserted);
+                CHECK(table.Find(key) == value);
+                if (value) {
+                    value->fetch_add(1, std::memory_order_relaxed);
+                    ++inserts;
+                }
+                values[t].push_back(value);
+            }
+        });
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    CHECK(inserts == limit && table.Size() == limit);
+    for (size_t t = 0; t < THREADS; ++t) {
+        for (size_t i = 0; i < keysPerThread; ++i) {
+            std::atomic<uint32_t> *value = values[t][i];
+            CHECK(table.Find(Address((t * keysPerThread + i + 1) * 64)) == value);
+            CHECK(value == nullptr || *value == 1);
+        }
+    }
+}
+
+// Keys sharing one home slot, found with the table's own Fibonacci hash
+std::vector<const void *> CollidingKeys(size_t capacity, size_t count) {
+    const int shift = 64 - std::countr_zero(capacity);
+    std::vector<const void *> keys;
+    for (uint64_t key = 16; keys.size() < count; key += 16) {
+        if (((key * 0x9E3779B97F4A7C15ull) >> shift) == 5) {
+            keys.push_back(Address(static_cast<uintptr_t>(key)));
+        }
+    }
+    return keys;
+}
+
+// Every thread inserts the same colliding keys, each starting at a different one, while a reader keeps looking them
+// up. Each key is claimed once, every thread gets its slot, and the reader never sees another key's value.
+void TestConcurrentCollisions() {
+    Table table;
+    CHECK(table.Create(64));
+    const std::vector<const void *> keys = CollidingKeys(table.Capacity(), 40);
+
+    using Values = std::vector<std::atomic<uint32_t> *>;
+    std::vector<Values> values(THREADS, Values(keys.size()));
+    std::atomic<bool> done = false;
+    Values seen(keys.size());
+    std::thread reader([&] {
+        while (!done) {
+            for (size_t i = 0; i < keys.size(); ++i) {
+                if (std::atomic<uint32_t> *value = table.Find(keys[i])) {
+                    CHECK(seen[i] == nullptr || seen[i] == value);
+                    seen[i] = value;
+                }
+            }
+        }
+    });
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < THREADS; ++t) {
+        threads.emplace_back([&, t] {
+            for (size_t n = 0; n < keys.size(); ++n) {
+                const size_t i = (t * 5 + n) % keys.size();
+                bool inserted = false;
+                values[t][i] = table.FindOrInsert(keys[i], inserted);
+                if (inserted) {
+                    values[t][i]->fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        });
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    done = true;
+    reader.join();
+
+    CHECK(table.Size() == keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        std::atomic<uint32_t> *value = table.Find(keys[i]);
+        CHECK(value != nullptr && *value == 1);
+        CHECK(seen[i] == nullptr || seen[i] == value);
+        for (size_t t = 0; t < THREADS; ++t) {
+            CHECK(values[t][i] == value);
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    TestCreate();
+    TestConcurrentFull();
+    TestConcurrentCollisions();
+    return CheckResult();
+}
\ No newline at end of file
@@ -0,0 +1,155 @@
+// L3DomainSelector growing and shrinking the active L3 domains, and threads placed domain by domain and again after a
+// reload, on sysfs fixtures of a two-CCD Ryzen and a single-L3 hybrid part
+
+#include "cache_locality.h"
+#include "check.h"
+#include "sysfs_fixture.h"
+#include "thread_placement.h"
+#include "topology.h"
+#include <initializer_list>
+
+namespace {
+
+ProcessorSet Set(std::initializer_list<uint32_t> indices) {
+    ProcessorSet set;
+    for (const uint32_t index : indices) {
+        set.Set(index);
+    }
+    return set;
+}
+
+const ProcessorSet FIRST_CCD = Set({0, 1, 2, 3, 8, 9, 10, 11});
+const ProcessorSet SECOND_CCD = Set({4, 5, 6, 7, 12, 13, 14, 15});
+
+bool LoadRyzen(CpuTopology &topology) {
+    const SysfsFixture fixture("locality-ryzen", TwoCcdRyzenCpus(), "0-15");
+    return LoadTopologyFromSysfs(fixture.Root(), topology) && topology.processors.size() == 16;
+}
+
+void TestSelectorExpandsAndShrinks() {
+    CpuTopology topology;
+    CHECK(LoadRyzen(topology));
+    const CacheLocalitySettings settings = {.enabled = true};
+    L3DomainSelector selector;
+    selector.Configure(topology, topology.All(), settings);
+    CHECK(selector.DomainCount() == 2 && selector.ActiveDomains() == 1);
+    CHECK(selector.Active() == FIRST_CCD);
+
+    // 90% of the eight active processors
+    CHECK(!selector.Update(7.0));
+    CHECK(selector.Update(7.2));
+    CHECK(selector.ActiveDomains() == 2 && selector.Active() == FIRST_CCD.Union(SECOND_CCD));
+    CHECK(!selector.Update(16.0)); // Nothing left to add
+
+    // Dropping the second CCD needs the first to be at most 60% busy for four samples in a row
+    CHECK(!selector.Update(4.0));
+    CHECK(!selector.Update(4.8));
+    CHECK(!selector.Update(3.0));
+    CHECK(!selector.Update(10.0)); // Too busy: the quiet samples start over
+    CHECK(!selector.Update(4.0));
+    CHECK(!selector.Update(4.0));
+    CHECK(!selector.Update(4.0));
+    CHECK(selector.ActiveDomains() == 2);
+    CHECK(selector.Update(4.0));
+    CHECK(selector.ActiveDomains() == 1 && selector.Active() == FIRST_CCD);
+    CHECK(!selector.Update(0.0)); // Never below one domain
+
+    // Reconfiguring starts over from the best domain
+    CHECK(selector.Update(8.0));
+    selector.Configure(topology, topology.All(), settings);
+    CHECK(selector.ActiveDomains() == 1 && selector.Active() == FIRST_CCD);
+}
+
+void TestSelectorSettings() {
+    CpuTopology topology;
+    CHECK(LoadRyzen(topology));
+    L3DomainSelector selector;
+    selector.Configure(topology, topology.All(),
+                       {.enabled = true, .expandBusyPercent = 50, .shrinkBusyPercent = 25, .shrinkSamples = 1});
+    CHECK(!selector.Update(3.9));
+    CHECK(selector.Update(4.0));
+    CHECK(!selector.Update(2.1));
+    CHECK(selector.Update(2.0));
+}
+
+// Only the allowed processors count: with one hardware thread per core, each CCD has four
+void TestSelectorAllowedSubset() {
+    CpuTopology topology;
+    CHECK(LoadRyzen(topology));
+    const ProcessorSet physical = ComputePolicySet(topology, AffinityPolicy::PhysicalCoresOnly);
+    L3DomainSelector selector;
+    selector.Configure(topology, physical, {.enabled = true});
+    CHECK(selector.DomainCount() == 2 && selector.Active() == Set({0, 1, 2, 3}));
+    CHECK(selector.Update(3.6));
+    CHECK(selector.Active() == physical);
+}
+
+void TestSelectorSingleDomain() {
+    const SysfsFixture fixture("locality-hybrid", HybridCpus(), "0-7");
+    CpuTopology topology;
+    CHECK(LoadTopologyFromSysfs(fixture.Root(), topology));
+    L3DomainSelector selector;
+    selector.Configure(topology, topology.All(), {.enabled = true});
+    CHECK(selector.DomainCount() == 1 && selector.Active().Count() == 8);
+    CHECK(!selector.Update(8.0));
+    CHECK(!selector.Update(0.0));
+
+    L3DomainSelector empty;
+    empty.Configure(CpuTopology{}, ProcessorSet{}, {.enabled = true});
+    CHECK(empty.DomainCount() == 0 && empty.ActiveDomains() == 0 && empty.Active().Empty());
+    CHECK(!empty.Update(1.0));
+}
+
+void TestPlacementByDomain() {
+    CpuTopology topology;
+    CHECK(LoadRyzen(topology));
+    const std::vector<ThreadPlacement> cores = OrderCoresByL3Domain(topology, topology.All());
+    CHECK(cores.size() == 8);
+    if (cores.size() != 8) {
+        return;
+    }
+    // Preferred cores first, the one hosting processor 0 last among them, then the rest of the first CCD
+    CHECK(cores[0].idealProcessor == 1 && cores[0].processors == Set({1, 9}));
+    CHECK(cores[1].idealProcessor == 0);
+    for (size_t i = 0; i < cores.size(); ++i) {
+        CHECK((i < 4 ? FIRST_CCD : SECOND_CCD).Test(cores[i].idealProcessor));
+    }
+
+    ThreadPlacer placer;
+    const auto list = BuildPlacementCores(topology, topology.All(), true);
+    for (uint32_t thread = 100; thread < 104; ++thread) {
+        CHECK(FIRST_CCD.Test(placer.Place(thread, list).idealProcessor));
+    }
+    CHECK(SECOND_CCD.Test(placer.Place(104, list).idealProcessor));
+    CHECK(placer.Place(100, list).idealProcessor == cores[0].idealProcessor); // Placed once
+    CHECK(placer.Find(104) && !placer.Find(105));
+}
+
+void TestPlacementReload() {
+    CpuTopology topology;
+    CHECK(LoadRyzen(topology));
+    ThreadPlacer placer;
+    const auto first = BuildPlacementCores(topology, topology.All(), true);
+    CHECK(FIRST_CCD.Test(placer.Place(100, first).idealProcessor));
+
+    // A newer list drops the old assignments; a caller still holding the old list does not bring them back
+    const auto second = BuildPlacementCores(topology, SECOND_CCD);
+    CHECK(second->generation > first->generation);
+    CHECK(SECOND_CCD.Test(placer.Place(101, second).idealProcessor));
+    CHECK(!placer.Find(100));
+    (void)placer.Place(100, first);
+    CHECK(!placer.Find(100) && placer.Find(101));
+    CHECK(placer.Place(102, second).idealProcessor != placer.Find(101)->idealProcessor);
+}
+
+} // namespace
+
+int main() {
+    TestSelectorExpandsAndShrinks();
+    TestSelectorSettings();
+    TestSelectorAllowedSubset();
+    TestSelectorSingleDomain();
+    TestPlacementByDomain();
+    TestPlacementReload();
+    return CheckResult();
+}
\ No newline at end of file
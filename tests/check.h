@@ -0,0 +1,30 @@
+#ifndef SPLINTERCELLPATCH_CHECK_H
+#define SPLINTERCELLPATCH_CHECK_H
+
+#include <cstdio>
+
+// Assertions for the unit tests under tests/. A failed CHECK reports its location and the test carries on, so one
+// run lists every failure; main returns CheckResult(), which ctest reads.
+
+inline int &CheckFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(condition)                                                                       \
+    do {                                                                                       \
+        if (!(condition)) {                                                                    \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #condition); \
+            ++CheckFailures();                                                                 \
+        }                                                                                      \
+    } while (false)
+
+inline int CheckResult() {
+    if (CheckFailures() != 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", CheckFailures());
+        return 1;
+    }
+    return 0;
+}
+
+#endif // SPLINTERCELLPATCH_CHECK_H
\ No newline at end of file
@@ -0,0 +1,128 @@
+// SplinterCellPatch.ini parsing: global keys and the executable's section, errors reported per line without
+// touching the profile, sections for other executables still checked, and strings owned by the parsed config
+
+#include "check.h"
+#include "config_file.h"
+#include "priority_rules.h"
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace {
+
+constexpr std::string_view EXECUTABLE = "C:\\Games\\Splinter Cell\\system\\SplinterCell.exe";
+
+bool HasError(const ProfileConfig &config, uint32_t line, std::string_view message) {
+    for (const ConfigError &error : config.errors) {
+        if (error.line == line && error.message == message) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void TestSections() {
+    const std::string_view text = "# comment\n"
+                                  "policy = all-cores\n"
+                                  "hotThreads.intervalMs = 250\n"
+                                  "\n"
+                                  "[splintercell.EXE]\n"
+                                  "policy = single-L3-domain\n"
+                                  "Placement = soft-cpu-sets\n"
+                                  "priority.maxClass = high\n"
+                                  "monotonicTimers = off\n"
+                                  "; another comment\n"
+                                  "[SCCT_Game.exe]\n"
+                                  "policy = P-cores-only\n"
+                                  "hotThreads.intervalMs = 1000\n";
+    const std::unique_ptr<ProfileConfig> config = ParseProfileConfig(text, EXECUTABLE, DEFAULT_PROFILE);
+    CHECK(config->errors.empty());
+    CHECK(config->profile.policy == AffinityPolicy::SingleL3Domain);
+    CHECK(config->profile.placement == PlacementMode::SoftCpuSets);
+    CHECK(config->profile.priority.maxPriorityClass == PRIORITY_CLASS_HIGH);
+    CHECK(!config->profile.monotonicTimers);
+    CHECK(config->profile.hotThreads.intervalMs == 250);
+
+    // Keys the file does not mention keep the base profile's values
+    CHECK(config->profile.hotThreads.maxHotThreads == DEFAULT_PROFILE.hotThreads.maxHotThreads);
+    CHECK(config->profile.statistics == DEFAULT_PROFILE.statistics);
+}
+
+void TestErrors() {
+    const std::string_view text = "policy = physical-cores-only\n"    // 1
+                                  "policy = every-core\n"             // 2: invalid value, the line above stays
+                                  "hotThreads.intervalMs = -5\n"      // 3: not an unsigned number
+                                  "hotThreads.maxHotThreads = 4x\n"   // 4: trailing garbage
+                                  "statistics = maybe\n"              // 5: not a boolean
+                                  "priority.maxClass = turbo\n"       // 6: unknown priority name
+                                  "colour = blue\n"                   // 7: unknown key
+                                  "just some words\n"                 // 8: no '='
+                                  "[SplinterCell.exe\n"               // 9: unterminated section
+                                  "[Other.exe]\n"                     // 10
+                                  "placement = sideways\n"            // 11: checked although not applied
+                                  "hookBackend = import-table\n";     // 12: valid, not applied
+    const std::unique_ptr<ProfileConfig> config = ParseProfileConfig(text, EXECUTABLE, DEFAULT_PROFILE);
+    CHECK(config->errors.size() == 9);
+    CHECK(HasError(*config, 2, "invalid value"));
+    CHECK(HasError(*config, 3, "invalid value"));
+    CHECK(HasError(*config, 4, "invalid value"));
+    CHECK(HasError(*config, 5, "invalid value"));
+    CHECK(HasError(*config, 6, "invalid value"));
+    CHECK(HasError(*config, 7, "unknown key"));
+    CHECK(HasError(*config, 8, "expected 'key = value'"));
+    CHECK(HasError(*config, 9, "unterminated section name"));
+    CHECK(HasError(*config, 11, "invalid value"));
+
+    // Errors come sorted by line even though other sections are checked first
+    for (size_t i = 1; i < config->errors.size(); ++i) {
+        CHECK(config->errors[i - 1].line <= config->errors[i].line);
+    }
+
+    // Rejected lines leave the profile alone
+    CHECK(config->profile.policy == AffinityPolicy::PhysicalCoresOnly);
+    CHECK(config->profile.hotThreads.intervalMs == DEFAULT_PROFILE.hotThreads.intervalMs);
+    CHECK(config->profile.hotThreads.maxHotThreads == DEFAULT_PROFILE.hotThreads.maxHotThreads);
+    CHECK(config->profile.statistics == DEFAULT_PROFILE.statistics);
+    CHECK(config->profile.priority.maxPriorityClass == DEFAULT_PROFILE.priority.maxPriorityClass);
+    CHECK(config->profile.hookBackend == DEFAULT_PROFILE.hookBackend);
+}
+
+void TestStrings() {
+    ExecutableProfile base = DEFAULT_PROFILE;
+    base.logFile = "base.log";
+    base.trace.file = "base.bin";
+
+    std::unique_ptr<ProfileConfig> first;
+    {
+        std::string text = "logFile = \"  spaced.log  \"\n";
+        first = ParseProfileConfig(text, "SplinterCell.exe", base);
+        text.assign(text.size(), '#');
+    }
+    CHECK(first->errors.empty());
+    CHECK(first->profile.logFile == "  spaced.log  ");
+    CHECK(first->profile.logFile.data() == first->logFile.data());
+    CHECK(first->profile.trace.file == "base.bin");
+
+    // A config built on top of another copies its strings, so the first one can be released
+    std::unique_ptr<ProfileConfig> second = ParseProfileConfig("trace.file = run.bin\n", EXECUTABLE, first->profile);
+    first.reset();
+    CHECK(second->profile.logFile == "  spaced.log  ");
+    CHECK(second->profile.trace.file == "run.bin");
+    CHECK(second->profile.logFile.data() == second->logFile.data());
+}
+
+void TestConfigFilePath() {
+    CHECK(ConfigFilePath(EXECUTABLE) == "C:\\Games\\Splinter Cell\\system\\SplinterCellPatch.ini");
+    CHECK(ConfigFilePath("/games/sc/SplinterCell.exe") == "/games/sc/SplinterCellPatch.ini");
+    CHECK(ConfigFilePath("SplinterCell.exe") == "SplinterCellPatch.ini");
+}
+
+} // namespace
+
+int main() {
+    TestSections();
+    TestErrors();
+    TestStrings();
+    TestConfigFilePath();
+    return CheckResult();
+}
\ No newline at end of file
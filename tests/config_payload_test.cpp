@@ -0,0 +1,218 @@
+// Launcher-to-DLL config payloads: every field survives a write/read round trip, Detours padding is ignored, and
+// damaged payloads (magic, version, checksum, truncation, enums out of range) are rejected without touching the
+// config they were read into
+
+#include "check.h"
+#include "config_payload.h"
+#include "priority_rules.h"
+#include <cstring>
+#include <vector>
+
+namespace {
+
+constexpr size_t BODY_POLICY = CONFIG_PAYLOAD_HEADER_SIZE;
+constexpr size_t BODY_PLACEMENT = BODY_POLICY + 1;
+constexpr size_t BODY_HOOK_BACKEND = BODY_PLACEMENT + 1;
+
+// A profile with no field left at its default, so a field the payload drops shows up
+ExecutableProfile DistinctProfile() {
+    ExecutableProfile profile = DEFAULT_PROFILE;
+    profile.policy = AffinityPolicy::SingleL3Domain;
+    profile.placement = PlacementMode::SoftCpuSets;
+    profile.hookBackend = HookBackend::ImportTable;
+    profile.priority = {.maxPriorityClass = PRIORITY_CLASS_HIGH,
+                        .maxMainThreadPriority = THREAD_PRIORITY_LEVEL_TIME_CRITICAL,
+                        .maxWorkerThreadPriority = THREAD_PRIORITY_LEVEL_LOWEST};
+    profile.hotThreads = {.enabled = false, .intervalMs = 125, .maxHotThreads = 3, .minSharePercent = 17,
+                          .promoteSamples = 4, .demoteSamples = 9};
+    profile.locality = {.enabled = true, .expandBusyPercent = 91, .shrinkBusyPercent = 33, .shrinkSamples = 7};
+    profile.monotonicTimers = false;
+    profile.statistics = false;
+    profile.control = false;
+    profile.suspendAllThreads = false;
+    profile.logFile = "logs/patch.log";
+    profile.trace = {.file = "C:\\traces\\run one.bin", .maxRecords = 4096};
+    profile.heap.enabled = true;
+    profile.heap.arenaMiB = 96;
+    profile.spinTuning.enabled = true;
+    profile.spinTuning.initialSpinCount = 1500;
+    profile.spinTuning.minSpinCount = 50;
+    profile.spinTuning.maxSpinCount = 12000;
+    profile.spinTuning.maxLocks = 300;
+    profile.lockProfiling.enabled = true;
+    profile.lockProfiling.maxLocks = 700;
+    profile.lockProfiling.reportLocks = 11;
+    return profile;
+}
+
+uint32_t Fnv1a(const std::vector<uint8_t> &bytes, size_t begin, size_t end) {
+    uint32_t hash = 0x811C9DC5;
+    for (size_t i = begin; i < end; ++i) {
+        hash = (hash ^ bytes[i]) * 0x01000193;
+    }
+    return hash;
+}
+
+// Stores the size and checksum of a payload edited after it was written, so only the edit itself is rejected
+void Reseal(std::vector<uint8_t> &payload) {
+    const auto size = static_cast<uint32_t>(payload.size());
+    const uint32_t checksum = Fnv1a(payload, CONFIG_PAYLOAD_HEADER_SIZE, payload.size());
+    std::memcpy(payload.data() + 8, &size, 4);
+    std::memcpy(payload.data() + 12, &checksum, 4);
+}
+
+// Reads into a config holding a marker profile and checks it came back untouched
+ConfigPayloadStatus ReadRejected(const std::vector<uint8_t> &payload) {
+    ProfileConfig config;
+    config.profile = DEFAULT_PROFILE;
+    config.logFile = "untouched.log";
+    config.profile.logFile = config.logFile;
+    const ConfigPayloadStatus status = ReadConfigPayload(payload, config);
+    if (status != ConfigPayloadStatus::Ok) {
+        CHECK(config.logFile == "untouched.log");
+        CHECK(config.profile.policy == DEFAULT_PROFILE.policy);
+        CHECK(config.profile.statistics == DEFAULT_PROFILE.statistics);
+    }
+    return status;
+}
+
+void CheckSameProfile(const ExecutableProfile &read, const ExecutableProfile &written) {
+    CHECK(read.executable == DEFAULT_PROFILE.executable); // Not part of the payload
+    CHECK(read.policy == written.policy);
+    CHECK(read.placement == written.placement);
+    CHECK(read.hookBackend == written.hookBackend);
+    CHECK(read.priority.maxPriorityClass == written.priority.maxPriorityClass);
+    CHECK(read.priority.maxMainThreadPriority == written.priority.maxMainThreadPriority);
+    CHECK(read.priority.maxWorkerThreadPriority == written.priority.maxWorkerThreadPriority);
+    CHECK(read.hotThreads.enabled == written.hotThreads.enabled);
+    CHECK(read.hotThreads.intervalMs == written.hotThreads.intervalMs);
+    CHECK(read.hotThreads.maxHotThreads == written.hotThreads.maxHotThreads);
+    CHECK(read.hotThreads.minSharePercent == written.hotThreads.minSharePercent);
+    CHECK(read.hotThreads.promoteSamples == written.hotThreads.promoteSamples);
+    CHECK(read.hotThreads.demoteSamples == written.hotThreads.demoteSamples);
+    CHECK(read.locality.enabled == written.locality.enabled);
+    CHECK(read.locality.expandBusyPercent == written.locality.expandBusyPercent);
+    CHECK(read.locality.shrinkBusyPercent == written.locality.shrinkBusyPercent);
+    CHECK(read.locality.shrinkSamples == written.locality.shrinkSamples);
+    CHECK(read.monotonicTimers == written.monotonicTimers);
+    CHECK(read.statistics == written.statistics);
+    CHECK(read.control == written.control);
+    CHECK(read.suspendAllThreads == written.suspendAllThreads);
+    CHECK(read.logFile == written.logFile);
+    CHECK(read.trace.file == written.trace.file);
+    CHECK(read.trace.maxRecords == written.trace.maxRecords);
+    CHECK(read.heap.enabled == written.heap.enabled);
+    CHECK(read.heap.arenaMiB == written.heap.arenaMiB);
+    CHECK(read.spinTuning.enabled == written.spinTuning.enabled);
+    CHECK(read.spinTuning.initialSpinCount == written.spinTuning.initialSpinCount);
+    CHECK(read.spinTuning.minSpinCount == written.spinTuning.minSpinCount);
+    CHECK(read.spinTuning.maxSpinCount == written.spinTuning.maxSpinCount);
+    CHECK(read.spinTuning.maxLocks == written.spinTuning.maxLocks);
+    CHECK(read.lockProfiling.enabled == written.lockProfiling.enabled);
+    CHECK(read.lockProfiling.maxLocks == written.lockProfiling.maxLocks);
+    CHECK(read.lockProfiling.reportLocks == written.lockProfiling.reportLocks);
+}
+
+void TestRoundTrip() {
+    for (const ExecutableProfile &written : {DEFAULT_PROFILE, DistinctProfile()}) {
+        const std::vector<uint8_t> payload = WriteConfigPayload(written);
+        ProfileConfig config;
+        config.profile = DEFAULT_PROFILE;
+        CHECK(ReadConfigPayload(payload, config) == ConfigPayloadStatus::Ok);
+        CheckSameProfile(config.profile, written);
+
+        // The profile's strings point into the config, not into the payload
+        CHECK(config.profile.logFile.data() == config.logFile.data());
+        CHECK(config.profile.trace.file.data() == config.traceFile.data());
+    }
+}
+
+void TestPadding() {
+    // DetourCopyPayloadToProcess may hand back more bytes than were written
+    const ExecutableProfile written = DistinctProfile();
+    std::vector<uint8_t> payload = WriteConfigPayload(written);
+    payload.resize(payload.size() + 13, 0xCD);
+    ProfileConfig config;
+    config.profile = DEFAULT_PROFILE;
+    CHECK(ReadConfigPayload(payload, config) == ConfigPayloadStatus::Ok);
+    CheckSameProfile(config.profile, written);
+}
+
+void TestHeader() {
+    const std::vector<uint8_t> payload = WriteConfigPayload(DistinctProfile());
+
+    std::vector<uint8_t> damaged = payload;
+    damaged[0] ^= 0xFF;
+    CHECK(ReadRejected(damaged) == ConfigPayloadStatus::BadMagic);
+
+    damaged = payload;
+    const uint16_t nextVersion = CONFIG_PAYLOAD_VERSION + 1;
+    std::memcpy(damaged.data() + 4, &nextVersion, 2);
+    CHECK(ReadRejected(damaged) == ConfigPayloadStatus::UnsupportedVersion);
+
+    damaged = payload;
+    const uint16_t largerHeader = CONFIG_PAYLOAD_HEADER_SIZE + 4;
+    std::memcpy(damaged.data() + 6, &largerHeader, 2);
+    CHECK(ReadRejected(damaged) == ConfigPayloadStatus::UnsupportedVersion);
+
+    damaged.assign(payload.begin(), payload.begin() + CONFIG_PAYLOAD_HEADER_SIZE - 1);
+    CHECK(ReadRejected(damaged) == ConfigPayloadStatus::Truncated);
+    CHECK(ReadRejected({}) == ConfigPayloadStatus::Truncated);
+
+    // The recorded size is larger than what arrived, or smaller than a header
+    damaged.assign(payload.begin(), payload.end() - 1);
+    CHECK(ReadRejected(damaged) == ConfigPayloadStatus::Truncated);
+    damaged = payload;
+    const uint32_t tooSmall = CONFIG_PAYLOAD_HEADER_SIZE - 1;
+    std::memcpy(damaged.data() + 8, &tooSmall, 4);
+    CHECK(ReadRejected(damaged) == ConfigPayloadStatus::Truncated);
+}
+
+void TestChecksum() {
+    const std::vector<uint8_t> payload = WriteConfigPayload(DistinctProfile());
+    for (const size_t offset : {BODY_POLICY, BODY_POLICY + 20, payload.size() - 1}) {
+        std::vector<uint8_t> damaged = payload;
+        damaged[offset] ^= 0x01;
+        CHECK(ReadRejected(damaged) == ConfigPayloadStatus::BadChecksum);
+    }
+    std::vector<uint8_t> damaged = payload;
+    damaged[12] ^= 0x80;
+    CHECK(ReadRejected(damaged) == ConfigPayloadStatus::BadChecksum);
+}
+
+void TestBody() {
+    const std::vector<uint8_t> payload = WriteConfigPayload(DistinctProfile());
+
+    // A body cut short but sealed as if it were whole: fixed fields, then a string running past the end
+    std::vector<uint8_t> damaged(payload.begin(), payload.begin() + BODY_POLICY + 10);
+    Reseal(damaged);
+    CHECK(ReadRejected(damaged) == ConfigPayloadStatus::Truncated);
+    damaged.assign(payload.begin(), payload.end() - 3);
+    Reseal(damaged);
+    CHECK(ReadRejected(damaged) == ConfigPayloadStatus::Truncated);
+
+    for (const size_t offset : {BODY_POLICY, BODY_PLACEMENT, BODY_HOOK_BACKEND}) {
+        damaged = payload;
+        damaged[offset] = 0xEE;
+        Reseal(damaged);
+        CHECK(ReadRejected(damaged) == ConfigPayloadStatus::InvalidValue);
+    }
+}
+
+void TestStatusNames() {
+    CHECK(ConfigPayloadStatusName(ConfigPayloadStatus::Ok) == "ok");
+    CHECK(ConfigPayloadStatusName(ConfigPayloadStatus::BadChecksum) == "checksum mismatch");
+    CHECK(ConfigPayloadStatusName(static_cast<ConfigPayloadStatus>(200)) == "unknown");
+}
+
+} // namespace
+
+int main() {
+    TestRoundTrip();
+    TestPadding();
+    TestHeader();
+    TestChecksum();
+    TestBody();
+    TestStatusNames();
+    return CheckResult();
+}
\ No newline at end of file
@@ -0,0 +1,176 @@
+// HookStats shared-memory blocks: one shard per processor across groups, totals seen by the writer and by a reader
+// in the same section, latency buckets and percentiles, and readers refusing blocks they cannot parse
+
+#include "check.h"
+#include "hook_stats.h"
+#include "shared_memory.h"
+#include "topology.h"
+#include <array>
+#include <cstring>
+#include <random>
+#include <set>
+
+namespace {
+
+constexpr uint64_t TICKS_PER_SECOND = 10000000;
+
+// Process ids no real process has, so the sections never clash with a running game or another test run
+uint32_t TestProcessId(uint32_t offset) {
+    static const uint32_t base = 0x40000000u | (std::random_device{}() & 0x0FFFFFF8u);
+    return base + offset;
+}
+
+uint32_t Processor(uint32_t group, uint32_t number) {
+    return group * PROCESSORS_PER_GROUP + number;
+}
+
+void TestShardPerProcessor() {
+    // Two groups of 36 processors: more than fit a single 64-bit group index, fewer than 64 per group
+    const std::array<uint32_t, 2> groups = {36, 36};
+    HookStats stats;
+    CHECK(stats.Create(TestProcessId(0), TICKS_PER_SECOND, groups));
+    CHECK(stats.ShardCount() == 72);
+
+    std::set<uint32_t> shards;
+    for (uint32_t group = 0; group < groups.size(); ++group) {
+        for (uint32_t number = 0; number < groups[group]; ++number) {
+            const uint32_t shard = stats.Shard(Processor(group, number));
+            CHECK(shard < stats.ShardCount());
+            shards.insert(shard);
+        }
+    }
+    CHECK(shards.size() == 72);
+    CHECK(stats.Shard(Processor(0, 0)) == 0);
+    CHECK(stats.Shard(Processor(1, 0)) == 36);
+    CHECK(stats.Shard(Processor(1, 35)) == 71);
+
+    // Processors Create was not told about still land on a valid shard
+    CHECK(stats.Shard(Processor(0, 40)) < stats.ShardCount());
+    CHECK(stats.Shard(Processor(5, 3)) < stats.ShardCount());
+    stats.Close();
+}
+
+void TestNoGroups() {
+    HookStats stats;
+    CHECK(stats.Create(TestProcessId(1), TICKS_PER_SECOND, {}));
+    CHECK(stats.ShardCount() == 1);
+    CHECK(stats.Shard(Processor(3, 17)) == 0);
+    stats.RecordCall(Processor(3, 17), TraceHook::SetThreadPriority, false, false);
+    CHECK(stats.Snapshot()[static_cast<size_t>(TraceHook::SetThreadPriority)].calls == 1);
+    stats.Close();
+}
+
+void TestTotals() {
+    const uint32_t processId = TestProcessId(2);
+    const std::array<uint32_t, 2> groups = {4, 2};
+    HookStats stats;
+    CHECK(stats.Create(processId, TICKS_PER_SECOND, groups));
+    CHECK(stats.Active());
+    CHECK(!stats.Create(processId, TICKS_PER_SECOND, groups));
+
+    const auto hook = TraceHook::SetThreadAffinityMask;
+    for (uint32_t number = 0; number < 4; ++number) {
+        stats.RecordCall(Processor(0, number), hook, number % 2 == 0, false);
+    }
+    stats.RecordCall(Processor(1, 1), hook, false, true);
+    stats.RecordLatency(Processor(0, 2), hook, 0);
+    stats.RecordLatency(Processor(1, 0), hook, 100);
+    stats.RecordAddressSpace({.total = 4096, .free = 1024, .largestFree = 512});
+
+    const HookTotals totals = stats.Snapshot()[static_cast<size_t>(hook)];
+    CHECK(totals.calls == 5);
+    CHECK(totals.rewrites == 2);
+    CHECK(totals.failures == 1);
+    CHECK(totals.latency[0] == 1);
+    CHECK(totals.latency[LatencyBucket(100)] == 1);
+    CHECK(stats.Snapshot()[static_cast<size_t>(TraceHook::CreateThread)].calls == 0);
+
+    HookStatsReader reader;
+    CHECK(reader.Open(processId));
+    CHECK(reader.TicksPerSecond() == TICKS_PER_SECOND);
+    const HookTotals read = reader.Snapshot()[static_cast<size_t>(hook)];
+    CHECK(read.calls == 5);
+    CHECK(read.rewrites == 2);
+    CHECK(read.failures == 1);
+    CHECK(read.latency == totals.latency);
+    CHECK(reader.AddressSpace().total == 4096);
+    CHECK(reader.AddressSpace().largestFree == 512);
+
+    stats.Close();
+    CHECK(!stats.Active());
+}
+
+void TestLatency() {
+    CHECK(LatencyBucket(0) == 0);
+    CHECK(LatencyBucket(1) == 1);
+    CHECK(LatencyBucket(2) == 2);
+    CHECK(LatencyBucket(3) == 2);
+    CHECK(LatencyBucket(4) == 3);
+    CHECK(LatencyBucket(~uint64_t{0}) == LATENCY_BUCKETS - 1);
+
+    std::array<uint64_t, LATENCY_BUCKETS> latency = {};
+    CHECK(LatencyPercentile(latency, 0.5) == 0);
+    latency[LatencyBucket(3)] = 90;
+    latency[LatencyBucket(1000)] = 10;
+    CHECK(LatencyPercentile(latency, 0.5) == 3);
+    CHECK(LatencyPercentile(latency, 0.9) == 3);
+    CHECK(LatencyPercentile(latency, 0.99) == 1023);
+    CHECK(LatencyPercentile(latency, 1.0) == 1023);
+}
+
+// Writes a block by hand so the reader can be fed headers HookStats never produces
+bool OpenForged(uint32_t processId, const StatsBlockHeader &header, size_t size) {
+    SharedMemory memory;
+    if (!memory.Create(StatsSectionName(processId), size)) {
+        return false;
+    }
+    std::memcpy(memory.Data(), &header, sizeof(header));
+    HookStatsReader reader;
+    return reader.Open(processId);
+}
+
+void TestReaderRejects() {
+    HookStatsReader reader;
+    CHECK(!reader.Open(TestProcessId(3)));
+
+    const uint32_t processId = TestProcessId(4);
+    StatsBlockHeader header;
+    header.shardCount = 2;
+    CHECK(OpenForged(processId, header, StatsBlockBytes(2)));
+
+    StatsBlockHeader badMagic = header;
+    badMagic.magic[0] = 'X';
+    CHECK(!OpenForged(processId, badMagic, StatsBlockBytes(2)));
+
+    StatsBlockHeader oldVersion = header;
+    oldVersion.version = 1;
+    CHECK(!OpenForged(processId, oldVersion, StatsBlockBytes(2)));
+
+    StatsBlockHeader otherHooks = header;
+    otherHooks.hookCount = STATS_HOOKS + 1;
+    CHECK(!OpenForged(processId, otherHooks, StatsBlockBytes(2)));
+
+    StatsBlockHeader otherBuckets = header;
+    otherBuckets.bucketCount = LATENCY_BUCKETS / 2;
+    CHECK(!OpenForged(processId, otherBuckets, StatsBlockBytes(2)));
+
+    StatsBlockHeader noShards = header;
+    noShards.shardCount = 0;
+    CHECK(!OpenForged(processId, noShards, StatsBlockBytes(2)));
+
+    // A header announcing more shards than the section holds
+    StatsBlockHeader truncated = header;
+    truncated.shardCount = 64;
+    CHECK(!OpenForged(processId, truncated, StatsBlockBytes(2)));
+}
+
+} // namespace
+
+int main() {
+    TestShardPerProcessor();
+    TestNoGroups();
+    TestTotals();
+    TestLatency();
+    TestReaderRejects();
+    return CheckResult();
+}
\ No newline at end of file
@@ -0,0 +1,116 @@
+// LogRing capacity, ordering, full and empty states, and records from concurrent producers
+
+#include "check.h"
+#include "log_ring.h"
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace {
+
+LogRecord MakeRecord(uint32_t producer, uint64_t sequence) {
+    LogRecord record;
+    record.pattern = "test";
+    record.timestamp = sequence;
+    std::memcpy(record.payload.data(), &producer, sizeof(producer));
+    std::memcpy(record.payload.data() + sizeof(uint64_t), &sequence, sizeof(sequence));
+    return record;
+}
+
+void ReadRecord(const LogRecord &record, uint32_t &producer, uint64_t &sequence) {
+    std::memcpy(&producer, record.payload.data(), sizeof(producer));
+    std::memcpy(&sequence, record.payload.data() + sizeof(uint64_t), sizeof(sequence));
+}
+
+void TestCapacity() {
+    CHECK(LogRing(0).Capacity() == 2);
+    CHECK(LogRing(5).Capacity() == 8);
+    CHECK(LogRing(4096).Capacity() == 4096);
+}
+
+void TestSingleProducer() {
+    LogRing ring(4);
+    LogRecord record;
+    CHECK(!ring.TryPop(record));
+
+    for (uint64_t i = 0; i < 4; ++i) {
+        CHECK(ring.TryPush(MakeRecord(0, i)));
+    }
+    CHECK(!ring.TryPush(MakeRecord(0, 4))); // Full
+
+    // Records come out in order, with their fields intact, and free their slots
+    for (uint64_t i = 0; i < 2; ++i) {
+        CHECK(ring.TryPop(record));
+        uint32_t producer = 1;
+        uint64_t sequence = 0;
+        ReadRecord(record, producer, sequence);
+        CHECK(producer == 0 && sequence == i && record.timestamp == i && record.pattern == "test");
+    }
+    CHECK(ring.TryPush(MakeRecord(0, 4)));
+    CHECK(ring.TryPush(MakeRecord(0, 5)));
+    CHECK(!ring.TryPush(MakeRecord(0, 6)));
+
+    // Around the end of the slot array several times
+    for (uint64_t next = 2; next < 40; ++next) {
+        CHECK(ring.TryPop(record) && record.timestamp == next);
+        CHECK(ring.TryPush(MakeRecord(0, next + 4)));
+    }
+    for (uint64_t next = 40; next < 44; ++next) {
+        CHECK(ring.TryPop(record) && record.timestamp == next);
+    }
+    CHECK(!ring.TryPop(record));
+}
+
+// Every record arrives exactly once, and each producer's in the order it pushed them
+void TestConcurrentProducers() {
+    constexpr uint32_t PRODUCERS = 4;
+    constexpr uint64_t RECORDS = 50000;
+    LogRing ring(64);
+
+    std::vector<std::thread> producers;
+    for (uint32_t producer = 0; producer < PRODUCERS; ++producer) {
+        producers.emplace_back([&ring, producer] {
+            for (uint64_t sequence = 0; sequence < RECORDS; ++sequence) {
+                while (!ring.TryPush(MakeRecord(producer, sequence))) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    uint64_t expected[PRODUCERS] = {};
+    uint64_t received = 0;
+    bool ordered = true;
+    LogRecord record;
+    while (received < PRODUCERS * RECORDS) {
+        if (!ring.TryPop(record)) {
+            std::this_thread::yield();
+            continue;
+        }
+        uint32_t producer = 0;
+        uint64_t sequence = 0;
+        ReadRecord(record, producer, sequence);
+        // Keep draining after a mismatch, or the producers would wait for space forever
+        if (producer < PRODUCERS && sequence == expected[producer]) {
+            ++expected[producer];
+        } else {
+            ordered = false;
+        }
+        ++received;
+    }
+    for (std::thread &thread : producers) {
+        thread.join();
+    }
+    CHECK(ordered);
+    CHECK(received == PRODUCERS * RECORDS);
+    CHECK(!ring.TryPop(record));
+}
+
+} // namespace
+
+int main() {
+    TestCapacity();
+    TestSingleProducer();
+    TestConcurrentProducers();
+    return CheckResult();
+}
\ No newline at end of file
@@ -0,0 +1,131 @@
+// MonotonicCounter clamping within a thread and across threads, through the wrap of 32-bit millisecond counters and
+// after a long idle stretch; no thread may ever read below a value another thread has already been returned
+
+#include "check.h"
+#include "monotonic_clock.h"
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+namespace {
+
+// Runs fn on a thread of its own
+template <typename Fn>
+void OnThread(Fn &&fn) {
+    std::thread(std::forward<Fn>(fn)).join();
+}
+
+void TestSingleThread() {
+    MonotonicCounter<uint64_t> counter;
+    counter.Seed(100);
+    CHECK(counter.Advance(100) == 100);
+    CHECK(counter.Advance(150) == 150);
+    CHECK(counter.Advance(140) == 150);
+    CHECK(counter.Advance(150) == 150); // Standing still is not going backwards
+    CHECK(counter.Clamped() == 1);
+    CHECK(counter.Advance(90) == 150); // Behind the seed as well
+    CHECK(counter.Advance(151) == 151);
+    CHECK(counter.Clamped() == 2);
+}
+
+void TestAcrossThreads() {
+    MonotonicCounter<uint64_t> counter;
+    counter.Seed(0);
+    CHECK(counter.Advance(1000) == 1000);
+
+    // Another thread whose core lags behind never reads below what this one was returned
+    OnThread([&] {
+        CHECK(counter.Advance(900) == 1000);
+        CHECK(counter.Advance(950) == 1000);
+        CHECK(counter.Advance(1010) == 1010);
+    });
+    CHECK(counter.Clamped() == 2);
+
+    // And the other way round: this thread's lagging core is clamped to the other thread's reading
+    CHECK(counter.Advance(1005) == 1010);
+    CHECK(counter.Advance(1020) == 1020);
+    OnThread([&] { CHECK(counter.Advance(1015) == 1020); });
+    CHECK(counter.Clamped() == 4);
+}
+
+void TestWrap() {
+    MonotonicCounter<uint32_t> counter;
+    counter.Seed(0xFFFFFFF0u);
+    CHECK(counter.Advance(0xFFFFFFF8u) == 0xFFFFFFF8u);
+    CHECK(counter.Advance(0x10u) == 0x10u);
+    CHECK(counter.Advance(0xFFFFFFFFu) == 0x10u);
+    CHECK(counter.Advance(0x11u) == 0x11u);
+    CHECK(counter.Clamped() == 1);
+
+    // Another thread reading from before the wrap is clamped past it
+    OnThread([&] { CHECK(counter.Advance(0xFFFFFFFAu) == 0x11u); });
+}
+
+// One thread reads the clock around the whole range while another sits idle; the idle thread then reads a lagging
+// core and must still not go below the busy thread's last value
+void TestIdleThread() {
+    using Counter = MonotonicCounter<uint32_t>;
+    Counter counter;
+    counter.Seed(0);
+    CHECK(counter.Advance(5) == 5);
+    uint32_t busyLast = 0;
+    OnThread([&] {
+        for (uint32_t step = 1; step <= 16; ++step) {
+            busyLast = counter.Advance(step * 0x10000000u + 5); // The last step wraps to 5
+            CHECK(busyLast == step * 0x10000000u + 5);
+        }
+    });
+    CHECK(busyLast == 5);
+    CHECK(counter.Advance(3) == 5);
+    CHECK(counter.Advance(6) == 6);
+    CHECK(counter.Clamped() == 1);
+
+    // Nobody read the clock for longer than the clamp window: the reading is new time, not drift
+    const uint32_t later = 6 + Counter::CLAMP_WINDOW * 4;
+    OnThread([&] { CHECK(counter.Advance(later) == later); });
+    CHECK(counter.Advance(later - 1) == later);
+    const uint32_t lapped = later - Counter::CLAMP_WINDOW - 1;
+    CHECK(counter.Advance(lapped) == lapped);
+}
+
+// Every reader sees a shared source through a skewed, unsynchronized "core counter". Before each reading a reader
+// takes note of the highest value any reader has already been returned, and its own reading must not be below it.
+void TestConcurrentReaders() {
+    MonotonicCounter<uint64_t> counter;
+    counter.Seed(0);
+    std::atomic<uint64_t> source = 0;
+    std::atomic<uint64_t> returned = 0; // Highest value returned to any reader, published after the reading
+    std::atomic<uint64_t> behind = 0;
+    const auto reader = [&](uint64_t skew) {
+        for (int i = 0; i < 100000; ++i) {
+            const uint64_t seen = returned.load(std::memory_order_acquire);
+            const uint64_t raw = source.fetch_add(1) + ((i & 1) ? skew : 0);
+            const uint64_t value = counter.Advance(raw);
+            if (value < seen) {
+                behind.fetch_add(1);
+            }
+            uint64_t highest = returned.load(std::memory_order_relaxed);
+            while (highest < value &&
+                   !returned.compare_exchange_weak(highest, value, std::memory_order_release)) {
+            }
+        }
+    };
+    std::thread first(reader, 0);
+    std::thread second(reader, 50);
+    reader(25);
+    first.join();
+    second.join();
+    CHECK(behind == 0);
+    CHECK(counter.Clamped() > 0);
+}
+
+} // namespace
+
+int main() {
+    TestSingleThread();
+    TestAcrossThreads();
+    TestWrap();
+    TestIdleThread();
+    TestConcurrentReaders();
+    return CheckResult();
+}
\ No newline at end of file
@@ -0,0 +1,148 @@
+#ifndef SPLINTERCELLPATCH_PE_FIXTURE_H
+#define SPLINTERCELLPATCH_PE_FIXTURE_H
+
+#include "pe_image.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+// Builds the smallest executable the PE editor accepts: DOS and NT headers, sixteen data directories and one .idata
+// section importing two KERNEL32.dll functions by name and a third by ordinal. The layout is fixed, so tests can
+// check RVAs and patch header fields at known offsets.
+
+struct PeFixtureOptions {
+    bool pe32Plus = false;
+    bool largeAddressAware = false;
+    bool checksum = true;  // Store the correct checksum, as a release linker does; 0 otherwise
+    bool signed_ = false;  // Point the security directory at a (fake) Authenticode blob
+};
+
+inline constexpr uint32_t PE_FIXTURE_NT_HEADERS = 0x40;
+inline constexpr uint32_t PE_FIXTURE_FILE_HEADER = PE_FIXTURE_NT_HEADERS + 4;
+inline constexpr uint32_t PE_FIXTURE_OPTIONAL_HEADER = PE_FIXTURE_FILE_HEADER + 20;
+inline constexpr uint32_t PE_FIXTURE_HEADERS_SIZE = 0x200;
+inline constexpr uint32_t PE_FIXTURE_SECTION_RVA = 0x1000;
+inline constexpr uint32_t PE_FIXTURE_SECTION_OFFSET = 0x200;
+inline constexpr uint32_t PE_FIXTURE_IMAGE_SIZE = 0x2000;
+
+// .idata contents, as RVAs
+inline constexpr uint32_t PE_FIXTURE_DESCRIPTORS = 0x1000;
+inline constexpr uint32_t PE_FIXTURE_LOOKUP = 0x1040;
+inline constexpr uint32_t PE_FIXTURE_ADDRESSES = 0x1060;
+inline constexpr uint32_t PE_FIXTURE_DLL_NAME = 0x1080;
+inline constexpr uint32_t PE_FIXTURE_HINT_NAMES[] = {0x10A0, 0x10C0};
+inline constexpr std::string_view PE_FIXTURE_SYMBOLS[] = {"QueryPerformanceCounter", "SetThreadAffinityMask"};
+inline constexpr uint16_t PE_FIXTURE_ORDINAL = 0x2A;
+
+inline uint32_t PeFixtureSectionHeaders(bool pe32Plus) {
+    return PE_FIXTURE_OPTIONAL_HEADER + (pe32Plus ? 240 : 224);
+}
+
+template <typename T>
+void PeFixturePut(std::vector<uint8_t> &file, size_t offset, T value) {
+    std::memcpy(file.data() + offset, &value, sizeof(T));
+}
+
+template <typename T>
+T PeFixtureGet(const std::vector<uint8_t> &file, size_t offset) {
+    T value{};
+    std::memcpy(&value, file.data() + offset, sizeof(T));
+    return value;
+}
+
+inline std::vector<uint8_t> BuildPeFixture(const PeFixtureOptions &options = {}) {
+    std::vector<uint8_t> file(PE_FIXTURE_SECTION_OFFSET + 0x200, 0);
+    const bool plus = options.pe32Plus;
+
+    file[0] = 'M';
+    file[1] = 'Z';
+    PeFixturePut<uint32_t>(file, 0x3C, PE_FIXTURE_NT_HEADERS);
+    PeFixturePut<uint32_t>(file, PE_FIXTURE_NT_HEADERS, 0x00004550);
+
+    // IMAGE_FILE_HEADER: EXECUTABLE_IMAGE, plus 32BIT_MACHINE for PE32
+    const uint16_t characteristics = static_cast<uint16_t>(
+        (plus ? 0x0002 : 0x0102) | (options.largeAddressAware ? PE_LARGE_ADDRESS_AWARE : 0));
+    PeFixturePut<uint16_t>(file, PE_FIXTURE_FILE_HEADER, plus ? 0x8664 : 0x014C);
+    PeFixturePut<uint16_t>(file, PE_FIXTURE_FILE_HEADER + 2, 1);
+    PeFixturePut<uint16_t>(file, PE_FIXTURE_FILE_HEADER + 16, plus ? 240 : 224);
+    PeFixturePut<uint16_t>(file, PE_FIXTURE_FILE_HEADER + 18, characteristics);
+
+    const uint32_t optional = PE_FIXTURE_OPTIONAL_HEADER;
+    PeFixturePut<uint16_t>(file, optional, plus ? 0x20B : 0x10B);
+    PeFixturePut<uint32_t>(file, optional + 8, 0x200); // SizeOfInitializedData
+    if (plus) {
+        PeFixturePut<uint64_t>(file, optional + 24, 0x140000000);
+    } else {
+        PeFixturePut<uint32_t>(file, optional + 28, 0x400000);
+    }
+    PeFixturePut<uint32_t>(file, optional + 32, 0x1000); // SectionAlignment
+    PeFixturePut<uint32_t>(file, optional + 36, 0x200);  // FileAlignment
+    PeFixturePut<uint32_t>(file, optional + 56, PE_FIXTURE_IMAGE_SIZE);
+    PeFixturePut<uint32_t>(file, optional + 60, PE_FIXTURE_HEADERS_SIZE);
+    PeFixturePut<uint16_t>(file, optional + 68, 2); // IMAGE_SUBSYSTEM_WINDOWS_GUI
+    const uint32_t directories = optional + (plus ? 112 : 96);
+    PeFixturePut<uint32_t>(file, directories - 4, 16);
+    PeFixturePut<uint32_t>(file, directories + 1 * 8, PE_FIXTURE_DESCRIPTORS);
+    PeFixturePut<uint32_t>(file, directories + 1 * 8 + 4, 40);
+    if (options.signed_) {
+        PeFixturePut<uint32_t>(file, directories + 4 * 8, static_cast<uint32_t>(file.size()));
+        PeFixturePut<uint32_t>(file, directories + 4 * 8 + 4, 0x100);
+    }
+
+    const uint32_t section = PeFixtureSectionHeaders(plus);
+    std::memcpy(file.data() + section, ".idata\0\0", 8);
+    PeFixturePut<uint32_t>(file, section + 8, 0x100); // VirtualSize
+    PeFixturePut<uint32_t>(file, section + 12, PE_FIXTURE_SECTION_RVA);
+    PeFixturePut<uint32_t>(file, section + 16, 0x200); // SizeOfRawData
+    PeFixturePut<uint32_t>(file, section + 20, PE_FIXTURE_SECTION_OFFSET);
+    PeFixturePut<uint32_t>(file, section + 36, 0xC0000040); // Initialized data, read, write
+
+    const auto at = [](uint32_t rva) { return size_t{PE_FIXTURE_SECTION_OFFSET} + (rva - PE_FIXTURE_SECTION_RVA); };
+    PeFixturePut<uint32_t>(file, at(PE_FIXTURE_DESCRIPTORS), PE_FIXTURE_LOOKUP);
+    PeFixturePut<uint32_t>(file, at(PE_FIXTURE_DESCRIPTORS) + 12, PE_FIXTURE_DLL_NAME);
+    PeFixturePut<uint32_t>(file, at(PE_FIXTURE_DESCRIPTORS) + 16, PE_FIXTURE_ADDRESSES);
+    const size_t thunk = plus ? 8 : 4;
+    for (const uint32_t table : {PE_FIXTURE_LOOKUP, PE_FIXTURE_ADDRESSES}) {
+        for (size_t i = 0; i < 2; ++i) {
+            PeFixturePut<uint32_t>(file, at(table) + i * thunk, PE_FIXTURE_HINT_NAMES[i]);
+        }
+        if (plus) {
+            PeFixturePut<uint64_t>(file, at(table) + 2 * thunk, (uint64_t{1} << 63) | PE_FIXTURE_ORDINAL);
+        } else {
+            PeFixturePut<uint32_t>(file, at(table) + 2 * thunk, (uint32_t{1} << 31) | PE_FIXTURE_ORDINAL);
+        }
+    }
+    std::memcpy(file.data() + at(PE_FIXTURE_DLL_NAME), "KERNEL32.dll", 12);
+    for (size_t i = 0; i < 2; ++i) {
+        std::memcpy(file.data() + at(PE_FIXTURE_HINT_NAMES[i]) + 2, PE_FIXTURE_SYMBOLS[i].data(),
+                    PE_FIXTURE_SYMBOLS[i].size());
+    }
+
+    if (options.checksum) {
+        PeFixturePut<uint32_t>(file, optional + 64, ComputePeChecksum(file));
+    }
+    return file;
+}
+
+// The file as the loader maps it: headers at 0 and every section at its RVA
+inline std::vector<uint8_t> MapPeFixture(const std::vector<uint8_t> &file) {
+    const uint32_t sizeOfImage = PeFixtureGet<uint32_t>(file, PE_FIXTURE_OPTIONAL_HEADER + 56);
+    const uint32_t sizeOfHeaders = PeFixtureGet<uint32_t>(file, PE_FIXTURE_OPTIONAL_HEADER + 60);
+    std::vector<uint8_t> image(sizeOfImage, 0);
+    std::copy_n(file.begin(), std::min<size_t>(sizeOfHeaders, file.size()), image.begin());
+
+    const uint16_t sectionCount = PeFixtureGet<uint16_t>(file, PE_FIXTURE_FILE_HEADER + 2);
+    const uint16_t optionalSize = PeFixtureGet<uint16_t>(file, PE_FIXTURE_FILE_HEADER + 16);
+    for (uint16_t i = 0; i < sectionCount; ++i) {
+        const size_t header = PE_FIXTURE_OPTIONAL_HEADER + optionalSize + size_t{i} * 40;
+        const uint32_t rva = PeFixtureGet<uint32_t>(file, header + 12);
+        const uint32_t rawSize = PeFixtureGet<uint32_t>(file, header + 16);
+        const uint32_t rawOffset = PeFixtureGet<uint32_t>(file, header + 20);
+        std::copy_n(file.begin() + rawOffset, std::min(rawSize, sizeOfImage - rva), image.begin() + rva);
+    }
+    return image;
+}
+
+#endif // SPLINTERCELLPATCH_PE_FIXTURE_H
\ No newline at end of file
@@ -0,0 +1,284 @@
+// Offline PE editing on fixture executables (tests/pe_fixture.h): adding the patch import and removing it again
+// byte for byte, the checksum the loader checks, the edits the patcher refuses, the import slots the import table
+// hook backend patches (read from files and from mapped images), and the large address aware flag
+
+#include "check.h"
+#include "pe_fixture.h"
+#include "pe_image.h"
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr std::string_view DLL_NAME = "SplinterCellPatch.dll";
+constexpr std::string_view DLL_SYMBOL = "DummyExport";
+
+void TestReadInfo() {
+    for (const bool pe32Plus : {false, true}) {
+        const std::vector<uint8_t> file = BuildPeFixture({.pe32Plus = pe32Plus});
+        PeInfo info;
+        CHECK(ReadPeInfo(file, info) == PeStatus::Ok);
+        CHECK(info.pe32Plus == pe32Plus);
+        CHECK(info.machine == (pe32Plus ? 0x8664 : 0x014C));
+        CHECK(info.sizeOfImage == PE_FIXTURE_IMAGE_SIZE);
+        CHECK(info.storedChecksum != 0);
+        CHECK(info.storedChecksum == info.computedChecksum);
+        CHECK(!info.patched);
+        CHECK(info.imports == std::vector<std::string>{"KERNEL32.dll"});
+    }
+}
+
+void TestChecksum() {
+    std::vector<uint8_t> file = BuildPeFixture({.checksum = false});
+    const uint32_t checksum = ComputePeChecksum(file);
+    CHECK(checksum != 0);
+
+    // The stored value itself is skipped, so storing it does not change the sum
+    PeFixturePut<uint32_t>(file, PE_FIXTURE_OPTIONAL_HEADER + 64, checksum);
+    CHECK(ComputePeChecksum(file) == checksum);
+
+    // The file length is part of the sum, and so is every other byte
+    file.push_back(0);
+    CHECK(ComputePeChecksum(file) == checksum + 1);
+    file.pop_back();
+    file[PE_FIXTURE_SECTION_OFFSET + 0x1F0] = 0x01;
+    CHECK(ComputePeChecksum(file) == checksum + 0x0001);
+    file[PE_FIXTURE_SECTION_OFFSET + 0x1F1] = 0x01;
+    CHECK(ComputePeChecksum(file) == checksum + 0x0101);
+}
+
+void TestAddRemoveRoundTrip() {
+    for (const bool pe32Plus : {false, true}) {
+        for (const bool checksum : {false, true}) {
+            const std::vector<uint8_t> original = BuildPeFixture({.pe32Plus = pe32Plus, .checksum = checksum});
+            std::vector<uint8_t> file = original;
+            CHECK(AddPeImport(file, DLL_NAME, DLL_SYMBOL) == PeStatus::Ok);
+            CHECK(file != original);
+            CHECK(file.size() % 0x200 == 0);
+
+            PeInfo info;
+            CHECK(ReadPeInfo(file, info) == PeStatus::Ok);
+            CHECK(info.patched);
+            CHECK(info.imports == (std::vector<std::string>{std::string(DLL_NAME), "KERNEL32.dll"}));
+            CHECK(info.storedChecksum == info.computedChecksum);
+            CHECK(info.sizeOfImage > PE_FIXTURE_IMAGE_SIZE);
+            CHECK(PeFixtureGet<uint16_t>(file, PE_FIXTURE_FILE_HEADER + 2) == 2);
+
+            // The new section header follows the existing one and carries the patch name
+            const size_t header = PeFixtureSectionHeaders(pe32Plus) + 40;
+            CHECK(std::memcmp(file.data() + header, PE_PATCH_SECTION_NAME.data(), 8) == 0);
+
+            CHECK(RemovePeImport(file) == PeStatus::Ok);
+            CHECK(file == original);
+        }
+    }
+}
+
+void TestRefusals() {
+    const std::vector<uint8_t> original = BuildPeFixture();
+
+    std::vector<uint8_t> file = original;
+    CHECK(RemovePeImport(file) == PeStatus::NotPatched);
+    CHECK(file == original);
+
+    CHECK(AddPeImport(file, DLL_NAME, DLL_SYMBOL) == PeStatus::Ok);
+    const std::vector<uint8_t> patched = file;
+    CHECK(AddPeImport(file, DLL_NAME, DLL_SYMBOL) == PeStatus::AlreadyPatched);
+    CHECK(file == patched);
+
+    // An import the executable already has, matched case-insensitively
+    file = original;
+    CHECK(AddPeImport(file, "kernel32.DLL", "Sleep") == PeStatus::AlreadyImported);
+    CHECK(file == original);
+
+    file = BuildPeFixture({.signed_ = true});
+    const std::vector<uint8_t> signedFile = file;
+    CHECK(AddPeImport(file, DLL_NAME, DLL_SYMBOL) == PeStatus::Signed);
+    CHECK(file == signedFile);
+
+    // SizeOfHeaders ends right after the only section header: no room for a second one
+    file = original;
+    PeFixturePut<uint32_t>(file, PE_FIXTURE_OPTIONAL_HEADER + 60, PeFixtureSectionHeaders(false) + 40);
+    CHECK(AddPeImport(file, DLL_NAME, DLL_SYMBOL) == PeStatus::NoHeaderRoom);
+
+    file = original;
+    file[0] = 'Z';
+    CHECK(AddPeImport(file, DLL_NAME, DLL_SYMBOL) == PeStatus::NotPe);
+    file = original;
+    PeFixturePut<uint16_t>(file, PE_FIXTURE_OPTIONAL_HEADER, 0x107); // ROM image
+    CHECK(AddPeImport(file, DLL_NAME, DLL_SYMBOL) == PeStatus::NotPe);
+    file.assign(original.begin(), original.begin() + 0x30);
+    CHECK(AddPeImport(file, DLL_NAME, DLL_SYMBOL) == PeStatus::NotPe);
+
+    // Section headers cut off, and an import table pointing past every section
+    file.assign(original.begin(), original.begin() + PeFixtureSectionHeaders(false) + 20);
+    CHECK(AddPeImport(file, DLL_NAME, DLL_SYMBOL) == PeStatus::Malformed);
+    file = original;
+    PeFixturePut<uint32_t>(file, PE_FIXTURE_OPTIONAL_HEADER + 96 + 8, 0x8000);
+    CHECK(AddPeImport(file, DLL_NAME, DLL_SYMBOL) == PeStatus::Malformed);
+
+    // A patch record (at the start of the patch section) whose original file size lies inside the section
+    file = patched;
+    const size_t recordFileSize = original.size() + 8 + 7 * 4;
+    PeFixturePut<uint32_t>(file, recordFileSize, static_cast<uint32_t>(patched.size()));
+    CHECK(RemovePeImport(file) == PeStatus::Malformed);
+}
+
+void CheckFixtureSlots(const std::vector<PeImportSlot> &slots, size_t first, bool pe32Plus) {
+    const uint32_t thunk = pe32Plus ? 8 : 4;
+    CHECK(slots.size() == first + 3);
+    if (slots.size() != first + 3) {
+        return;
+    }
+    for (size_t i = 0; i < 2; ++i) {
+        CHECK(slots[first + i].module == "KERNEL32.dll");
+        CHECK(slots[first + i].symbol == PE_FIXTURE_SYMBOLS[i]);
+        CHECK(slots[first + i].ordinal == 0);
+        CHECK(slots[first + i].slotRva == PE_FIXTURE_ADDRESSES + i * thunk);
+    }
+    CHECK(slots[first + 2].symbol.empty());
+    CHECK(slots[first + 2].ordinal == PE_FIXTURE_ORDINAL);
+    CHECK(slots[first + 2].slotRva == PE_FIXTURE_ADDRESSES + 2 * thunk);
+}
+
+void TestImportSlots() {
+    for (const bool pe32Plus : {false, true}) {
+        const std::vector<uint8_t> file = BuildPeFixture({.pe32Plus = pe32Plus});
+        std::vector<PeImportSlot> slots;
+        CHECK(ReadPeImportSlots(file, PeView::File, slots) == PeStatus::Ok);
+        CheckFixtureSlots(slots, 0, pe32Plus);
+
+        // Once mapped the loader overwrites the address table; names still come from the lookup table
+        std::vector<uint8_t> image = MapPeFixture(file);
+        for (uint32_t i = 0; i < 3; ++i) {
+            PeFixturePut<uint32_t>(image, PE_FIXTURE_ADDRESSES + i * (pe32Plus ? 8 : 4), 0x7FFE0000 + i * 16);
+        }
+        CHECK(ReadPeImportSlots(image, PeView::Mapped, slots) == PeStatus::Ok);
+        CheckFixtureSlots(slots, 0, pe32Plus);
+
+        // The patched executable imports the DLL first, from the patch section
+        std::vector<uint8_t> patched = file;
+        CHECK(AddPeImport(patched, DLL_NAME, DLL_SYMBOL) == PeStatus::Ok);
+        for (const PeView view : {PeView::File, PeView::Mapped}) {
+            const std::vector<uint8_t> bytes = view == PeView::File ? patched : MapPeFixture(patched);
+            CHECK(ReadPeImportSlots(bytes, view, slots) == PeStatus::Ok);
+            CHECK(!slots.empty() && slots[0].module == DLL_NAME && slots[0].symbol == DLL_SYMBOL);
+            CHECK(!slots.empty() && slots[0].slotRva >= PE_FIXTURE_IMAGE_SIZE);
+            CheckFixtureSlots(slots, 1, pe32Plus);
+        }
+    }
+}
+
+void TestImportSlotsWithoutLookupTable() {
+    // Old linkers leave OriginalFirstThunk at 0: a file still has names in the address table, a mapped image does not
+    std::vector<uint8_t> file = BuildPeFixture();
+    PeFixturePut<uint32_t>(file, PE_FIXTURE_SECTION_OFFSET + (PE_FIXTURE_DESCRIPTORS - PE_FIXTURE_SECTION_RVA), 0);
+    std::vector<PeImportSlot> slots;
+    CHECK(ReadPeImportSlots(file, PeView::File, slots) == PeStatus::Ok);
+    CheckFixtureSlots(slots, 0, false);
+    CHECK(ReadPeImportSlots(MapPeFixture(file), PeView::Mapped, slots) == PeStatus::Ok);
+    CHECK(slots.empty());
+}
+
+void TestImportSlotsMalformed() {
+    std::vector<uint8_t> file = BuildPeFixture();
+    const size_t lookup = PE_FIXTURE_SECTION_OFFSET + (PE_FIXTURE_LOOKUP - PE_FIXTURE_SECTION_RVA);
+    PeFixturePut<uint32_t>(file, lookup, 0x9000); // Hint/name entry outside the image
+    std::vector<PeImportSlot> slots;
+    CHECK(ReadPeImportSlots(file, PeView::File, slots) == PeStatus::Malformed);
+
+    file = BuildPeFixture();
+    file.resize(PE_FIXTURE_SECTION_OFFSET + 0x20); // The section ends inside the descriptors
+    PeFixturePut<uint32_t>(file, PeFixtureSectionHeaders(false) + 16, 0x20);
+    CHECK(ReadPeImportSlots(file, PeView::File, slots) == PeStatus::Malformed);
+}
+
+uint16_t Characteristics(const std::vector<uint8_t> &file) {
+    return PeFixtureGet<uint16_t>(file, PE_FIXTURE_FILE_HEADER + 18);
+}
+
+void TestLargeAddressAware() {
+    for (const bool checksum : {false, true}) {
+        const std::vector<uint8_t> original = BuildPeFixture({.checksum = checksum});
+        std::vector<uint8_t> file = original;
+        CHECK(SetPeLargeAddressAware(file, false) == PeStatus::AlreadySet);
+        CHECK(file == original);
+
+        CHECK(SetPeLargeAddressAware(file, true) == PeStatus::Ok);
+        CHECK(file.size() == original.size());
+        CHECK(Characteristics(file) == (Characteristics(original) | PE_LARGE_ADDRESS_AWARE));
+        PeInfo info;
+        CHECK(ReadPeInfo(file, info) == PeStatus::Ok);
+        CHECK(info.storedChecksum == info.computedChecksum); // Stored even when the linker left it at 0
+        CHECK(SetPeLargeAddressAware(file, true) == PeStatus::AlreadySet);
+
+        // Clearing restores the flag and, with it, the checksum the file was built with
+        CHECK(SetPeLargeAddressAware(file, false) == PeStatus::Ok);
+        CHECK(Characteristics(file) == Characteristics(original));
+        CHECK(ReadPeInfo(file, info) == PeStatus::Ok);
+        CHECK(info.storedChecksum == info.computedChecksum);
+        if (checksum) {
+            CHECK(file == original);
+        }
+    }
+
+    std::vector<uint8_t> file = BuildPeFixture({.signed_ = true});
+    CHECK(SetPeLargeAddressAware(file, true) == PeStatus::Signed);
+    CHECK(!(Characteristics(file) & PE_LARGE_ADDRESS_AWARE));
+    file = BuildPeFixture();
+    file[1] = 'X';
+    CHECK(SetPeLargeAddressAware(file, true) == PeStatus::NotPe);
+}
+
+void TestLargeAddressAwareAfterPatch() {
+    // The flag set on a patched executable stays when the import is removed; the checksum is then recomputed
+    const std::vector<uint8_t> original = BuildPeFixture();
+    std::vector<uint8_t> file = original;
+    CHECK(AddPeImport(file, DLL_NAME, DLL_SYMBOL) == PeStatus::Ok);
+    CHECK(SetPeLargeAddressAware(file, true) == PeStatus::Ok);
+    CHECK(RemovePeImport(file) == PeStatus::Ok);
+    CHECK(file.size() == original.size());
+    CHECK(Characteristics(file) & PE_LARGE_ADDRESS_AWARE);
+    PeInfo info;
+    CHECK(ReadPeInfo(file, info) == PeStatus::Ok);
+    CHECK(!info.patched);
+    CHECK(info.storedChecksum == info.computedChecksum);
+
+    CHECK(SetPeLargeAddressAware(file, false) == PeStatus::Ok);
+    CHECK(file == original);
+}
+
+void TestUserAddressSpace() {
+    constexpr uint64_t GIB = uint64_t{1} << 30;
+    const struct {
+        PeFixtureOptions options;
+        uint64_t bytes;
+    } cases[] = {
+        {{.pe32Plus = false, .largeAddressAware = false}, 2 * GIB},
+        {{.pe32Plus = false, .largeAddressAware = true}, 4 * GIB},
+        {{.pe32Plus = true, .largeAddressAware = false}, 2 * GIB},
+        {{.pe32Plus = true, .largeAddressAware = true}, 128 * 1024 * GIB},
+    };
+    for (const auto &[options, bytes] : cases) {
+        PeInfo info;
+        CHECK(ReadPeInfo(BuildPeFixture(options), info) == PeStatus::Ok);
+        CHECK(PeUserAddressSpace(info) == bytes);
+    }
+}
+
+} // namespace
+
+int main() {
+    TestReadInfo();
+    TestChecksum();
+    TestAddRemoveRoundTrip();
+    TestRefusals();
+    TestImportSlots();
+    TestImportSlotsWithoutLookupTable();
+    TestImportSlotsMalformed();
+    TestLargeAddressAware();
+    TestLargeAddressAwareAfterPatch();
+    TestUserAddressSpace();
+    return CheckResult();
+}
\ No newline at end of file
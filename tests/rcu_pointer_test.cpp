@@ -0,0 +1,118 @@
+// RcuPointer: empty until the first publish, snapshots freed only once no reader holds them, and readers racing a
+// publisher always seeing a complete snapshot
+
+#include "check.h"
+#include "rcu_pointer.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::atomic<int> g_live = 0; // Snapshots not yet destroyed
+
+// Every field holds the same value, so a torn or freed snapshot shows up as a mismatch
+struct Snapshot {
+    explicit Snapshot(uint64_t value) : a(value), b(value), c(value) { ++g_live; }
+    ~Snapshot() {
+        a = b = c = ~uint64_t{0};
+        --g_live;
+    }
+
+    uint64_t a;
+    uint64_t b;
+    uint64_t c;
+};
+
+void TestPublish() {
+    {
+        RcuPointer<Snapshot> pointer;
+        CHECK(pointer.Read().Get() == nullptr);
+
+        pointer.Publish(std::make_unique<const Snapshot>(1));
+        CHECK(pointer.Read()->a == 1);
+        CHECK(g_live == 1);
+
+        pointer.Publish(std::make_unique<const Snapshot>(2));
+        CHECK((*pointer.Read()).b == 2);
+        CHECK(g_live == 1);
+    }
+    CHECK(g_live == 0);
+}
+
+void TestWaitsForReader() {
+    RcuPointer<Snapshot> pointer;
+    pointer.Publish(std::make_unique<const Snapshot>(1));
+
+    std::atomic<bool> published = false;
+    std::thread publisher;
+    {
+        const auto guard = pointer.Read();
+        publisher = std::thread([&] {
+            pointer.Publish(std::make_unique<const Snapshot>(2));
+            published = true;
+        });
+
+        // The publisher swaps the pointer right away but cannot free the snapshot this guard holds
+        while (pointer.Read()->a != 2) {
+            std::this_thread::yield();
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        CHECK(!published);
+        CHECK(g_live == 2);
+        CHECK(guard->a == 1 && guard->c == 1);
+    }
+    publisher.join();
+    CHECK(published);
+    CHECK(g_live == 1);
+}
+
+void TestConcurrentReaders() {
+    constexpr int READERS = 4;
+    constexpr uint64_t PUBLISHES = 2000;
+
+    RcuPointer<Snapshot> pointer;
+    pointer.Publish(std::make_unique<const Snapshot>(0));
+    std::atomic<bool> stop = false;
+    std::atomic<int> torn = 0;
+    std::atomic<int> backwards = 0;
+    std::vector<std::thread> readers;
+    for (int i = 0; i < READERS; ++i) {
+        readers.emplace_back([&] {
+            uint64_t last = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                const auto guard = pointer.Read();
+                if (guard->a != guard->b || guard->b != guard->c) {
+                    ++torn;
+                }
+                if (guard->a < last) {
+                    ++backwards;
+                }
+                last = guard->a;
+            }
+        });
+    }
+    for (uint64_t value = 1; value <= PUBLISHES; ++value) {
+        pointer.Publish(std::make_unique<const Snapshot>(value));
+    }
+    stop = true;
+    for (std::thread &reader : readers) {
+        reader.join();
+    }
+    CHECK(torn == 0);
+    CHECK(backwards == 0);
+    CHECK(pointer.Read()->a == PUBLISHES);
+    CHECK(g_live == 1);
+}
+
+} // namespace
+
+int main() {
+    TestPublish();
+    TestWaitsForReader();
+    TestConcurrentReaders();
+    CHECK(g_live == 0);
+    return CheckResult();
+}
\ No newline at end of file
@@ -0,0 +1,177 @@
+// SlabHeap: sizes and resizing as HeapSize/HeapReAlloc see them, blocks freed by another thread coming back to their
+// owner, and the spans of an exited thread being reused by the next thread that needs their size class
+
+#include "check.h"
+#include "slab_heap.h"
+#include <cstdint>
+#include <cstring>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Thread caches bind to the first SlabHeap a thread allocates from, so every test shares one
+SlabHeap g_heap;
+
+// The largest size class holds three blocks per span, so a few allocations fill one
+constexpr size_t LARGE = SlabHeap::MAX_BLOCK_SIZE;
+constexpr size_t LARGE_PER_SPAN = 3;
+
+template <typename Fn>
+void OnThread(Fn &&fn) {
+    std::thread(std::forward<Fn>(fn)).join();
+}
+
+uintptr_t SpanOf(const void *block) {
+    return reinterpret_cast<uintptr_t>(block) / SlabHeap::SPAN_SIZE;
+}
+
+void TestBeforeCreate() {
+    SlabHeap heap;
+    int local = 0;
+    CHECK(!heap.Owns(&local));
+    CHECK(!heap.Owns(nullptr));
+}
+
+void TestAllocateSizeResize() {
+    for (const size_t size : {size_t{0}, size_t{1}, size_t{16}, size_t{17}, size_t{128}, size_t{129}, size_t{1000},
+                              size_t{4097}, LARGE}) {
+        void *block = g_heap.Allocate(size);
+        CHECK(block != nullptr);
+        if (!block) {
+            continue;
+        }
+        CHECK(g_heap.Owns(block));
+        CHECK(reinterpret_cast<uintptr_t>(block) % 16 == 0);
+        CHECK(g_heap.Size(block) == size);
+        std::memset(block, 0xA5, size);
+        g_heap.Free(block);
+    }
+    CHECK(g_heap.Allocate(LARGE + 1) == nullptr);
+    int local = 0;
+    CHECK(!g_heap.Owns(&local));
+
+    // Resize stays within the block's size class and never moves it
+    void *block = g_heap.Allocate(40); // 48-byte class
+    CHECK(g_heap.Resize(block, 48));
+    CHECK(g_heap.Size(block) == 48);
+    CHECK(g_heap.Resize(block, 3));
+    CHECK(g_heap.Size(block) == 3);
+    CHECK(!g_heap.Resize(block, 49));
+    CHECK(g_heap.Size(block) == 3);
+
+    // Reallocate keeps the contents when it has to move, and leaves the block alone when it cannot serve the size
+    std::memcpy(block, "abc", 3);
+    void *grown = g_heap.Reallocate(block, 3000);
+    CHECK(grown != nullptr && grown != block);
+    CHECK(g_heap.Size(grown) == 3000);
+    CHECK(std::memcmp(grown, "abc", 3) == 0);
+    CHECK(g_heap.Reallocate(grown, LARGE + 1) == nullptr);
+    CHECK(g_heap.Size(grown) == 3000);
+    g_heap.Free(grown);
+
+    // Live blocks never overlap
+    std::vector<uint32_t *> blocks;
+    for (uint32_t i = 0; i < 5000; ++i) {
+        auto *values = static_cast<uint32_t *>(g_heap.Allocate(48));
+        CHECK(values != nullptr);
+        if (values) {
+            std::fill_n(values, 12, i);
+            blocks.push_back(values);
+        }
+    }
+    for (uint32_t i = 0; i < blocks.size(); ++i) {
+        CHECK(blocks[i][0] == i && blocks[i][11] == i);
+        g_heap.Free(blocks[i]);
+    }
+}
+
+void TestRemoteFree() {
+    OnThread([] {
+        std::vector<void *> blocks;
+        for (size_t i = 0; i < LARGE_PER_SPAN; ++i) {
+            blocks.push_back(g_heap.Allocate(LARGE));
+        }
+        CHECK(SpanOf(blocks.front()) == SpanOf(blocks.back()));
+        const uint32_t peak = g_heap.Snapshot().spansPeak;
+
+        // Another thread frees them onto the span's remote queue while the owner is still alive
+        OnThread([&] {
+            for (void *block : blocks) {
+                g_heap.Free(block);
+            }
+        });
+
+        // The span is used up, so the owner takes the remote frees back instead of carving a new span
+        std::set<void *> reused;
+        for (size_t i = 0; i < LARGE_PER_SPAN; ++i) {
+            reused.insert(g_heap.Allocate(LARGE));
+        }
+        CHECK(reused == std::set<void *>(blocks.begin(), blocks.end()));
+        CHECK(g_heap.Snapshot().spansPeak == peak);
+        for (void *block : reused) {
+            g_heap.Free(block);
+        }
+    });
+}
+
+void TestReuseAfterExit() {
+    const SlabHeap::Statistics before = g_heap.Snapshot();
+
+    // A thread fills a span, frees two blocks, and exits with the third still in use
+    void *kept = nullptr;
+    std::vector<void *> freed;
+    OnThread([&] {
+        for (size_t i = 0; i < LARGE_PER_SPAN; ++i) {
+            void *block = g_heap.Allocate(LARGE);
+            if (i == 0) {
+                kept = block;
+            } else {
+                freed.push_back(block);
+            }
+        }
+        for (void *block : freed) {
+            g_heap.Free(block);
+        }
+        CHECK(g_heap.Snapshot().threadCaches == before.threadCaches + 1);
+    });
+    const SlabHeap::Statistics exited = g_heap.Snapshot();
+    CHECK(exited.threadCaches == before.threadCaches);
+    CHECK(exited.spansAbandoned == before.spansAbandoned + 1);
+
+    // The next thread needing that size class adopts the span and its free blocks
+    void *adopted = nullptr;
+    OnThread([&] {
+        adopted = g_heap.Allocate(LARGE);
+        CHECK(adopted == freed[0] || adopted == freed[1]);
+        CHECK(SpanOf(adopted) == SpanOf(kept));
+        const SlabHeap::Statistics statistics = g_heap.Snapshot();
+        CHECK(statistics.spansAbandoned == before.spansAbandoned);
+        CHECK(statistics.spansPeak == exited.spansPeak);
+
+        // The block left behind by the first thread is freed from here and from the main thread alike
+        g_heap.Free(adopted);
+    });
+    CHECK(g_heap.Snapshot().spansAbandoned == before.spansAbandoned + 1);
+    g_heap.Free(kept);
+
+    // Once every block is back, the span returns to the pool and is reused without growing the arena
+    OnThread([&] {
+        CHECK(g_heap.Allocate(LARGE) != nullptr);
+        CHECK(g_heap.Snapshot().spansAbandoned == before.spansAbandoned);
+    });
+    CHECK(g_heap.Snapshot().spansPeak == exited.spansPeak);
+}
+
+} // namespace
+
+int main() {
+    TestBeforeCreate();
+    CHECK(g_heap.Create(64 * SlabHeap::SPAN_SIZE * 16));
+    CHECK(!g_heap.Create(64 * SlabHeap::SPAN_SIZE));
+    TestAllocateSizeResize();
+    TestRemoteFree();
+    TestReuseAfterExit();
+    return CheckResult();
+}
\ No newline at end of file
@@ -0,0 +1,110 @@
+// SpinTuner: spin counts given at initialization, raised while contended waits stay short, lowered while they stay
+// long and raised again once contention eases, and locks beyond the tracked maximum
+
+#include "check.h"
+#include "spin_tuner.h"
+#include <cstdint>
+
+namespace {
+
+constexpr uint64_t TICKS_PER_SECOND = 1'000'000'000; // One tick per nanosecond
+constexpr SpinTuningSettings SETTINGS = {
+    .enabled = true, .initialSpinCount = 4000, .minSpinCount = 100, .maxSpinCount = 64000, .maxLocks = 16
+};
+
+// Records `count` contended enters of `waitNs`; returns the last spin count the tuner asked for, or `current`
+uint32_t Contend(SpinTuner &tuner, const void *lock, uint32_t current, uint64_t waitNs, size_t count,
+                 uint32_t &changes) {
+    for (size_t i = 0; i < count; ++i) {
+        if (const std::optional<uint32_t> next = tuner.RecordContended(lock, waitNs)) {
+            CHECK(*next != current);
+            current = *next;
+            ++changes;
+        }
+    }
+    return current;
+}
+
+void TestInitialize() {
+    SpinTuner tuner;
+    CHECK(!tuner.Create(SETTINGS, 0));
+    CHECK(tuner.Create(SETTINGS, TICKS_PER_SECOND));
+
+    int locks[3] = {};
+    CHECK(tuner.Initialize(&locks[0]) == 4000);
+    CHECK(tuner.Initialize(&locks[1], 10) == 100);
+    CHECK(tuner.Initialize(&locks[2], 1'000'000) == 64000);
+    CHECK(tuner.TrackedLocks() == 3);
+
+    // A lock first seen contended gets the initial spin count
+    int unseen = 0;
+    CHECK(tuner.RecordContended(&unseen, 1000) == 4000u);
+    CHECK(tuner.TrackedLocks() == 4);
+}
+
+// Short waits double the spin count every ADAPT_INTERVAL enters up to the maximum, long waits halve it down to the
+// minimum, and short waits bring it back up
+void TestRisesAndFalls() {
+    SpinTuner tuner;
+    CHECK(tuner.Create(SETTINGS, TICKS_PER_SECOND));
+    int lock = 0;
+    uint32_t spinCount = tuner.Initialize(&lock);
+
+    uint32_t changes = 0;
+    const uint32_t first = Contend(tuner, &lock, spinCount, 1'000, SpinTuner::ADAPT_INTERVAL, changes);
+    CHECK(changes == 1 && first > spinCount);
+    spinCount = Contend(tuner, &lock, first, 1'000, SpinTuner::ADAPT_INTERVAL * 8, changes);
+    CHECK(spinCount == SETTINGS.maxSpinCount);
+
+    changes = 0;
+    spinCount = Contend(tuner, &lock, spinCount, 1'000'000, SpinTuner::ADAPT_INTERVAL * 16, changes);
+    CHECK(changes > 1 && spinCount == SETTINGS.minSpinCount);
+
+    changes = 0;
+    spinCount = Contend(tuner, &lock, spinCount, 1'000, SpinTuner::ADAPT_INTERVAL * 16, changes);
+    CHECK(changes > 1 && spinCount > SETTINGS.minSpinCount);
+
+    // Waits between the thresholds leave the spin count alone
+    changes = 0;
+    (void)Contend(tuner, &lock, spinCount, 50'000, SpinTuner::ADAPT_INTERVAL * 32, changes);
+    const std::vector<SpinTuner::LockSummary> summary = tuner.MostContended(1);
+    CHECK(summary.size() == 1 && summary[0].lock == &lock);
+    if (summary.size() == 1) {
+        CHECK(summary[0].raised > 0 && summary[0].lowered > 0);
+        CHECK(summary[0].averageWaitNs > SpinTuner::SHORT_WAIT_NS);
+        CHECK(summary[0].averageWaitNs < SpinTuner::LONG_WAIT_NS);
+    }
+    CHECK(changes == 0);
+}
+
+// A wait of many seconds saturates the average instead of overflowing it
+void TestLongWait() {
+    SpinTuner tuner;
+    CHECK(tuner.Create(SETTINGS, TICKS_PER_SECOND));
+    int lock = 0;
+    uint32_t changes = 0;
+    const uint32_t spinCount = Contend(tuner, &lock, 0, TICKS_PER_SECOND * 1000, SpinTuner::ADAPT_INTERVAL, changes);
+    CHECK(spinCount == SETTINGS.initialSpinCount / 2);
+}
+
+void TestFull() {
+    SpinTuner tuner;
+    CHECK(tuner.Create(SETTINGS, TICKS_PER_SECOND));
+    int locks[32] = {};
+    for (int &lock : locks) {
+        (void)tuner.Initialize(&lock);
+    }
+    CHECK(tuner.Full() && tuner.TrackedLocks() < 32);
+    CHECK(tuner.Initialize(&locks[31], 500) == 500); // Untracked locks still get a spin count
+    CHECK(!tuner.RecordContended(&locks[31], 1000));
+}
+
+} // namespace
+
+int main() {
+    TestInitialize();
+    TestRisesAndFalls();
+    TestLongWait();
+    TestFull();
+    return CheckResult();
+}
\ No newline at end of file
@@ -0,0 +1,122 @@
+#ifndef SPLINTERCELLPATCH_SYSFS_FIXTURE_H
+#define SPLINTERCELLPATCH_SYSFS_FIXTURE_H
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Writes a /sys/devices/system/cpu tree with the files LoadTopologyFromSysfs reads, into a fresh directory under
+// the system's temporary directory that is removed again on destruction. The machines in the tests are modeled on
+// the sysfs trees of real ones.
+
+struct FixtureCpu {
+    uint32_t cpu = 0;
+    uint32_t package = 0;
+    uint32_t coreId = 0;             // Per package, as the kernel numbers them
+    std::string_view siblings = {};  // thread_siblings_list
+    std::string_view l3Shared = {};  // cache/index3/shared_cpu_list; empty for no L3 description
+    uint64_t capacity = 0;           // cpu_capacity; 0 leaves the file out
+    uint64_t highestPerf = 0;        // acpi_cppc/highest_perf; 0 leaves the file out
+};
+
+class SysfsFixture {
+public:
+    // online is the cpulist of the "online" file; empty leaves it out, so CPUs are found by listing the directory
+    SysfsFixture(std::string_view name, const std::vector<FixtureCpu> &cpus, std::string_view online) {
+        m_root = std::filesystem::temp_directory_path() / ("splintercell-sysfs-" + std::string(name));
+        std::filesystem::remove_all(m_root);
+        std::filesystem::create_directories(m_root);
+        if (!online.empty()) {
+            Write(m_root / "online", online);
+        }
+        for (const FixtureCpu &cpu : cpus) {
+            const std::filesystem::path dir = m_root / ("cpu" + std::to_string(cpu.cpu));
+            Write(dir / "topology" / "physical_package_id", std::to_string(cpu.package));
+            Write(dir / "topology" / "core_id", std::to_string(cpu.coreId));
+            Write(dir / "topology" / "thread_siblings_list", cpu.siblings);
+            // A private L1 in index0, so the reader has to pick the L3 by level
+            Write(dir / "cache" / "index0" / "level", "1");
+            Write(dir / "cache" / "index0" / "shared_cpu_list", cpu.siblings);
+            if (!cpu.l3Shared.empty()) {
+                Write(dir / "cache" / "index3" / "level", "3");
+                Write(dir / "cache" / "index3" / "shared_cpu_list", cpu.l3Shared);
+            }
+            if (cpu.capacity != 0) {
+                Write(dir / "cpu_capacity", std::to_string(cpu.capacity));
+            }
+            if (cpu.highestPerf != 0) {
+                Write(dir / "acpi_cppc" / "highest_perf", std::to_string(cpu.highestPerf));
+            }
+        }
+        // Entries that look like CPUs to a careless reader
+        std::filesystem::create_directories(m_root / "cpufreq");
+        std::filesystem::create_directories(m_root / "cpuidle");
+    }
+
+    SysfsFixture(const SysfsFixture &) = delete;
+    SysfsFixture &operator=(const SysfsFixture &) = delete;
+
+    ~SysfsFixture() {
+        std::error_code error;
+        std::filesystem::remove_all(m_root, error);
+    }
+
+    [[nodiscard]] std::string Root() const { return m_root.string(); }
+    [[nodiscard]] std::filesystem::path Path() const { return m_root; }
+
+    static void Write(const std::filesystem::path &path, std::string_view text) {
+        std::filesystem::create_directories(path.parent_path());
+        std::ofstream(path) << text << '\n';
+    }
+
+private:
+    std::filesystem::path m_root;
+};
+
+// Two CCDs of four SMT cores each, numbered the way Linux does it (cpu0-7 first threads, cpu8-15 their siblings).
+// Cores 0 and 1 are the preferred cores.
+inline std::vector<FixtureCpu> TwoCcdRyzenCpus() {
+    std::vector<FixtureCpu> cpus;
+    static constexpr std::string_view SIBLINGS[] = {"0,8", "1,9", "2,10", "3,11", "4,12", "5,13", "6,14", "7,15"};
+    for (uint32_t cpu = 0; cpu < 16; ++cpu) {
+        const uint32_t core = cpu % 8;
+        cpus.push_back({
+            .cpu = cpu, .package = 0, .coreId = core, .siblings = SIBLINGS[core],
+            .l3Shared = core < 4 ? "0-3,8-11" : "4-7,12-15", .highestPerf = core < 2 ? 196u : 166u,
+        });
+    }
+    return cpus;
+}
+
+// Hybrid part: two P-cores with SMT (cpu0-3) and four E-cores (cpu4-7) sharing one L3
+inline std::vector<FixtureCpu> HybridCpus() {
+    return {
+        {.cpu = 0, .coreId = 0, .siblings = "0-1", .l3Shared = "0-7", .capacity = 1024},
+        {.cpu = 1, .coreId = 0, .siblings = "0-1", .l3Shared = "0-7", .capacity = 1024},
+        {.cpu = 2, .coreId = 4, .siblings = "2-3", .l3Shared = "0-7", .capacity = 1024},
+        {.cpu = 3, .coreId = 4, .siblings = "2-3", .l3Shared = "0-7", .capacity = 1024},
+        {.cpu = 4, .coreId = 8, .siblings = "4", .l3Shared = "0-7", .capacity = 602},
+        {.cpu = 5, .coreId = 9, .siblings = "5", .l3Shared = "0-7", .capacity = 602},
+        {.cpu = 6, .coreId = 10, .siblings = "6", .l3Shared = "0-7", .capacity = 602},
+        {.cpu = 7, .coreId = 11, .siblings = "7", .l3Shared = "0-7", .capacity = 602},
+    };
+}
+
+// Two sockets of two SMT cores each, with the same core ids in both packages
+inline std::vector<FixtureCpu> TwoSocketCpus() {
+    return {
+        {.cpu = 0, .package = 0, .coreId = 0, .siblings = "0,4", .l3Shared = "0-1,4-5"},
+        {.cpu = 1, .package = 0, .coreId = 1, .siblings = "1,5", .l3Shared = "0-1,4-5"},
+        {.cpu = 2, .package = 1, .coreId = 0, .siblings = "2,6", .l3Shared = "2-3,6-7"},
+        {.cpu = 3, .package = 1, .coreId = 1, .siblings = "3,7", .l3Shared = "2-3,6-7"},
+        {.cpu = 4, .package = 0, .coreId = 0, .siblings = "0,4", .l3Shared = "0-1,4-5"},
+        {.cpu = 5, .package = 0, .coreId = 1, .siblings = "1,5", .l3Shared = "0-1,4-5"},
+        {.cpu = 6, .package = 1, .coreId = 0, .siblings = "2,6", .l3Shared = "2-3,6-7"},
+        {.cpu = 7, .package = 1, .coreId = 1, .siblings = "3,7", .l3Shared = "2-3,6-7"},
+    };
+}
+
+#endif // SPLINTERCELLPATCH_SYSFS_FIXTURE_H
\ No newline at end of file
@@ -0,0 +1,182 @@
+// LoadTopologyFromSysfs on sysfs fixtures of real machine layouts, and the policy masks computed from them
+
+#include "check.h"
+#include "sysfs_fixture.h"
+#include "topology.h"
+#include <filesystem>
+#include <initializer_list>
+
+namespace {
+
+ProcessorSet Set(std::initializer_list<uint32_t> indices) {
+    ProcessorSet set;
+    for (const uint32_t index : indices) {
+        set.Set(index);
+    }
+    return set;
+}
+
+void TestProcessorSet() {
+    const ProcessorSet low = ProcessorSet::FromGroupMask(0, 0xF0);
+    CHECK(low.Count() == 4 && low.Test(4) && !low.Test(3));
+    CHECK(low.GroupMask(0) == 0xF0 && low.GroupMask(1) == 0);
+
+    const ProcessorSet high = ProcessorSet::FromGroupMask(1, 0x3);
+    CHECK(high.Test(64) && high.Test(65) && high.GroupMask(1) == 0x3 && high.GroupCount() == 2);
+
+    const ProcessorSet both = low.Union(high);
+    CHECK(both.Count() == 6);
+    CHECK(both.Intersect(high) == high);
+    CHECK(both.Without(high) == low);
+    CHECK(low.Intersect(high).Empty());
+    CHECK(ProcessorSet{}.Empty() && ProcessorSet{}.Count() == 0);
+}
+
+void TestPolicyNames() {
+    CHECK(ParseAffinityPolicy("physical-cores-only") == AffinityPolicy::PhysicalCoresOnly);
+    CHECK(ParseAffinityPolicy("SINGLE-l3-DOMAIN") == AffinityPolicy::SingleL3Domain);
+    CHECK(ParseAffinityPolicy("p-cores-only") == AffinityPolicy::PerformanceCoresOnly);
+    CHECK(!ParseAffinityPolicy("all cores"));
+    for (const AffinityPolicy policy : {AffinityPolicy::AllCores, AffinityPolicy::PhysicalCoresOnly,
+                                        AffinityPolicy::SingleL3Domain, AffinityPolicy::PerformanceCoresOnly}) {
+        CHECK(ParseAffinityPolicy(AffinityPolicyName(policy)) == policy);
+    }
+}
+
+void TestTwoCcdRyzen() {
+    const SysfsFixture fixture("ryzen", TwoCcdRyzenCpus(), "0-15");
+    CpuTopology topology;
+    CHECK(LoadTopologyFromSysfs(fixture.Root(), topology));
+    CHECK(topology.processors.size() == 16);
+    if (topology.processors.size() != 16) {
+        return;
+    }
+
+    // Siblings share a core, and the CCDs are the L3 domains
+    CHECK(topology.Find(3)->core == topology.Find(11)->core);
+    CHECK(topology.Find(3)->core != topology.Find(4)->core);
+    CHECK(topology.Find(0)->l3Domain == topology.Find(8)->l3Domain);
+    CHECK(topology.Find(0)->l3Domain != topology.Find(4)->l3Domain);
+    CHECK(topology.Find(0)->smtPrimary && !topology.Find(8)->smtPrimary);
+    CHECK(topology.Find(0)->schedulingClass == 1 && topology.Find(5)->schedulingClass == 0);
+    CHECK(topology.MaxEfficiencyClass() == 0);
+
+    CHECK(ComputePolicySet(topology, AffinityPolicy::AllCores).Count() == 16);
+    CHECK(ComputePolicySet(topology, AffinityPolicy::PhysicalCoresOnly) == Set({0, 1, 2, 3, 4, 5, 6, 7}));
+    CHECK(ComputePolicySet(topology, AffinityPolicy::SingleL3Domain) == Set({0, 1, 2, 3, 8, 9, 10, 11}));
+    // Without cpu_capacity every processor is in the one (fastest) class
+    CHECK(ComputePolicySet(topology, AffinityPolicy::PerformanceCoresOnly).Count() == 16);
+
+    const std::vector<ProcessorSet> domains = RankL3Domains(topology, topology.All());
+    CHECK(domains.size() == 2);
+    CHECK(domains.size() == 2 && domains[1] == Set({4, 5, 6, 7, 12, 13, 14, 15}));
+}
+
+void TestHybrid() {
+    const SysfsFixture fixture("hybrid", HybridCpus(), "0-7");
+    CpuTopology topology;
+    CHECK(LoadTopologyFromSysfs(fixture.Root(), topology));
+    CHECK(topology.processors.size() == 8);
+    if (topology.processors.size() != 8) {
+        return;
+    }
+
+    CHECK(topology.Find(0)->efficiencyClass == 1 && topology.Find(4)->efficiencyClass == 0);
+    CHECK(topology.MaxEfficiencyClass() == 1);
+    CHECK(ComputePolicySet(topology, AffinityPolicy::PerformanceCoresOnly) == Set({0, 1, 2, 3}));
+    CHECK(ComputePolicySet(topology, AffinityPolicy::PhysicalCoresOnly) == Set({0, 2, 4, 5, 6, 7}));
+    CHECK(ComputePolicySet(topology, AffinityPolicy::SingleL3Domain).Count() == 8);
+
+    // Only E-cores allowed: the domain ranking must not invent P-cores
+    const std::vector<ProcessorSet> domains = RankL3Domains(topology, Set({4, 5, 6}));
+    CHECK(domains.size() == 1 && domains[0] == Set({4, 5, 6}));
+}
+
+void TestTwoSockets() {
+    const SysfsFixture fixture("sockets", TwoSocketCpus(), "0-7");
+    CpuTopology topology;
+    CHECK(LoadTopologyFromSysfs(fixture.Root(), topology));
+    CHECK(topology.processors.size() == 8);
+    if (topology.processors.size() != 8) {
+        return;
+    }
+
+    // Core ids repeat across packages but cores must not merge
+    CHECK(topology.Find(0)->package == 0 && topology.Find(2)->package == 1);
+    CHECK(topology.Find(0)->core != topology.Find(2)->core);
+    CHECK(topology.Find(0)->core == topology.Find(4)->core);
+    CHECK(ComputePolicySet(topology, AffinityPolicy::PhysicalCoresOnly) == Set({0, 1, 2, 3}));
+    CHECK(ComputePolicySet(topology, AffinityPolicy::SingleL3Domain) == Set({0, 1, 4, 5}));
+}
+
+// A VM without an "online" file or cache information: CPUs come from the directory listing, one domain per package
+void TestMinimalVm() {
+    const std::vector<FixtureCpu> cpus = {
+        {.cpu = 0, .coreId = 0, .siblings = "0"},
+        {.cpu = 1, .coreId = 1, .siblings = "1"},
+        {.cpu = 2, .coreId = 2, .siblings = "2"},
+        {.cpu = 10, .coreId = 3, .siblings = "10"},
+    };
+    const SysfsFixture fixture("vm", cpus, "");
+    CpuTopology topology;
+    CHECK(LoadTopologyFromSysfs(fixture.Root(), topology));
+    CHECK(topology.processors.size() == 4);
+    CHECK(topology.Find(10) != nullptr && topology.Find(3) == nullptr);
+    CHECK(ComputePolicySet(topology, AffinityPolicy::SingleL3Domain).Count() == 4);
+}
+
+// Offline CPUs keep their directories but are left out of "online"
+void TestOfflineCpus() {
+    const SysfsFixture fixture("offline", TwoCcdRyzenCpus(), "0-3,8-11");
+    CpuTopology topology;
+    CHECK(LoadTopologyFromSysfs(fixture.Root(), topology));
+    CHECK(topology.processors.size() == 8);
+    CHECK(topology.Find(4) == nullptr);
+    CHECK(RankL3Domains(topology, topology.All()).size() == 1);
+}
+
+void TestMalformed() {
+    CpuTopology topology;
+    const SysfsFixture empty("empty", {}, "");
+    CHECK(!LoadTopologyFromSysfs(empty.Root(), topology));
+    CHECK(!LoadTopologyFromSysfs((empty.Path() / "missing").string(), topology));
+
+    const SysfsFixture broken("broken", HybridCpus(), "0-7");
+    std::filesystem::remove(broken.Path() / "cpu5" / "topology" / "core_id");
+    CHECK(!LoadTopologyFromSysfs(broken.Root(), topology));
+
+    const SysfsFixture badList("badlist", HybridCpus(), "7-0");
+    CHECK(LoadTopologyFromSysfs(badList.Root(), topology)); // Falls back to the directory listing
+    CHECK(topology.processors.size() == 8);
+
+    CHECK(ComputePolicySet(CpuTopology{}, AffinityPolicy::AllCores).Empty());
+}
+
+// The machine running the test, when it has a sysfs tree
+void TestSystem() {
+    if (!std::filesystem::exists("/sys/devices/system/cpu/online")) {
+        return;
+    }
+    CpuTopology topology;
+    CHECK(LoadTopologyFromSysfs("/sys/devices/system/cpu", topology));
+    CHECK(!topology.processors.empty());
+    for (const AffinityPolicy policy : {AffinityPolicy::AllCores, AffinityPolicy::PhysicalCoresOnly,
+                                        AffinityPolicy::SingleL3Domain, AffinityPolicy::PerformanceCoresOnly}) {
+        CHECK(!ComputePolicySet(topology, policy).Empty());
+    }
+}
+
+} // namespace
+
+int main() {
+    TestProcessorSet();
+    TestPolicyNames();
+    TestTwoCcdRyzen();
+    TestHybrid();
+    TestTwoSockets();
+    TestMinimalVm();
+    TestOfflineCpus();
+    TestMalformed();
+    TestSystem();
+    return CheckResult();
+}
\ No newline at end of file
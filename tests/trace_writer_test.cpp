@@ -0,0 +1,207 @@
+// TraceWriter files and their conversion to Chrome trace JSON: header, capacity, shrinking on close, traces that
+// were never closed, malformed input and trace sizes that do not fit the address space
+
+#include "check.h"
+#include "chrome_trace.h"
+#include "trace_writer.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <span>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr uint64_t TICKS_PER_SECOND = 1000000;
+constexpr uint64_t START_TICKS = 5000;
+constexpr uint32_t PROCESS_ID = 4242;
+
+std::filesystem::path TracePath(const char *name) {
+    return std::filesystem::temp_directory_path() / (std::string("splintercell-trace-") + name + ".bin");
+}
+
+std::vector<std::byte> ReadFile(const std::filesystem::path &path) {
+    std::ifstream input(path, std::ios::binary);
+    std::vector<char> bytes{std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>()};
+    std::vector<std::byte> data(bytes.size());
+    std::memcpy(data.data(), bytes.data(), bytes.size());
+    return data;
+}
+
+std::string Convert(std::span<const std::byte> trace, bool &ok) {
+    std::ostringstream out;
+    ok = ConvertTraceToChromeJson(trace, out);
+    return out.str();
+}
+
+TraceRecord AffinityRecord(uint64_t timestamp) {
+    TraceRecord record;
+    record.timestamp = timestamp;
+    record.threadId = 7;
+    record.hook = TraceHook::SetThreadAffinityMask;
+    record.original = {0x1, 0};
+    record.rewritten = {0x30, 0};
+    record.result = 0xFF;
+    record.targetThreadId = 9;
+    return record;
+}
+
+void TestFileSize() {
+    CHECK(TraceFileBytes(0) == sizeof(TraceFileHeader));
+    CHECK(TraceFileBytes(3) == sizeof(TraceFileHeader) + 3 * sizeof(TraceRecord));
+    // The largest setting needs 256 GiB, which wraps around in a 32-bit size_t
+    CHECK(TraceFileBytes(UINT32_MAX) == 64 + uint64_t{UINT32_MAX} * 64);
+    CHECK((TraceFileBytes(UINT32_MAX) <= MAX_TRACE_FILE_BYTES) == (sizeof(size_t) == 8));
+
+    if constexpr (sizeof(size_t) == 4) {
+        const std::filesystem::path path = TracePath("huge");
+        TraceWriter writer;
+        const std::string file = path.string();
+        CHECK(!writer.Open({.file = file, .maxRecords = UINT32_MAX}, TICKS_PER_SECOND, START_TICKS, PROCESS_ID));
+        CHECK(!writer.Active() && !std::filesystem::exists(path));
+    }
+}
+
+void TestWriteAndConvert() {
+    const std::filesystem::path path = TracePath("closed");
+    const std::string file = path.string();
+    TraceWriter writer;
+    CHECK(!writer.Open({.file = {}}, TICKS_PER_SECOND, START_TICKS, PROCESS_ID));
+    CHECK(!writer.Open({.file = file, .maxRecords = 0}, TICKS_PER_SECOND, START_TICKS, PROCESS_ID));
+    CHECK(!writer.Append(AffinityRecord(START_TICKS)));
+
+    CHECK(writer.Open({.file = file, .maxRecords = 4}, TICKS_PER_SECOND, START_TICKS, PROCESS_ID));
+    CHECK(writer.Active());
+    CHECK(!writer.Open({.file = file, .maxRecords = 4}, TICKS_PER_SECOND, START_TICKS, PROCESS_ID));
+    CHECK(std::filesystem::file_size(path) == TraceFileBytes(4));
+
+    CHECK(writer.Append(AffinityRecord(START_TICKS + 1500)));
+    TraceRecord created;
+    created.timestamp = START_TICKS + 2000;
+    created.threadId = 7;
+    created.hook = TraceHook::CreateThread;
+    created.original = {0x401000, 0};
+    created.result = 11;
+    CHECK(writer.Append(created));
+    CHECK(writer.Written() == 2 && writer.Dropped() == 0);
+    writer.Close();
+    CHECK(!writer.Active());
+    CHECK(!writer.Append(AffinityRecord(START_TICKS)));
+    writer.Close(); // A second close does nothing
+
+    // Shrunk to the records written, with the count in the header
+    const std::vector<std::byte> trace = ReadFile(path);
+    CHECK(trace.size() == TraceFileBytes(2));
+    TraceFileHeader header;
+    std::memcpy(&header, trace.data(), sizeof(header));
+    CHECK(header.magic == TRACE_MAGIC && header.version == TRACE_VERSION);
+    CHECK(header.recordSize == sizeof(TraceRecord) && header.recordCount == 2);
+    CHECK(header.ticksPerSecond == TICKS_PER_SECOND && header.startTicks == START_TICKS);
+    CHECK(header.processId == PROCESS_ID);
+
+    bool ok = false;
+    const std::string json = Convert(trace, ok);
+    CHECK(ok);
+    CHECK(json.starts_with("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["));
+    CHECK(json.find("\"pid\":4242") != std::string::npos);
+    // Drawn on the target thread's track, 1.5 ms after the start
+    CHECK(json.find("{\"name\":\"SetThreadAffinityMask\",\"cat\":\"hook\",\"ph\":\"i\",\"s\":\"t\",\"ts\":1500.000,"
+                    "\"pid\":4242,\"tid\":9,\"args\":{\"caller\":7,\"thread\":9,\"mask\":\"0x1\","
+                    "\"applied mask\":\"0x30\",\"applied group\":0,\"previous mask\":\"0xFF\"}}") != std::string::npos);
+    CHECK(json.find("\"name\":\"CreateThread\"") != std::string::npos);
+    CHECK(json.find("\"start address\":\"0x401000\"") != std::string::npos);
+    CHECK(json.find("{\"name\":\"Thread created\",\"cat\":\"thread\",\"ph\":\"i\",\"s\":\"t\",\"ts\":2000.000,"
+                    "\"pid\":4242,\"tid\":11,\"args\":{\"creator\":7}}") != std::string::npos);
+    CHECK(json.ends_with("\n]}\n"));
+    std::filesystem::remove(path);
+}
+
+void TestFull() {
+    const std::filesystem::path path = TracePath("full");
+    const std::string file = path.string();
+    TraceWriter writer;
+    CHECK(writer.Open({.file = file, .maxRecords = 2}, TICKS_PER_SECOND, START_TICKS, PROCESS_ID));
+    CHECK(writer.Append(AffinityRecord(START_TICKS)));
+    CHECK(writer.Append(AffinityRecord(START_TICKS)));
+    CHECK(!writer.Append(AffinityRecord(START_TICKS)));
+    CHECK(!writer.Append(AffinityRecord(START_TICKS)));
+    CHECK(writer.Written() == 2 && writer.Dropped() == 2);
+    writer.Close();
+    CHECK(std::filesystem::file_size(path) == TraceFileBytes(2));
+
+    // The writer can be opened again for a new trace
+    CHECK(writer.Open({.file = file, .maxRecords = 8}, TICKS_PER_SECOND, START_TICKS, PROCESS_ID));
+    CHECK(writer.Written() == 0 && writer.Dropped() == 0);
+    writer.Close();
+    CHECK(std::filesystem::file_size(path) == TraceFileBytes(0));
+    std::filesystem::remove(path);
+}
+
+// A process that dies while tracing leaves a full-size file without a record count; unused slots are skipped
+void TestUnclosedTrace() {
+    const std::filesystem::path path = TracePath("crashed");
+    const std::string file = path.string();
+    TraceWriter writer;
+    CHECK(writer.Open({.file = file, .maxRecords = 16}, TICKS_PER_SECOND, START_TICKS, PROCESS_ID));
+    CHECK(writer.Append(AffinityRecord(START_TICKS + 10)));
+    CHECK(writer.Append(AffinityRecord(START_TICKS + 20)));
+
+    const std::vector<std::byte> trace = ReadFile(path); // The mapping is shared, so the file has the records
+    CHECK(trace.size() == TraceFileBytes(16));
+    bool ok = false;
+    const std::string json = Convert(trace, ok);
+    CHECK(ok);
+    size_t events = 0;
+    for (size_t at = json.find("SetThreadAffinityMask"); at != std::string::npos;
+         at = json.find("SetThreadAffinityMask", at + 1)) {
+        ++events;
+    }
+    CHECK(events == 2);
+    writer.Close();
+    std::filesystem::remove(path);
+}
+
+void TestMalformed() {
+    TraceFileHeader header;
+    header.recordSize = sizeof(TraceRecord);
+    header.ticksPerSecond = TICKS_PER_SECOND;
+    std::vector<std::byte> trace(sizeof(header) + sizeof(TraceRecord) + 10); // Ends in a partial record
+    std::memcpy(trace.data(), &header, sizeof(header));
+    TraceRecord record = AffinityRecord(0);
+    record.hook = TraceHook::Count; // Unknown hooks are skipped
+    std::memcpy(trace.data() + sizeof(header), &record, sizeof(record));
+
+    bool ok = false;
+    CHECK(Convert(trace, ok).find("SetThreadAffinityMask") == std::string::npos);
+    CHECK(ok);
+    Convert(std::span(trace).first(sizeof(header) - 1), ok);
+    CHECK(!ok);
+
+    const auto convertModified = [&](auto modify) {
+        TraceFileHeader modified = header;
+        modify(modified);
+        std::vector<std::byte> copy = trace;
+        std::memcpy(copy.data(), &modified, sizeof(modified));
+        bool converted = false;
+        Convert(copy, converted);
+        return converted;
+    };
+    CHECK(!convertModified([](TraceFileHeader &h) { h.magic[0] = 'X'; }));
+    CHECK(!convertModified([](TraceFileHeader &h) { h.version = TRACE_VERSION + 1; }));
+    CHECK(!convertModified([](TraceFileHeader &h) { h.recordSize = 32; }));
+    CHECK(!convertModified([](TraceFileHeader &h) { h.ticksPerSecond = 0; }));
+}
+
+} // namespace
+
+int main() {
+    TestFileSize();
+    TestWriteAndConvert();
+    TestFull();
+    TestUnclosedTrace();
+    TestMalformed();
+    return CheckResult();
+}
\ No newline at end of file
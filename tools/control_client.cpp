@@ -0,0 +1,89 @@
+// Sends a command to a process running SplinterCellPatch.dll and prints the response.
+// Usage: SplinterCellControl <process id> <command> [<arguments>]    (try "help")
+//        SplinterCellControl <process id> --bench [<round trips>]     (measures ping round trips)
+
+#include "control_channel.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+int RunCommand(ControlClient &client, const std::string &line) {
+    ControlResponse response;
+    if (!client.Request(line, response)) {
+        std::cerr << "Connection lost\n";
+        return 1;
+    }
+    for (const std::string &text : response.lines) {
+        (response.ok ? std::cout : std::cerr) << text << '\n';
+    }
+    return response.ok ? 0 : 1;
+}
+
+int RunBenchmark(ControlClient &client, long roundTrips) {
+    std::vector<double> microseconds;
+    microseconds.reserve(static_cast<size_t>(roundTrips));
+    const auto begin = std::chrono::steady_clock::now();
+    for (long i = 0; i < roundTrips; ++i) {
+        ControlResponse response;
+        const auto start = std::chrono::steady_clock::now();
+        if (!client.Request("ping", response) || !response.ok) {
+            std::cerr << "Round trip " << i << " failed\n";
+            return 1;
+        }
+        microseconds.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    std::ranges::sort(microseconds);
+    const auto percentile = [&](double p) {
+        return microseconds[static_cast<size_t>(p * static_cast<double>(microseconds.size() - 1))];
+    };
+    std::printf("%ld round trips in %.3f s (%.0f requests/s)\n", roundTrips, seconds,
+                static_cast<double>(roundTrips) / seconds);
+    std::printf("min %.1f us, p50 %.1f us, p99 %.1f us, max %.1f us\n", microseconds.front(), percentile(0.5),
+                percentile(0.99), microseconds.back());
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <process id> <command> [<arguments>]\n"
+                  << "       " << argv[0] << " <process id> --bench [<round trips>]\n";
+        return 2;
+    }
+    const auto processId = static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10));
+    if (processId == 0) {
+        std::cerr << "Invalid process id\n";
+        return 2;
+    }
+
+    ControlClient client;
+    if (!client.Connect(processId)) {
+        std::cerr << "Process " << processId << " has no SplinterCellPatch control channel\n";
+        return 1;
+    }
+
+    if (std::string(argv[2]) == "--bench") {
+        const long roundTrips = argc > 3 ? std::strtol(argv[3], nullptr, 10) : 10000;
+        if (roundTrips <= 0) {
+            std::cerr << "Invalid round trip count\n";
+            return 2;
+        }
+        return RunBenchmark(client, roundTrips);
+    }
+
+    std::string line = argv[2];
+    for (int i = 3; i < argc; ++i) {
+        line += ' ';
+        line += argv[i];
+    }
+    return RunCommand(client, line);
+}
\ No newline at end of file
@@ -0,0 +1,258 @@
+// Multi-threaded allocation stress comparing the C library's malloc with SlabHeap, the allocator behind the opt-in
+// heap replacement (see slab_heap.h).
+// Usage: SplinterCellHeapBench [<operations per thread>] [<thread count>...]
+//        (defaults: 2000000 operations, 1 2 4 ... up to the number of hardware threads)
+//
+// Every thread keeps a working set of live blocks and replaces a random one per operation, mostly with small sizes
+// as game code allocates them. One block in eight is handed to the next thread through a ring and freed there, so
+// cross-thread frees are part of the load. Each block carries a tag that is checked when it is freed.
+
+#include "slab_heap.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr size_t WORKING_SET = 512;
+constexpr size_t RING_SIZE = 1024; // Power of two
+constexpr size_t ARENA_SIZE = size_t{1} << 30;
+
+struct Allocator {
+    const char *name;
+    void *(*allocate)(size_t size);
+    void (*free)(void *block);
+};
+
+SlabHeap g_slabHeap;
+
+// Same routing as the hooks: sizes or threads the slab heap refuses fall back to malloc
+void *SlabAllocate(size_t size) {
+    void *block = g_slabHeap.Allocate(size);
+    return block ? block : std::malloc(size);
+}
+
+void SlabFree(void *block) {
+    if (g_slabHeap.Owns(block)) {
+        g_slabHeap.Free(block);
+    } else {
+        std::free(block);
+    }
+}
+
+constexpr Allocator ALLOCATORS[] = {
+    {"malloc", std::malloc, std::free},
+    {"slab", SlabAllocate, SlabFree},
+};
+
+uint64_t NextRandom(uint64_t &state) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+// Three quarters up to 128 bytes, most of the rest up to 1 KiB, a few up to 8 KiB
+size_t RandomSize(uint64_t random) {
+    const uint64_t bucket = random & 15;
+    random >>= 4;
+    if (bucket < 12) {
+        return 8 + random % 121;
+    }
+    if (bucket < 15) {
+        return 129 + random % 896;
+    }
+    return 1025 + random % 7168;
+}
+
+// Single producer, single consumer
+struct alignas(64) Ring {
+    std::array<void *, RING_SIZE> blocks = {};
+    alignas(64) std::atomic<size_t> head = 0; // Written by the consumer
+    alignas(64) std::atomic<size_t> tail = 0; // Written by the producer
+
+    bool Push(void *block) {
+        const size_t tailValue = tail.load(std::memory_order_relaxed);
+        if (tailValue - head.load(std::memory_order_acquire) == RING_SIZE) {
+            return false;
+        }
+        blocks[tailValue % RING_SIZE] = block;
+        tail.store(tailValue + 1, std::memory_order_release);
+        return true;
+    }
+
+    void *Pop() {
+        const size_t headValue = head.load(std::memory_order_relaxed);
+        if (headValue == tail.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        void *block = blocks[headValue % RING_SIZE];
+        head.store(headValue + 1, std::memory_order_release);
+        return block;
+    }
+};
+
+uint64_t Tag(const void *block, size_t size) {
+    return reinterpret_cast<uintptr_t>(block) ^ (size * 0x9E3779B97F4A7C15ull);
+}
+
+void WriteTag(void *block, size_t size) {
+    const uint64_t tag = Tag(block, size);
+    std::memcpy(block, &tag, sizeof(tag));
+    static_cast<unsigned char *>(block)[size - 1] = static_cast<unsigned char>(size);
+}
+
+bool CheckTag(const void *block, size_t size) {
+    uint64_t tag = 0;
+    std::memcpy(&tag, block, sizeof(tag));
+    const auto last = static_cast<const unsigned char *>(block)[size - 1];
+    return tag == Tag(block, size) && last == static_cast<unsigned char>(size);
+}
+
+struct Block {
+    void *address = nullptr;
+    size_t size = 0;
+};
+
+struct Result {
+    double seconds = 0;
+    uint64_t corrupted = 0;
+};
+
+Result Run(const Allocator &allocator, size_t threadCount, uint64_t operations) {
+    std::vector<std::unique_ptr<Ring>> rings(threadCount);
+    for (auto &ring : rings) {
+        ring = std::make_unique<Ring>();
+    }
+    std::atomic<size_t> ready = 0;
+    std::atomic<bool> start = false;
+    std::atomic<size_t> finished = 0;
+    std::atomic<uint64_t> corrupted = 0;
+
+    const auto freeBlock = [&](void *address, size_t size) {
+        if (!CheckTag(address, size)) {
+            corrupted.fetch_add(1, std::memory_order_relaxed);
+        }
+        allocator.free(address);
+    };
+    // The size is stored after the tag, so the thread freeing a block it received can check it
+    const auto drain = [&](Ring &ring) {
+        while (void *address = ring.Pop()) {
+            size_t size = 0;
+            std::memcpy(&size, static_cast<unsigned char *>(address) + sizeof(uint64_t), sizeof(size));
+            freeBlock(address, size);
+        }
+    };
+
+    const auto worker = [&](size_t index) {
+        std::array<Block, WORKING_SET> live = {};
+        uint64_t random = 0x2545F4914F6CDD1Dull * (index + 1);
+        Ring &incoming = *rings[index];
+        Ring &outgoing = *rings[(index + 1) % threadCount];
+
+        ++ready;
+        while (!start.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+        for (uint64_t i = 0; i < operations; ++i) {
+            const uint64_t value = NextRandom(random);
+            Block &slot = live[value % WORKING_SET];
+            if (slot.address) {
+                // Every eighth block is freed by the next thread
+                if ((value >> 20 & 7) != 0 || threadCount == 1 || !outgoing.Push(slot.address)) {
+                    freeBlock(slot.address, slot.size);
+                }
+            }
+            slot.size = std::max(RandomSize(value >> 24), sizeof(uint64_t) + sizeof(size_t) + 1);
+            slot.address = allocator.allocate(slot.size);
+            WriteTag(slot.address, slot.size);
+            std::memcpy(static_cast<unsigned char *>(slot.address) + sizeof(uint64_t), &slot.size, sizeof(size_t));
+            if ((i & 63) == 0) {
+                drain(incoming);
+            }
+        }
+        for (Block &slot : live) {
+            if (slot.address) {
+                freeBlock(slot.address, slot.size);
+            }
+        }
+        // Blocks can arrive until the producer is done
+        ++finished;
+        while (finished.load() != threadCount) {
+            drain(incoming);
+            std::this_thread::yield();
+        }
+        drain(incoming);
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < threadCount; ++i) {
+        threads.emplace_back(worker, i);
+    }
+    while (ready.load() != threadCount) {
+        std::this_thread::yield();
+    }
+    const auto begin = std::chrono::steady_clock::now();
+    start.store(true, std::memory_order_release);
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    return {seconds, corrupted.load()};
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    const uint64_t operations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000000;
+    std::vector<size_t> threadCounts;
+    for (int i = 2; i < argc; ++i) {
+        threadCounts.push_back(std::strtoul(argv[i], nullptr, 10));
+    }
+    if (threadCounts.empty()) {
+        const size_t hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+        for (size_t count = 1; count < hardwareThreads; count *= 2) {
+            threadCounts.push_back(count);
+        }
+        threadCounts.push_back(hardwareThreads);
+    }
+    if (operations == 0 || std::ranges::find(threadCounts, size_t{0}) != threadCounts.end()) {
+        std::fprintf(stderr, "Usage: %s [<operations per thread>] [<thread count>...]\n", argv[0]);
+        return 2;
+    }
+    if (!g_slabHeap.Create(ARENA_SIZE)) {
+        std::fprintf(stderr, "Cannot reserve the slab heap arena\n");
+        return 1;
+    }
+
+    std::printf("%llu operations per thread, working set of %zu blocks per thread\n",
+                static_cast<unsigned long long>(operations), WORKING_SET);
+    std::printf("%8s %16s %16s %8s\n", "threads", "malloc Mops/s", "slab Mops/s", "speedup");
+    bool intact = true;
+    for (const size_t threadCount : threadCounts) {
+        std::array<double, std::size(ALLOCATORS)> throughput = {};
+        for (size_t i = 0; i < std::size(ALLOCATORS); ++i) {
+            const Result result = Run(ALLOCATORS[i], threadCount, operations);
+            throughput[i] = static_cast<double>(operations * threadCount) / result.seconds / 1e6;
+            if (result.corrupted != 0) {
+                std::fprintf(stderr, "%s: %llu corrupted blocks with %zu threads\n", ALLOCATORS[i].name,
+                             static_cast<unsigned long long>(result.corrupted), threadCount);
+                intact = false;
+            }
+        }
+        std::printf("%8zu %16.1f %16.1f %7.2fx\n", threadCount, throughput[0], throughput[1],
+                    throughput[1] / throughput[0]);
+    }
+
+    const SlabHeap::Statistics statistics = g_slabHeap.Snapshot();
+    std::printf("slab heap: %u of %u spans carved, %u in use, %u abandoned\n", statistics.spansPeak,
+                statistics.spansTotal, statistics.spansUsed, statistics.spansAbandoned);
+    return intact ? 0 : 1;
+}
\ No newline at end of file
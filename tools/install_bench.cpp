@@ -0,0 +1,128 @@
+// Measures how long a hook transaction keeps the process suspended as the number of threads grows.
+// Usage: SplinterCellInstallBench [<repeats>] [<thread count>...]    (defaults: 20 repeats, 10 100 1000 threads)
+//
+// Every round attaches and detaches a pass-through SetProcessAffinityMask hook while the worker threads alternate
+// between short bursts of work and sleeping, like the threads of a running game.
+
+#include "hook_table.h"
+#include "logging.h"
+#include <windows.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+namespace {
+
+typedef BOOL (WINAPI *PFN_SetProcessAffinityMask)(HANDLE, DWORD_PTR);
+PFN_SetProcessAffinityMask Real_SetProcessAffinityMask = nullptr;
+
+BOOL WINAPI Bench_SetProcessAffinityMask(HANDLE hProcess, DWORD_PTR dwProcessAffinityMask) {
+    return Real_SetProcessAffinityMask(hProcess, dwProcessAffinityMask);
+}
+
+constexpr HookEntry BENCH_TABLE[] = {
+    MakeHook<Real_SetProcessAffinityMask, Bench_SetProcessAffinityMask>("kernel32.dll", "SetProcessAffinityMask"),
+};
+
+struct Percentiles {
+    uint64_t min = 0;
+    uint64_t median = 0;
+    uint64_t max = 0;
+};
+
+Percentiles Summarize(std::vector<uint64_t> samples) {
+    std::ranges::sort(samples);
+    return {samples.front(), samples[samples.size() / 2], samples.back()};
+}
+
+void WriteStderr(const char *line) {
+    std::fputs(line, stderr);
+}
+
+// Returns false if a transaction failed
+bool MeasureThreadCount(size_t threadCount, int repeats, HookThreads mode) {
+    std::atomic<bool> stop = false;
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < threadCount; ++i) {
+        workers.emplace_back([&stop] {
+            volatile uint64_t sink = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                for (int spin = 0; spin < 20000; ++spin) {
+                    sink = sink + static_cast<uint64_t>(spin);
+                }
+                Sleep(1);
+            }
+        });
+    }
+
+    std::vector<uint64_t> attach;
+    std::vector<uint64_t> detach;
+    uint32_t suspended = 0;
+    bool ok = true;
+    const HookMask entries = SelectHooks(BENCH_TABLE, 0);
+    for (int round = 0; round < repeats && ok; ++round) {
+        HookTransactionStats stats;
+        ok = AttachHooks(BENCH_TABLE, entries, HookBackend::Detours, mode, stats);
+        attach.push_back(stats.suspendedMicroseconds);
+        suspended = stats.threads;
+        ok = ok && DetachHooks(BENCH_TABLE, entries, HookBackend::Detours, mode, stats);
+        detach.push_back(stats.suspendedMicroseconds);
+    }
+
+    stop = true;
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+    if (!ok) {
+        return false;
+    }
+
+    const Percentiles attachTimes = Summarize(attach);
+    const Percentiles detachTimes = Summarize(detach);
+    std::printf("%8zu %-8s %10u %10llu %10llu %10llu %10llu\n", threadCount,
+                mode == HookThreads::All ? "all" : "current", suspended,
+                static_cast<unsigned long long>(attachTimes.min), static_cast<unsigned long long>(attachTimes.median),
+                static_cast<unsigned long long>(attachTimes.max), static_cast<unsigned long long>(detachTimes.median));
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    const int repeats = argc > 1 ? std::atoi(argv[1]) : 20;
+    std::vector<size_t> threadCounts;
+    for (int i = 2; i < argc; ++i) {
+        threadCounts.push_back(std::strtoul(argv[i], nullptr, 10));
+    }
+    if (threadCounts.empty()) {
+        threadCounts = {10, 100, 1000};
+    }
+    if (repeats <= 0) {
+        std::fprintf(stderr, "Invalid repeat count\n");
+        return 2;
+    }
+
+    if (!ProcessLogger().Start(WriteStderr, {})) {
+        ProcessLogger().Stop();
+    }
+    if (!ResolveHooks(BENCH_TABLE)) {
+        ProcessLogger().Stop();
+        return 1;
+    }
+
+    std::printf("%8s %-8s %10s %10s %10s %10s %10s\n", "threads", "mode", "suspended", "min us", "median us",
+                "max us", "detach us");
+    int result = 0;
+    for (const size_t threadCount : threadCounts) {
+        for (const HookThreads mode : {HookThreads::Current, HookThreads::All}) {
+            if (!MeasureThreadCount(threadCount, repeats, mode)) {
+                result = 1;
+            }
+        }
+    }
+    ProcessLogger().Stop();
+    return result;
+}
\ No newline at end of file
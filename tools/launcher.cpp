@@ -0,0 +1,161 @@
+// Starts a game with SplinterCellPatch.dll already in its import table, so the hooks are live before the game's
+// first instruction runs.
+// Usage: SplinterCellLauncher [--dll <path>] [--wait] <game.exe> [<game arguments>...]
+//
+// The game is created suspended with DetourCreateProcessWithDllEx, which adds the DLL to the in-memory import table
+// of the new process, and only then resumed. The DLL defaults to SplinterCellPatch.dll next to the launcher and must
+// have the game's bitness. With --wait the launcher exits with the game's exit code.
+//
+// The game's profile (its compiled-in profile with SplinterCellPatch.ini applied) is resolved here and copied into
+// the new process as a Detours payload, so the DLL starts without touching the disk.
+
+#include "config_payload.h"
+#include <windows.h>
+#include <bit>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#include "detours_x64.h"
+#else
+#include "detours_x86.h"
+#endif
+
+namespace {
+
+constexpr std::string_view DLL_NAME = "SplinterCellPatch.dll";
+
+// Quotes one argument so CommandLineToArgvW and the CRT split it back unchanged
+void AppendArgument(std::string &commandLine, std::string_view argument) {
+    if (!commandLine.empty()) {
+        commandLine += ' ';
+    }
+    if (!argument.empty() && argument.find_first_of(" \t\n\v\"") == std::string_view::npos) {
+        commandLine += argument;
+        return;
+    }
+
+    commandLine += '"';
+    size_t backslashes = 0;
+    for (const char c : argument) {
+        if (c == '\\') {
+            ++backslashes;
+            continue;
+        }
+        // Backslashes are only special before a quote
+        commandLine.append(c == '"' ? backslashes * 2 + 1 : backslashes, '\\');
+        backslashes = 0;
+        commandLine += c;
+    }
+    commandLine.append(backslashes * 2, '\\');
+    commandLine += '"';
+}
+
+std::filesystem::path LauncherDirectory() {
+    char path[MAX_PATH] = {};
+    GetModuleFileNameA(nullptr, path, MAX_PATH);
+    return std::filesystem::path(path).parent_path();
+}
+
+// Same resolution as the DLL: compiled-in profile for the game's file name, then the config file next to it
+std::vector<uint8_t> BuildConfigPayload(const std::string &game) {
+    const ExecutableProfile &base = FindExecutableProfile(game);
+    const std::string configPath = ConfigFilePath(game);
+    std::string text;
+    if (!ReadConfigFile(configPath, text)) {
+        text.clear(); // No file: the compiled-in profile as is
+    }
+    const std::unique_ptr<ProfileConfig> config = ParseProfileConfig(text, game, base);
+    for (const ConfigError &error : config->errors) {
+        std::fprintf(stderr, "%s line %u: %.*s, line ignored\n", configPath.c_str(), error.line,
+                     static_cast<int>(error.message.size()), error.message.data());
+    }
+    return WriteConfigPayload(config->profile);
+}
+
+void PrintUsage(const char *launcher) {
+    std::fprintf(stderr, "Usage: %s [--dll <path>] [--wait] <game.exe> [<game arguments>...]\n", launcher);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::filesystem::path dllPath = LauncherDirectory() / DLL_NAME;
+    bool wait = false;
+    int gameIndex = 1;
+    for (; gameIndex < argc; ++gameIndex) {
+        const std::string_view option = argv[gameIndex];
+        if (option == "--dll" && gameIndex + 1 < argc) {
+            dllPath = argv[++gameIndex];
+        } else if (option == "--wait") {
+            wait = true;
+        } else {
+            break;
+        }
+    }
+    if (gameIndex >= argc) {
+        PrintUsage(argv[0]);
+        return 2;
+    }
+
+    std::error_code error;
+    const std::filesystem::path gamePath = std::filesystem::absolute(argv[gameIndex], error);
+    dllPath = std::filesystem::absolute(dllPath, error);
+    if (!std::filesystem::exists(gamePath) || !std::filesystem::exists(dllPath)) {
+        std::fprintf(stderr, "Cannot find %s\n", std::filesystem::exists(gamePath) ? dllPath.string().c_str()
+                                                                                    : gamePath.string().c_str());
+        return 1;
+    }
+
+    std::string commandLine;
+    AppendArgument(commandLine, gamePath.string());
+    for (int i = gameIndex + 1; i < argc; ++i) {
+        AppendArgument(commandLine, argv[i]);
+    }
+
+    // Games expect to run from their own directory
+    const std::string game = gamePath.string();
+    const std::string workingDirectory = gamePath.parent_path().string();
+    const std::string dll = dllPath.string();
+    STARTUPINFOA startup = {};
+    startup.cb = sizeof(startup);
+    PROCESS_INFORMATION process = {};
+    if (!DetourCreateProcessWithDllExA(game.c_str(), commandLine.data(), nullptr, nullptr, FALSE,
+                                       CREATE_SUSPENDED | CREATE_DEFAULT_ERROR_MODE, nullptr,
+                                       workingDirectory.c_str(), &startup, &process, dll.c_str(), nullptr)) {
+        std::fprintf(stderr, "Cannot start %s with %s (error: 0x%lX)\n", game.c_str(), dll.c_str(),
+                     static_cast<unsigned long>(GetLastError()));
+        return 1;
+    }
+
+    // Without the payload the DLL falls back to reading the config file itself
+    std::vector<uint8_t> payload = BuildConfigPayload(game);
+    if (!DetourCopyPayloadToProcess(process.hProcess, std::bit_cast<GUID>(CONFIG_PAYLOAD_GUID), payload.data(),
+                                    static_cast<DWORD>(payload.size()))) {
+        std::fprintf(stderr, "Cannot pass the profile to %s (error: 0x%lX), the DLL will read %s\n", game.c_str(),
+                     static_cast<unsigned long>(GetLastError()), CONFIG_FILE_NAME.data());
+    }
+
+    if (ResumeThread(process.hThread) == static_cast<DWORD>(-1)) {
+        std::fprintf(stderr, "Cannot resume %s (error: 0x%lX)\n", game.c_str(),
+                     static_cast<unsigned long>(GetLastError()));
+        TerminateProcess(process.hProcess, 1);
+        CloseHandle(process.hThread);
+        CloseHandle(process.hProcess);
+        return 1;
+    }
+    std::printf("Started %s (process %lu)\n", game.c_str(), static_cast<unsigned long>(process.dwProcessId));
+
+    DWORD exitCode = 0;
+    if (wait) {
+        WaitForSingleObject(process.hProcess, INFINITE);
+        GetExitCodeProcess(process.hProcess, &exitCode);
+    }
+    CloseHandle(process.hThread);
+    CloseHandle(process.hProcess);
+    return static_cast<int>(exitCode);
+}
\ No newline at end of file
@@ -0,0 +1,242 @@
+// Multi-threaded stress of LockProfiler, the aggregation behind the lock contention profiling mode (see
+// lock_profiler.h), with standard mutexes standing in for the game's locks (pthread mutexes on Linux).
+// Usage: SplinterCellLockStress [<operations per thread>] [<thread count>]
+//        (defaults: 200000 operations, the number of hardware threads but at least 4)
+//
+// std::mutex plays a CRITICAL_SECTION and std::timed_mutex an object waited on with a timeout. Locks are taken the
+// way the hooks take them: a try first, counted as an uncontended acquire, then a timed wait. Half the operations
+// go to one hot lock, the rest spread over the others. Call sites are simulated: each acquire is attributed to one
+// of more sites than a lock has slots for, picked with a skew, so the report shows which ones the profiler kept.
+// The same load runs once without recording, for the overhead, then once recording; the totals must add up.
+
+#include "lock_profiler.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr size_t LOCK_COUNT = 64;
+constexpr size_t TIMED_LOCK_COUNT = 4;
+constexpr size_t CALL_SITE_COUNT = 12; // More than LockProfiler::CALL_SITES
+constexpr uintptr_t CALL_SITE_BASE = 0x401000; // Simulated return addresses are CALL_SITE_BASE + 16 * site
+constexpr auto TIMED_WAIT = std::chrono::microseconds(200);
+constexpr size_t REPORT_LOCKS = 8;
+
+struct alignas(64) Lock {
+    std::mutex mutex;
+};
+
+struct alignas(64) TimedLock {
+    std::timed_mutex mutex;
+};
+
+struct Counts {
+    uint64_t acquires = 0;
+    uint64_t timeouts = 0;
+};
+
+LockProfiler g_profiler;
+
+uint64_t Now() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+}
+
+uint64_t NextRandom(uint64_t &state) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+// Site 0 about half the time, site 1 a quarter, and so on
+size_t RandomCallSite(uint64_t random) {
+    return std::min<size_t>(std::countr_one(random), CALL_SITE_COUNT - 1);
+}
+
+uintptr_t CallSiteAddress(size_t site) {
+    return CALL_SITE_BASE + 16 * site;
+}
+
+// What Hooked_EnterCriticalSection does
+void Enter(std::mutex &mutex, uintptr_t callSite, bool record) {
+    if (mutex.try_lock()) {
+        if (record) {
+            g_profiler.RecordAcquire(LockKind::CriticalSection, &mutex);
+        }
+        return;
+    }
+    const uint64_t start = Now();
+    mutex.lock();
+    if (record) {
+        g_profiler.RecordWait(LockKind::CriticalSection, &mutex, callSite, Now() - start, true);
+    }
+}
+
+// What Hooked_WaitForSingleObject does
+bool Wait(std::timed_mutex &mutex, uintptr_t callSite, bool record) {
+    if (mutex.try_lock()) {
+        if (record) {
+            g_profiler.RecordAcquire(LockKind::WaitObject, &mutex);
+        }
+        return true;
+    }
+    const uint64_t start = Now();
+    const bool acquired = mutex.try_lock_for(TIMED_WAIT);
+    if (record) {
+        g_profiler.RecordWait(LockKind::WaitObject, &mutex, callSite, Now() - start, acquired);
+    }
+    return acquired;
+}
+
+// Work done while holding a lock, long enough for other threads to pile up
+void Hold(uint64_t random) {
+    volatile uint64_t sink = random;
+    for (uint64_t i = 0; i < 32 + (random & 127); ++i) {
+        sink = sink * 6364136223846793005ull + 1;
+    }
+}
+
+double Run(std::span<Lock> locks, std::span<TimedLock> timedLocks, size_t threadCount, uint64_t operations,
+           bool record, Counts &counts) {
+    std::atomic<size_t> ready = 0;
+    std::atomic<bool> start = false;
+    std::atomic<uint64_t> acquires = 0;
+    std::atomic<uint64_t> timeouts = 0;
+
+    const auto worker = [&](size_t index) {
+        uint64_t random = 0x2545F4914F6CDD1Dull * (index + 1);
+        uint64_t acquired = 0;
+        uint64_t timedOut = 0;
+        ++ready;
+        while (!start.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+        for (uint64_t i = 0; i < operations; ++i) {
+            const uint64_t value = NextRandom(random);
+            const uintptr_t callSite = CallSiteAddress(RandomCallSite(value >> 32));
+            if ((value & 31) == 0) {
+                std::timed_mutex &mutex = timedLocks[(value >> 8) % timedLocks.size()].mutex;
+                if (Wait(mutex, callSite, record)) {
+                    Hold(value >> 16);
+                    mutex.unlock();
+                    ++acquired;
+                } else {
+                    ++timedOut;
+                }
+                continue;
+            }
+            // Half the acquires go to the hot lock
+            std::mutex &mutex = locks[(value & 32) != 0 ? 0 : (value >> 8) % locks.size()].mutex;
+            Enter(mutex, callSite, record);
+            Hold(value >> 16);
+            mutex.unlock();
+            ++acquired;
+        }
+        acquires += acquired;
+        timeouts += timedOut;
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < threadCount; ++i) {
+        threads.emplace_back(worker, i);
+    }
+    while (ready.load() != threadCount) {
+        std::this_thread::yield();
+    }
+    const auto begin = std::chrono::steady_clock::now();
+    start.store(true, std::memory_order_release);
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    counts = {acquires.load(), timeouts.load()};
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+void PrintReport(const std::vector<LockProfiler::LockReport> &reports) {
+    std::printf("%-18s %-16s %10s %10s %8s %10s %8s %8s %8s\n", "lock", "kind", "acquires", "contended", "timeouts",
+                "wait ms", "p50 us", "p99 us", "max us");
+    for (const LockProfiler::LockReport &lock : reports) {
+        std::printf("%-18p %-16.*s %10llu %10llu %8llu %10.2f %8llu %8llu %8llu\n", lock.lock,
+                    static_cast<int>(LockKindName(lock.kind).size()), LockKindName(lock.kind).data(),
+                    static_cast<unsigned long long>(lock.acquires), static_cast<unsigned long long>(lock.contended),
+                    static_cast<unsigned long long>(lock.timeouts), static_cast<double>(lock.totalWaitNs) / 1e6,
+                    static_cast<unsigned long long>(WaitPercentileUs(lock.waitHistogram, 0.5)),
+                    static_cast<unsigned long long>(WaitPercentileUs(lock.waitHistogram, 0.99)),
+                    static_cast<unsigned long long>(lock.maxWaitNs / 1000));
+        for (const LockProfiler::CallSiteReport &site : lock.callSites) {
+            std::printf("    site %2llu %10llu waits %10.2f ms\n",
+                        static_cast<unsigned long long>((site.address - CALL_SITE_BASE) / 16),
+                        static_cast<unsigned long long>(site.waits), static_cast<double>(site.waitNs) / 1e6);
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    const uint64_t operations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+    const size_t threadCount =
+        argc > 2 ? std::strtoul(argv[2], nullptr, 10) : std::max(4u, std::thread::hardware_concurrency());
+    if (operations == 0 || threadCount == 0) {
+        std::fprintf(stderr, "Usage: %s [<operations per thread>] [<thread count>]\n", argv[0]);
+        return 2;
+    }
+    if (!g_profiler.Create({.enabled = true, .maxLocks = 1024}, 1'000'000'000)) {
+        std::fprintf(stderr, "Cannot create the lock profiler\n");
+        return 1;
+    }
+    const auto locks = std::make_unique<Lock[]>(LOCK_COUNT);
+    const auto timedLocks = std::make_unique<TimedLock[]>(TIMED_LOCK_COUNT);
+    const std::span lockSpan(locks.get(), LOCK_COUNT);
+    const std::span timedLockSpan(timedLocks.get(), TIMED_LOCK_COUNT);
+
+    std::printf("%llu operations on each of %zu threads, %zu locks and %zu timed locks\n",
+                static_cast<unsigned long long>(operations), threadCount, LOCK_COUNT, TIMED_LOCK_COUNT);
+    Counts plainCounts;
+    Counts counts;
+    const double plainSeconds = Run(lockSpan, timedLockSpan, threadCount, operations, false, plainCounts);
+    const double seconds = Run(lockSpan, timedLockSpan, threadCount, operations, true, counts);
+    const auto total = static_cast<double>(operations * threadCount);
+    std::printf("%.2f Mops/s without recording, %.2f Mops/s recording (%.0f ns per operation)\n\n",
+                total / plainSeconds / 1e6, total / seconds / 1e6, (seconds - plainSeconds) / total * 1e9);
+
+    const std::vector<LockProfiler::LockReport> all = g_profiler.Report(LOCK_COUNT + TIMED_LOCK_COUNT);
+    PrintReport({all.begin(), all.begin() + static_cast<ptrdiff_t>(std::min(all.size(), REPORT_LOCKS))});
+
+    // Every acquire and timeout must be accounted for exactly once
+    Counts recorded;
+    uint64_t siteWaits = 0;
+    uint64_t contended = 0;
+    for (const LockProfiler::LockReport &lock : all) {
+        recorded.acquires += lock.acquires;
+        recorded.timeouts += lock.timeouts;
+        contended += lock.contended;
+        for (const LockProfiler::CallSiteReport &site : lock.callSites) {
+            siteWaits += site.waits;
+        }
+    }
+    std::printf("\n%zu locks tracked, %llu acquires and %llu timeouts recorded, %llu of %llu waits attributed\n",
+                g_profiler.TrackedLocks(), static_cast<unsigned long long>(recorded.acquires),
+                static_cast<unsigned long long>(recorded.timeouts), static_cast<unsigned long long>(siteWaits),
+                static_cast<unsigned long long>(contended));
+    if (recorded.acquires != counts.acquires || recorded.timeouts != counts.timeouts ||
+        recorded.acquires + recorded.timeouts != operations * threadCount || siteWaits > contended) {
+        std::fprintf(stderr, "Recorded totals do not match: %llu acquires and %llu timeouts were made\n",
+                     static_cast<unsigned long long>(counts.acquires),
+                     static_cast<unsigned long long>(counts.timeouts));
+        return 1;
+    }
+    return 0;
+}
\ No newline at end of file
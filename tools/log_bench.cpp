@@ -0,0 +1,188 @@
+// Multi-producer stress of LogRing, the queue behind the asynchronous logger (see log_ring.h), against a mutex
+// protected queue of the same capacity.
+// Usage: SplinterCellLogBench [<records per producer>] [<producer count>...]
+//        (defaults: 1000000 records, 1 2 4 ... up to the number of hardware threads)
+//
+// Producers push records as fast as they can. Where AsyncLogger would drop a record because the queue is full, they
+// yield and retry, so that every record is delivered; how often that happened is reported. One consumer pops
+// continuously. Each record carries its producer and sequence number, and the consumer checks that every
+// producer's records arrive complete and in order. The time per push, retries included, is what an intercepted
+// call pays, so it is reported next to the throughput.
+
+#include "async_logger.h"
+#include "log_ring.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr size_t CAPACITY = AsyncLogger::DEFAULT_CAPACITY;
+
+// Same interface as LogRing, with one lock around a deque
+class MutexQueue {
+public:
+    explicit MutexQueue(size_t capacity) : m_capacity(capacity) {}
+
+    bool TryPush(const LogRecord &record) {
+        std::lock_guard lock(m_mutex);
+        if (m_records.size() == m_capacity) {
+            return false;
+        }
+        m_records.push_back(record);
+        return true;
+    }
+
+    bool TryPop(LogRecord &record) {
+        std::lock_guard lock(m_mutex);
+        if (m_records.empty()) {
+            return false;
+        }
+        record = m_records.front();
+        m_records.pop_front();
+        return true;
+    }
+
+private:
+    size_t m_capacity;
+    std::mutex m_mutex;
+    std::deque<LogRecord> m_records;
+};
+
+struct Result {
+    double pushNanoseconds = 0;  // Per push, averaged over the producers
+    double recordsPerSecond = 0; // Records delivered to the consumer
+    uint64_t full = 0;           // Pushes that found the queue full and were retried
+    bool intact = true;
+};
+
+template <typename Queue>
+Result Run(size_t producerCount, uint64_t records) {
+    Queue queue(CAPACITY);
+    std::atomic<size_t> ready = 0;
+    std::atomic<bool> start = false;
+    std::atomic<size_t> finished = 0;
+    std::atomic<uint64_t> pushNanoseconds = 0;
+    std::atomic<uint64_t> full = 0;
+
+    const auto producer = [&](uint32_t index) {
+        LogRecord record;
+        record.pattern = "bench";
+        ++ready;
+        while (!start.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+        uint64_t retries = 0;
+        const auto begin = std::chrono::steady_clock::now();
+        for (uint64_t sequence = 0; sequence < records; ++sequence) {
+            std::memcpy(record.payload.data(), &index, sizeof(index));
+            std::memcpy(record.payload.data() + sizeof(uint64_t), &sequence, sizeof(sequence));
+            while (!queue.TryPush(record)) {
+                ++retries;
+                std::this_thread::yield();
+            }
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - begin;
+        pushNanoseconds += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        full += retries;
+        ++finished;
+    };
+
+    std::vector<std::thread> producers;
+    for (size_t i = 0; i < producerCount; ++i) {
+        producers.emplace_back(producer, static_cast<uint32_t>(i));
+    }
+    while (ready.load() != producerCount) {
+        std::this_thread::yield();
+    }
+
+    // The consumer runs on this thread
+    std::vector<uint64_t> expected(producerCount, 0);
+    uint64_t received = 0;
+    bool intact = true;
+    const auto consume = [&](const LogRecord &record) {
+        uint32_t index = 0;
+        uint64_t sequence = 0;
+        std::memcpy(&index, record.payload.data(), sizeof(index));
+        std::memcpy(&sequence, record.payload.data() + sizeof(uint64_t), sizeof(sequence));
+        if (index >= producerCount || sequence != expected[index]) {
+            intact = false;
+        } else {
+            expected[index] = sequence + 1;
+        }
+        ++received;
+    };
+
+    const auto begin = std::chrono::steady_clock::now();
+    start.store(true, std::memory_order_release);
+    LogRecord record;
+    while (finished.load(std::memory_order_acquire) != producerCount) {
+        if (queue.TryPop(record)) {
+            consume(record);
+        }
+    }
+    while (queue.TryPop(record)) {
+        consume(record);
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    for (std::thread &thread : producers) {
+        thread.join();
+    }
+
+    Result result;
+    result.pushNanoseconds = static_cast<double>(pushNanoseconds.load()) / static_cast<double>(records * producerCount);
+    result.recordsPerSecond = static_cast<double>(received) / seconds;
+    result.full = full.load();
+    result.intact = intact && received == records * producerCount;
+    return result;
+}
+
+void Print(const char *name, size_t producerCount, uint64_t records, const Result &result) {
+    std::printf("%9zu %-8s %10.1f %14.2f %9.2f%%\n", producerCount, name, result.pushNanoseconds,
+                result.recordsPerSecond / 1e6,
+                100.0 * static_cast<double>(result.full) / static_cast<double>(records * producerCount));
+    if (!result.intact) {
+        std::fprintf(stderr, "%s: records lost, duplicated or reordered with %zu producers\n", name, producerCount);
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    const uint64_t records = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    std::vector<size_t> producerCounts;
+    for (int i = 2; i < argc; ++i) {
+        producerCounts.push_back(std::strtoul(argv[i], nullptr, 10));
+    }
+    if (producerCounts.empty()) {
+        const size_t hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+        for (size_t count = 1; count < hardwareThreads; count *= 2) {
+            producerCounts.push_back(count);
+        }
+        producerCounts.push_back(hardwareThreads);
+    }
+    if (records == 0 || std::ranges::find(producerCounts, size_t{0}) != producerCounts.end()) {
+        std::fprintf(stderr, "Usage: %s [<records per producer>] [<producer count>...]\n", argv[0]);
+        return 2;
+    }
+
+    std::printf("%llu records per producer, capacity %zu, one consumer\n", static_cast<unsigned long long>(records),
+                CAPACITY);
+    std::printf("%9s %-8s %10s %14s %10s\n", "producers", "queue", "push ns", "Mrecords/s", "full");
+    bool intact = true;
+    for (const size_t producerCount : producerCounts) {
+        const Result ring = Run<LogRing>(producerCount, records);
+        const Result mutex = Run<MutexQueue>(producerCount, records);
+        Print("ring", producerCount, records, ring);
+        Print("mutex", producerCount, records, mutex);
+        intact = intact && ring.intact && mutex.intact;
+    }
+    return intact ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,290 @@
+// Adds SplinterCellPatch.dll to the import table of game executables, or removes it, so the games load the DLL
+// without an injector or launcher. Directories are searched recursively for .exe files, which are processed in
+// parallel.
+// Usage: SplinterCellPatcher add|remove|laa|no-laa|check [--force] [--jobs <n>] <exe or directory>...
+//
+// A stored checksum that does not match the file is reported and the file is left alone unless --force is given.
+// Patched files get a fresh checksum; removing the patch restores the original bytes. The DLL has to sit next to
+// the executable (or anywhere on the DLL search path).
+//
+// laa sets the LARGE_ADDRESS_AWARE flag, which gives 32-bit games 4 GiB of address space on 64-bit Windows instead
+// of 2 GiB; no-laa clears it again. check reports the flag and the resulting address space.
+
+#include "pe_image.h"
+#include "string_utils.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr std::string_view DLL_NAME = "SplinterCellPatch.dll";
+constexpr std::string_view DLL_SYMBOL = "DummyExport"; // Any export works; this one exists for injectors
+
+enum class Command : uint8_t {
+    Add,
+    Remove,
+    LargeAddressAware,
+    NoLargeAddressAware,
+    Check,
+};
+
+constexpr std::pair<Command, std::string_view> COMMAND_NAMES[] = {
+    {Command::Add, "add"},
+    {Command::Remove, "remove"},
+    {Command::LargeAddressAware, "laa"},
+    {Command::NoLargeAddressAware, "no-laa"},
+    {Command::Check, "check"},
+};
+
+enum class Outcome : uint8_t {
+    Changed,
+    Unchanged,
+    Failed,
+};
+
+struct Options {
+    Command command = Command::Check;
+    bool force = false;
+    unsigned jobs = 0;
+};
+
+bool ReadBinaryFile(const fs::path &path, std::vector<uint8_t> &bytes) {
+    std::ifstream input(path, std::ios::binary);
+    if (!input) {
+        return false;
+    }
+    bytes.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+    return !input.bad();
+}
+
+// Writes next to the target and renames over it, so an interrupted run never leaves a half-written executable
+bool ReplaceBinaryFile(const fs::path &path, const std::vector<uint8_t> &bytes) {
+    fs::path temporary = path;
+    temporary += ".scpatch-tmp";
+    {
+        std::ofstream output(temporary, std::ios::binary | std::ios::trunc);
+        output.write(reinterpret_cast<const char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        if (!output) {
+            return false;
+        }
+    }
+    std::error_code error;
+    fs::rename(temporary, path, error);
+    if (error) {
+        fs::remove(temporary, error);
+        return false;
+    }
+    return true;
+}
+
+bool ChecksumMatches(const PeInfo &info) {
+    return info.storedChecksum == 0 || info.storedChecksum == info.computedChecksum;
+}
+
+bool LargeAddressAware(const PeInfo &info) {
+    return (info.characteristics & PE_LARGE_ADDRESS_AWARE) != 0;
+}
+
+std::string AddressSpaceText(const PeInfo &info) {
+    const uint64_t gib = PeUserAddressSpace(info) >> 30;
+    return gib >= 1024 ? std::to_string(gib >> 10) + " TiB" : std::to_string(gib) + " GiB";
+}
+
+PeStatus Edit(Command command, std::vector<uint8_t> &bytes) {
+    switch (command) {
+        case Command::Add: return AddPeImport(bytes, DLL_NAME, DLL_SYMBOL);
+        case Command::Remove: return RemovePeImport(bytes);
+        case Command::LargeAddressAware: return SetPeLargeAddressAware(bytes, true);
+        case Command::NoLargeAddressAware: return SetPeLargeAddressAware(bytes, false);
+        case Command::Check: break;
+    }
+    return PeStatus::Ok;
+}
+
+// The edited image must parse, carry exactly the change that was asked for and have a valid checksum
+bool VerifyEdit(Command command, const PeInfo &before, const std::vector<uint8_t> &bytes) {
+    PeInfo result;
+    if (ReadPeInfo(bytes, result) != PeStatus::Ok) {
+        return false;
+    }
+    const bool imported =
+        std::ranges::any_of(result.imports, [](const std::string &name) { return EqualsIgnoreCase(name, DLL_NAME); });
+    switch (command) {
+        case Command::Add:
+            return result.patched && imported && ChecksumMatches(result);
+        case Command::Remove:
+            return !result.patched && !imported;
+        case Command::LargeAddressAware:
+        case Command::NoLargeAddressAware:
+            return LargeAddressAware(result) == (command == Command::LargeAddressAware) &&
+                   result.patched == before.patched && result.storedChecksum == result.computedChecksum;
+        case Command::Check:
+            break;
+    }
+    return true;
+}
+
+std::string_view ChangedMessage(Command command) {
+    switch (command) {
+        case Command::Add: return "patched";
+        case Command::Remove: return "restored";
+        case Command::LargeAddressAware: return "large address aware";
+        case Command::NoLargeAddressAware: return "large address awareness cleared";
+        case Command::Check: break;
+    }
+    return "unchanged";
+}
+
+// Returns the outcome and a one-line description
+Outcome ProcessFile(const fs::path &path, const Options &options, std::string &message) {
+    std::vector<uint8_t> bytes;
+    if (!ReadBinaryFile(path, bytes)) {
+        message = "cannot read";
+        return Outcome::Failed;
+    }
+    PeInfo info;
+    if (const PeStatus status = ReadPeInfo(bytes, info); status != PeStatus::Ok) {
+        message = PeStatusName(status);
+        return Outcome::Failed;
+    }
+    const bool checksumOk = ChecksumMatches(info);
+
+    if (options.command == Command::Check) {
+        message = std::string(info.patched ? "patched" : "not patched") + ", " + (info.pe32Plus ? "PE32+" : "PE32") +
+                  (LargeAddressAware(info) ? ", large address aware" : "") + ", " + AddressSpaceText(info) +
+                  " address space, checksum " + (info.storedChecksum == 0 ? "not set" : checksumOk ? "ok" : "MISMATCH");
+        return checksumOk ? Outcome::Unchanged : Outcome::Failed;
+    }
+    if (!checksumOk && !options.force) {
+        message = "checksum mismatch, file may be damaged (use --force to patch anyway)";
+        return Outcome::Failed;
+    }
+
+    const PeStatus status = Edit(options.command, bytes);
+    if (status == PeStatus::AlreadyPatched || status == PeStatus::NotPatched || status == PeStatus::AlreadySet) {
+        message = PeStatusName(status);
+        return Outcome::Unchanged;
+    }
+    if (status != PeStatus::Ok) {
+        message = PeStatusName(status);
+        return Outcome::Failed;
+    }
+
+    // Re-read the result before it replaces the original
+    if (!VerifyEdit(options.command, info, bytes)) {
+        message = "verification of the edited image failed, file left unchanged";
+        return Outcome::Failed;
+    }
+    if (!ReplaceBinaryFile(path, bytes)) {
+        message = "cannot write";
+        return Outcome::Failed;
+    }
+    message = ChangedMessage(options.command);
+    if (options.command == Command::LargeAddressAware || options.command == Command::NoLargeAddressAware) {
+        PeInfo result;
+        if (ReadPeInfo(bytes, result) == PeStatus::Ok) {
+            message += ", " + AddressSpaceText(result) + " address space";
+        }
+    }
+    return Outcome::Changed;
+}
+
+void CollectExecutables(const fs::path &path, std::vector<fs::path> &files) {
+    std::error_code error;
+    if (!fs::is_directory(path, error)) {
+        files.push_back(path);
+        return;
+    }
+    for (auto it = fs::recursive_directory_iterator(path, fs::directory_options::skip_permission_denied, error);
+         it != fs::recursive_directory_iterator(); it.increment(error)) {
+        if (it->is_regular_file(error) && EqualsIgnoreCase(it->path().extension().string(), ".exe")) {
+            files.push_back(it->path());
+        }
+    }
+}
+
+bool ParseOptions(int argc, char **argv, Options &options, std::vector<fs::path> &targets) {
+    if (argc < 3) {
+        return false;
+    }
+    const auto command = std::ranges::find(COMMAND_NAMES, std::string_view(argv[1]),
+                                           &std::pair<Command, std::string_view>::second);
+    if (command == std::end(COMMAND_NAMES)) {
+        return false;
+    }
+    options.command = command->first;
+    for (int i = 2; i < argc; ++i) {
+        const std::string_view argument = argv[i];
+        if (argument == "--force") {
+            options.force = true;
+        } else if (argument == "--jobs" && i + 1 < argc) {
+            options.jobs = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else {
+            targets.emplace_back(argv[i]);
+        }
+    }
+    return !targets.empty();
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    Options options;
+    std::vector<fs::path> targets;
+    if (!ParseOptions(argc, argv, options, targets)) {
+        std::fprintf(stderr, "Usage: %s add|remove|laa|no-laa|check [--force] [--jobs <n>] <exe or directory>...\n",
+                     argv[0]);
+        return 2;
+    }
+
+    std::vector<fs::path> files;
+    for (const fs::path &target : targets) {
+        CollectExecutables(target, files);
+    }
+
+    // Files are handed out one at a time; each worker reads, edits and writes its own file
+    std::atomic<size_t> next = 0;
+    std::array<std::atomic<size_t>, 3> counts = {};
+    std::mutex outputMutex;
+    const auto worker = [&] {
+        for (size_t i = next++; i < files.size(); i = next++) {
+            std::string message;
+            const Outcome outcome = ProcessFile(files[i], options, message);
+            ++counts[static_cast<size_t>(outcome)];
+            std::lock_guard lock(outputMutex);
+            std::fprintf(outcome == Outcome::Failed ? stderr : stdout, "%s: %s\n", files[i].string().c_str(),
+                         message.c_str());
+        }
+    };
+
+    const unsigned jobs = std::clamp<unsigned>(options.jobs != 0 ? options.jobs : std::thread::hardware_concurrency(),
+                                               1, static_cast<unsigned>(std::max<size_t>(files.size(), 1)));
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < jobs; ++i) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    std::printf("%zu file(s): %zu changed, %zu unchanged, %zu failed\n", files.size(),
+                counts[static_cast<size_t>(Outcome::Changed)].load(),
+                counts[static_cast<size_t>(Outcome::Unchanged)].load(),
+                counts[static_cast<size_t>(Outcome::Failed)].load());
+    return counts[static_cast<size_t>(Outcome::Failed)] != 0 ? 1 : 0;
+}
\ No newline at end of file
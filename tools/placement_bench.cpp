@@ -0,0 +1,238 @@
+// Compares the two placement modes of the SetProcessAffinityMask hook (see PlacementMode in settings.h) on a
+// synthetic frame workload: a hard process affinity mask against process default CPU Sets.
+// Usage: SplinterCellPlacementBench [<policy>] [<frames>] [<worker threads>] [<background threads>]
+//        (defaults: physical-cores-only, 2000 frames, one worker per processor the policy selects, a quarter as
+//        many background threads but at least one)
+//
+// Every frame, each worker runs the same fixed amount of work and the frame ends when the last one finishes, as a
+// game waits for its jobs. Background threads are pinned to the fastest processors of the policy at above normal
+// priority and spin there, standing in for interrupts and other programs. With a hard mask the workers cannot leave
+// those processors; with CPU Sets the scheduler may move them elsewhere. The policy is placed in processor group 0,
+// where SetProcessAffinityMask applies, and the process mask and CPU Sets are reset after every mode.
+
+#include "processor_groups.h"
+#include "settings.h"
+#include "thread_placement.h"
+#include "topology.h"
+#include <windows.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <optional>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr uint64_t WORK_PER_FRAME = 1u << 18; // Iterations per worker and frame, a fraction of a millisecond
+
+enum class Placement {
+    None,
+    Hard,
+    Soft,
+};
+
+struct Result {
+    bool applied = false;
+    DWORD error = 0; // Why the placement could not be applied
+    double framesPerSecond = 0;
+    double medianMicroseconds = 0;
+    double p99Microseconds = 0;
+    double maxMicroseconds = 0;
+};
+
+// Workers wait for the frame number to change and count themselves done
+struct FrameSync {
+    std::atomic<uint64_t> frame = 0; // 0 before the first frame, UINT64_MAX to stop
+    std::atomic<size_t> done = 0;
+};
+
+uint64_t Work(uint64_t state) {
+    for (uint64_t i = 0; i < WORK_PER_FRAME; ++i) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+    }
+    return state;
+}
+
+void Worker(FrameSync &sync, size_t workerCount, uint64_t seed, std::atomic<uint64_t> &sink) {
+    uint64_t seen = 0;
+    uint64_t state = seed;
+    for (;;) {
+        sync.frame.wait(seen);
+        seen = sync.frame.load();
+        if (seen == UINT64_MAX) {
+            break;
+        }
+        state = Work(state);
+        if (sync.done.fetch_add(1) + 1 == workerCount) {
+            sync.done.notify_one();
+        }
+    }
+    sink += state;
+}
+
+bool Apply(Placement placement, const CpuTopology &topology, const ProcessorSet &processors) {
+    switch (placement) {
+    case Placement::None:
+        return true;
+    case Placement::Hard:
+        return SetProcessAffinityMask(GetCurrentProcess(), static_cast<DWORD_PTR>(processors.GroupMask(0)));
+    case Placement::Soft:
+        return SetProcessCpuSets(GetCurrentProcess(), topology, processors);
+    }
+    return false;
+}
+
+void Reset(DWORD_PTR processMask) {
+    SetProcessDefaultCpuSets(GetCurrentProcess(), nullptr, 0);
+    SetProcessAffinityMask(GetCurrentProcess(), processMask);
+}
+
+Result Run(Placement placement, const CpuTopology &topology, const ProcessorSet &processors,
+           const std::vector<uint32_t> &busyProcessors, size_t workerCount, uint64_t frames) {
+    Result result;
+    if (!Apply(placement, topology, processors)) {
+        result.error = GetLastError();
+        return result;
+    }
+    result.applied = true;
+
+    // Background threads get hard masks of their own, inside the policy, so every mode shares the same busy cores
+    std::atomic<bool> stop = false;
+    std::vector<std::thread> background;
+    for (const uint32_t index : busyProcessors) {
+        background.emplace_back([&stop, index] {
+            SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR{1} << (index % PROCESSORS_PER_GROUP));
+            SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_ABOVE_NORMAL);
+            volatile uint64_t spin = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                spin = spin + 1;
+            }
+        });
+    }
+
+    FrameSync sync;
+    std::atomic<uint64_t> sink = 0;
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < workerCount; ++i) {
+        workers.emplace_back(Worker, std::ref(sync), workerCount, 0x2545F4914F6CDD1Dull * (i + 1), std::ref(sink));
+    }
+
+    std::vector<double> frameTimes;
+    frameTimes.reserve(frames);
+    const auto begin = std::chrono::steady_clock::now();
+    for (uint64_t frame = 1; frame <= frames; ++frame) {
+        const auto frameBegin = std::chrono::steady_clock::now();
+        sync.done = 0;
+        sync.frame = frame;
+        sync.frame.notify_all();
+        for (size_t done = sync.done.load(); done != workerCount; done = sync.done.load()) {
+            sync.done.wait(done);
+        }
+        frameTimes.push_back(
+            std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - frameBegin).count());
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    sync.frame = UINT64_MAX;
+    sync.frame.notify_all();
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+    stop = true;
+    for (std::thread &thread : background) {
+        thread.join();
+    }
+
+    std::ranges::sort(frameTimes);
+    result.framesPerSecond = static_cast<double>(frames) / seconds;
+    result.medianMicroseconds = frameTimes[frameTimes.size() / 2];
+    result.p99Microseconds = frameTimes[frameTimes.size() * 99 / 100];
+    result.maxMicroseconds = frameTimes.back();
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    const std::optional<AffinityPolicy> policy =
+        ParseAffinityPolicy(argc > 1 ? argv[1] : AffinityPolicyName(AffinityPolicy::PhysicalCoresOnly));
+    const uint64_t frames = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 2000;
+    if (!policy || frames == 0) {
+        std::fprintf(stderr, "Usage: %s [<policy>] [<frames>] [<worker threads>] [<background threads>]\n", argv[0]);
+        return 2;
+    }
+
+    CpuTopology topology;
+    if (!LoadTopologyFromSystem(topology)) {
+        std::fprintf(stderr, "Cannot read the topology\n");
+        return 1;
+    }
+    constexpr uint64_t maskBits = AFFINITY_MASK_BITS >= 64 ? ~uint64_t{0} : (uint64_t{1} << AFFINITY_MASK_BITS) - 1;
+    const ProcessorSet processors =
+        ComputePolicySet(topology, *policy).Intersect(ProcessorSet::FromGroupMask(0, maskBits));
+    if (processors.Empty()) {
+        std::fprintf(stderr, "The policy selects no processor of group 0\n");
+        return 1;
+    }
+
+    const size_t workerCount = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : processors.Count();
+    const size_t backgroundCount =
+        argc > 4 ? std::strtoul(argv[4], nullptr, 10) : std::max<size_t>(1, processors.Count() / 4);
+    if (workerCount == 0) {
+        std::fprintf(stderr, "Usage: %s [<policy>] [<frames>] [<worker threads>] [<background threads>]\n", argv[0]);
+        return 2;
+    }
+    std::vector<uint32_t> busyProcessors;
+    for (const ThreadPlacement &core : OrderCoresBySpeed(topology, processors)) {
+        if (busyProcessors.size() == backgroundCount) {
+            break;
+        }
+        busyProcessors.push_back(core.idealProcessor);
+    }
+
+    DWORD_PTR processMask = 0;
+    DWORD_PTR systemMask = 0;
+    if (!GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask)) {
+        std::fprintf(stderr, "GetProcessAffinityMask failed with error: 0x%lX\n", GetLastError());
+        return 1;
+    }
+
+    const std::string_view policyName = AffinityPolicyName(*policy);
+    std::printf("%.*s: %u of %zu processors, %zu workers, %zu background threads, %llu frames\n",
+                static_cast<int>(policyName.size()), policyName.data(), processors.Count(),
+                topology.processors.size(), workerCount, busyProcessors.size(),
+                static_cast<unsigned long long>(frames));
+    std::printf("%-14s %10s %12s %12s %12s\n", "placement", "frames/s", "median us", "p99 us", "max us");
+
+    struct Mode {
+        Placement placement;
+        std::string_view name;
+    };
+    const Mode modes[] = {
+        {Placement::None, "none"},
+        {Placement::Hard, PlacementModeName(PlacementMode::HardAffinity)},
+        {Placement::Soft, PlacementModeName(PlacementMode::SoftCpuSets)},
+    };
+    int status = 0;
+    for (const Mode &mode : modes) {
+        const Result result = Run(mode.placement, topology, processors, busyProcessors, workerCount, frames);
+        Reset(processMask);
+        if (!result.applied) {
+            std::printf("%-14.*s cannot be applied, error 0x%lX\n", static_cast<int>(mode.name.size()),
+                        mode.name.data(), result.error);
+            status = 1;
+            continue;
+        }
+        std::printf("%-14.*s %10.1f %12.1f %12.1f %12.1f\n", static_cast<int>(mode.name.size()), mode.name.data(),
+                    result.framesPerSecond, result.medianMicroseconds, result.p99Microseconds,
+                    result.maxMicroseconds);
+    }
+    return status;
+}
\ No newline at end of file
@@ -0,0 +1,93 @@
+// Prints live hook statistics of a process running SplinterCellPatch.dll.
+// Usage: SplinterCellStats <process id> [<interval ms>]    (runs until interrupted)
+
+#include "hook_stats.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <thread>
+
+namespace {
+
+double TicksToMicroseconds(uint64_t ticks, uint64_t ticksPerSecond) {
+    return static_cast<double>(ticks) * 1e6 / static_cast<double>(ticksPerSecond);
+}
+
+// Headroom matters most for 32-bit games: large allocations fail once the largest free region runs out, well before
+// the free total does
+void PrintAddressSpace(const AddressSpaceUsage &usage) {
+    if (usage.total == 0) {
+        return;
+    }
+    constexpr double MIB = 1024.0 * 1024.0;
+    std::printf("address space: %.0f MiB free of %.0f MiB (%.1f%%), largest free region %.0f MiB\n",
+                static_cast<double>(usage.free) / MIB, static_cast<double>(usage.total) / MIB,
+                100.0 * static_cast<double>(usage.free) / static_cast<double>(usage.total),
+                static_cast<double>(usage.largestFree) / MIB);
+}
+
+void PrintRates(const std::array<HookTotals, STATS_HOOKS> &current, const std::array<HookTotals, STATS_HOOKS> &previous,
+                double seconds, uint64_t ticksPerSecond) {
+    std::printf("%-24s %10s %10s %10s %12s %10s %10s\n", "hook", "calls/s", "rewrites/s", "failures/s", "calls",
+                "p50 us", "p99 us");
+    for (uint32_t hook = 1; hook < STATS_HOOKS; ++hook) {
+        const HookTotals &now = current[hook];
+        const HookTotals &before = previous[hook];
+        if (now.calls == 0) {
+            continue;
+        }
+        const std::string name(TRACE_HOOKS[hook].name);
+        std::printf("%-24s %10.1f %10.1f %10.1f %12llu", name.c_str(),
+                    static_cast<double>(now.calls - before.calls) / seconds,
+                    static_cast<double>(now.rewrites - before.rewrites) / seconds,
+                    static_cast<double>(now.failures - before.failures) / seconds,
+                    static_cast<unsigned long long>(now.calls));
+        // Timer hooks do not time the real call
+        if (std::accumulate(now.latency.begin(), now.latency.end(), uint64_t{0}) == 0) {
+            std::printf(" %10s %10s\n", "-", "-");
+        } else {
+            std::printf(" %10.2f %10.2f\n", TicksToMicroseconds(LatencyPercentile(now.latency, 0.5), ticksPerSecond),
+                        TicksToMicroseconds(LatencyPercentile(now.latency, 0.99), ticksPerSecond));
+        }
+    }
+    std::printf("\n");
+    std::fflush(stdout);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    if (argc < 2 || argc > 3) {
+        std::cerr << "Usage: " << argv[0] << " <process id> [<interval ms>]\n";
+        return 2;
+    }
+    const auto processId = static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10));
+    const long intervalMs = argc == 3 ? std::strtol(argv[2], nullptr, 10) : 1000;
+    if (processId == 0 || intervalMs <= 0) {
+        std::cerr << "Invalid process id or interval\n";
+        return 2;
+    }
+
+    HookStatsReader reader;
+    if (!reader.Open(processId)) {
+        std::cerr << "Process " << processId << " publishes no SplinterCellPatch statistics\n";
+        return 1;
+    }
+
+    // Percentiles are bucket upper bounds, so they overstate latency by less than 2x
+    std::array<HookTotals, STATS_HOOKS> previous = reader.Snapshot();
+    auto previousTime = std::chrono::steady_clock::now();
+    for (;;) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(intervalMs));
+        const std::array<HookTotals, STATS_HOOKS> current = reader.Snapshot();
+        const auto now = std::chrono::steady_clock::now();
+        const double seconds = std::chrono::duration<double>(now - previousTime).count();
+        PrintAddressSpace(reader.AddressSpace());
+        PrintRates(current, previous, seconds, reader.TicksPerSecond());
+        previous = current;
+        previousTime = now;
+    }
+}
\ No newline at end of file
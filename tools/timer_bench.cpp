@@ -0,0 +1,153 @@
+// Cost of a clamped timer reading (see monotonic_clock.h) against the native clock, as the timer hooks pay it.
+// Usage: SplinterCellTimerBench [<readings per thread>] [<thread count>...]
+//        (defaults: 10000000 readings, 1 2 4 ... up to the number of hardware threads)
+//
+// The native clock is QueryPerformanceCounter on Windows and steady_clock elsewhere. Every thread reads it in a
+// tight loop, as a game polling the timer does, directly, through MonotonicCounter, and through a maximum guarded by
+// a mutex, for comparison. Readings going backwards within a thread are counted; for the clamped clocks there must be
+// none. (tests/monotonic_clock_test.cpp checks the ordering across threads.)
+
+#include "monotonic_clock.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+namespace {
+
+#ifdef _WIN32
+constexpr const char *CLOCK_NAME = "QueryPerformanceCounter";
+
+uint64_t ReadClock() {
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    return static_cast<uint64_t>(counter.QuadPart);
+}
+#else
+constexpr const char *CLOCK_NAME = "steady_clock";
+
+uint64_t ReadClock() {
+    return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+}
+#endif
+
+MonotonicCounter<uint64_t> g_counter;
+std::mutex g_lockedMutex;
+uint64_t g_lockedMaximum = 0;
+
+uint64_t ReadNative() {
+    return ReadClock();
+}
+
+uint64_t ReadMonotonic() {
+    return g_counter.Advance(ReadClock());
+}
+
+uint64_t ReadLockedMaximum() {
+    const uint64_t raw = ReadClock();
+    std::lock_guard lock(g_lockedMutex);
+    g_lockedMaximum = std::max(g_lockedMaximum, raw);
+    return g_lockedMaximum;
+}
+
+struct Reader {
+    const char *name;
+    uint64_t (*read)();
+};
+
+constexpr Reader READERS[] = {
+    {"native", ReadNative},
+    {"monotonic", ReadMonotonic},
+    {"locked max", ReadLockedMaximum},
+};
+
+struct Result {
+    double nanoseconds = 0; // Per reading
+    uint64_t backwards = 0;
+};
+
+Result Run(const Reader &reader, size_t threadCount, uint64_t readings) {
+    std::atomic<size_t> ready = 0;
+    std::atomic<bool> start = false;
+    std::atomic<uint64_t> backwards = 0;
+    const auto worker = [&] {
+        ++ready;
+        while (!start.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+        uint64_t previous = 0;
+        uint64_t count = 0;
+        for (uint64_t i = 0; i < readings; ++i) {
+            const uint64_t value = reader.read();
+            count += value < previous ? 1 : 0;
+            previous = value;
+        }
+        backwards += count;
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < threadCount; ++i) {
+        threads.emplace_back(worker);
+    }
+    while (ready.load() != threadCount) {
+        std::this_thread::yield();
+    }
+    const auto begin = std::chrono::steady_clock::now();
+    start.store(true, std::memory_order_release);
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    const double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+    return {elapsed / static_cast<double>(readings), backwards.load()};
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    const uint64_t readings = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+    std::vector<size_t> threadCounts;
+    for (int i = 2; i < argc; ++i) {
+        threadCounts.push_back(std::strtoul(argv[i], nullptr, 10));
+    }
+    if (threadCounts.empty()) {
+        const size_t hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+        for (size_t count = 1; count < hardwareThreads; count *= 2) {
+            threadCounts.push_back(count);
+        }
+        threadCounts.push_back(hardwareThreads);
+    }
+    if (readings == 0 || std::ranges::find(threadCounts, size_t{0}) != threadCounts.end()) {
+        std::fprintf(stderr, "Usage: %s [<readings per thread>] [<thread count>...]\n", argv[0]);
+        return 2;
+    }
+
+    g_counter.Seed(ReadClock());
+    g_lockedMaximum = ReadClock();
+    std::printf("%s, %llu readings per thread, ns per reading\n", CLOCK_NAME,
+                static_cast<unsigned long long>(readings));
+    std::printf("%8s %12s %12s %12s\n", "threads", READERS[0].name, READERS[1].name, READERS[2].name);
+    bool ordered = true;
+    for (const size_t threadCount : threadCounts) {
+        double nanoseconds[std::size(READERS)] = {};
+        for (size_t i = 0; i < std::size(READERS); ++i) {
+            const Result result = Run(READERS[i], threadCount, readings);
+            nanoseconds[i] = result.nanoseconds;
+            // The native clock is allowed to go backwards, that is what the clamp is for
+            if (i != 0 && result.backwards != 0) {
+                std::fprintf(stderr, "%s: %llu readings went backwards with %zu threads\n", READERS[i].name,
+                             static_cast<unsigned long long>(result.backwards), threadCount);
+                ordered = false;
+            }
+        }
+        std::printf("%8zu %12.1f %12.1f %12.1f\n", threadCount, nanoseconds[0], nanoseconds[1], nanoseconds[2]);
+    }
+    std::printf("monotonic: %llu readings clamped\n", static_cast<unsigned long long>(g_counter.Clamped()));
+    return ordered ? 0 : 1;
+}
\ No newline at end of file
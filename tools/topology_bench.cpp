@@ -0,0 +1,66 @@
+// Times topology discovery and the affinity policy computation, the work behind every SetProcessAffinityMask the
+// hooks rewrite (see topology.h).
+// Usage: SplinterCellTopologyBench [<sysfs cpu directory>] [<iterations>]
+//        (defaults: the running machine's topology, 100000 iterations)
+//
+// A directory is read with LoadTopologyFromSysfs, so a copy of /sys/devices/system/cpu taken on another machine
+// benchmarks that machine's layout on any platform.
+
+#include "topology.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace {
+
+constexpr AffinityPolicy POLICIES[] = {
+    AffinityPolicy::AllCores,
+    AffinityPolicy::PhysicalCoresOnly,
+    AffinityPolicy::SingleL3Domain,
+    AffinityPolicy::PerformanceCoresOnly,
+};
+
+bool Load(const std::string &root, CpuTopology &topology) {
+    return root.empty() ? LoadTopologyFromSystem(topology) : LoadTopologyFromSysfs(root, topology);
+}
+
+double NanosecondsSince(std::chrono::steady_clock::time_point begin, uint64_t iterations) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count() /
+           static_cast<double>(iterations);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    const std::string root = argc > 1 ? argv[1] : "";
+    const uint64_t iterations = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 100000;
+    if (iterations == 0) {
+        std::fprintf(stderr, "Usage: %s [<sysfs cpu directory>] [<iterations>]\n", argv[0]);
+        return 2;
+    }
+
+    CpuTopology topology;
+    const auto loadBegin = std::chrono::steady_clock::now();
+    if (!Load(root, topology)) {
+        std::fprintf(stderr, "Cannot read the topology%s%s\n", root.empty() ? "" : " from ", root.c_str());
+        return 1;
+    }
+    const double loadNs = NanosecondsSince(loadBegin, 1);
+    std::printf("%zu logical processors, %zu L3 domains, loaded in %.1f us\n", topology.processors.size(),
+                RankL3Domains(topology, topology.All()).size(), loadNs / 1000);
+
+    std::printf("%-22s %10s %12s\n", "policy", "processors", "ns per call");
+    uint32_t sink = 0;
+    for (const AffinityPolicy policy : POLICIES) {
+        const auto begin = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < iterations; ++i) {
+            sink += ComputePolicySet(topology, policy).Count();
+        }
+        const double ns = NanosecondsSince(begin, iterations);
+        const std::string_view name = AffinityPolicyName(policy);
+        std::printf("%-22.*s %10u %12.1f\n", static_cast<int>(name.size()), name.data(),
+                    ComputePolicySet(topology, policy).Count(), ns);
+    }
+    return sink == 0 ? 1 : 0;
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+// Converts a hook trace written by SplinterCellPatch.dll into Chrome/Perfetto JSON.
+// Usage: SplinterCellTraceConvert <trace file> [<output.json>]    (writes to stdout without an output file)
+
+#include "chrome_trace.h"
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+int main(int argc, char **argv) {
+    if (argc < 2 || argc > 3) {
+        std::cerr << "Usage: " << argv[0] << " <trace file> [<output.json>]\n";
+        return 2;
+    }
+
+    std::ifstream input(argv[1], std::ios::binary);
+    if (!input) {
+        std::cerr << "Cannot open " << argv[1] << '\n';
+        return 1;
+    }
+    std::vector<char> bytes{std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>()};
+
+    std::ofstream file;
+    if (argc == 3) {
+        file.open(argv[2]);
+        if (!file) {
+            std::cerr << "Cannot create " << argv[2] << '\n';
+            return 1;
+        }
+    }
+    std::ostream &out = argc == 3 ? file : std::cout;
+
+    if (!ConvertTraceToChromeJson(std::as_bytes(std::span(bytes)), out)) {
+        std::cerr << argv[1] << " is not a supported SplinterCellPatch trace\n";
+        return 1;
+    }
+    return 0;
+}
\ No newline at end of file